@@ -10,6 +10,7 @@ in VS_OUT {
    float Intensity;
    mat3 TBN;
    flat int meshIndex;
+   flat int drawIndex;
 } fs_in;
 
 // ---- LIGHTING MODE CONSTANTS ----
@@ -120,6 +121,61 @@ uniform bool isChunkOutline;
 uniform int selectedMeshIndex;
 uniform bool isMeshSelected;
 
+// Per-mesh parameters of the batched mesh draws (MeshBatchRenderer), indexed by the draw's
+// base instance plus the instance. Mirrors MeshBatchRenderer::DrawParams.
+struct MeshDrawParams {
+    mat4 model;
+    vec4 positionScale;           // xyz: quantized position decode
+    vec4 positionOffset;
+    vec4 colorShininess;          // Object color, shininess in w
+    vec4 specularColorDiffusion;  // Specular color, specular diffusion in w
+    float emissive;
+    float hasTexture;
+    float diffuseReflectivity;
+    float specularReflectivity;
+    float refractiveIndex;
+    float transparency;
+    int meshIndex;
+    uint flags;                   // 1 selected, 2 normal map, 4 specular map, 8 AO map
+};
+layout (std430, binding = 5) readonly buffer MeshDrawBuffer {
+    MeshDrawParams meshDraws[];
+};
+
+// Material parameters of the current draw; the textures stay on the material uniform
+struct Surface {
+   bool hasNormalMap;
+   bool hasSpecularMap;
+   bool hasAOMap;
+   float hasTexture;
+   vec3 objectColor;
+   float shininess;
+   float emissive;
+   float diffuseReflectivity;
+   float specularReflectivity;
+   vec3 specularColor;
+   float specularDiffusion;
+   float refractiveIndex;
+   float transparency;
+   bool selected;
+};
+Surface surface;
+
+void loadSurface() {
+   if (fs_in.drawIndex < 0) {
+      surface = Surface(material.hasNormalMap, material.hasSpecularMap, material.hasAOMap, material.hasTexture,
+                        material.objectColor, material.shininess, material.emissive, material.diffuseReflectivity,
+                        material.specularReflectivity, material.specularColor, material.specularDiffusion,
+                        material.refractiveIndex, material.transparency, isSelected);
+      return;
+   }
+   MeshDrawParams draw = meshDraws[fs_in.drawIndex];
+   surface = Surface((draw.flags & 2u) != 0u, (draw.flags & 4u) != 0u, (draw.flags & 8u) != 0u, draw.hasTexture,
+                     draw.colorShininess.rgb, draw.colorShininess.w, draw.emissive, draw.diffuseReflectivity,
+                     draw.specularReflectivity, draw.specularColorDiffusion.rgb, draw.specularColorDiffusion.w,
+                     draw.refractiveIndex, draw.transparency, (draw.flags & 1u) != 0u);
+}
+
 // ---- HELPER FUNCTIONS ----
 // Returns true if a world position is inside the voxel grid
 bool isInVoxelGrid(vec3 worldPos) {
@@ -172,7 +228,7 @@ vec3 calculatePointLight(PointLight light, vec3 normal, vec3 viewDir, float spec
    float diff = max(dot(normal, lightDir), 0.0);
    
    vec3 reflectDir = reflect(-lightDir, normal);
-   float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+   float spec = pow(max(dot(viewDir, reflectDir), 0.0), surface.shininess);
    
    float distance = length(light.position - fs_in.FragPos);
    float attenuation = 1.0 / (1.0 + 0.09 * distance + 0.032 * (distance * distance));
@@ -191,7 +247,7 @@ vec3 calculateSunLight(Sun sun, vec3 normal, vec3 viewDir, float specularStrengt
    float diff = max(dot(normal, lightDir), 0.0);
    
    vec3 reflectDir = reflect(-lightDir, normal);
-   float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+   float spec = pow(max(dot(viewDir, reflectDir), 0.0), surface.shininess);
    
    vec3 ambient = 0.1 * sun.color * sun.intensity;
    vec3 diffuse = diff * sun.color * sun.intensity;
@@ -354,7 +410,7 @@ vec3 traceSpecularVoxelCone(vec3 from, vec3 direction) {
     
     // Cone parameters for specular reflections
     // Tighter cone for sharp reflections, wider for rough materials
-    float coneAperture = 0.02 + 0.15 * material.specularDiffusion; // 1-9 degrees
+    float coneAperture = 0.02 + 0.15 * surface.specularDiffusion; // 1-9 degrees
     const float MIN_CONE_RADIUS = voxelSize * 0.5;
     
     vec4 acc = vec4(0.0);
@@ -362,7 +418,7 @@ vec3 traceSpecularVoxelCone(vec3 from, vec3 direction) {
     float maxDist = min(vctSettings.tracingMaxDistance, length(gridMax - gridMin) * 0.6);
     
     // Use more samples for high-quality reflections
-    int maxSteps = min(12, int(8.0 + 4.0 / (material.specularDiffusion + 0.1)));
+    int maxSteps = min(12, int(8.0 + 4.0 / (surface.specularDiffusion + 0.1)));
     
     for (int i = 0; i < maxSteps && dist < maxDist && acc.a < 0.98; i++) {
         vec3 samplePos = from + dist * direction;
@@ -400,7 +456,7 @@ vec3 traceSpecularVoxelCone(vec3 from, vec3 direction) {
         
         // Energy conservation with proper blending
         float f = 1.0 - acc.a;
-        float weight = 0.12 * (1.0 + 0.8 * material.specularDiffusion) * distAttenuation;
+        float weight = 0.12 * (1.0 + 0.8 * surface.specularDiffusion) * distAttenuation;
         
         acc.rgb += weight * voxel.rgb * voxel.a * f;
         acc.a += weight * voxel.a * f;
@@ -411,8 +467,8 @@ vec3 traceSpecularVoxelCone(vec3 from, vec3 direction) {
     }
     
     // Final specular contribution with material properties
-    float specularStrength = material.specularReflectivity * (2.0 - material.specularDiffusion);
-    return acc.rgb * specularStrength * material.specularColor;
+    float specularStrength = surface.specularReflectivity * (2.0 - surface.specularDiffusion);
+    return acc.rgb * specularStrength * surface.specularColor;
 }
 
 vec3 traceRefractiveVoxelCone(vec3 from, vec3 direction) {
@@ -440,7 +496,7 @@ vec3 traceRefractiveVoxelCone(vec3 from, vec3 direction) {
         
         // Faster refraction LOD transition for better performance
         // Use higher mipmap levels sooner to improve performance
-        float specDiffusion = max(0.05, 0.6 * material.specularDiffusion);
+        float specDiffusion = max(0.05, 0.6 * surface.specularDiffusion);
         float level = 0.12 * specDiffusion * log2(1.0 + dist / voxelSize * 1.4); // 1.4x faster falloff
         
         // Sample surrounding points and average to reduce noise
@@ -529,7 +585,7 @@ vec3 calculateIndirectDiffuseLight(vec3 normal, vec3 baseColor) {
     float noiseAmount = 0.03;
     
     // Apply material properties with subtle noise to break patterns
-    return DIFFUSE_INDIRECT_FACTOR * material.diffuseReflectivity * 
+    return DIFFUSE_INDIRECT_FACTOR * surface.diffuseReflectivity * 
            acc * baseColor * (1.0 + noise * noiseAmount - noiseAmount/2.0);
 }
 
@@ -548,12 +604,12 @@ vec3 calculateIndirectSpecularLight(vec3 viewDirection) {
     vec3 reflection = reflect(viewDirection, normal);
     
     // Now trace the cone in the reflection direction from the fragment position
-    return material.specularReflectivity * material.specularColor * 
+    return surface.specularReflectivity * surface.specularColor * 
            traceSpecularVoxelCone(fs_in.FragPos, reflection);
 }
 
 vec3 calculateRefractiveLight(vec3 viewDirection) {
-    if (material.transparency < 0.01) return vec3(0.0);
+    if (surface.transparency < 0.01) return vec3(0.0);
     
     vec3 normal = normalize(fs_in.Normal);
     
@@ -563,7 +619,7 @@ vec3 calculateRefractiveLight(vec3 viewDirection) {
     }
     
     // Calculate refraction direction using IOR
-    vec3 refraction = refract(viewDirection, normal, 1.0/material.refractiveIndex);
+    vec3 refraction = refract(viewDirection, normal, 1.0/surface.refractiveIndex);
     
     // Handle total internal reflection
     if (length(refraction) < 0.01) {
@@ -576,7 +632,7 @@ vec3 calculateRefractiveLight(vec3 viewDirection) {
     if (!isEntering) {
         // Exiting the medium - flip normal and adjust IOR
         normal = -normal;
-        refraction = refract(viewDirection, normal, material.refractiveIndex);
+        refraction = refract(viewDirection, normal, surface.refractiveIndex);
         
         if (length(refraction) < 0.01) {
             refraction = reflect(viewDirection, normal);
@@ -584,19 +640,19 @@ vec3 calculateRefractiveLight(vec3 viewDirection) {
     }
     
     // Mix refraction color with material colors
-    vec3 baseColor = material.hasTexture > 0.5 ? 
+    vec3 baseColor = surface.hasTexture > 0.5 ? 
                     texture(material.textures[0], fs_in.TexCoords).rgb : 
-                    material.objectColor;
+                    surface.objectColor;
     
     // Get refracted light
     vec3 refractedLight = traceRefractiveVoxelCone(fs_in.FragPos, refraction);
     
     // For glass-like materials, reduce color influence for more realistic look
     float colorInfluence = 0.3;  // How much the material color affects the refraction
-    vec3 tintColor = mix(vec3(1.0), material.specularColor, colorInfluence);
+    vec3 tintColor = mix(vec3(1.0), surface.specularColor, colorInfluence);
     
     // Attenuate based on thickness
-    float attenuation = 0.7 + 0.3 * material.transparency; // Higher transparency = less attenuation
+    float attenuation = 0.7 + 0.3 * surface.transparency; // Higher transparency = less attenuation
     
     return tintColor * refractedLight * attenuation;
 }
@@ -612,20 +668,20 @@ vec3 calculateVCTSunLight(Sun sun, vec3 viewDirection) {
     
     // Specular lighting
     vec3 halfwayDir = normalize(lightDir + (-viewDirection));
-    float specAngle = pow(max(dot(normal, halfwayDir), 0.0), material.shininess);
+    float specAngle = pow(max(dot(normal, halfwayDir), 0.0), surface.shininess);
     
     // Refraction
     float refractiveAngle = 0.0;
-    if (material.transparency > 0.01) {
-        vec3 refraction = refract(viewDirection, normal, 1.0/material.refractiveIndex);
+    if (surface.transparency > 0.01) {
+        vec3 refraction = refract(viewDirection, normal, 1.0/surface.refractiveIndex);
         if (length(refraction) > 0.01) {
-            refractiveAngle = max(0.0, material.transparency * dot(refraction, lightDir));
+            refractiveAngle = max(0.0, surface.transparency * dot(refraction, lightDir));
         }
     }
     
     // Shadow calculation
     float shadow = 1.0;
-    if (vctSettings.shadows && diffuseAngle * (1.0 - material.transparency) > 0.0) {
+    if (vctSettings.shadows && diffuseAngle * (1.0 - surface.transparency) > 0.0) {
         // Sun is directional, so use a large distance
         shadow = traceShadowCone(fs_in.FragPos, lightDir, 100.0);
     }
@@ -635,18 +691,18 @@ vec3 calculateVCTSunLight(Sun sun, vec3 viewDirection) {
     specAngle = min(shadow, max(specAngle, refractiveAngle));
     
     // Get base color
-    vec3 baseColor = material.hasTexture > 0.5 ? 
+    vec3 baseColor = surface.hasTexture > 0.5 ? 
                     texture(material.textures[0], fs_in.TexCoords).rgb : 
-                    material.objectColor;
+                    surface.objectColor;
     
     // Calculate with material properties
-    float df = 1.0 / (1.0 + 0.25 * material.specularDiffusion); // Diffusion factor
-    float diffuse = diffuseAngle * (1.0 - material.transparency);
+    float df = 1.0 / (1.0 + 0.25 * surface.specularDiffusion); // Diffusion factor
+    float diffuse = diffuseAngle * (1.0 - surface.transparency);
     float specular = 3.0 * pow(specAngle, df * SPECULAR_POWER);
     
     vec3 ambient = 0.1 * sun.color * sun.intensity * baseColor;
-    vec3 diff = material.diffuseReflectivity * baseColor * diffuse * sun.intensity;
-    vec3 spec = material.specularReflectivity * material.specularColor * specular * sun.intensity;
+    vec3 diff = surface.diffuseReflectivity * baseColor * diffuse * sun.intensity;
+    vec3 spec = surface.specularReflectivity * surface.specularColor * specular * sun.intensity;
     
     return ambient + sun.color * (diff + spec);
 }
@@ -663,20 +719,20 @@ vec3 calculateVCTDirectLight(PointLight light, vec3 viewDirection) {
     
     // Specular lighting
     vec3 halfwayDir = normalize(lightDir + (-viewDirection));
-    float specAngle = pow(max(dot(normal, halfwayDir), 0.0), material.shininess);
+    float specAngle = pow(max(dot(normal, halfwayDir), 0.0), surface.shininess);
     
     // Refraction
     float refractiveAngle = 0.0;
-    if (material.transparency > 0.01) {
-        vec3 refraction = refract(viewDirection, normal, 1.0/material.refractiveIndex);
+    if (surface.transparency > 0.01) {
+        vec3 refraction = refract(viewDirection, normal, 1.0/surface.refractiveIndex);
         if (length(refraction) > 0.01) {
-            refractiveAngle = max(0.0, material.transparency * dot(refraction, lightDir));
+            refractiveAngle = max(0.0, surface.transparency * dot(refraction, lightDir));
         }
     }
     
     // Shadow calculation
     float shadow = 1.0;
-    if (vctSettings.shadows && diffuseAngle * (1.0 - material.transparency) > 0.0) {
+    if (vctSettings.shadows && diffuseAngle * (1.0 - surface.transparency) > 0.0) {
         shadow = traceShadowCone(fs_in.FragPos, lightDir, distanceToLight);
     }
     
@@ -685,17 +741,17 @@ vec3 calculateVCTDirectLight(PointLight light, vec3 viewDirection) {
     specAngle = min(shadow, max(specAngle, refractiveAngle));
     
     // Get base color
-    vec3 baseColor = material.hasTexture > 0.5 ? 
+    vec3 baseColor = surface.hasTexture > 0.5 ? 
                     texture(material.textures[0], fs_in.TexCoords).rgb : 
-                    material.objectColor;
+                    surface.objectColor;
     
     // Calculate final lighting with material properties
-    float df = 1.0 / (1.0 + 0.25 * material.specularDiffusion); // Diffusion factor
-    float diffuse = diffuseAngle * (1.0 - material.transparency);
+    float df = 1.0 / (1.0 + 0.25 * surface.specularDiffusion); // Diffusion factor
+    float diffuse = diffuseAngle * (1.0 - surface.transparency);
     float specular = SPECULAR_FACTOR * pow(specAngle, df * SPECULAR_POWER);
     
-    vec3 diff = material.diffuseReflectivity * baseColor * diffuse;
-    vec3 spec = material.specularReflectivity * material.specularColor * specular;
+    vec3 diff = surface.diffuseReflectivity * baseColor * diffuse;
+    vec3 spec = surface.specularReflectivity * surface.specularColor * specular;
     
     // Apply attenuation
     float attenuation = 1.0 / (1.0 + 0.09 * distanceToLight + 0.032 * distanceToLight * distanceToLight);
@@ -704,6 +760,8 @@ vec3 calculateVCTDirectLight(PointLight light, vec3 viewDirection) {
 }
 
 void main() {
+    loadSurface();
+
     // --- EARLY EXITS for special rendering modes ---
     // Check for point cloud rendering first - quick exit path
     if (isPointCloud) {
@@ -738,16 +796,16 @@ void main() {
     
     // --- COMMON CALCULATIONS - Calculate once, use many times ---
     // Get base color and material properties
-    vec3 baseColor = material.hasTexture > 0.5 ? 
+    vec3 baseColor = surface.hasTexture > 0.5 ? 
                     texture(material.textures[0], fs_in.TexCoords).rgb : 
-                    material.objectColor;
+                    surface.objectColor;
     
-    float specularStrength = material.hasSpecularMap ? 
+    float specularStrength = surface.hasSpecularMap ? 
                            texture(material.textures[1], fs_in.TexCoords).r : 0.5;
     
     // Calculate normal - do this once
     vec3 normal;
-    if (material.hasNormalMap) {
+    if (surface.hasNormalMap) {
         normal = texture(material.textures[2], fs_in.TexCoords).rgb;
         normal = normalize(fs_in.TBN * (normal * 2.0 - 1.0));
     } else {
@@ -791,11 +849,11 @@ void main() {
         result *= baseColor;
         
         // Add environment reflection
-        vec3 reflectionColor = calculateEnvironmentReflection(normal, material.shininess / 128.0);
+        vec3 reflectionColor = calculateEnvironmentReflection(normal, surface.shininess / 128.0);
         result += reflectionColor * specularStrength;
         
         // Add emissive contribution
-        result += material.emissive * baseColor;
+        result += surface.emissive * baseColor;
     }
     else if (lightingMode == LIGHTING_VOXEL_CONE_TRACING) {
         // ------ VOXEL CONE TRACING LIGHTING ------
@@ -814,7 +872,7 @@ void main() {
         else {
             // Add indirect diffuse lighting (global illumination)
             if (vctSettings.indirectDiffuseLight) {
-                float diffuseContrib = material.diffuseReflectivity * (1.0 - material.transparency);
+                float diffuseContrib = surface.diffuseReflectivity * (1.0 - surface.transparency);
                 if (diffuseContrib > 0.01) {
                     // Apply a smoother blend with the existing lighting
                     vec3 indirectDiffuse = calculateIndirectDiffuseLight(normal, baseColor);
@@ -828,7 +886,7 @@ void main() {
                 // Even objects with zero specularContrib should have a very small amount
                 // Just to check if the reflection system is working
                 float minSpecular = 0.001;
-                float specularContrib = max(minSpecular, material.specularReflectivity * (1.0 - material.transparency));
+                float specularContrib = max(minSpecular, surface.specularReflectivity * (1.0 - surface.transparency));
                 
                 // Add specular reflection - ensure it's visible on all objects for testing
                 vec3 specReflection = calculateIndirectSpecularLight(viewDir);
@@ -838,19 +896,19 @@ void main() {
             }
             
             // Add transparency/refraction
-            if (material.transparency > 0.01) {
+            if (surface.transparency > 0.01) {
                 // Calculate transparency effect
                 vec3 refractedResult = calculateRefractiveLight(viewDir);
                 
                 // Smoother transition based on transparency value
-                float blendFactor = material.transparency;
+                float blendFactor = surface.transparency;
                 
                 // Fresnel-like effect - edges more reflective, center more transparent
                 float fresnelFactor = pow(1.0 - max(0.0, dot(normal, -viewDir)), 3.0);
                 float reflectMix = 0.1 + 0.3 * fresnelFactor; // How much reflection to mix in
                 
                 // Add subtle reflection on the edges
-                if (vctSettings.indirectSpecularLight && material.specularReflectivity > 0.01) {
+                if (vctSettings.indirectSpecularLight && surface.specularReflectivity > 0.01) {
                     vec3 reflectionColor = calculateIndirectSpecularLight(viewDir);
                     refractedResult = mix(refractedResult, reflectionColor, reflectMix);
                 }
@@ -859,7 +917,7 @@ void main() {
                 result = mix(result, refractedResult, smoothstep(0.0, 1.0, blendFactor));
                 
                 // Add a subtle fresnel highlight at edges
-                result += fresnelFactor * material.specularColor * 0.1;
+                result += fresnelFactor * surface.specularColor * 0.1;
             }
             
             // Add direct lighting with shadows
@@ -880,13 +938,13 @@ void main() {
             }
             
             // Add emissive contribution
-            result += material.emissive * baseColor;
+            result += surface.emissive * baseColor;
         }
     }
     
     // Selection highlighting (works in both lighting modes)
     if (selectionMode) {
-        if (isSelected) {
+        if (surface.selected) {
             if (selectedMeshIndex == -1 || selectedMeshIndex == fs_in.meshIndex) { 
                 result = mix(result, vec3(1.0, 0.0, 0.0), 0.3);
             }
@@ -8,6 +8,7 @@ in VS_OUT {
    vec3 VertexColor;
    float Intensity;
    flat int meshIndex;
+   flat int drawIndex;
 } fs_in;
 
 // ---- LIGHTING MODE CONSTANTS ----
@@ -96,6 +97,46 @@ struct Sun {
 };
 uniform Sun sun;
 
+// Per-mesh parameters of the batched mesh draws (MeshBatchRenderer), indexed by the draw's
+// base instance plus the instance. Mirrors MeshBatchRenderer::DrawParams.
+struct MeshDrawParams {
+    mat4 model;
+    vec4 positionScale;           // xyz: quantized position decode
+    vec4 positionOffset;
+    vec4 colorShininess;          // Object color, shininess in w
+    vec4 specularColorDiffusion;  // Specular color, specular diffusion in w
+    float emissive;
+    float hasTexture;
+    float diffuseReflectivity;
+    float specularReflectivity;
+    float refractiveIndex;
+    float transparency;
+    int meshIndex;
+    uint flags;                   // 1 selected, 2 normal map, 4 specular map, 8 AO map
+};
+layout (std430, binding = 5) readonly buffer MeshDrawBuffer {
+    MeshDrawParams meshDraws[];
+};
+
+// Material parameters of the current draw; the textures stay on the material uniform
+struct Surface {
+   float hasTexture;
+   vec3 objectColor;
+   float shininess;
+   float emissive;
+   bool selected;
+};
+Surface surface;
+
+void loadSurface() {
+   if (fs_in.drawIndex < 0) {
+      surface = Surface(material.hasTexture, material.objectColor, material.shininess, material.emissive, isSelected);
+      return;
+   }
+   MeshDrawParams draw = meshDraws[fs_in.drawIndex];
+   surface = Surface(draw.hasTexture, draw.colorShininess.rgb, draw.colorShininess.w, draw.emissive, (draw.flags & 1u) != 0u);
+}
+
 // ---- RAYTRACING STRUCTURES ----
 struct Ray {
     vec3 origin;
@@ -402,8 +443,8 @@ vec3 calculateRadianceLighting(vec3 worldPos, vec3 normal, vec3 materialColor, f
     color /= float(samplesPerPixel);
     
     // Add emissive component from this fragment itself
-    if (material.emissive > 0.0) {
-        color += materialColor * material.emissive;
+    if (surface.emissive > 0.0) {
+        color += materialColor * surface.emissive;
     }
     
     // Pure raytracing - no direct sun lighting, light only comes from:
@@ -417,6 +458,8 @@ vec3 calculateRadianceLighting(vec3 worldPos, vec3 normal, vec3 materialColor, f
 
 
 void main() {
+    loadSurface();
+
     if (isPointCloud) {
         // Point cloud rendering - exact same as standard shader, no modifications
         FragColor = vec4(fs_in.VertexColor * fs_in.Intensity, 1.0);
@@ -424,10 +467,10 @@ void main() {
     }
     
     // Get material properties from rasterization
-    vec3 materialColor = material.objectColor;
+    vec3 materialColor = surface.objectColor;
     
     // Sample diffuse texture if available
-    if (material.hasTexture > 0.5 && material.numDiffuseTextures > 0) {
+    if (surface.hasTexture > 0.5 && material.numDiffuseTextures > 0) {
         vec4 texColor = texture(material.textures[0], fs_in.TexCoords);
         materialColor = texColor.rgb;
     }
@@ -440,19 +483,19 @@ void main() {
     
     if (enableRaytracing) {
         // Raytracing for lighting calculation starting from the rasterized fragment
-        result = calculateRadianceLighting(worldPos, normal, materialColor, material.shininess, viewDir);
+        result = calculateRadianceLighting(worldPos, normal, materialColor, surface.shininess, viewDir);
     } else {
         // When raytracing is disabled, just show material color with minimal ambient
         result = materialColor * 0.3; // Just ambient material color
         
         // Add emissive component
-        if (material.emissive > 0.0) {
-            result += materialColor * material.emissive;
+        if (surface.emissive > 0.0) {
+            result += materialColor * surface.emissive;
         }
     }
     
     // Apply selection highlighting (matches main fragment shader behavior)
-    if (selectionMode && isSelected) {
+    if (selectionMode && surface.selected) {
         if (selectedMeshIndex == -1 || selectedMeshIndex == fs_in.meshIndex) {
             result = mix(result, vec3(1.0, 0.0, 0.0), 0.3); // Red highlight like main shader
         }
@@ -2,8 +2,7 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
-layout (location = 3) in vec3 aTangent;
-layout (location = 4) in vec3 aBitangent;
+layout (location = 3) in vec4 aTangent;     // Meshes: w is the bitangent handedness
 
 
 out VS_OUT {
@@ -13,6 +12,7 @@ out VS_OUT {
     vec3 VertexColor;
     float Intensity;
     flat int meshIndex;
+    flat int drawIndex;     // Into meshDraws, -1 for draws set up with uniforms
 } vs_out;
 
 // Transformation matrices
@@ -20,6 +20,10 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// Decode of meshes with quantized positions, identity otherwise
+uniform vec3 meshPositionScale = vec3(1.0);
+uniform vec3 meshPositionOffset = vec3(0.0);
+
 // Lighting mode constants
 const int LIGHTING_SHADOW_MAPPING = 0;
 const int LIGHTING_VOXEL_CONE_TRACING = 1;
@@ -28,27 +32,122 @@ const int LIGHTING_RADIANCE = 2;
 // Render states
 uniform bool isPointCloud;
 uniform int currentMeshIndex;
+uniform bool useNodeDrawBuffer;
+uniform bool useMeshDrawBuffer;
+uniform bool pointCloudHasNormals;
+
+// Per-node parameters of the octree multi-draw, indexed by the draw's base instance
+struct NodeDrawParams {
+    float pointSize;
+    uint clipped;     // Node straddles a clip volume, test each point
+};
+layout (std430, binding = 4) readonly buffer NodeDrawBuffer {
+    NodeDrawParams nodeDraws[];
+};
+
+// Per-mesh parameters of the batched mesh draws (MeshBatchRenderer), indexed by the draw's
+// base instance plus the instance. Mirrors MeshBatchRenderer::DrawParams.
+struct MeshDrawParams {
+    mat4 model;
+    vec4 positionScale;           // xyz: quantized position decode
+    vec4 positionOffset;
+    vec4 colorShininess;          // Object color, shininess in w
+    vec4 specularColorDiffusion;  // Specular color, specular diffusion in w
+    float emissive;
+    float hasTexture;
+    float diffuseReflectivity;
+    float specularReflectivity;
+    float refractiveIndex;
+    float transparency;
+    int meshIndex;
+    uint flags;                   // 1 selected, 2 normal map, 4 specular map, 8 AO map
+};
+layout (std430, binding = 5) readonly buffer MeshDrawBuffer {
+    MeshDrawParams meshDraws[];
+};
+
+// Point cloud clip volumes in model space, see PointCloudClipVolume
+const int MAX_CLIP_VOLUMES = 8;
+uniform int clipVolumeCount;
+uniform int clipVolumeShapes[MAX_CLIP_VOLUMES]; // 0 box, 1 plane
+uniform int clipVolumeModes[MAX_CLIP_VOLUMES];  // 0 keep inside, 1 keep outside
+uniform vec4 clipVolumeA[MAX_CLIP_VOLUMES];     // Box min, or plane normal and offset
+uniform vec4 clipVolumeB[MAX_CLIP_VOLUMES];     // Box max
+
+bool isClipped(vec3 p) {
+    for (int i = 0; i < clipVolumeCount; i++) {
+        bool inside;
+        if (clipVolumeShapes[i] == 0) {
+            inside = all(greaterThanEqual(p, clipVolumeA[i].xyz)) && all(lessThanEqual(p, clipVolumeB[i].xyz));
+        } else {
+            inside = dot(clipVolumeA[i].xyz, p) + clipVolumeA[i].w >= 0.0;
+        }
+        if (inside != (clipVolumeModes[i] == 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Octahedral normal packed into two unsigned bytes (aTangent.xy on point clouds)
+vec3 decodeOctahedralNormal(vec2 e) {
+    e = e * 2.0 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * sign(n.xy);
+    }
+    return normalize(n);
+}
 
 void main() {
+    // Per-draw state from the uniforms or, for batched meshes, from the draw buffer
+    mat4 modelMatrix = model;
+    vec3 positionScale = meshPositionScale;
+    vec3 positionOffset = meshPositionOffset;
+    int meshIndex = currentMeshIndex;
+    vs_out.drawIndex = -1;
+    if (useMeshDrawBuffer) {
+        // Meshes sharing their geometry are instances of one draw
+        int drawIndex = gl_BaseInstance + gl_InstanceID;
+        MeshDrawParams draw = meshDraws[drawIndex];
+        modelMatrix = draw.model;
+        positionScale = draw.positionScale.xyz;
+        positionOffset = draw.positionOffset.xyz;
+        meshIndex = draw.meshIndex;
+        vs_out.drawIndex = drawIndex;
+    }
+
     // Use the model matrix directly
-    mat3 normalMatrix = transpose(inverse(mat3(model)));
+    mat3 normalMatrix = transpose(inverse(mat3(modelMatrix)));
     
+    vec3 position = aPos * positionScale + positionOffset;
+
     // Calculate fragment position in world space
-    vs_out.FragPos = vec3(model * vec4(aPos, 1.0));
+    vs_out.FragPos = vec3(modelMatrix * vec4(position, 1.0));
     
     if (isPointCloud) {
         // Point cloud specific attributes
         vs_out.VertexColor = aNormal;         // Using normal data for color
         vs_out.Intensity = aTexCoords.x;      // Using texCoord.x for intensity
-        vs_out.Normal = vec3(0.0);            // Not used for point clouds
+        // Build-time estimated normals, unoriented surfaces should light both sides
+        vs_out.Normal = pointCloudHasNormals ? normalMatrix * decodeOctahedralNormal(aTangent.xy) : vec3(0.0);
         vs_out.TexCoords = vec2(0.0);         // Not used for point clouds
+        if (useNodeDrawBuffer) {
+            NodeDrawParams node = nodeDraws[gl_BaseInstance];
+            gl_PointSize = node.pointSize;
+            if (node.clipped != 0u && isClipped(position)) {
+                // Outside the clip volume: place the point beyond the far plane so it is culled
+                gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+                return;
+            }
+        }
     } else {
         // Regular model attributes
         vs_out.Normal = normalize(normalMatrix * aNormal);
         vs_out.TexCoords = aTexCoords;
         vs_out.VertexColor = vec3(1.0);
         vs_out.Intensity = 1.0;
-        vs_out.meshIndex = currentMeshIndex;
+        vs_out.meshIndex = meshIndex;
     }
     
     // Final position calculation
@@ -1,10 +1,41 @@
-#version 330 core
+#version 460 core
 layout (location = 0) in vec3 aPos;
 
 uniform mat4 lightSpaceMatrix;
 uniform mat4 model;
 
+// Decode of meshes with quantized positions, identity otherwise
+uniform vec3 meshPositionScale = vec3(1.0);
+uniform vec3 meshPositionOffset = vec3(0.0);
+
+// Per-mesh parameters of the batched mesh draws (MeshBatchRenderer), indexed by the draw's
+// base instance plus the instance. Mirrors MeshBatchRenderer::DrawParams.
+struct MeshDrawParams {
+    mat4 model;
+    vec4 positionScale;           // xyz: quantized position decode
+    vec4 positionOffset;
+    vec4 colorShininess;          // Object color, shininess in w
+    vec4 specularColorDiffusion;  // Specular color, specular diffusion in w
+    float emissive;
+    float hasTexture;
+    float diffuseReflectivity;
+    float specularReflectivity;
+    float refractiveIndex;
+    float transparency;
+    int meshIndex;
+    uint flags;                   // 1 selected, 2 normal map, 4 specular map, 8 AO map
+};
+layout (std430, binding = 5) readonly buffer MeshDrawBuffer {
+    MeshDrawParams meshDraws[];
+};
+uniform bool useMeshDrawBuffer;
+
 void main()
 {
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+    if (useMeshDrawBuffer) {
+        MeshDrawParams draw = meshDraws[gl_BaseInstance + gl_InstanceID];
+        gl_Position = lightSpaceMatrix * draw.model * vec4(aPos * draw.positionScale.xyz + draw.positionOffset.xyz, 1.0);
+    } else {
+        gl_Position = lightSpaceMatrix * model * vec4(aPos * meshPositionScale + meshPositionOffset, 1.0);
+    }
 }
\ No newline at end of file
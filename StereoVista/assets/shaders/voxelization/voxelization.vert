@@ -9,13 +9,17 @@ uniform mat4 V;
 uniform mat4 P;
 uniform int mipmapLevel;
 
+// Decode of meshes with quantized positions, identity otherwise
+uniform vec3 meshPositionScale = vec3(1.0);
+uniform vec3 meshPositionOffset = vec3(0.0);
+
 out vec3 worldPositionGeom;
 out vec3 normalGeom;
 out vec2 texCoordGeom;     // Added texture coordinates output
 
 void main() {
     // Transform position to world space
-    worldPositionGeom = vec3(M * vec4(position, 1));
+    worldPositionGeom = vec3(M * vec4(position * meshPositionScale + meshPositionOffset, 1));
     
     // Transform normal to world space
     normalGeom = normalize(mat3(transpose(inverse(M))) * normal);
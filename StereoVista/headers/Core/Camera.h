@@ -94,6 +94,9 @@ public:
 
     std::function<void()> centeringCompletedCallback;
 
+    // Motion tracking for prediction (smoothed world-space velocity)
+    glm::vec3 Velocity = glm::vec3(0.0f);
+
     // Constructor with default values
     Camera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), float yaw = YAW, float pitch = PITCH)
         : isMoving(false), isLookingAtEmptySpace(false), Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM),
@@ -477,6 +480,49 @@ public:
         }
     }
 
+    // Tracks camera velocity from frame to frame, call once per frame after all camera updates
+    void TrackMotion(float deltaTime) {
+        if (!motionTracked) {
+            lastTrackedPosition = Position;
+            motionTracked = true;
+            return;
+        }
+        if (deltaTime <= 0.0f) return;
+
+        glm::vec3 frameVelocity = (Position - lastTrackedPosition) / deltaTime;
+        lastTrackedPosition = Position;
+
+        // Smooth over a few frames so single-frame jitter does not throw the prediction off
+        float smoothing = glm::clamp(deltaTime * 10.0f, 0.0f, 1.0f);
+        Velocity = glm::mix(Velocity, frameVelocity, smoothing);
+    }
+
+    // Predicts where the camera will be after secondsAhead. Centering animations and scroll
+    // momentum follow their known curves, everything else is extrapolated from Velocity.
+    glm::vec3 PredictPosition(float secondsAhead) {
+        if (IsAnimating) {
+            float progress = glm::min(AnimationProgress + secondsAhead / AnimationDuration, 1.0f);
+            return glm::mix(AnimationStartPosition, AnimationEndPosition, easeOutCubic(progress));
+        }
+
+        if (scrollVelocity != 0.0f) {
+            // Velocity decreases linearly until it reaches zero, see UpdateScrolling
+            float scrollFactor = CalculateScrollFactor(1.0f);
+            float speed = abs(scrollVelocity);
+            float deceleration = scrollDeceleration * scrollFactor;
+            float duration = deceleration > 0.0f ? glm::min(secondsAhead, speed / deceleration) : secondsAhead;
+            float travel = (speed * duration - 0.5f * deceleration * duration * duration) * scrollFactor * MovementSpeed;
+
+            glm::vec3 direction = Front;
+            if (isScrollingToCursor && glm::length(scrollTargetPos - Position) > 0.01f) {
+                direction = glm::normalize(scrollTargetPos - Position);
+            }
+            return Position + direction * travel * glm::sign(scrollVelocity);
+        }
+
+        return Position + Velocity * secondsAhead;
+    }
+
     // Sets orbit distance and updates orbit point
     void SetOrbitPoint(float distance) {
         OrbitDistance = distance;
@@ -627,6 +673,8 @@ public:
 
 private:
     float lastScrollTime = 0.0f;
+    glm::vec3 lastTrackedPosition = glm::vec3(0.0f);
+    bool motionTracked = false;
 
     // Cubic easing function for smooth animation
     float easeOutCubic(float t) {
@@ -32,6 +32,7 @@ namespace Engine {
     struct Scene {
         std::vector<Model> models;
         std::vector<PointCloud> pointClouds;
+        std::vector<PointCloudSequence> pointCloudSequences;
         SceneSettings settings;
         Camera::CameraState cameraState;
         
@@ -6,6 +6,7 @@
 #include "Cursors/Types/PlaneCursor.h"
 #include "Core/Camera.h"
 #include <memory>
+#include <functional>
 
 namespace Cursor {
     // Central manager for all cursor types
@@ -55,6 +56,18 @@ namespace Cursor {
         const glm::vec3& getCursorPosition() const { return m_cursorPosition; }
         bool isCursorPositionValid() const { return m_cursorPositionValid; }
 
+        // CPU ray pick tried along the cursor ray (used for point clouds). coneSlope is the pick
+        // radius per unit of distance; returns true with the world-space hit position.
+        using RayPicker = std::function<bool(const glm::vec3& origin, const glm::vec3& direction, float coneSlope, glm::vec3& hitPosition)>;
+        void setRayPicker(RayPicker picker) { m_rayPicker = std::move(picker); }
+
+        // The depth buffer readback stalls the GPU, so it can be skipped when the ray picker
+        // covers everything in the scene
+        void setDepthPickingEnabled(bool enabled) { m_depthPickingEnabled = enabled; }
+        bool isDepthPickingEnabled() const { return m_depthPickingEnabled; }
+        float getPickRadiusPixels() const { return m_pickRadiusPixels; }
+        void setPickRadiusPixels(float radius) { m_pickRadiusPixels = radius; }
+
     private:
         std::unique_ptr<SphereCursor> m_sphereCursor;
         std::unique_ptr<FragmentCursor> m_fragmentCursor;
@@ -77,5 +90,10 @@ namespace Cursor {
         // Mouse position
         float m_lastX;
         float m_lastY;
+
+        // Picking
+        RayPicker m_rayPicker;
+        bool m_depthPickingEnabled;
+        float m_pickRadiusPixels;
     };
 }
\ No newline at end of file
@@ -2,6 +2,70 @@
 #include "Core.h"
 
 namespace Engine {
+	// Owning GL object name. Move-only; the object is deleted when its owner is destroyed or
+	// reset, so owners must go away while the context is still current.
+	template <typename Traits>
+	class GLHandle {
+	public:
+		GLHandle() = default;
+		explicit GLHandle(GLuint id) : m_id(id) {}
+		~GLHandle() { reset(); }
+
+		GLHandle(const GLHandle&) = delete;
+		GLHandle& operator=(const GLHandle&) = delete;
+		GLHandle(GLHandle&& other) noexcept : m_id(other.release()) {}
+		GLHandle& operator=(GLHandle&& other) noexcept {
+			if (this != &other) {
+				reset(other.release());
+			}
+			return *this;
+		}
+
+		static GLHandle create() {
+			GLuint id = 0;
+			Traits::create(id);
+			return GLHandle(id);
+		}
+
+		GLuint get() const { return m_id; }
+		explicit operator bool() const { return m_id != 0; }
+
+		GLuint release() {
+			GLuint id = m_id;
+			m_id = 0;
+			return id;
+		}
+
+		void reset(GLuint id = 0) {
+			if (m_id != 0) {
+				Traits::destroy(m_id);
+			}
+			m_id = id;
+		}
+
+	private:
+		GLuint m_id = 0;
+	};
+
+	struct GLBufferTraits {
+		static void create(GLuint& id) { glGenBuffers(1, &id); }
+		static void destroy(GLuint id) { glDeleteBuffers(1, &id); }
+	};
+
+	struct GLVertexArrayTraits {
+		static void create(GLuint& id) { glGenVertexArrays(1, &id); }
+		static void destroy(GLuint id) { glDeleteVertexArrays(1, &id); }
+	};
+
+	struct GLTextureTraits {
+		static void create(GLuint& id) { glGenTextures(1, &id); }
+		static void destroy(GLuint id) { glDeleteTextures(1, &id); }
+	};
+
+	using GLBuffer = GLHandle<GLBufferTraits>;
+	using GLVertexArray = GLHandle<GLVertexArrayTraits>;
+	using GLTexture = GLHandle<GLTextureTraits>;
+
 	namespace Buffers {
 		GLuint createVAO();
 		void createVBO(GLuint vaoID, GLsizeiptr verticesByteSize, const void* vertices, GLuint bindingIndex, int vertexLen, GLenum usage);
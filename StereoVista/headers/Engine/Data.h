@@ -1,5 +1,6 @@
 #pragma once
 #include "Core.h"
+#include "PointCloudGpuArena.h"
 #include <memory>
 #include <array>
 #include <unordered_map>
@@ -8,7 +9,9 @@
 #include <chrono>
 #include <filesystem>
 #include <numeric>
+#include <limits>
 #include <mutex>
+#include <shared_mutex>
 #include <thread>
 #include <future>
 #include <atomic>
@@ -28,7 +31,31 @@ namespace Engine {
         glm::vec3 position;
         float intensity;
         glm::vec3 color;
+        uint16_t normal = 0; // Octahedral, 8 bits per axis; only meaningful when the cloud has normals
+
+        static uint16_t packNormal(const glm::vec3& n) {
+            glm::vec2 oct = glm::vec2(n) / (std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+            if (n.z < 0.0f) {
+                oct = (1.0f - glm::abs(glm::vec2(oct.y, oct.x))) *
+                      glm::vec2(oct.x >= 0.0f ? 1.0f : -1.0f, oct.y >= 0.0f ? 1.0f : -1.0f);
+            }
+            glm::vec2 unorm = glm::clamp(oct * 0.5f + 0.5f, 0.0f, 1.0f) * 255.0f + 0.5f;
+            return static_cast<uint16_t>(static_cast<uint16_t>(unorm.x) | (static_cast<uint16_t>(unorm.y) << 8));
+        }
+
+        glm::vec3 unpackNormal() const {
+            glm::vec2 oct = glm::vec2(normal & 0xFF, normal >> 8) / 255.0f * 2.0f - 1.0f;
+            glm::vec3 n(oct, 1.0f - std::abs(oct.x) - std::abs(oct.y));
+            if (n.z < 0.0f) {
+                glm::vec2 folded = (1.0f - glm::abs(glm::vec2(n.y, n.x))) *
+                                   glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+                n.x = folded.x;
+                n.y = folded.y;
+            }
+            return glm::normalize(n);
+        }
     };
+    static_assert(sizeof(PointCloudPoint) == PointCloudGpuArena::POINT_STRIDE, "PointCloudPoint size changed");
 
     // Legacy point cloud chunk structure (for backward compatibility)
     struct PointCloudChunk {
@@ -44,69 +71,442 @@ namespace Engine {
         }
     };
 
-    // Enhanced octree-based point cloud structures
-    struct PointCloudOctreeNode {
-        // Node identification
-        uint64_t nodeId;
-        int depth;
-        glm::vec3 center;
-        glm::vec3 bounds; // half-size of the node
-        
-        // Point storage - either in memory or on disk
-        std::vector<PointCloudPoint> points; // In-memory points (for active nodes)
-        size_t totalPointCount;
-        
-        // Disk storage information
-        bool isOnDisk;
-        std::string diskFilePath;
-        size_t diskFileOffset;
-        
-        // LOD information
-        std::vector<size_t> lodPointCounts; // Points per LOD level
-        std::vector<GLuint> lodVBOs; // OpenGL VBOs for each LOD level
-        bool vbosGenerated;
-        
-        // Memory management
-        bool isLoaded;
-        std::chrono::steady_clock::time_point lastAccessed;
-        size_t memoryUsage; // Bytes used by this node
-        
-        // Octree structure
-        bool isLeaf;
-        std::array<std::unique_ptr<PointCloudOctreeNode>, 8> children;
-        
-        PointCloudOctreeNode() : 
-            nodeId(0), depth(0), center(0.0f), bounds(0.0f), 
-            totalPointCount(0), isOnDisk(false), diskFileOffset(0),
-            vbosGenerated(false), isLoaded(false), memoryUsage(0), isLeaf(true) {
-            lodPointCounts.resize(5);
-            lodVBOs.resize(5, 0);
+    // Results of background node loads, drained on the render thread. Shared with
+    // the loader workers so a task can outlive a rebuilt or deleted octree.
+    struct PointCloudLoadInbox {
+        std::mutex mutex;
+        std::vector<std::pair<uint32_t, std::vector<PointCloudPoint>>> completed;
+    };
+
+    // Pooled structure-of-arrays storage for the point cloud octree.
+    // Nodes are addressed by 32-bit index (index 0 is the root). The children of a
+    // node are allocated contiguously, so only the first child index and an
+    // occupancy mask are stored. Point data only exists for resident nodes and the
+    // cache file of a node is derived from its index on demand.
+    struct PointCloudNodePool {
+        static constexpr uint32_t INVALID_NODE = 0xFFFFFFFFu;
+        static constexpr int NUM_LOD_LEVELS = 5;
+
+        enum NodeFlags : uint8_t {
+            NODE_LEAF = 1 << 0,
+            NODE_ON_DISK = 1 << 1,
+            NODE_LOADED = 1 << 2,
+            NODE_VBOS_GENERATED = 1 << 3,
+            NODE_LOAD_PENDING = 1 << 4,
+            NODE_PREFETCHED = 1 << 5  // Loaded or queued by the prefetcher and not needed yet
+        };
+
+        // Traversal data, read every frame
+        std::vector<glm::vec4> centerHalfSize; // xyz = center, w = half-size of the cubic node
+        std::vector<uint32_t> firstChild;
+        std::vector<uint8_t> childMask;
+        std::vector<uint8_t> depth;
+        std::vector<uint8_t> flags;
+        std::vector<uint32_t> totalPointCount;
+
+        // LOD and GPU data. A node uploads its points once in random order, LOD level n
+        // draws the first lodPointCounts[n] of them.
+        std::vector<std::array<uint32_t, NUM_LOD_LEVELS>> lodPointCounts;
+        std::vector<PointCloudGpuAllocation> gpuAllocations;
+
+        // Residency
+        std::vector<uint32_t> lastAccessedFrame;
+        // Point pages are immutable once resident and shared with query threads, which
+        // take residencyMutex as readers; the render thread locks it only to publish
+        // or drop a page, so queries never stall a frame for longer than a map update.
+        std::unordered_map<uint32_t, std::shared_ptr<const std::vector<PointCloudPoint>>> residentPoints;
+        std::shared_ptr<std::shared_mutex> residencyMutex = std::make_shared<std::shared_mutex>();
+        size_t residentBytes = 0;
+        size_t gpuBytes = 0;
+        uint32_t frameCounter = 0;
+
+        // Prefetch statistics
+        uint32_t prefetchRequests = 0;
+        uint32_t prefetchHits = 0;   // Needed for rendering after the prefetcher had already loaded it
+        uint32_t prefetchLate = 0;   // Needed while its prefetch was still in flight
+        uint32_t demandLoads = 0;    // Needed without having been prefetched
+
+        std::shared_ptr<PointCloudLoadInbox> loadInbox = std::make_shared<PointCloudLoadInbox>();
+
+        PointCloudNodePool() = default;
+        PointCloudNodePool(PointCloudNodePool&&) = default;
+        PointCloudNodePool& operator=(PointCloudNodePool&&) = default;
+        PointCloudNodePool(const PointCloudNodePool&) = delete;
+        PointCloudNodePool& operator=(const PointCloudNodePool&) = delete;
+
+        ~PointCloudNodePool() {
+            clear();
         }
-        
-        ~PointCloudOctreeNode() {
-            cleanup();
+
+        uint32_t size() const { return static_cast<uint32_t>(flags.size()); }
+        bool empty() const { return flags.empty(); }
+
+        void reserve(size_t nodeCount) {
+            centerHalfSize.reserve(nodeCount);
+            firstChild.reserve(nodeCount);
+            childMask.reserve(nodeCount);
+            depth.reserve(nodeCount);
+            flags.reserve(nodeCount);
+            totalPointCount.reserve(nodeCount);
+            lodPointCounts.reserve(nodeCount);
+            gpuAllocations.reserve(nodeCount);
+            lastAccessedFrame.reserve(nodeCount);
         }
-        
-        void cleanup() {
-            for (GLuint vbo : lodVBOs) {
-                if (vbo != 0) {
-                    glDeleteBuffers(1, &vbo);
+
+        uint32_t allocate(const glm::vec3& center, float halfSize, int nodeDepth) {
+            uint32_t index = size();
+            centerHalfSize.emplace_back(center, halfSize);
+            firstChild.push_back(INVALID_NODE);
+            childMask.push_back(0);
+            depth.push_back(static_cast<uint8_t>(nodeDepth));
+            flags.push_back(NODE_LEAF);
+            totalPointCount.push_back(0);
+            lodPointCounts.push_back({});
+            gpuAllocations.push_back({});
+            lastAccessedFrame.push_back(0);
+            return index;
+        }
+
+        // Allocates one contiguous block for every octant set in mask
+        uint32_t allocateChildren(uint32_t parent, uint8_t mask) {
+            glm::vec3 parentCenter = center(parent);
+            float childHalfSize = halfSize(parent) * 0.5f;
+            int childDepth = depth[parent] + 1;
+
+            uint32_t first = size();
+            for (int octant = 0; octant < 8; octant++) {
+                if (!(mask & (1 << octant))) continue;
+                glm::vec3 offset((octant & 1) ? 1.0f : -1.0f, (octant & 2) ? 1.0f : -1.0f, (octant & 4) ? 1.0f : -1.0f);
+                allocate(parentCenter + offset * childHalfSize, childHalfSize, childDepth);
+            }
+
+            firstChild[parent] = first;
+            childMask[parent] = mask;
+            flags[parent] &= ~NODE_LEAF;
+            return first;
+        }
+
+        uint32_t childIndex(uint32_t node, int octant) const {
+            uint8_t mask = childMask[node];
+            if (!(mask & (1 << octant))) return INVALID_NODE;
+            uint32_t below = mask & ((1u << octant) - 1u);
+            uint32_t offset = 0;
+            while (below) { offset += below & 1u; below >>= 1; }
+            return firstChild[node] + offset;
+        }
+
+        int childCount(uint32_t node) const {
+            uint32_t mask = childMask[node];
+            int count = 0;
+            while (mask) { count += mask & 1u; mask >>= 1; }
+            return count;
+        }
+
+        glm::vec3 center(uint32_t node) const { return glm::vec3(centerHalfSize[node]); }
+        float halfSize(uint32_t node) const { return centerHalfSize[node].w; }
+
+        bool hasFlag(uint32_t node, uint8_t flag) const { return (flags[node] & flag) != 0; }
+        void setFlag(uint32_t node, uint8_t flag) { flags[node] |= flag; }
+        void clearFlag(uint32_t node, uint8_t flag) { flags[node] &= ~flag; }
+        bool isLeaf(uint32_t node) const { return hasFlag(node, NODE_LEAF); }
+        bool isLoaded(uint32_t node) const { return hasFlag(node, NODE_LOADED); }
+        // Drawable from VBOs or at least one upload away; the CPU copy may already be dropped
+        bool isResident(uint32_t node) const { return hasFlag(node, NODE_LOADED | NODE_VBOS_GENERATED); }
+
+        void touch(uint32_t node) { lastAccessedFrame[node] = frameCounter; }
+
+        // Render thread only; other threads must go through sharedPoints()
+        const std::vector<PointCloudPoint>* points(uint32_t node) const {
+            auto it = residentPoints.find(node);
+            return it != residentPoints.end() ? it->second.get() : nullptr;
+        }
+
+        // Safe from any thread; the page stays valid after it is evicted
+        std::shared_ptr<const std::vector<PointCloudPoint>> sharedPoints(uint32_t node) const {
+            std::shared_lock<std::shared_mutex> lock(*residencyMutex);
+            auto it = residentPoints.find(node);
+            return it != residentPoints.end() ? it->second : nullptr;
+        }
+
+        void setPoints(uint32_t node, std::vector<PointCloudPoint>&& nodePoints) {
+            setPoints(node, std::make_shared<const std::vector<PointCloudPoint>>(std::move(nodePoints)));
+        }
+
+        void setPoints(uint32_t node, std::shared_ptr<const std::vector<PointCloudPoint>> page) {
+            releasePoints(node);
+            residentBytes += page->size() * sizeof(PointCloudPoint);
+            {
+                std::unique_lock<std::shared_mutex> lock(*residencyMutex);
+                residentPoints[node] = std::move(page);
+            }
+            setFlag(node, NODE_LOADED);
+        }
+
+        void releasePoints(uint32_t node) {
+            std::shared_ptr<const std::vector<PointCloudPoint>> page;
+            {
+                std::unique_lock<std::shared_mutex> lock(*residencyMutex);
+                auto it = residentPoints.find(node);
+                if (it != residentPoints.end()) {
+                    page = std::move(it->second);
+                    residentPoints.erase(it);
+                }
+            }
+            if (page) {
+                residentBytes -= page->size() * sizeof(PointCloudPoint);
+            }
+            clearFlag(node, NODE_LOADED);
+        }
+
+        // Arena memory of a node, all LOD levels share one allocation
+        size_t nodeGpuBytes(uint32_t node) const {
+            if (!hasFlag(node, NODE_VBOS_GENERATED)) return 0;
+            return static_cast<size_t>(gpuAllocations[node].count) * sizeof(PointCloudPoint);
+        }
+
+        void markVBOsGenerated(uint32_t node) {
+            setFlag(node, NODE_VBOS_GENERATED);
+            gpuBytes += nodeGpuBytes(node);
+        }
+
+        void releaseVBOs(uint32_t node) {
+            gpuBytes -= nodeGpuBytes(node);
+            PointCloudGpuArena::release(gpuAllocations[node]);
+            clearFlag(node, NODE_VBOS_GENERATED);
+        }
+
+        // Size of the per-node metadata, excluding resident point data
+        size_t metadataBytes() const {
+            size_t perNode = sizeof(glm::vec4) + sizeof(uint32_t) * 3 + sizeof(uint8_t) * 3 +
+                sizeof(std::array<uint32_t, NUM_LOD_LEVELS>) + sizeof(PointCloudGpuAllocation);
+            return perNode * size();
+        }
+
+        void clear() {
+            for (uint32_t i = 0; i < size(); i++) {
+                if (hasFlag(i, NODE_VBOS_GENERATED)) {
+                    releaseVBOs(i);
                 }
             }
-            std::fill(lodVBOs.begin(), lodVBOs.end(), 0);
-            vbosGenerated = false;
+            centerHalfSize.clear();
+            firstChild.clear();
+            childMask.clear();
+            depth.clear();
+            flags.clear();
+            totalPointCount.clear();
+            lodPointCounts.clear();
+            gpuAllocations.clear();
+            lastAccessedFrame.clear();
+            if (residencyMutex) {
+                std::unique_lock<std::shared_mutex> lock(*residencyMutex);
+                residentPoints.clear();
+            }
+            residentBytes = 0;
+            gpuBytes = 0;
+            frameCounter = 0;
+            prefetchRequests = prefetchHits = prefetchLate = demandLoads = 0;
+            // Orphan in-flight loads that still reference the old node indices
+            if (loadInbox) {
+                loadInbox = std::make_shared<PointCloudLoadInbox>();
+            }
         }
     };
     
-    // Disk storage management
+    // Disk storage management (memory budgets are scene-wide, see PointCloudResidencyManager)
     struct PointCloudChunkCache {
-        size_t maxMemoryMB;
-        size_t currentMemoryMB;
         std::string cacheDirectory;
-        std::unordered_map<uint64_t, std::weak_ptr<PointCloudOctreeNode>> nodeCache;
-        std::list<uint64_t> accessOrder; // LRU tracking
-        
-        PointCloudChunkCache() : maxMemoryMB(8192), currentMemoryMB(0) {} // Default 8GB limit
+    };
+
+    // Results of the last octree build, also written next to the node cache as build_stats.json
+    struct PointCloudBuildStats {
+        static constexpr int FILL_BUCKETS = 10;
+
+        // Parameters the tree was built with
+        int maxOctreeDepth = 0;
+        size_t maxPointsPerNode = 0;
+
+        size_t inputPoints = 0;
+        size_t storedPoints = 0;
+        size_t duplicatesRemoved = 0;
+        size_t outliersRemoved = 0;
+        size_t normalsEstimated = 0;
+        uint32_t nodeCount = 0;
+        uint32_t leafCount = 0;
+
+        // Shape of the tree, indexed by depth; points are the ones stored in leaves at that depth
+        std::vector<uint32_t> nodesPerDepth;
+        std::vector<uint32_t> leavesPerDepth;
+        std::vector<uint64_t> pointsPerDepth;
+
+        // Leaf fill relative to maxPointsPerNode in FILL_BUCKETS equal steps; leaves at the
+        // depth limit can hold more than maxPointsPerNode and are counted in the last bucket
+        std::vector<uint32_t> leafFillHistogram;
+        uint32_t minLeafPoints = 0;
+        uint32_t maxLeafPoints = 0;
+        uint32_t leavesAtMaxDepth = 0;
+        uint32_t overfullLeaves = 0;
+
+        // Node cache on disk
+        uint32_t cachePages = 0;
+        uint64_t cacheBytes = 0;
+
+        // Wall time per phase. The page pass runs on every core, its normal estimation and
+        // encoding times are summed over the workers.
+        float partitionSeconds = 0.0f;
+        float cleanupSeconds = 0.0f;
+        float pageSeconds = 0.0f;
+        float normalCpuSeconds = 0.0f;
+        float encodeCpuSeconds = 0.0f;
+        float buildSeconds = 0.0f;
+
+        float meanLeafPoints() const {
+            return leafCount > 0 ? static_cast<float>(storedPoints) / leafCount : 0.0f;
+        }
+    };
+
+    // Crop volume of a point cloud, in its local space. A box keeps the points inside
+    // [boxMin, boxMax] (Inside) or the ones outside it (Outside); a plane keeps the points with
+    // dot(planeNormal, p) + planeOffset >= 0 (Inside) or < 0 (Outside). A point is shown when
+    // every enabled volume keeps it.
+    struct PointCloudClipVolume {
+        enum class Shape : int { Box = 0, Plane = 1 };
+        enum class Mode : int { Inside = 0, Outside = 1 };
+        // How a node's bounds relate to the kept region
+        enum class Coverage { Culled, Kept, Partial };
+
+        Shape shape = Shape::Box;
+        Mode mode = Mode::Inside;
+        bool enabled = true;
+        glm::vec3 boxMin = glm::vec3(-1.0f);
+        glm::vec3 boxMax = glm::vec3(1.0f);
+        glm::vec3 planeNormal = glm::vec3(0.0f, 0.0f, 1.0f);
+        float planeOffset = 0.0f;
+
+        bool keeps(const glm::vec3& p) const {
+            bool inside;
+            if (shape == Shape::Box) {
+                inside = glm::all(glm::greaterThanEqual(p, boxMin)) && glm::all(glm::lessThanEqual(p, boxMax));
+            } else {
+                inside = glm::dot(planeNormal, p) + planeOffset >= 0.0f;
+            }
+            return inside == (mode == Mode::Inside);
+        }
+
+        Coverage classify(const glm::vec3& center, float halfSize) const {
+            bool allInside, noneInside;
+            if (shape == Shape::Box) {
+                glm::vec3 nodeMin = center - halfSize;
+                glm::vec3 nodeMax = center + halfSize;
+                allInside = glm::all(glm::greaterThanEqual(nodeMin, boxMin)) && glm::all(glm::lessThanEqual(nodeMax, boxMax));
+                noneInside = glm::any(glm::greaterThan(nodeMin, boxMax)) || glm::any(glm::lessThan(nodeMax, boxMin));
+            } else {
+                float distance = glm::dot(planeNormal, center) + planeOffset;
+                float reach = halfSize * (std::abs(planeNormal.x) + std::abs(planeNormal.y) + std::abs(planeNormal.z));
+                allInside = distance - reach >= 0.0f;
+                noneInside = distance + reach < 0.0f;
+            }
+            if (mode == Mode::Outside) {
+                std::swap(allInside, noneInside);
+            }
+            return allInside ? Coverage::Kept : (noneInside ? Coverage::Culled : Coverage::Partial);
+        }
+
+        bool operator==(const PointCloudClipVolume& other) const {
+            return shape == other.shape && mode == other.mode && enabled == other.enabled &&
+                   boxMin == other.boxMin && boxMax == other.boxMax &&
+                   planeNormal == other.planeNormal && planeOffset == other.planeOffset;
+        }
+        bool operator!=(const PointCloudClipVolume& other) const { return !(*this == other); }
+
+        // Combined coverage of all enabled volumes
+        static Coverage classifyAll(const std::vector<PointCloudClipVolume>& volumes, const glm::vec3& center, float halfSize) {
+            Coverage result = Coverage::Kept;
+            for (const auto& volume : volumes) {
+                if (!volume.enabled) continue;
+                Coverage coverage = volume.classify(center, halfSize);
+                if (coverage == Coverage::Culled) return Coverage::Culled;
+                if (coverage == Coverage::Partial) result = Coverage::Partial;
+            }
+            return result;
+        }
+
+        static bool keptByAll(const std::vector<PointCloudClipVolume>& volumes, const glm::vec3& p) {
+            for (const auto& volume : volumes) {
+                if (volume.enabled && !volume.keeps(p)) return false;
+            }
+            return true;
+        }
+    };
+
+    // Octree nodes selected for a frame, shared by both eyes and every other view of it.
+    // The selection only depends on the camera position and LOD settings, so it is kept
+    // while the camera stays close to where it was made; each frame only re-checks which
+    // of the selected nodes are resident and rebuilds their draw commands.
+    struct PointCloudRenderList {
+        struct DrawNode {
+            uint32_t node;
+            uint8_t lodLevel;
+            bool clipped;    // Straddles a clip volume, its points are tested in the shader
+            float pointSize;
+        };
+        // Range of the frame's indirect commands that use one arena buffer
+        struct Batch {
+            uint32_t buffer;
+            uint32_t firstCommand;
+            uint32_t commandCount;
+        };
+
+        // Selection and the state it was made for
+        std::vector<uint32_t> requiredNodes; // Kept loaded and touched every frame
+        std::vector<DrawNode> drawNodes;     // Drawn whenever their data is on the GPU
+        glm::vec3 cameraPosition = glm::vec3(std::numeric_limits<float>::max());
+        std::array<float, 5> lodDistances = {};
+        float lodMultiplier = 0.0f;
+        float basePointSize = 0.0f;
+        std::vector<PointCloudClipVolume> clipVolumes;
+        std::shared_ptr<const PointCloudLoadInbox> pool; // Identifies the octree the selection belongs to
+
+        // Draws of the current frame
+        std::vector<Batch> batches;
+        uint32_t frame = 0;
+
+        // Statistics
+        uint32_t selectionsRebuilt = 0;
+        uint32_t selectionsReused = 0;
+
+        void invalidate() {
+            pool.reset();
+            requiredNodes.clear();
+            drawNodes.clear();
+            batches.clear();
+        }
+    };
+
+    // Ordered clouds played back as one 4D dataset. The frames are regular clouds of the scene
+    // tagged with the sequence id; they are built in one shared root cube so a node covers the
+    // same region in every frame, with their node caches next to each other on disk.
+    struct PointCloudSequence {
+        uint32_t id = 0;
+        std::string name;
+        int currentFrame = 0;
+        bool visible = true;
+
+        // Playback
+        bool playing = false;
+        bool loop = true;
+        float framesPerSecond = 10.0f;
+        int prefetchFrames = 3;        // Frames ahead of the current one that are streamed in
+        float frameTimer = 0.0f;       // Time since the current frame was shown
+
+        // Statistics
+        float measuredFramesPerSecond = 0.0f;
+        uint32_t framesAdvanced = 0;
+        uint64_t nodesRequiredOnAdvance = 0; // Nodes the new frame needed when it was shown
+        uint64_t nodesReadyOnAdvance = 0;    // ... of which the look-ahead had already made resident
+
+        float getPrefetchHitRate() const {
+            return nodesRequiredOnAdvance > 0 ? static_cast<float>(nodesReadyOnAdvance) / nodesRequiredOnAdvance : 0.0f;
+        }
     };
 
     struct PointCloud {
@@ -124,17 +524,50 @@ namespace Engine {
         float basePointSize = 2.0f;
 
         // Enhanced octree-based system
-        std::unique_ptr<PointCloudOctreeNode> octreeRoot;
+        PointCloudNodePool octreeNodes;
         glm::vec3 octreeBoundsMin;
         glm::vec3 octreeBoundsMax;
         glm::vec3 octreeCenter;
         float octreeSize;
         int maxOctreeDepth = 12; // Maximum octree depth
         size_t maxPointsPerNode = 5000; // Points per leaf node before subdivision
+        bool autoLeafSize = true;       // Derive maxPointsPerNode from the point density and memory budgets
+
+        // Leaf cleanup during the octree build
+        bool removeDuplicates = true;
+        float duplicateTolerance = 0.0f; // Points closer than this are merged, 0 only drops exact copies
+        bool removeOutliers = false;
+        int outlierNeighbors = 8;        // k of the k-NN mean distance
+        float outlierStdDevs = 2.0f;     // Drop points whose mean distance exceeds mean + this * stddev
+        // Opt-in: a k-NN pass over every leaf, only worth it for clouds that are lit
+        bool estimateNormals = false;
+        int normalNeighbors = 16;
+        bool hasNormals = false;         // Set by the build when every node page carries normals
+        PointCloudBuildStats buildStats;
         
         // LOD and distance management  
         float lodDistances[5] = { 10.0f, 25.0f, 50.0f, 100.0f, 200.0f };
         float lodMultiplier = 1.0f; // Scale LOD distances
+
+        // Drop the RAM copy of a node once its VBOs are uploaded; queries and picks re-stream it
+        // from the node cache when needed. Keeping it halves the memory available for nodes.
+        bool keepCpuCopy = false;
+
+        // Predictive loading along the extrapolated camera path
+        bool enablePrefetch = true;
+        float prefetchHorizon = 0.5f; // Seconds ahead of the camera
+
+        // Crop volumes, applied when selecting and loading nodes and, for nodes that straddle
+        // a volume, per point in the shader. At most MAX_CLIP_VOLUMES are used.
+        std::vector<PointCloudClipVolume> clipVolumes;
+        static constexpr int MAX_CLIP_VOLUMES = 8;
+
+        // Visible octree nodes, selected once per frame by OctreePointCloudManager::updateLOD
+        PointCloudRenderList renderList;
+
+        // Sequence membership, 0 for standalone clouds. Playback controls the visibility of frames.
+        uint32_t sequenceId = 0;
+        int sequenceFrame = 0;
         
         // Memory and disk management
         PointCloudChunkCache chunkCache;
@@ -158,6 +591,8 @@ namespace Engine {
         PointCloud() {
             chunkCache.cacheDirectory = "pointcloud_cache";
         }
+
+        bool hasOctree() const { return !octreeNodes.empty(); }
         
         // Move constructor
         PointCloud(PointCloud&& other) noexcept 
@@ -165,11 +600,17 @@ namespace Engine {
               points(std::move(other.points)), position(other.position),
               rotation(other.rotation), scale(other.scale), visible(other.visible),
               vao(other.vao), vbo(other.vbo),
-              basePointSize(other.basePointSize), octreeRoot(std::move(other.octreeRoot)),
+              basePointSize(other.basePointSize), octreeNodes(std::move(other.octreeNodes)),
               octreeBoundsMin(other.octreeBoundsMin), octreeBoundsMax(other.octreeBoundsMax),
               octreeCenter(other.octreeCenter), octreeSize(other.octreeSize),
-              maxOctreeDepth(other.maxOctreeDepth), maxPointsPerNode(other.maxPointsPerNode),
-              lodMultiplier(other.lodMultiplier), chunkCache(std::move(other.chunkCache)),
+              maxOctreeDepth(other.maxOctreeDepth), maxPointsPerNode(other.maxPointsPerNode), autoLeafSize(other.autoLeafSize),
+              removeDuplicates(other.removeDuplicates), duplicateTolerance(other.duplicateTolerance),
+              removeOutliers(other.removeOutliers), outlierNeighbors(other.outlierNeighbors),
+              outlierStdDevs(other.outlierStdDevs), estimateNormals(other.estimateNormals),
+              normalNeighbors(other.normalNeighbors), hasNormals(other.hasNormals), buildStats(std::move(other.buildStats)),
+              lodMultiplier(other.lodMultiplier), keepCpuCopy(other.keepCpuCopy), enablePrefetch(other.enablePrefetch),
+              prefetchHorizon(other.prefetchHorizon), clipVolumes(std::move(other.clipVolumes)), renderList(std::move(other.renderList)),
+              sequenceId(other.sequenceId), sequenceFrame(other.sequenceFrame), chunkCache(std::move(other.chunkCache)),
               useOctree(other.useOctree), useDiskCache(other.useDiskCache),
               totalLoadedNodes(other.totalLoadedNodes), chunkOutlineVAO(other.chunkOutlineVAO),
               chunkOutlineVBO(other.chunkOutlineVBO), chunkOutlineVertices(std::move(other.chunkOutlineVertices)),
@@ -205,18 +646,35 @@ namespace Engine {
                 vbo = other.vbo;
                 basePointSize = other.basePointSize;
                 
-                octreeRoot = std::move(other.octreeRoot);
+                octreeNodes = std::move(other.octreeNodes);
                 octreeBoundsMin = other.octreeBoundsMin;
                 octreeBoundsMax = other.octreeBoundsMax;
                 octreeCenter = other.octreeCenter;
                 octreeSize = other.octreeSize;
                 maxOctreeDepth = other.maxOctreeDepth;
                 maxPointsPerNode = other.maxPointsPerNode;
+                autoLeafSize = other.autoLeafSize;
+                removeDuplicates = other.removeDuplicates;
+                duplicateTolerance = other.duplicateTolerance;
+                removeOutliers = other.removeOutliers;
+                outlierNeighbors = other.outlierNeighbors;
+                outlierStdDevs = other.outlierStdDevs;
+                estimateNormals = other.estimateNormals;
+                normalNeighbors = other.normalNeighbors;
+                hasNormals = other.hasNormals;
+                buildStats = std::move(other.buildStats);
                 
                 for (int i = 0; i < 5; i++) {
                     lodDistances[i] = other.lodDistances[i];
                 }
                 lodMultiplier = other.lodMultiplier;
+                keepCpuCopy = other.keepCpuCopy;
+                enablePrefetch = other.enablePrefetch;
+                prefetchHorizon = other.prefetchHorizon;
+                clipVolumes = std::move(other.clipVolumes);
+                renderList = std::move(other.renderList);
+                sequenceId = other.sequenceId;
+                sequenceFrame = other.sequenceFrame;
                 
                 chunkCache = std::move(other.chunkCache);
                 useOctree = other.useOctree;
@@ -252,9 +710,8 @@ namespace Engine {
         }
         
         void cleanup() {
-            if (octreeRoot) {
-                octreeRoot.reset();
-            }
+            octreeNodes.clear();
+            renderList.invalidate();
             
             // Clean up legacy chunks
             for (auto& chunk : chunks) {
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace Engine {
+
+    // Persistent worker threads for data-parallel CPU work (octree builds, mesh import). The
+    // calling thread always takes part in its own batch, so parallelFor may be called from a
+    // worker without deadlocking and falls back to a plain loop before initialize().
+    class JobSystem {
+    public:
+        // Starts threadCount workers, by default one less than the hardware threads
+        static void initialize(size_t threadCount = 0);
+        static void shutdown();
+
+        // Runs task(i) for every i in [0, count) and returns once all of them finished.
+        // Tasks must not throw.
+        static void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+        static size_t getWorkerCount() { return s_workers.size(); }
+
+    private:
+        struct Batch;
+
+        static void workerLoop();
+        static void runBatch(Batch& batch);
+
+        static std::vector<std::thread> s_workers;
+        static std::deque<std::shared_ptr<Batch>> s_batches;
+        static std::mutex s_batchMutex;
+        static std::condition_variable s_batchAvailable;
+        static std::condition_variable s_batchFinished;
+        static bool s_stopping;
+    };
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include "Loaders/ModelLoader.h"
+#include <map>
+#include <vector>
+
+namespace Engine {
+
+    // Draws the meshes of a pass from MeshGpuArena with one glMultiDrawElementsIndirect per batch.
+    // Per-mesh uniforms (model matrix, position decode, material) move into a storage buffer that
+    // the shaders index with the draw's base instance. A batch is every mesh with the same vertex
+    // format, index type and textures, so untextured scenes and the depth pass draw in one call
+    // per format and index type. Meshes sharing their geometry (see MeshGeometryRegistry) become
+    // instances of one command and read consecutive parameters. A pass is built once per frame
+    // and replayed for every eye.
+    class MeshBatchRenderer {
+    public:
+        enum Pass {
+            PASS_SCENE = 0,  // Main camera, cluster culled
+            PASS_RADAR,
+            PASS_DEPTH,      // Shadow map, positions only
+            PASS_COUNT
+        };
+
+        enum DrawFlags : uint32_t {
+            DRAW_SELECTED = 1u << 0,
+            DRAW_NORMAL_MAP = 1u << 1,
+            DRAW_SPECULAR_MAP = 1u << 2,
+            DRAW_AO_MAP = 1u << 3
+        };
+
+        // std430 layout of MeshDrawParams in the shaders, 160 bytes
+        struct DrawParams {
+            glm::mat4 model;
+            glm::vec4 positionScale;
+            glm::vec4 positionOffset;
+            glm::vec4 colorShininess;
+            glm::vec4 specularColorDiffusion;
+            float emissive;
+            float hasTexture;
+            float diffuseReflectivity;
+            float specularReflectivity;
+            float refractiveIndex;
+            float transparency;
+            int32_t meshIndex;
+            uint32_t flags;
+        };
+
+        struct Stats {
+            uint32_t meshes = 0;
+            uint32_t batches = 0;   // Multi-draw calls
+            uint32_t commands = 0;  // Draws in them, one per geometry and level or culled cluster range
+        };
+
+        // Invalidates the passes of the previous frame
+        static void beginFrame();
+
+        // Passes are built once per frame: check isBuilt, then beginPass and addMesh for every mesh
+        static bool isBuilt(Pass pass) { return s_passes[pass].built; }
+        static void beginPass(Pass pass);
+        // Fills in the mesh's position decode, the rest of params is the caller's. With cullClusters
+        // the full level only draws the clusters MeshClusterCuller kept this frame.
+        static void addMesh(Pass pass, const Mesh& mesh, const DrawParams& params, bool cullClusters);
+
+        // Issues the pass with shader, which has to be in use
+        static void draw(Pass pass, Shader& shader);
+
+        // Frees the buffers of every pass, called once before the GL context goes away
+        static void releaseGpuResources();
+
+        static const Stats& getStats(Pass pass) { return s_passes[pass].stats; }
+
+        static constexpr GLuint DRAW_PARAMS_BINDING = 5;
+
+    private:
+        struct BatchKey {
+            MeshVertexFormat format;
+            GLenum indexType;
+            std::vector<GLuint> textureIds;
+
+            bool operator<(const BatchKey& other) const {
+                if (format != other.format) return format < other.format;
+                if (indexType != other.indexType) return indexType < other.indexType;
+                return textureIds < other.textureIds;
+            }
+        };
+
+        // Meshes drawing the same level of one shared geometry
+        struct InstanceGroup {
+            uint32_t count;
+            uint32_t firstIndex;
+            int32_t baseVertex;
+            std::vector<DrawParams> instances;
+        };
+
+        struct Batch {
+            MeshVertexFormat format;
+            GLenum indexType;
+            std::vector<Texture> textures;
+            // Cluster ranges of culled meshes, each mesh has its own parameters
+            std::vector<DrawElementsIndirectCommand> clusterCommands;
+            std::vector<InstanceGroup> groups;
+            std::map<std::pair<const MeshGpuAllocation*, int>, size_t> groupIndex;
+            // Slice of the pass's command buffer, set on upload
+            size_t firstCommand = 0;
+            uint32_t commandCount = 0;
+        };
+
+        struct PassData {
+            bool built = false;
+            bool uploaded = false;
+            std::vector<DrawParams> params;  // Of culled meshes while building, of all on upload
+            std::vector<Batch> batches;
+            std::map<BatchKey, size_t> batchIndex;
+            GLuint paramsBuffer = 0;
+            GLuint commandBuffer = 0;
+            Stats stats;
+        };
+
+        static void upload(PassData& pass);
+
+        static PassData s_passes[PASS_COUNT];
+    };
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "Loaders/ModelLoader.h"
+#include <vector>
+
+namespace Engine {
+
+    // Per-frame culling of mesh clusters (see MeshletBuilder). Runs once per frame on the job
+    // system against the union of both eye frusta and, while back faces are culled, against the
+    // clusters' normal cones seen from both eyes; models with non-uniform or mirroring scale skip
+    // the cone test. The surviving clusters of each mesh become
+    // indirect draw commands that MeshBatchRenderer merges into the scene pass of every eye.
+    class MeshClusterCuller {
+    public:
+        struct Stats {
+            uint32_t meshes = 0;
+            uint32_t clusters = 0;
+            uint32_t visibleClusters = 0;
+            uint32_t commands = 0;
+        };
+
+        // Once per frame after the LOD choice, before any eye is drawn. Mono views pass the same
+        // matrix and position twice.
+        static void cullModels(std::vector<Model>& models, const glm::mat4& leftViewProjection, const glm::mat4& rightViewProjection,
+                               const glm::vec3& leftEye, const glm::vec3& rightEye, bool backfaceCulling);
+
+        // Appends the frame's visible clusters of mesh to commands as arena draws with the given
+        // base instance. False if the mesh was not culled this frame and has to be drawn whole.
+        static bool appendVisible(const Mesh& mesh, uint32_t baseInstance, std::vector<DrawElementsIndirectCommand>& commands);
+
+        static void setEnabled(bool enabled) { s_enabled = enabled; }
+        static bool isEnabled() { return s_enabled; }
+        static const Stats& getStats() { return s_stats; }
+
+    private:
+        // Meshlets [first, first + count) of one mesh, culled by one job
+        struct CullTask {
+            Mesh* mesh;
+            glm::mat4 modelMatrix;
+            uint32_t first;
+            uint32_t count;
+            bool coneCulling;  // Back faces culled and the model scaled uniformly
+        };
+
+        static void cullRange(const CullTask& task, const glm::mat4& leftViewProjection, const glm::mat4& rightViewProjection,
+                              const glm::vec3& leftEye, const glm::vec3& rightEye,
+                              std::vector<DrawElementsIndirectCommand>& commands, uint32_t& visibleClusters);
+
+        // Meshlets per job; large meshes are split so one mesh still spreads over the workers
+        static constexpr uint32_t CLUSTERS_PER_TASK = 4096;
+
+        // Mesh-local: first index relative to the mesh's full level, no base vertex
+        static std::vector<DrawElementsIndirectCommand> s_frameCommands;
+        static uint32_t s_frame;
+        static bool s_frameBackfaceCulling;
+        static bool s_enabled;
+        static Stats s_stats;
+    };
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "Engine/MeshGpuArena.h"
+#include <memory>
+#include <unordered_map>
+
+namespace Engine {
+
+    // Shares one arena copy between meshes whose GPU geometry is identical: primitives created
+    // again, clones, and assets loaded more than once. Keyed by a 128-bit hash of the packed
+    // vertices and indices; an entry lives as long as a mesh still holds it. Meshes sharing a
+    // copy also share a draw command, see MeshBatchRenderer. Render thread only.
+    class MeshGeometryRegistry {
+    public:
+        struct Stats {
+            uint32_t geometries = 0;  // Resident copies
+            uint32_t meshes = 0;      // Meshes drawing from them
+            size_t savedBytes = 0;    // Arena bytes the extra meshes would have taken
+        };
+
+        // The resident copy of this geometry, uploaded on first use
+        static std::shared_ptr<const MeshGpuAllocation> acquire(MeshVertexFormat format, const void* vertices, uint32_t vertexCount,
+                                                                const void* indices, uint64_t indexBytes);
+
+        static Stats getStats();
+
+    private:
+        struct Key {
+            uint64_t hash[2];
+            bool operator==(const Key& other) const { return hash[0] == other.hash[0] && hash[1] == other.hash[1]; }
+        };
+
+        struct KeyHash {
+            size_t operator()(const Key& key) const { return static_cast<size_t>(key.hash[0]); }
+        };
+
+        struct Entry {
+            std::weak_ptr<const MeshGpuAllocation> allocation;
+            size_t bytes = 0;
+        };
+
+        static Key computeKey(MeshVertexFormat format, const void* vertices, uint64_t vertexBytes, const void* indices, uint64_t indexBytes);
+
+        static std::unordered_map<Key, Entry, KeyHash> s_entries;
+    };
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace Engine {
+
+    // Vertex layouts of mesh geometry, see PackedVertex and QuantizedVertex
+    enum class MeshVertexFormat : uint32_t {
+        Packed = 0,
+        Quantized = 1
+    };
+
+    // Command of glMultiDrawElementsIndirect
+    struct DrawElementsIndirectCommand {
+        uint32_t count;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t baseInstance;
+    };
+
+    // Vertex and index range of one mesh in the arena, given back when its owner goes away.
+    // Move-only like the GL handles it replaces.
+    class MeshGpuAllocation {
+    public:
+        MeshGpuAllocation() = default;
+        ~MeshGpuAllocation();
+        MeshGpuAllocation(const MeshGpuAllocation&) = delete;
+        MeshGpuAllocation& operator=(const MeshGpuAllocation&) = delete;
+        MeshGpuAllocation(MeshGpuAllocation&& other) noexcept;
+        MeshGpuAllocation& operator=(MeshGpuAllocation&& other) noexcept;
+
+        bool valid() const { return vertexCount > 0; }
+
+        MeshVertexFormat format = MeshVertexFormat::Packed;
+        uint32_t firstVertex = 0;       // In the format's vertex buffer, the draws' base vertex
+        uint32_t vertexCount = 0;
+        uint64_t indexByteOffset = 0;   // In the shared index buffer, 4-byte aligned
+        uint64_t indexBytes = 0;
+    };
+
+    // Geometry of every mesh in a few shared buffers: one vertex buffer and VAO per vertex
+    // format and one index buffer for all of them, holding 16- and 32-bit index ranges side by
+    // side. Meshes draw with their base vertex and first index, so meshes of one format can go
+    // out in a single multi-draw. Buffers grow by copying on the GPU; ranges never move.
+    // Render thread only.
+    class MeshGpuArena {
+    public:
+        static constexpr uint32_t FORMAT_COUNT = 2;
+        static constexpr uint64_t INITIAL_VERTICES = 1u << 16;
+        static constexpr uint64_t INITIAL_INDEX_BYTES = 1u << 20;
+
+        static MeshGpuAllocation allocate(MeshVertexFormat format, uint32_t vertexCount, uint64_t indexBytes);
+        static void release(MeshGpuAllocation& allocation);
+        static void uploadVertices(const MeshGpuAllocation& allocation, const void* vertices);
+        static void uploadIndices(const MeshGpuAllocation& allocation, const void* indices);
+
+        static uint32_t getVertexSize(MeshVertexFormat format);
+        // VAO of a format with the shared index buffer bound
+        static GLuint getVertexArray(MeshVertexFormat format);
+
+        static size_t getReservedBytes();
+        static size_t getAllocatedBytes();
+
+        // Deletes every buffer, outstanding allocations become invalid
+        static void shutdown();
+
+    private:
+        // First fit over sorted free ranges, in elements of the pool
+        struct RangeList {
+            uint64_t capacity = 0;
+            uint64_t used = 0;
+            std::map<uint64_t, uint64_t> freeRanges; // first -> count
+
+            bool allocate(uint64_t count, uint64_t& first);
+            void release(uint64_t first, uint64_t count);
+            void grow(uint64_t newCapacity);
+        };
+
+        struct VertexPool {
+            GLuint vertexArray = 0;
+            GLuint buffer = 0;
+            RangeList ranges;
+        };
+
+        static void setupVertexArray(MeshVertexFormat format);
+        static GLuint growBuffer(GLuint buffer, uint64_t oldBytes, uint64_t newBytes);
+        static void reserveVertices(MeshVertexFormat format, uint64_t vertexCount);
+        static void reserveIndexWords(uint64_t wordCount);
+
+        static VertexPool s_vertexPools[FORMAT_COUNT];
+        static GLuint s_indexBuffer;
+        static RangeList s_indexWords; // 4-byte words
+    };
+
+}
@@ -11,132 +11,370 @@
 #include <queue>
 #include <future>
 #include <atomic>
+#include <limits>
+#include <list>
+#include <map>
+#include <functional>
+#include <ostream>
 
 namespace Engine {
 
+    // Single point returned by a nearest-point or ray query, in point cloud local space
+    struct PointCloudQueryHit {
+        PointCloudPoint point;
+        uint32_t nodeIndex = PointCloudNodePool::INVALID_NODE;
+        float distance = 0.0f;     // Distance to the query point, or perpendicular distance to the ray
+        float rayDistance = 0.0f;  // Distance along the ray (ray queries only)
+    };
+
+    // Leaf pages that pass a cloud's clip volumes. Taken on the render thread; reading it does not
+    // touch the cloud, so the cloud may change or go away while a snapshot is being read.
+    struct PointCloudClipSnapshot {
+        struct Page {
+            std::shared_ptr<const std::vector<PointCloudPoint>> points; // Null when only in the node cache
+            std::string filePath;
+            bool clipped; // Straddles a clip volume, points are tested individually
+        };
+        std::vector<Page> pages;
+        std::vector<PointCloudClipVolume> clipVolumes;
+    };
+
     class OctreePointCloudManager {
     public:
         static void buildOctree(PointCloud& pointCloud);
+        // Builds inside the given bounds instead of the points' own, so clouds built with the
+        // same bounds share their node layout (sequence frames)
+        static void buildOctree(PointCloud& pointCloud, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+        // Once per frame, before any view is drawn: streams in the nodes needed around the camera
+        // and builds the cloud's render list for the frame
         static void updateLOD(PointCloud& pointCloud, const glm::vec3& cameraPosition);
-        static void renderVisible(PointCloud& pointCloud, const glm::vec3& cameraPosition);
-        
-        // Memory management
-        static void ensureMemoryLimit(PointCloud& pointCloud);
-        static void unloadDistantNodes(PointCloud& pointCloud, const glm::vec3& cameraPosition);
+        // Replays the frame's render list with one multi-draw per arena buffer, may be called for
+        // every eye. Expects the cloud's VAO and a shader reading per-node point sizes and clip
+        // flags from NODE_DRAW_BUFFER_BINDING.
+        static void renderVisible(PointCloud& pointCloud);
+        // Frees the arena and draw buffers, called once before the GL context goes away
+        static void releaseGpuResources();
+
+        static constexpr GLuint NODE_DRAW_BUFFER_BINDING = 4;
+
+        // Memory management, budgets are enforced across clouds by PointCloudResidencyManager
         static size_t getMemoryUsage(const PointCloud& pointCloud);
-        
+        static void unloadNode(PointCloud& pointCloud, uint32_t nodeIndex);
+        // Tier eviction: a node without its CPU copy stays drawable from its VBOs, a node
+        // without VBOs is re-uploaded from its CPU copy
+        static void releaseNodeCpuCopy(PointCloud& pointCloud, uint32_t nodeIndex);
+        static void releaseNodeGpuCopy(PointCloud& pointCloud, uint32_t nodeIndex);
+
         // Disk storage
-        static void saveToDisk(PointCloudOctreeNode* node, const std::string& cacheDir);
-        static void loadFromDisk(PointCloudOctreeNode* node, const std::string& cacheDir);
+        static void saveToDisk(PointCloud& pointCloud, uint32_t nodeIndex);
+        static void loadFromDisk(PointCloud& pointCloud, uint32_t nodeIndex);
         static void createCacheDirectory(const std::string& cacheDir);
-        
+        static std::string getNodeFilePath(const std::string& cacheDir, uint32_t nodeIndex);
+
+        // Build statistics, persisted as build_stats.json in the node cache directory
+        static bool saveBuildStats(const PointCloudBuildStats& stats, const std::string& cacheDir);
+        static bool loadBuildStats(const std::string& cacheDir, PointCloudBuildStats& stats);
+        static void printBuildStats(const PointCloudBuildStats& stats, std::ostream& out);
+        // Headless report on an existing node cache: its recorded build statistics and the pages
+        // actually on disk; readPages also decodes every page. Returns a process exit code.
+        static int inspectCache(const std::string& cacheDir, bool readPages);
+
         // Async loading system
         static void initializeAsyncSystem();
         static void shutdownAsyncSystem();
-        static void requestAsyncLoad(PointCloudOctreeNode* node, const std::string& cacheDirectory);
-        static void processCompletedLoads();
-        
+        static void requestAsyncLoad(PointCloud& pointCloud, uint32_t nodeIndex, bool prefetch = false);
+        static void processCompletedLoads(PointCloud& pointCloud);
+
+        // Predictive loading: queues low-priority loads for the nodes that will be needed at the
+        // given predicted camera positions
+        static void prefetchAlongPath(PointCloud& pointCloud, const std::vector<glm::vec3>& predictedCameraPositions);
+        // Fraction of demanded node loads that the prefetcher had already completed
+        static float getPrefetchHitRate(const PointCloud& pointCloud);
+        // Look-ahead for a cloud that is not drawn yet (the next frames of a sequence): touches the
+        // nodes it would need at cameraPosition, queues prefetch loads for missing ones and, with
+        // upload, moves loaded ones to the GPU. Returns how many of the requiredCount nodes are resident.
+        static size_t prefetchView(PointCloud& pointCloud, const glm::vec3& cameraPosition, bool upload, size_t& requiredCount);
+
         // Visualization
         static void generateOctreeVisualization(PointCloud& pointCloud, int depth);
-        
+
+        // Spatial queries, in the point cloud's local space. Render thread only: they walk the
+        // node tree and the clip volumes, which the render thread changes without a lock. Nodes
+        // that are only on disk are read for the duration of the query without becoming resident.
+        // Work off the render thread goes through snapshotClippedPages below.
+        static std::vector<PointCloudPoint> queryBox(const PointCloud& pointCloud, const glm::vec3& boxMin, const glm::vec3& boxMax);
+        static std::vector<PointCloudPoint> queryRadius(const PointCloud& pointCloud, const glm::vec3& center, float radius);
+        static std::vector<PointCloudQueryHit> queryNearest(const PointCloud& pointCloud, const glm::vec3& position, size_t count);
+        // Finds the first point along the ray inside a cone of radius + coneSlope * distance,
+        // use coneSlope for pixel-footprint picking and 0 for a plain cylinder. Points cropped by
+        // the cloud's clip volumes are not hit.
+        static bool queryRay(const PointCloud& pointCloud, const glm::vec3& origin, const glm::vec3& direction,
+                             float radius, float coneSlope, PointCloudQueryHit& hit,
+                             float maxDistance = std::numeric_limits<float>::max());
+        // Interactive variant of queryRay for cursor and selection picking. Only tests pages in
+        // memory, so it never waits on the disk cache; drawn nodes missing theirs are queued for
+        // loading and hit by later picks. coneSlope is the pick radius per unit of distance
+        // (pixel footprint). Render thread only.
+        static bool pickRay(PointCloud& pointCloud, const glm::vec3& origin, const glm::vec3& direction,
+                            float coneSlope, PointCloudQueryHit& hit);
+
+        // Cropped export: the snapshot is taken on the render thread, reading it returns the
+        // points kept by the clip volumes and may run on any thread
+        static PointCloudClipSnapshot snapshotClippedPages(const PointCloud& pointCloud);
+        static std::vector<PointCloudPoint> readClippedPages(const PointCloudClipSnapshot& snapshot);
+
     private:
+        // A leaf's range of the build's points: of the index array while partitioning, of the
+        // points themselves once they are in leaf order. count shrinks as the leaf is cleaned.
+        struct BuildLeaf {
+            uint32_t nodeIndex;
+            size_t first;
+            size_t count;
+        };
+
         struct BuildContext {
-            size_t nextNodeId;
             std::string cacheDirectory;
             size_t maxPointsPerNode;
             int maxDepth;
+
+            // Leaf cleanup
+            bool removeDuplicates;
+            float duplicateTolerance;
+            bool removeOutliers;
+            int outlierNeighbors;
+            float outlierStdDevs;
+            bool estimateNormals;
+            int normalNeighbors;
+
+            // Leaves, filled by the recursion and processed afterwards
+            std::vector<BuildLeaf> leaves;
         };
-        
+
         // Async loading task structure
         struct LoadingTask {
-            PointCloudOctreeNode* node = nullptr;
-            std::string cacheDirectory;
-            std::promise<bool> promise;
+            std::shared_ptr<PointCloudLoadInbox> inbox;
+            uint32_t nodeIndex = PointCloudNodePool::INVALID_NODE;
+            std::string filePath;
         };
-        
+
+        // Builds with the octree bounds already set on the cloud
+        static void buildOctreeInBounds(PointCloud& pointCloud);
+
+        // Leaf size for autoLeafSize clouds: the points an octree cell about half as wide as
+        // the first LOD band holds at this cloud's density, bounded so that the smaller memory
+        // budget still fits MIN_RESIDENT_LEAVES leaves
+        static constexpr size_t MIN_LEAF_POINTS = 1000;
+        static constexpr size_t MAX_LEAF_POINTS = 50000;
+        static constexpr size_t MIN_RESIDENT_LEAVES = 4096;
+        static size_t chooseLeafSize(const PointCloud& pointCloud);
+
+        // Partitions indices[first, first + count) among the node's children in place
         static void buildOctreeRecursive(
-            PointCloudOctreeNode* node,
+            uint32_t nodeIndex,
             const std::vector<PointCloudPoint>& points,
-            const std::vector<size_t>& pointIndices,
-            const glm::vec3& center,
-            const glm::vec3& bounds,
+            std::vector<size_t>& indices,
+            size_t first,
+            size_t count,
             int depth,
             BuildContext& context,
             PointCloud& pointCloud
         );
-        
-        static void generateLODForNode(PointCloudOctreeNode* node);
-        static void createVBOsForNode(PointCloudOctreeNode* node);
-        
-        static float calculateNodeDistance(const PointCloudOctreeNode* node, const glm::vec3& cameraPos);
+        // Reorders points so that points[i] is the old points[order[i]], without a second copy.
+        // Leaves order as the identity.
+        static void permutePoints(std::vector<PointCloudPoint>& points, std::vector<size_t>& order);
+
+        // Depth histogram, leaf fill and cache size of a finished build
+        static void collectTreeStats(const PointCloud& pointCloud, PointCloudBuildStats& stats);
+
+        // Cleans every leaf, estimates normals, sizes and saves the leaves in parallel, then
+        // updates the internal point totals. Consumes pointCloud.points.
+        static void processLeaves(PointCloud& pointCloud, BuildContext& context);
+
+        // Both filters compact the points to the front of the range and return how many were removed
+        static size_t removeDuplicatePoints(PointCloudPoint* points, size_t count, float tolerance);
+        static size_t removeStatisticalOutliers(PointCloudPoint* points, size_t count, int neighbors, float stdDevs);
+
+        // k nearest neighbours of the first queryCount points among all points, as rows of
+        // `neighbors` indices, padded with INVALID_NEIGHBOR
+        static constexpr uint32_t INVALID_NEIGHBOR = 0xFFFFFFFFu;
+        static void findNearestNeighbors(const PointCloudPoint* points, size_t count, size_t queryCount, int neighbors,
+                                         std::vector<uint32_t>& nearest);
+        static float estimateGridCellSize(const PointCloudPoint* points, size_t count, glm::vec3& minBound, glm::vec3& maxBound);
+
+        // PCA normals of one leaf, using the points of neighbouring leaves near its faces
+        static size_t estimateLeafNormals(const PointCloudNodePool& nodes, const std::vector<uint32_t>& leafOfNode,
+                                          const std::vector<BuildLeaf>& leaves, PointCloudPoint* points, size_t leaf,
+                                          int neighbors, const glm::vec3& viewpoint);
+        static glm::vec3 estimateNormal(const PointCloudPoint* points, const uint32_t* neighbors, int count, const glm::vec3& position);
+
+        static void generateLODForNode(PointCloudNodePool& nodes, uint32_t nodeIndex, const std::vector<PointCloudPoint>& points);
+        static void createVBOsForNode(PointCloudNodePool& nodes, uint32_t nodeIndex);
+
+        static float calculateNodeDistance(const PointCloudNodePool& nodes, uint32_t nodeIndex, const glm::vec3& cameraPos);
         static int calculateRequiredLOD(float distance, const float lodDistances[5]);
-        
-        static void updateNodeRecursive(
-            PointCloudOctreeNode* node,
+        static bool shouldSubdivideNode(const PointCloudNodePool& nodes, uint32_t nodeIndex, float distance, const float lodDistances[5]);
+
+        // Render list selection, only re-run when the camera has moved noticeably. The traversals
+        // take the clip volumes still to be tested, or nullptr once a node is known to be kept.
+        static bool isSelectionStale(const PointCloud& pointCloud, const glm::vec3& cameraPosition);
+        static void selectRequiredNodes(
+            PointCloudRenderList& renderList,
+            const PointCloudNodePool& nodes,
+            uint32_t nodeIndex,
+            const glm::vec3& cameraPosition,
+            const float lodDistances[5],
+            float lodMultiplier,
+            const std::vector<PointCloudClipVolume>* clipVolumes
+        );
+
+        static void prefetchNodeRecursive(
+            PointCloud& pointCloud,
+            uint32_t nodeIndex,
             const glm::vec3& cameraPosition,
             const float lodDistances[5],
             float lodMultiplier,
-            const std::string& cacheDirectory
+            const std::vector<PointCloudClipVolume>* clipVolumes
         );
-        
-        static void renderNodeRecursive(
-            PointCloudOctreeNode* node,
+
+        static void selectDrawNodes(
+            PointCloudRenderList& renderList,
+            const PointCloudNodePool& nodes,
+            uint32_t nodeIndex,
             const glm::vec3& cameraPosition,
             const float lodDistances[5],
-            float basePointSize
+            float basePointSize,
+            const std::vector<PointCloudClipVolume>* clipVolumes
         );
-        
-        static void renderNodeAtLOD(
-            PointCloudOctreeNode* node,
+
+        static void addDrawNode(
+            PointCloudRenderList& renderList,
+            const PointCloudNodePool& nodes,
+            uint32_t nodeIndex,
             float distance,
             const float lodDistances[5],
-            float basePointSize
+            float basePointSize,
+            bool clipped
         );
-        
-        static void renderLeafDescendants(
-            PointCloudOctreeNode* node,
+
+        static void selectLeafDescendants(
+            PointCloudRenderList& renderList,
+            const PointCloudNodePool& nodes,
+            uint32_t nodeIndex,
             float distance,
             const float lodDistances[5],
-            float basePointSize
+            float basePointSize,
+            const std::vector<PointCloudClipVolume>* clipVolumes
         );
-        
+
+        // Returns false when the node lies outside the clip volumes, and clears clipVolumes when
+        // the node lies fully inside them
+        static bool narrowClipVolumes(const std::vector<PointCloudClipVolume>*& clipVolumes,
+                                      const PointCloudNodePool& nodes, uint32_t nodeIndex);
+
+        // Queues the load of a node, or uploads it when its points are in memory
+        static void makeNodeDrawable(PointCloud& pointCloud, uint32_t nodeIndex, bool prefetch);
+
+        // Turns the resident part of the render list into this frame's indirect commands
+        static void buildFrameDraws(PointCloud& pointCloud);
+
         // Disk I/O helpers
-        static std::string getNodeFilePath(const std::string& cacheDir, uint64_t nodeId);
-        static void saveNodeToHDF5(const PointCloudOctreeNode* node, const std::string& filePath);
-        static void loadNodeFromHDF5(PointCloudOctreeNode* node, const std::string& filePath);
-        
+        static void saveNodeToHDF5(const std::vector<PointCloudPoint>& points, const std::string& filePath);
+        static bool loadNodeFromHDF5(const std::string& filePath, std::vector<PointCloudPoint>& points);
+
         // Memory management helpers
-        static void markNodeAccessed(PointCloudOctreeNode* node);
-        static void collectMemoryUsage(PointCloudOctreeNode* node, size_t& totalMemory);
-        static void collectLoadedNodes(PointCloudOctreeNode* node, 
-                                     std::vector<std::pair<std::chrono::steady_clock::time_point, PointCloudOctreeNode*>>& nodesByAge);
         static void unloadOldestNodes(PointCloud& pointCloud, size_t targetMemoryMB);
-        
+
         // Visualization helpers
-        static void generateOctreeVisualizationRecursive(PointCloudOctreeNode* node, int targetDepth, 
+        static void generateOctreeVisualizationRecursive(const PointCloudNodePool& nodes, uint32_t nodeIndex, int targetDepth,
                                                        int currentDepth, std::vector<glm::vec3>& vertices);
-        
+
+        // Recently dropped CPU copies, kept so queries and re-uploads rarely go back to disk.
+        // Entries hold the pool's load inbox, which identifies a pool until it is rebuilt.
+        struct CachedPage {
+            std::shared_ptr<PointCloudLoadInbox> owner;
+            uint32_t nodeIndex;
+            std::shared_ptr<const std::vector<PointCloudPoint>> points;
+        };
+        using PageKey = std::pair<const PointCloudLoadInbox*, uint32_t>;
+
+        static std::shared_ptr<const std::vector<PointCloudPoint>> findCachedPage(const PointCloudNodePool& nodes, uint32_t nodeIndex);
+        static void storeCachedPage(const PointCloudNodePool& nodes, uint32_t nodeIndex, std::shared_ptr<const std::vector<PointCloudPoint>> points);
+
+        // Query helpers. With missedNodes only pages in memory are tested and drawn nodes without
+        // one are appended to it; without, missing pages are streamed from the node cache.
+        static bool traceRay(const PointCloud& pointCloud, const glm::vec3& origin, const glm::vec3& direction,
+                             float radius, float coneSlope, PointCloudQueryHit& hit, float maxDistance, std::vector<uint32_t>* missedNodes);
+        static std::shared_ptr<const std::vector<PointCloudPoint>> acquireNodePoints(const PointCloud& pointCloud, uint32_t nodeIndex);
+        static float nodeDistanceSquared(const PointCloudNodePool& nodes, uint32_t nodeIndex, const glm::vec3& position);
+        static bool intersectNodeRay(const PointCloudNodePool& nodes, uint32_t nodeIndex, const glm::vec3& origin,
+                                     const glm::vec3& inverseDirection, float padding, float& tEnter, float& tExit);
+
+        // Distance kernels over node point arrays (SSE when available)
+        static void computeDistancesSquared(const PointCloudPoint* points, size_t count, const glm::vec3& position, float* distancesSquared);
+        static void computeRayDistances(const PointCloudPoint* points, size_t count, const glm::vec3& origin,
+                                        const glm::vec3& direction, float* alongRay, float* perpendicularSquared);
+
         // Async loading worker function
         static void workerThreadFunction();
-        
+
         // Static members for async loading system
         static std::vector<std::thread> s_workerThreads;
         static std::queue<LoadingTask> s_loadingQueue;
+        static std::queue<LoadingTask> s_prefetchQueue; // Only served when s_loadingQueue is empty
+        static constexpr size_t MAX_PREFETCH_QUEUE = 256;
         static std::mutex s_queueMutex;
         static std::condition_variable s_queueCondition;
         static std::atomic<bool> s_shutdownRequested;
-        static std::vector<std::future<bool>> s_completedTasks;
-        static std::mutex s_completedMutex;
         static std::mutex s_hdf5Mutex; // Serialize HDF5 operations for thread safety
+
+        // Page cache for dropped CPU copies
+        static std::list<CachedPage> s_pageCache; // Most recently used first
+        static std::map<PageKey, std::list<CachedPage>::iterator> s_pageCacheIndex;
+        static std::mutex s_pageCacheMutex;
+        static size_t s_pageCacheBytes;
+        static constexpr size_t PAGE_CACHE_BUDGET = size_t(256) * 1024 * 1024;
+
+        // Fraction of the nearest LOD distance the camera may move before the selection is redone
+        static constexpr float RENDER_LIST_REUSE_FRACTION = 0.02f;
+
+        // Multi-draw submission. The commands of all clouds are collected in one buffer per
+        // frame; each cloud's render list refers to its range.
+        struct PendingDraw {
+            uint32_t buffer;
+            uint32_t first;
+            uint32_t count;
+            float pointSize;
+            bool clipped;
+        };
+        struct DrawArraysIndirectCommand {
+            uint32_t count;
+            uint32_t instanceCount;
+            uint32_t first;
+            uint32_t baseInstance;
+        };
+        static std::vector<PendingDraw> s_pendingDraws;
+        static std::vector<DrawArraysIndirectCommand> s_frameCommands;
+        // Per-command parameters read by the vertex shader, std430 layout
+        struct NodeDrawParams {
+            float pointSize;
+            uint32_t clipped;
+        };
+        static std::vector<NodeDrawParams> s_frameNodeDraws;
+        static uint32_t s_frameDrawsFrame;
+        static bool s_frameDrawsUploaded;
+        static GLuint s_indirectBuffer;
+        static GLuint s_nodeDrawBuffer;
     };
 
     // Utility functions for octree bounds calculation
     struct OctreeBounds {
-        static void calculateBounds(const std::vector<PointCloudPoint>& points, 
+        static void calculateBounds(const std::vector<PointCloudPoint>& points,
                                   glm::vec3& min, glm::vec3& max, glm::vec3& center, float& size);
+        // Padded cube around an axis-aligned box
+        static void calculateCube(const glm::vec3& min, const glm::vec3& max, glm::vec3& center, float& size);
         static void getChildBounds(const glm::vec3& parentCenter, const glm::vec3& parentBounds,
                                  int childIndex, glm::vec3& childCenter, glm::vec3& childBounds);
         static int getChildIndex(const glm::vec3& point, const glm::vec3& center);
     };
 
-}
\ No newline at end of file
+}
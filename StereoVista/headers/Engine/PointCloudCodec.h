@@ -0,0 +1,19 @@
+#pragma once
+#include "Data.h"
+#include <vector>
+#include <cstdint>
+
+namespace Engine {
+    // Lossless compression of octree node pages for the disk cache.
+    //
+    // Points are reordered along a Morton curve inside the node, which keeps neighbours close
+    // in the stream. Positions (and intensity) are stored as zigzag deltas of their order-preserving
+    // float bit patterns, bit-packed in blocks of 128 values with one bit width per block. Colors
+    // that are exact 8-bit values are stored as bytes, run-length coded when that is smaller.
+    // Packed normals are delta coded like positions.
+    // Decoding reproduces every float bit for bit; only the order of points changes.
+    namespace PointCloudCodec {
+        void encode(const std::vector<PointCloudPoint>& points, std::vector<uint8_t>& encoded);
+        bool decode(const uint8_t* data, size_t size, std::vector<PointCloudPoint>& points);
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <map>
+
+namespace Engine {
+
+    // Range of points inside one of the arena's vertex buffers
+    struct PointCloudGpuAllocation {
+        static constexpr uint32_t INVALID_BUFFER = 0xFFFFFFFFu;
+
+        uint32_t buffer = INVALID_BUFFER; // Arena buffer slot, see PointCloudGpuArena::getBuffer
+        uint32_t first = 0;               // First point in the buffer
+        uint32_t count = 0;
+
+        bool valid() const { return buffer != INVALID_BUFFER; }
+    };
+
+    // Suballocates octree node vertex data from a few large shared buffers so the visible
+    // nodes of a cloud can be drawn with one multi-draw per buffer instead of one bind and
+    // draw per node. Points are stored at POINT_STRIDE bytes, matching PointCloudPoint.
+    // Render thread only.
+    class PointCloudGpuArena {
+    public:
+        static constexpr size_t POINT_STRIDE = 32;
+        static constexpr uint32_t BUFFER_POINTS = 1u << 21; // 64 MB per buffer
+
+        static PointCloudGpuAllocation allocate(uint32_t pointCount);
+        static void release(PointCloudGpuAllocation& allocation);
+        static void upload(const PointCloudGpuAllocation& allocation, const void* points);
+
+        static GLuint getBuffer(uint32_t slot) { return slot < s_buffers.size() ? s_buffers[slot].buffer : 0; }
+        static size_t getBufferCount();
+        static size_t getReservedBytes();
+        static size_t getAllocatedBytes() { return s_allocatedPoints * POINT_STRIDE; }
+
+        // Deletes every buffer, outstanding allocations become invalid
+        static void shutdown();
+
+    private:
+        struct ArenaBuffer {
+            GLuint buffer = 0;
+            uint32_t capacity = 0;
+            uint32_t usedPoints = 0;
+            std::map<uint32_t, uint32_t> freeRanges; // first point -> point count
+        };
+
+        static bool allocateFrom(uint32_t slot, uint32_t pointCount, PointCloudGpuAllocation& allocation);
+        static uint32_t createBuffer(uint32_t capacity);
+
+        static std::vector<ArenaBuffer> s_buffers;
+        static size_t s_allocatedPoints;
+    };
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "Data.h"
+#include <vector>
+
+namespace Engine {
+
+    // Scene-wide memory budgets for streamed point cloud nodes. All clouds share one CPU
+    // and one GPU budget; when either is exceeded the least recently used nodes of that
+    // tier are evicted regardless of which cloud they belong to. The budgets start from the
+    // detected RAM and VRAM and shrink while other applications leave too little of either free.
+    class PointCloudResidencyManager {
+    public:
+        // Sizes the CPU budget from the detected physical memory
+        static void initialize();
+        // Sizes the GPU budget from the driver's memory info; needs a current GL context
+        static void initializeGpu();
+
+        // Advances the shared frame counter used to rank nodes of every cloud
+        static void beginFrame();
+        static uint32_t getFrame() { return s_frame; }
+
+        // Evicts CPU and GPU copies across all clouds until both budgets are met. Every
+        // BUDGET_UPDATE_INTERVAL frames the budgets are first adjusted to the free memory.
+        static void enforceBudgets(std::vector<PointCloud>& pointClouds);
+
+        // Current budgets, at most the limits and lower while memory is under pressure
+        static size_t getCpuBudget() { return s_cpuBudgetBytes; }
+        static size_t getGpuBudget() { return s_gpuBudgetBytes; }
+        static size_t getCpuBudgetLimit() { return s_cpuBudgetLimit; }
+        static size_t getGpuBudgetLimit() { return s_gpuBudgetLimit; }
+        static void setCpuBudget(size_t bytes) { s_cpuBudgetLimit = s_cpuBudgetBytes = bytes; }
+        static void setGpuBudget(size_t bytes) { s_gpuBudgetLimit = s_gpuBudgetBytes = bytes; }
+
+        // Copies evicted over the whole session, per tier
+        static size_t getCpuEvictions() { return s_cpuEvictions; }
+        static size_t getGpuEvictions() { return s_gpuEvictions; }
+
+        static size_t getCpuUsage(const std::vector<PointCloud>& pointClouds);
+        static size_t getGpuUsage(const std::vector<PointCloud>& pointClouds);
+
+        static size_t detectPhysicalMemory();
+        // Memory other processes could still get, 0 when it cannot be queried
+        static size_t detectAvailableMemory();
+        static size_t detectAvailableGpuMemory();
+
+    private:
+        // Vendor extension the free VRAM is read from
+        enum class GpuMemoryQuery { None, Nvx, Ati };
+
+        struct EvictionCandidate {
+            PointCloud* pointCloud;
+            uint32_t nodeIndex;
+            uint32_t lastAccessedFrame;
+            uint8_t depth;
+        };
+
+        static const uint32_t BUDGET_UPDATE_INTERVAL = 60;
+        static const size_t MIN_BUDGET_BYTES = size_t(256) * 1024 * 1024;
+
+        // Moves a budget toward what its tier could use while keeping reserve bytes free
+        static size_t adjustBudget(size_t budget, size_t limit, size_t usage, size_t available, size_t reserve);
+        static void updateBudgets(const std::vector<PointCloud>& pointClouds);
+        static bool hasGlExtension(const char* name);
+
+        static size_t evictTier(std::vector<PointCloud>& pointClouds, bool gpuTier, size_t& usage, size_t target);
+
+        static size_t s_cpuBudgetBytes;
+        static size_t s_gpuBudgetBytes;
+        static size_t s_cpuBudgetLimit;
+        static size_t s_gpuBudgetLimit;
+        static size_t s_cpuReserveBytes;
+        static size_t s_gpuReserveBytes;
+        static GpuMemoryQuery s_gpuMemoryQuery;
+        static uint32_t s_frame;
+        static size_t s_cpuEvictions;
+        static size_t s_gpuEvictions;
+        static bool s_cpuOverBudget;
+        static bool s_gpuOverBudget;
+    };
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "Data.h"
+#include <future>
+#include <string>
+#include <vector>
+
+namespace Engine {
+
+    // Playback of point cloud sequences. Only the current frame of a sequence is visible; the
+    // frames after it are streamed through the node cache ahead of time so that the nodes the
+    // camera needs are resident by the time playback reaches them.
+    class PointCloudSequenceManager {
+    public:
+        // Once per frame, before the point cloud LOD update: advances playback, switches the
+        // visible frame and runs the look-ahead for the next prefetchFrames frames
+        static void update(std::vector<PointCloudSequence>& sequences, std::vector<PointCloud>& pointClouds,
+                           float deltaTime, const glm::vec3& cameraPosition);
+
+        // Shows the given frame, clamped to the sequence
+        static void seek(PointCloudSequence& sequence, std::vector<PointCloud>& pointClouds, int frame);
+
+        // Frames of a sequence that are still in the scene, in playback order
+        static std::vector<PointCloud*> getFrames(const PointCloudSequence& sequence, std::vector<PointCloud>& pointClouds);
+
+        static uint32_t allocateSequenceId() { return s_nextSequenceId++; }
+
+        // Loads the frames and builds their octrees on a worker thread, the render thread keeps
+        // drawing meanwhile. The sequence joins the scene in updateImports once all frames are built.
+        static void beginImport(const std::vector<std::string>& framePaths, const std::string& name);
+        // Once per frame on the render thread: moves finished imports into the scene. True if
+        // frames were added.
+        static bool updateImports(std::vector<PointCloudSequence>& sequences, std::vector<PointCloud>& pointClouds);
+        static size_t getPendingImports() { return s_imports.size(); }
+        // Waits for running imports and drops their frames, before the GL context goes away
+        static void shutdown();
+
+    private:
+        struct PendingImport {
+            PointCloudSequence sequence;
+            std::future<std::vector<PointCloud>> frames;
+        };
+
+        static void showFrame(PointCloudSequence& sequence, const std::vector<PointCloud*>& frames, int frame);
+
+        static uint32_t s_nextSequenceId;
+        static std::vector<PendingImport> s_imports;
+    };
+
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include "Loaders/ModelLoader.h"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Engine {
+
+    // Read-only memory mapping of a whole file
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::string& path);
+        void close();
+
+        const uint8_t* data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#else
+        int m_fd = -1;
+#endif
+    };
+
+    // Cooked meshes of imported model files, so that loading the same file again skips Assimp.
+    // A cache file holds the final vertex and index buffers, LOD chains and meshlets, the
+    // material parameters and the resolved texture paths. It is named after a hash of the source
+    // file contents and the import flags, so an edited file or changed post-processing misses
+    // the cache instead of reading stale data. Vertex and index data are stored in the in-memory
+    // layout, so reading a mesh back is a plain copy out of the mapping.
+    class MeshCache {
+    public:
+        struct CachedTexture {
+            std::string type;
+            std::string path;      // Reference in the source file
+            std::string fullPath;  // File it resolved to, empty if none was found
+        };
+
+        struct CachedMesh {
+            const Vertex* vertices = nullptr;
+            uint32_t vertexCount = 0;
+            const GLuint* indices = nullptr;
+            uint32_t indexCount = 0;
+            const GLuint* lodIndices = nullptr;
+            uint32_t lodIndexCount = 0;
+            std::vector<MeshLod> lods;
+            std::vector<Meshlet> meshlets;
+            unsigned int materialIndex = 0;
+            glm::vec3 color = glm::vec3(1.0f);
+            float shininess = 32.0f;
+            std::string name;
+        };
+
+        // An open cache file. The vertex and index pointers point into the mapping and stay valid
+        // as long as the CachedModel lives.
+        struct CachedModel {
+            MappedFile file;
+            std::vector<CachedMesh> meshes;
+            std::vector<std::vector<CachedTexture>> materials;
+            glm::vec3 boundsMin = glm::vec3(0.0f);
+            glm::vec3 boundsMax = glm::vec3(0.0f);
+        };
+
+        // Streams meshes into a temporary file that replaces the cache entry in finish(). An
+        // unfinished writer (cancelled or failed import) removes its temporary file.
+        class Writer {
+        public:
+            explicit Writer(uint64_t key);
+            ~Writer();
+            Writer(const Writer&) = delete;
+            Writer& operator=(const Writer&) = delete;
+
+            bool isOpen() const { return m_stream.is_open(); }
+
+            void addMesh(const MeshData& data);
+            void setMaterialTextures(unsigned int materialIndex, const std::vector<CachedTexture>& textures);
+            bool finish();
+
+        private:
+            struct PendingMesh {
+                uint64_t vertexOffset;
+                uint64_t indexOffset;
+                uint64_t lodIndexOffset;
+                uint32_t vertexCount;
+                uint32_t indexCount;
+                uint32_t lodIndexCount;
+                std::vector<MeshLod> lods;
+                std::vector<Meshlet> meshlets;
+                unsigned int materialIndex;
+                glm::vec3 color;
+                float shininess;
+                std::string name;
+            };
+
+            void align(size_t alignment);
+
+            uint64_t m_key;
+            std::string m_path;
+            std::string m_tempPath;
+            std::ofstream m_stream;
+            uint64_t m_offset = 0;
+            bool m_failed = false;
+            std::vector<PendingMesh> m_meshes;
+            std::vector<std::vector<CachedTexture>> m_materials;
+            glm::vec3 m_boundsMin;
+            glm::vec3 m_boundsMax;
+        };
+
+        // Hash of the file contents combined with the import flags, the cook options and the cache
+        // format version; 0 if the file cannot be read
+        static uint64_t computeKey(const std::string& sourcePath, unsigned int importFlags);
+
+        // Null when there is no valid cache file for key
+        static std::unique_ptr<CachedModel> open(uint64_t key);
+
+        static std::string getCachePath(uint64_t key);
+
+        // Copy of a cached mesh in the form the import pipeline passes around
+        static MeshData toMeshData(const CachedMesh& mesh);
+
+        static void setEnabled(bool enabled) { s_enabled = enabled; }
+        static bool isEnabled() { return s_enabled; }
+
+        static void setCacheDirectory(const std::string& directory) { s_cacheDirectory = directory; }
+        static const std::string& getCacheDirectory() { return s_cacheDirectory; }
+
+    private:
+        // Also covers the cook steps: bump it when the simplifier, the meshlet builder or their settings change
+        static constexpr uint32_t FORMAT_VERSION = 4;
+
+        static bool s_enabled;
+        static std::string s_cacheDirectory;
+    };
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "Loaders/ModelLoader.h"
+#include <vector>
+
+namespace Engine {
+
+    // Reorders a cooked mesh for the GPU without changing what it draws. Triangles are ordered
+    // for the post-transform vertex cache (Tipsify), clusters of triangles are ordered so that
+    // likely occluders are drawn first, and vertices are renumbered in order of first use so that
+    // vertex fetch walks the buffer front to back. Meshlets stay contiguous, only their order and
+    // the triangles inside them change.
+    class MeshOptimizer {
+    public:
+        // Reorders data in place and fills data.orderStats
+        static void optimize(MeshData& data);
+
+        // Vertices transformed by a FIFO cache of CACHE_SIZE entries drawing the triangle list
+        static uint64_t countCacheMisses(const GLuint* indices, size_t indexCount, size_t vertexCount);
+
+        // Rasterizes the triangle list from the six axis directions into OVERDRAW_GRID sized
+        // depth buffers with back faces culled. covered counts pixels hit at all, shaded the
+        // fragments that passed the depth test.
+        static void measureOverdraw(const std::vector<Vertex>& vertices, const GLuint* indices, size_t indexCount,
+                                    uint64_t& covered, uint64_t& shaded);
+
+        static void setEnabled(bool enabled) { s_enabled = enabled; }
+        static bool isEnabled() { return s_enabled; }
+
+        static constexpr uint32_t CACHE_SIZE = 16;
+        static constexpr int OVERDRAW_GRID = 256;
+        // A cluster is cut once its own miss rate is within this factor of the whole mesh's
+        static constexpr float CLUSTER_ACMR_THRESHOLD = 1.05f;
+        static constexpr size_t MIN_CLUSTER_TRIANGLES = 16;
+
+    private:
+        // Tipsify on one triangle list in place. localOf maps vertices to range-local ids and is
+        // all NO_VERTEX on entry and exit. clusterStarts, if given, receives the first triangle
+        // of every run that started from a cold cache.
+        static void orderForVertexCache(GLuint* indices, size_t indexCount, std::vector<uint32_t>& localOf,
+                                        std::vector<uint32_t>* clusterStarts);
+
+        static bool s_enabled;
+    };
+
+}
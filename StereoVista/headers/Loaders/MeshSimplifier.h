@@ -0,0 +1,29 @@
+#pragma once
+#include "Loaders/ModelLoader.h"
+#include <vector>
+
+namespace Engine {
+
+    // Quadric error edge collapse for mesh LODs. A collapse moves a vertex onto a neighbour and
+    // never creates vertices, so every level indexes the vertex buffer of the full mesh. Open
+    // borders and attribute seams (several vertices at one position) stay where they are, which
+    // keeps adjacent meshes and texture charts closed at the cost of less reduction along them.
+    class MeshSimplifier {
+    public:
+        // Indices of a simplified copy with about targetIndexCount indices, or fewer collapses if
+        // the next one would move the surface further than maxError (object space units).
+        // outError receives a bound on how far the result deviates from the input surface.
+        static std::vector<GLuint> simplify(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+                                            size_t targetIndexCount, float maxError, float& outError);
+
+        // Fills data.lodIndices and data.lods with levels of about half the triangles of the
+        // previous one. Meshes below MIN_LOD_TRIANGLES * 2 triangles get no levels.
+        static void buildLodChain(MeshData& data);
+
+        static constexpr size_t MIN_LOD_TRIANGLES = 512;
+        static constexpr size_t MAX_LOD_LEVELS = 6;
+        // A level that removes less than this fraction of the previous one ends the chain
+        static constexpr float MIN_LOD_REDUCTION = 0.2f;
+    };
+
+}
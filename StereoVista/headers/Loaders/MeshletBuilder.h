@@ -0,0 +1,24 @@
+#pragma once
+#include "Loaders/ModelLoader.h"
+#include <vector>
+
+namespace Engine {
+
+    // Splits the full level of a mesh into meshlets for cluster culling. Triangles are grown into
+    // compact clusters of similar orientation and the index list is reordered so that each
+    // cluster is one contiguous range; the triangles themselves do not change.
+    class MeshletBuilder {
+    public:
+        // Fills data.meshlets and reorders data.indices. Meshes below MIN_SOURCE_TRIANGLES are
+        // left alone, one draw is cheaper than culling them.
+        static void build(MeshData& data);
+
+        // Bounding sphere and normal cone of indexCount indices starting at indexOffset
+        static Meshlet computeBounds(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+                                     uint32_t indexOffset, uint32_t indexCount);
+
+        static constexpr uint32_t MAX_TRIANGLES = 128;
+        static constexpr size_t MIN_SOURCE_TRIANGLES = 1024;
+    };
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include "Loaders/ModelLoader.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Engine {
+
+    // Imports model files on a background thread. beginImport returns a placeholder model that is
+    // shown as a box right away; once the file is parsed the box takes the model's bounds and
+    // update() moves the converted meshes into it under a per-frame time budget, so the render
+    // loop keeps running while large files load.
+    class ModelImportManager {
+    public:
+        enum class Stage { Reading, Textures, Converting, Uploading, Done, Failed };
+
+        struct ImportStatus {
+            uint32_t id = 0;
+            std::string path;
+            Stage stage = Stage::Reading;
+            float progress = 0.0f;
+            uint32_t meshesLoaded = 0;
+            uint32_t totalMeshes = 0;
+        };
+
+        // Starts importing path and returns the placeholder to insert into the scene. onComplete
+        // runs on the render thread once every mesh is in the model.
+        static Model beginImport(const std::string& path, std::function<void(Model&)> onComplete = nullptr);
+
+        // Once per frame on the render thread. Returns true when a model finished loading or a
+        // cancelled or failed import was removed from models.
+        static bool update(std::vector<Model>& models);
+
+        // The placeholder model is removed from the scene by the next update()
+        static void cancel(uint32_t importId);
+        // Cancels every import and waits for the workers; call before the GL context goes away
+        static void shutdown();
+
+        static std::vector<ImportStatus> getImports();
+        static bool hasActiveImports();
+
+        static const char* stageName(Stage stage);
+
+        // Time the render thread spends per frame on texture and mesh uploads
+        static void setUploadBudgetMs(float milliseconds) { s_uploadBudgetMs = milliseconds; }
+        static float getUploadBudgetMs() { return s_uploadBudgetMs; }
+
+    private:
+        struct TextureRef {
+            std::string type;
+            std::string path;
+            size_t imageIndex = 0;
+        };
+
+        struct ImportJob {
+            uint32_t id = 0;
+            std::string path;
+            std::string directory;
+            std::function<void(Model&)> onComplete;
+            std::thread worker;
+
+            std::atomic<bool> cancelled{ false };
+            std::atomic<bool> workerDone{ false };
+            std::atomic<Stage> stage{ Stage::Reading };
+            std::atomic<float> readProgress{ 0.0f };
+            std::atomic<uint32_t> texturesDecoded{ 0 };
+            std::atomic<uint32_t> meshesConverted{ 0 };
+            std::atomic<uint32_t> meshesUploaded{ 0 };
+
+            // Published by the worker, guarded by mutex
+            mutable std::mutex mutex;
+            std::condition_variable queueSpace;
+            bool boundsReady = false;
+            glm::vec3 boundsMin = glm::vec3(0.0f);
+            glm::vec3 boundsMax = glm::vec3(0.0f);
+            uint32_t totalMeshes = 0;
+            uint32_t totalTextures = 0;
+            bool texturesReady = false;
+            std::vector<TextureImage> images;
+            std::vector<std::vector<TextureRef>> materialTextures;
+            std::deque<MeshData> readyMeshes;
+            size_t queuedBytes = 0;
+            std::string error;
+
+            // Render thread only
+            bool boundsApplied = false;
+            size_t imagesUploaded = 0;
+            std::vector<Texture> uploadedImages;
+            std::vector<std::vector<Texture>> meshTextures;
+        };
+
+        static void runImport(ImportJob& job);
+        static void finishJob(size_t jobIndex);
+        static std::vector<Texture> resolveTextures(ImportJob& job, unsigned int materialIndex);
+        static Mesh createBoxMesh(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+        static float computeProgress(const ImportJob& job);
+
+        // Converted meshes waiting for upload; the worker pauses above this
+        static constexpr size_t MAX_QUEUED_BYTES = 256ull * 1024 * 1024;
+
+        static std::vector<std::unique_ptr<ImportJob>> s_jobs;
+        static uint32_t s_nextImportId;
+        static float s_uploadBudgetMs;
+    };
+
+}
@@ -5,6 +5,9 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include "../Engine/Core.h"
+#include "../Engine/MeshGpuArena.h"
+#include <memory>
+#include <limits>
 
 // Material type enum for presets
 enum class MaterialType {
@@ -22,18 +25,149 @@ namespace Engine {
     class Shader;
 
     struct Texture {
-        GLuint id;
+        GLuint id = 0;
         std::string type;
         std::string path;      // Original reference path from model file
         std::string fullPath;  // Full filesystem path of the actual texture file
+
+        // Owns id. Meshes and models that use the same texture share it, the GL texture is
+        // deleted with the last of them.
+        std::shared_ptr<GLTexture> handle;
+
+        void adopt(GLuint textureId) {
+            handle = std::make_shared<GLTexture>(textureId);
+            id = textureId;
+        }
+    };
+
+    // Simplified level of a mesh. Levels index the vertices of the full mesh; their indices
+    // follow each other in lodIndices.
+    struct MeshLod {
+        uint32_t indexOffset = 0;  // Into lodIndices
+        uint32_t indexCount = 0;
+        float error = 0.0f;        // Upper bound on the deviation from the full mesh, object space units
+    };
+
+    // Cluster of neighbouring triangles of the full mesh, a contiguous range of its indices.
+    // Bounds and normal cone are in object space; the cluster faces away from every point p with
+    // dot(center - p, coneAxis) >= coneCutoff * length(center - p) + radius.
+    struct Meshlet {
+        uint32_t indexOffset = 0;
+        uint32_t indexCount = 0;
+        glm::vec3 center = glm::vec3(0.0f);
+        float radius = 0.0f;
+        glm::vec3 coneAxis = glm::vec3(0.0f);
+        float coneCutoff = 1.0f;  // 1 when the triangles face too many directions to cull
+    };
+
+    // Meshlet bounds as separate arrays padded to a multiple of four, for the SIMD culling.
+    // Padding entries have a negative infinite radius and never pass.
+    struct MeshletBounds {
+        std::vector<float> centerX, centerY, centerZ, radius;
+        std::vector<float> axisX, axisY, axisZ, cutoff;
+
+        void build(const std::vector<Meshlet>& meshlets) {
+            size_t padded = (meshlets.size() + 3) & ~size_t(3);
+            for (std::vector<float>* column : { &centerX, &centerY, &centerZ, &axisX, &axisY, &axisZ }) {
+                column->assign(padded, 0.0f);
+            }
+            radius.assign(padded, -std::numeric_limits<float>::infinity());
+            cutoff.assign(padded, 1.0f);
+            for (size_t i = 0; i < meshlets.size(); i++) {
+                centerX[i] = meshlets[i].center.x;
+                centerY[i] = meshlets[i].center.y;
+                centerZ[i] = meshlets[i].center.z;
+                radius[i] = meshlets[i].radius;
+                axisX[i] = meshlets[i].coneAxis.x;
+                axisY[i] = meshlets[i].coneAxis.y;
+                axisZ[i] = meshlets[i].coneAxis.z;
+                cutoff[i] = meshlets[i].coneCutoff;
+            }
+        }
+    };
+
+    // Vertex cache and overdraw figures of the full level before and after MeshOptimizer. Kept as
+    // counts so that the figures of several meshes add up.
+    struct MeshOrderStats {
+        uint64_t triangles = 0;
+        uint64_t cacheMissesBefore = 0, cacheMissesAfter = 0;
+        uint64_t pixelsCovered = 0, pixelsShadedBefore = 0, pixelsShadedAfter = 0;
+
+        MeshOrderStats& operator+=(const MeshOrderStats& other) {
+            triangles += other.triangles;
+            cacheMissesBefore += other.cacheMissesBefore;
+            cacheMissesAfter += other.cacheMissesAfter;
+            pixelsCovered += other.pixelsCovered;
+            pixelsShadedBefore += other.pixelsShadedBefore;
+            pixelsShadedAfter += other.pixelsShadedAfter;
+            return *this;
+        }
+
+        // Vertex shader runs per triangle
+        float acmrBefore() const { return triangles ? float(cacheMissesBefore) / float(triangles) : 0.0f; }
+        float acmrAfter() const { return triangles ? float(cacheMissesAfter) / float(triangles) : 0.0f; }
+        // Fragments shaded per covered pixel
+        float overdrawBefore() const { return pixelsCovered ? float(pixelsShadedBefore) / float(pixelsCovered) : 0.0f; }
+        float overdrawAfter() const { return pixelsCovered ? float(pixelsShadedAfter) / float(pixelsCovered) : 0.0f; }
+    };
+
+    // CPU side of an imported mesh. Converted on worker threads; only turning it into a Mesh
+    // needs the GL thread.
+    struct MeshData {
+        std::vector<Vertex> vertices;
+        std::vector<GLuint> indices;
+        std::vector<GLuint> lodIndices;
+        std::vector<MeshLod> lods;  // Coarser levels, increasing error
+        std::vector<Meshlet> meshlets;  // Clusters of indices, empty for small meshes
+        MeshOrderStats orderStats;      // Zero unless MeshOptimizer ran on it
+        unsigned int materialIndex = 0;
+        glm::vec3 color = glm::vec3(1.0f);
+        float shininess = 32.0f;
+        std::string name;
+    };
+
+    // GPU layout of a mesh vertex, 24 bytes instead of the 60 of Vertex. Normal and tangent are
+    // 10:10:10:2 signed normalized with the bitangent handedness in the tangent's w, texture
+    // coordinates are half floats. The bitangent is rebuilt in the shader.
+    struct PackedVertex {
+        glm::vec3 position;
+        uint32_t normal;
+        uint32_t tangent;
+        uint32_t texCoords;
+    };
+
+    // PackedVertex with the position as 16-bit fractions of the mesh bounds, 20 bytes
+    struct QuantizedVertex {
+        uint16_t position[4];  // w is padding
+        uint32_t normal;
+        uint32_t tangent;
+        uint32_t texCoords;
+    };
+
+    // Pixels of a texture file. Decoded on any thread, uploaded on the GL thread.
+    struct TextureImage {
+        std::string fullPath;
+        int width = 0;
+        int height = 0;
+        int components = 0;
+        std::vector<unsigned char> pixels;  // Empty if no file could be decoded
     };
 
+    // Move-only. The GPU geometry is shared through MeshGeometryRegistry with every mesh of the
+    // same vertices and indices and released with the last of them.
     class Mesh {
     public:
         std::vector<Vertex> vertices;
         std::vector<GLuint> indices;
         std::vector<Texture> textures;
-        GLuint VAO, VBO, EBO;
+        // Simplified levels, drawn from the same vertex buffer; empty for small meshes
+        std::vector<GLuint> lodIndices;
+        std::vector<MeshLod> lods;
+        // Clusters of the full level, culled per frame by MeshClusterCuller
+        std::vector<Meshlet> meshlets;
+        MeshletBounds meshletBounds;
+        // Vertices and indices (full level, then the LODs) in the shared geometry buffers
+        std::shared_ptr<const MeshGpuAllocation> gpu;
 
         bool visible = true;
         glm::vec3 color = glm::vec3(1.0f);
@@ -41,26 +175,102 @@ namespace Engine {
         float emissive = 0.0f;
         std::string name;  // Optional: for better identification
 
+        // GPU format chosen in setupMesh
+        GLenum indexType = GL_UNSIGNED_INT;  // GL_UNSIGNED_SHORT when every index fits
+        bool quantized = false;
+        // Quantized positions decode as stored * positionScale + positionOffset
+        glm::vec3 positionScale = glm::vec3(1.0f);
+        glm::vec3 positionOffset = glm::vec3(0.0f);
+
+        // Meshes created while this is set store QuantizedVertex instead of PackedVertex. Off by
+        // default: neighbouring meshes quantize to different grids and can show hairline gaps.
+        static bool quantizePositions;
+
+        // Level drawn by Draw: 0 is the full mesh, n is lods[n - 1]
+        int currentLod = 0;
+        // Object space bounding sphere, for the LOD choice
+        glm::vec3 boundsCenter = glm::vec3(0.0f);
+        float boundsRadius = 0.0f;
+
+        // Draw the coarsest level whose error projects to at most lodPixelError pixels
+        static bool lodEnabled;
+        static float lodPixelError;
+
+        // Commands of the visible clusters, valid while clusterFrame is MeshClusterCuller's frame
+        uint32_t clusterFrame = 0;
+        uint32_t clusterFirstCommand = 0;
+        uint32_t clusterCommandCount = 0;
+
+        // Pass the vectors with std::move to hand them over without a copy
         Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices, std::vector<Texture> textures)
-            : vertices(vertices), indices(indices), textures(textures),
+            : vertices(std::move(vertices)), indices(std::move(indices)), textures(std::move(textures)),
             visible(true), color(1.0f), shininess(32.0f), emissive(0.0f) {
             setupMesh();
         }
 
+        // Takes the geometry, LOD chain and material parameters of data
+        Mesh(MeshData&& data, std::vector<Texture> textures);
+
+        Mesh(const Mesh&) = delete;
+        Mesh& operator=(const Mesh&) = delete;
+        Mesh(Mesh&&) noexcept = default;
+        Mesh& operator=(Mesh&&) noexcept = default;
+
+        // Copy with its own CPU data; the GPU geometry and the textures are shared
+        Mesh clone() const;
+
+        // Binds the textures and draws currentLod on its own; scene passes go through MeshBatchRenderer
         void Draw(Shader& shader);
+        // Draws one level with the arena's VAO, no uniforms or textures set
+        void drawLevel(int level) const;
+        // Sets the material texture units and counts of shader
+        static void bindTextures(Shader& shader, const std::vector<Texture>& textures);
+
+        // Picks currentLod for a view in which one object space unit at the mesh covers
+        // pixelsPerUnit pixels. Called once per frame, both eyes draw the same level.
+        void selectLod(float pixelsPerUnit);
+        int getLodCount() const { return static_cast<int>(lods.size()) + 1; }
+        size_t getLodIndexCount(int level) const { return level == 0 ? indices.size() : lods[level - 1].indexCount; }
+        // First index of a level in the arena's index buffer, in units of indexType
+        uint32_t getFirstIndex(int level) const;
+
+        // Size of the vertex and index buffers
+        size_t getGpuBytes() const;
+
+        // Sets the position decode uniforms for a draw of this mesh with shader; reset afterwards
+        // with resetPositionDecode so later draws see unquantized positions
+        void applyPositionDecode(Shader& shader) const;
+        static void resetPositionDecode(Shader& shader);
 
     private:
         void setupMesh();
+        static void packAttributes(const Vertex& vertex, uint32_t& normal, uint32_t& tangent, uint32_t& texCoords);
     };
 
     GLuint createDefaultWhiteTexture();
 
+    // Move-only like its meshes; use clone() for an independent copy
     class Model {
     public:
         // Constructor
         Model() = default;
         Model(const std::string& path);
 
+        Model(const Model&) = delete;
+        Model& operator=(const Model&) = delete;
+        Model(Model&&) noexcept = default;
+        Model& operator=(Model&&) noexcept = default;
+
+        Model clone() const;
+
+        // Post-processing applied to every imported file
+        static constexpr unsigned int IMPORT_FLAGS =
+            aiProcess_Triangulate |
+            aiProcess_GenNormals |
+            aiProcess_CalcTangentSpace |
+            aiProcess_JoinIdenticalVertices |
+            aiProcess_SortByPType;
+
         // Public methods
         void Draw(Shader& shader);
 
@@ -88,12 +298,29 @@ namespace Engine {
         float boundingSphereRadius = 0.0f;
         std::string directory;
         std::vector<bool> selectedMeshes;
+
+        // Non-zero while ModelImportManager is still adding meshes to this model
+        uint32_t importId = 0;
+        // meshes only holds the bounding box shown until the first imported mesh arrives
+        bool placeholder = false;
+
         static GLuint TextureFromFile(const char* path, const std::string& directory, std::string& outFullPath);
+        // The two halves of TextureFromFile: file search and decode, then the GL upload
+        static bool decodeTextureFile(const char* path, const std::string& directory, TextureImage& image);
+        static GLuint uploadTexture(const TextureImage& image);
         const std::vector<Mesh>& getMeshes() const { return meshes; }
         std::vector<Mesh>& getMeshes() { return meshes; }
 
         std::vector<Mesh> meshes;
 
+        // Radius around the model origin that contains every vertex
+        void updateBoundingSphere();
+
+        // Meshes referenced by the node tree, in the order they become Model::meshes
+        static void collectMeshes(const aiNode* node, const aiScene* scene, std::vector<const aiMesh*>& meshList);
+        // Vertex packing, index flattening, the LOD chain, meshlets and ordering; touches no GL state and runs on any thread
+        static MeshData convertMesh(const aiMesh* mesh, const aiScene* scene, size_t meshIndex);
+
         bool hasNormalMap() const {
             if (meshes.empty()) return false;
             for (const auto& texture : meshes[0].textures) {
@@ -191,15 +418,17 @@ namespace Engine {
         std::vector<Texture> loadedTextures;
 
         void loadModel(const std::string& path);
-        void processNode(aiNode* node, const aiScene* scene);
-        Mesh processMesh(aiMesh* mesh, const aiScene* scene, size_t meshIndex);
+        // Render thread: textures of every used material, then one Mesh per converted mesh.
+        // materialTextures receives the textures loaded for each material.
+        void uploadMeshes(std::vector<MeshData>& converted, const aiScene* scene, std::vector<std::vector<Texture>>& materialTextures);
+        std::vector<Texture> loadMeshTextures(aiMaterial* material);
         std::vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName);
         GLuint loadEmbeddedTexture(const std::string& embeddedPath, std::string& outFullPath);
 
     };
 
     // Factory functions
-    Model* loadModel(const std::string& filePath);
+    Model loadModel(const std::string& filePath);
     Model createCube(const glm::vec3& color, float shininess, float emissive);
     Model createSphere(const glm::vec3& color, float shininess, float emissive, int rings = 20, int sectors = 20);
     Model createCylinder(const glm::vec3& color, float shininess, float emissive, int sectors = 20);
@@ -2,20 +2,39 @@
 #pragma once
 #include "../Engine/Data.h"
 #include <sstream>
+#include <future>
 
 namespace Engine {
 
     class PointCloudLoader {
     public:
-        static PointCloud loadPointCloudFile(const std::string& filePath, size_t downsampleFactor = 1);
+        // With buildIndex false the raw points are returned without building the octree or
+        // touching GL, for callers that build it themselves, possibly on another thread
+        static PointCloud loadPointCloudFile(const std::string& filePath, size_t downsampleFactor = 1, bool buildIndex = true);
         static bool exportToXYZ(const PointCloud& pointCloud, const std::string& filePath);
         static bool exportToBinary(const PointCloud& pointCloud, const std::string& filePath);
-        static PointCloud loadFromBinary(const std::string& filePath);
-        static PointCloud loadFromHDF5(const std::string& filePath, size_t downsampleFactor = 1);
+        static PointCloud loadFromBinary(const std::string& filePath, bool buildIndex = true);
+        static PointCloud loadFromHDF5(const std::string& filePath, size_t downsampleFactor = 1, bool buildIndex = true);
         static bool exportToHDF5(const PointCloud& pointCloud, const std::string& filePath);
+        // Writers shared by the exports, transform maps the points' local space to the exported space
+        static bool exportPointsToXYZ(const std::vector<PointCloudPoint>& points, const glm::mat4& transform, const std::string& filePath);
+        static bool exportPointsToBinary(const std::vector<PointCloudPoint>& points, const glm::mat4& transform, const std::string& filePath);
+        // Writes the points kept by the cloud's clip volumes (all points without volumes) on a
+        // worker thread. Works for octree clouds whose points only live in the node cache.
+        static std::future<bool> exportClippedAsync(const PointCloud& pointCloud, const std::string& filePath, bool binary);
+        static glm::mat4 getModelMatrix(const PointCloud& pointCloud);
+
+        // Loads the files as the frames of a sequence, in order. The frames share one octree root
+        // cube and get their node caches below a per-sequence directory; only the first is visible.
+        // Touches no GL state and runs on any thread; the frames get their vertex arrays from
+        // setupPointCloudGLBuffers on the render thread.
+        static std::vector<PointCloud> loadSequence(const std::vector<std::string>& framePaths, uint32_t sequenceId,
+                                                    const std::string& sequenceName);
+
+        // Creates the cloud's vertex array and uploads its raw points, render thread only
+        static void setupPointCloudGLBuffers(PointCloud& pointCloud);
 
     private:
-        static void setupPointCloudGLBuffers(PointCloud& pointCloud);
         static constexpr char BINARY_MAGIC_NUMBER[4] = { 'P', 'C', 'B', '1' };
         static std::string vec3_to_string(const glm::vec3& vec) {
             std::stringstream ss;
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <json.h>
 #include "Loaders/PointCloudLoader.h"
+#include "Loaders/ModelImportManager.h"
 #include <filesystem>
 #include <unordered_set>
 #include <utility>
@@ -319,59 +320,59 @@ namespace Engine {
                         if (modelJson.contains("localPath")) {
                             std::filesystem::path modelPath = sceneDir / modelJson["localPath"].get<std::string>();
                             
-                            // Load model from file
-                            model = *Engine::loadModel(modelPath.string());
-                            model.path = modelJson["path"].get<std::string>();
-                            model.directory = modelPath.parent_path().string();
-
-                            // Clear existing textures before loading new ones
-                            for (auto& mesh : model.getMeshes()) {
-                                mesh.textures.clear();
-                            }
+                            // Imported in the background; the saved textures replace the imported ones once it completes
+                            json texturesJson = modelJson.value("textures", json::array());
+                            std::filesystem::path modelDir = modelPath.parent_path();
+                            model = ModelImportManager::beginImport(modelPath.string(),
+                                [texturesJson, modelDir](Model& loaded) {
+                                    // Clear existing textures before loading new ones
+                                    for (auto& mesh : loaded.getMeshes()) {
+                                        mesh.textures.clear();
+                                    }
 
-                            // Load textures if present
-                            if (modelJson.contains("textures")) {
-                                std::unordered_set<std::string> loadedTextures;
+                                    std::unordered_set<std::string> loadedTextures;
 
-                                for (const auto& textureJson : modelJson["textures"]) {
-                                    std::string identifier = textureJson["type"].get<std::string>() + "|" +
-                                        textureJson["originalPath"].get<std::string>();
+                                    for (const auto& textureJson : texturesJson) {
+                                        std::string identifier = textureJson["type"].get<std::string>() + "|" +
+                                            textureJson["originalPath"].get<std::string>();
 
-                                    if (loadedTextures.find(identifier) == loadedTextures.end()) {
-                                        loadedTextures.insert(identifier);
+                                        if (loadedTextures.find(identifier) == loadedTextures.end()) {
+                                            loadedTextures.insert(identifier);
 
-                                        Texture texture;
-                                        texture.type = textureJson["type"];
-                                        texture.path = textureJson["originalPath"];
+                                            Texture texture;
+                                            texture.type = textureJson["type"];
+                                            texture.path = textureJson["originalPath"];
 
-                                        std::filesystem::path texturePath = modelPath.parent_path() /
-                                            textureJson["localPath"].get<std::string>();
-                                        texture.fullPath = texturePath.string();
+                                            std::filesystem::path texturePath = modelDir /
+                                                textureJson["localPath"].get<std::string>();
+                                            texture.fullPath = texturePath.string();
 
-                                        texture.id = Model::TextureFromFile(
-                                            texturePath.filename().string().c_str(),
-                                            texturePath.parent_path().string(),
-                                            texture.fullPath
-                                        );
+                                            texture.adopt(Model::TextureFromFile(
+                                                texturePath.filename().string().c_str(),
+                                                texturePath.parent_path().string(),
+                                                texture.fullPath
+                                            ));
 
-                                        // Get the mesh index if it exists
-                                        size_t meshIndex = textureJson.value("meshIndex", 0);
+                                            // Get the mesh index if it exists
+                                            size_t meshIndex = textureJson.value("meshIndex", 0);
 
-                                        // Add the texture to specified mesh or all meshes if not specified
-                                        if (meshIndex < model.getMeshes().size()) {
-                                            model.getMeshes()[meshIndex].textures.push_back(texture);
-                                        }
-                                        else {
-                                            // Add to all meshes if index is invalid
-                                            for (auto& mesh : model.getMeshes()) {
-                                                mesh.textures.push_back(texture);
+                                            // Add the texture to specified mesh or all meshes if not specified
+                                            if (meshIndex < loaded.getMeshes().size()) {
+                                                loaded.getMeshes()[meshIndex].textures.push_back(texture);
+                                            }
+                                            else {
+                                                // Add to all meshes if index is invalid
+                                                for (auto& mesh : loaded.getMeshes()) {
+                                                    mesh.textures.push_back(texture);
+                                                }
                                             }
-                                        }
 
-                                        std::cout << "Loaded texture: " << texturePath.string() << std::endl;
+                                            std::cout << "Loaded texture: " << texturePath.string() << std::endl;
+                                        }
                                     }
-                                }
-                            }
+                                });
+                            model.path = modelJson["path"].get<std::string>();
+                            model.directory = modelDir.string();
                         } else {
                             // Creating a primitive
                             glm::vec3 color = glm::vec3(
@@ -432,7 +433,7 @@ namespace Engine {
                         model.emissive = modelJson.value("emissive", 0.0f);
                         model.visible = modelJson.value("visible", true);
 
-                        scene.models.push_back(model);
+                        scene.models.push_back(std::move(model));
                     }
                     catch (const std::exception& e) {
                         std::cerr << "Failed to load model: " << e.what() << std::endl;
@@ -254,8 +254,9 @@ namespace Engine {
                 }
 
                 // Draw mesh
-                glBindVertexArray(mesh.VAO);
-                glDrawElements(GL_TRIANGLES, mesh.indices.size(), GL_UNSIGNED_INT, 0);
+                mesh.applyPositionDecode(*m_voxelShader);
+                mesh.drawLevel(0);
+                if (mesh.quantized) Mesh::resetPositionDecode(*m_voxelShader);
             }
         }
 
@@ -19,7 +19,9 @@ namespace Cursor {
         m_windowWidth(1920),
         m_windowHeight(1080),
         m_lastX(0.0f),
-        m_lastY(0.0f)
+        m_lastY(0.0f),
+        m_depthPickingEnabled(true),
+        m_pickRadiusPixels(3.0f)
     {
         m_sphereCursor = std::make_unique<SphereCursor>();
         m_fragmentCursor = std::make_unique<FragmentCursor>();
@@ -77,26 +79,46 @@ namespace Cursor {
         m_windowWidth = windowWidth;
         m_windowHeight = windowHeight;
 
-        // Read depth at cursor position
-        float depth = 0.0;
-        glReadPixels(m_lastX, (float)m_windowHeight - m_lastY, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &depth);
-
-        // Convert cursor position to world space
         glm::mat4 vpInv = glm::inverse(projection * view);
-        glm::vec4 ndc = glm::vec4(
-            (m_lastX / (float)m_windowWidth) * 2.0 - 1.0,
-            1.0 - (m_lastY / (float)m_windowHeight) * 2.0,
-            depth * 2.0 - 1.0,
-            1.0
-        );
-        auto worldPosH = vpInv * ndc;
-        auto worldPos = worldPosH / worldPosH.w;
-        auto isHit = depth != 1.0;
+        float ndcX = (m_lastX / (float)m_windowWidth) * 2.0f - 1.0f;
+        float ndcY = 1.0f - (m_lastY / (float)m_windowHeight) * 2.0f;
+
+        bool isHit = false;
+        glm::vec3 hitPosition(0.0f);
+
+        if (m_depthPickingEnabled) {
+            // Read depth at cursor position
+            float depth = 0.0;
+            glReadPixels(m_lastX, (float)m_windowHeight - m_lastY, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &depth);
+
+            // Convert cursor position to world space
+            auto worldPosH = vpInv * glm::vec4(ndcX, ndcY, depth * 2.0 - 1.0, 1.0);
+            hitPosition = glm::vec3(worldPosH / worldPosH.w);
+            isHit = depth != 1.0;
+        }
+
+        if (m_rayPicker) {
+            glm::vec4 nearH = vpInv * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+            glm::vec4 farH = vpInv * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+            glm::vec3 rayOrigin = glm::vec3(nearH) / nearH.w;
+            glm::vec3 rayDirection = glm::normalize(glm::vec3(farH) / farH.w - rayOrigin);
+
+            // Pick cone covering m_pickRadiusPixels around the cursor
+            float coneSlope = m_pickRadiusPixels * 2.0f / (projection[1][1] * (float)m_windowHeight);
+
+            glm::vec3 pickPosition;
+            if (m_rayPicker(rayOrigin, rayDirection, coneSlope, pickPosition)) {
+                if (!isHit || glm::distance(rayOrigin, pickPosition) < glm::distance(rayOrigin, hitPosition)) {
+                    hitPosition = pickPosition;
+                    isHit = true;
+                }
+            }
+        }
 
         // Update cursor properties based on whether it hit geometry
         if (isHit && (m_sphereCursor->isVisible() || m_fragmentCursor->isVisible() || m_planeCursor->isVisible())) {
             m_cursorPositionValid = true;
-            m_cursorPosition = glm::vec3(worldPos);
+            m_cursorPosition = hitPosition;
 
             m_sphereCursor->setPosition(m_cursorPosition);
             m_sphereCursor->setPositionValid(true);
@@ -0,0 +1,110 @@
+#include "../../headers/Engine/JobSystem.h"
+#include <atomic>
+#include <iostream>
+
+namespace Engine {
+
+    struct JobSystem::Batch {
+        const std::function<void(size_t)>* task = nullptr;
+        size_t count = 0;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+    };
+
+    std::vector<std::thread> JobSystem::s_workers;
+    std::deque<std::shared_ptr<JobSystem::Batch>> JobSystem::s_batches;
+    std::mutex JobSystem::s_batchMutex;
+    std::condition_variable JobSystem::s_batchAvailable;
+    std::condition_variable JobSystem::s_batchFinished;
+    bool JobSystem::s_stopping = false;
+
+    void JobSystem::initialize(size_t threadCount) {
+        if (!s_workers.empty()) {
+            return;
+        }
+        if (threadCount == 0) {
+            unsigned int hardwareThreads = std::thread::hardware_concurrency();
+            threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+        }
+
+        s_stopping = false;
+        for (size_t i = 0; i < threadCount; i++) {
+            s_workers.emplace_back(workerLoop);
+        }
+        std::cout << "Job system started with " << threadCount << " worker threads" << std::endl;
+    }
+
+    void JobSystem::shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(s_batchMutex);
+            s_stopping = true;
+        }
+        s_batchAvailable.notify_all();
+        for (std::thread& worker : s_workers) {
+            worker.join();
+        }
+        s_workers.clear();
+    }
+
+    void JobSystem::parallelFor(size_t count, const std::function<void(size_t)>& task) {
+        if (count == 0) {
+            return;
+        }
+        if (s_workers.empty() || count == 1) {
+            for (size_t i = 0; i < count; i++) {
+                task(i);
+            }
+            return;
+        }
+
+        auto batch = std::make_shared<Batch>();
+        batch->task = &task;
+        batch->count = count;
+        {
+            std::lock_guard<std::mutex> lock(s_batchMutex);
+            s_batches.push_back(batch);
+        }
+        s_batchAvailable.notify_all();
+
+        runBatch(*batch);
+
+        std::unique_lock<std::mutex> lock(s_batchMutex);
+        s_batchFinished.wait(lock, [&batch]() { return batch->done.load() == batch->count; });
+    }
+
+    void JobSystem::runBatch(Batch& batch) {
+        size_t completed = 0;
+        size_t index;
+        while ((index = batch.next.fetch_add(1)) < batch.count) {
+            (*batch.task)(index);
+            completed++;
+        }
+
+        if (completed > 0 && batch.done.fetch_add(completed) + completed == batch.count) {
+            std::lock_guard<std::mutex> lock(s_batchMutex);
+            s_batchFinished.notify_all();
+        }
+    }
+
+    void JobSystem::workerLoop() {
+        for (;;) {
+            std::shared_ptr<Batch> batch;
+            {
+                std::unique_lock<std::mutex> lock(s_batchMutex);
+                s_batchAvailable.wait(lock, []() {
+                    // Batches whose indices are all handed out only wait for their last tasks
+                    while (!s_batches.empty() && s_batches.front()->next.load() >= s_batches.front()->count) {
+                        s_batches.pop_front();
+                    }
+                    return s_stopping || !s_batches.empty();
+                });
+                if (s_batches.empty()) {
+                    return;
+                }
+                batch = s_batches.front();
+            }
+            runBatch(*batch);
+        }
+    }
+
+}
@@ -0,0 +1,149 @@
+#include "Engine/MeshBatchRenderer.h"
+#include "Engine/MeshClusterCuller.h"
+
+namespace Engine {
+
+    static_assert(sizeof(MeshBatchRenderer::DrawParams) == 160, "DrawParams must match the std430 layout of MeshDrawParams");
+
+    MeshBatchRenderer::PassData MeshBatchRenderer::s_passes[MeshBatchRenderer::PASS_COUNT];
+
+    void MeshBatchRenderer::beginFrame() {
+        for (PassData& pass : s_passes) {
+            pass.built = false;
+            pass.uploaded = false;
+        }
+    }
+
+    void MeshBatchRenderer::beginPass(Pass pass) {
+        PassData& data = s_passes[pass];
+        data.params.clear();
+        data.batches.clear();
+        data.batchIndex.clear();
+        data.stats = Stats();
+        data.built = true;
+        data.uploaded = false;
+    }
+
+    void MeshBatchRenderer::addMesh(Pass pass, const Mesh& mesh, const DrawParams& params, bool cullClusters) {
+        if (!mesh.visible || !mesh.gpu || !mesh.gpu->valid()) return;
+        PassData& data = s_passes[pass];
+
+        // Textures are bound per batch; the depth pass draws no material at all
+        BatchKey key{ mesh.gpu->format, mesh.indexType, {} };
+        if (pass != PASS_DEPTH) {
+            for (const Texture& texture : mesh.textures) {
+                key.textureIds.push_back(texture.id);
+            }
+        }
+        size_t batchIndex;
+        auto found = data.batchIndex.find(key);
+        if (found == data.batchIndex.end()) {
+            batchIndex = data.batches.size();
+            data.batchIndex.emplace(key, batchIndex);
+            Batch batch;
+            batch.format = key.format;
+            batch.indexType = key.indexType;
+            if (pass != PASS_DEPTH) {
+                batch.textures = mesh.textures;
+            }
+            data.batches.push_back(std::move(batch));
+        }
+        else {
+            batchIndex = found->second;
+        }
+
+        Batch& batch = data.batches[batchIndex];
+        DrawParams meshParams = params;
+        meshParams.positionScale = glm::vec4(mesh.positionScale, 0.0f);
+        meshParams.positionOffset = glm::vec4(mesh.positionOffset, 0.0f);
+        data.stats.meshes++;
+
+        // Culled clusters differ per mesh and cannot be instanced
+        if (cullClusters && mesh.currentLod == 0) {
+            uint32_t baseInstance = static_cast<uint32_t>(data.params.size());
+            if (MeshClusterCuller::appendVisible(mesh, baseInstance, batch.clusterCommands)) {
+                data.params.push_back(meshParams);
+                return;
+            }
+        }
+
+        auto groupKey = std::make_pair(mesh.gpu.get(), mesh.currentLod);
+        auto group = batch.groupIndex.find(groupKey);
+        if (group == batch.groupIndex.end()) {
+            group = batch.groupIndex.emplace(groupKey, batch.groups.size()).first;
+            batch.groups.push_back({ static_cast<uint32_t>(mesh.getLodIndexCount(mesh.currentLod)), mesh.getFirstIndex(mesh.currentLod),
+                                     static_cast<int32_t>(mesh.gpu->firstVertex), {} });
+        }
+        batch.groups[group->second].instances.push_back(meshParams);
+    }
+
+    void MeshBatchRenderer::upload(PassData& pass) {
+        if (pass.paramsBuffer == 0) {
+            glGenBuffers(1, &pass.paramsBuffer);
+            glGenBuffers(1, &pass.commandBuffer);
+        }
+
+        // The batches' commands back to back, each batch draws its own slice. The instances of a
+        // group follow the culled meshes' parameters, gl_InstanceID walks through them.
+        std::vector<DrawElementsIndirectCommand> commands;
+        for (Batch& batch : pass.batches) {
+            batch.firstCommand = commands.size();
+            commands.insert(commands.end(), batch.clusterCommands.begin(), batch.clusterCommands.end());
+            for (const InstanceGroup& group : batch.groups) {
+                uint32_t baseInstance = static_cast<uint32_t>(pass.params.size());
+                pass.params.insert(pass.params.end(), group.instances.begin(), group.instances.end());
+                commands.push_back({ group.count, static_cast<uint32_t>(group.instances.size()), group.firstIndex, group.baseVertex, baseInstance });
+            }
+            batch.commandCount = static_cast<uint32_t>(commands.size() - batch.firstCommand);
+        }
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, pass.paramsBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, pass.params.size() * sizeof(DrawParams), pass.params.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, pass.commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+        pass.stats.batches = static_cast<uint32_t>(pass.batches.size());
+        pass.stats.commands = static_cast<uint32_t>(commands.size());
+        pass.uploaded = true;
+    }
+
+    void MeshBatchRenderer::draw(Pass pass, Shader& shader) {
+        PassData& data = s_passes[pass];
+        if (data.stats.meshes == 0) return;
+
+        // Uploaded with the first eye and replayed for the second
+        if (!data.uploaded) {
+            upload(data);
+        }
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_PARAMS_BINDING, data.paramsBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, data.commandBuffer);
+        shader.setBool("useMeshDrawBuffer", true);
+        for (const Batch& batch : data.batches) {
+            if (batch.commandCount == 0) continue;
+            if (pass != PASS_DEPTH) {
+                Mesh::bindTextures(shader, batch.textures);
+            }
+            glBindVertexArray(MeshGpuArena::getVertexArray(batch.format));
+            glMultiDrawElementsIndirect(GL_TRIANGLES, batch.indexType,
+                                        reinterpret_cast<const void*>(batch.firstCommand * sizeof(DrawElementsIndirectCommand)),
+                                        static_cast<GLsizei>(batch.commandCount), 0);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        shader.setBool("useMeshDrawBuffer", false);
+    }
+
+    void MeshBatchRenderer::releaseGpuResources() {
+        for (PassData& pass : s_passes) {
+            if (pass.paramsBuffer != 0) {
+                glDeleteBuffers(1, &pass.paramsBuffer);
+                glDeleteBuffers(1, &pass.commandBuffer);
+            }
+            pass = PassData();
+        }
+    }
+
+}
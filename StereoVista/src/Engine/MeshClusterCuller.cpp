@@ -0,0 +1,235 @@
+#include "Engine/MeshClusterCuller.h"
+#include "Engine/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MESH_CULL_SSE
+#endif
+
+namespace Engine {
+
+    std::vector<DrawElementsIndirectCommand> MeshClusterCuller::s_frameCommands;
+    uint32_t MeshClusterCuller::s_frame = 0;
+    bool MeshClusterCuller::s_frameBackfaceCulling = false;
+    bool MeshClusterCuller::s_enabled = true;
+    MeshClusterCuller::Stats MeshClusterCuller::s_stats;
+
+    // The six planes of a view-projection matrix in the space it is applied to, normalized so
+    // that distances are in that space's units. Points inside have dot(plane, p) >= 0.
+    static void extractFrustumPlanes(const glm::mat4& m, glm::vec4 planes[6]) {
+        glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+        planes[0] = row3 + row0;  // Left
+        planes[1] = row3 - row0;  // Right
+        planes[2] = row3 + row1;  // Bottom
+        planes[3] = row3 - row1;  // Top
+        planes[4] = row3 + row2;  // Near
+        planes[5] = row3 - row2;  // Far
+        for (int i = 0; i < 6; i++) {
+            float length = glm::length(glm::vec3(planes[i]));
+            if (length > 0.0f) {
+                planes[i] /= length;
+            }
+        }
+    }
+
+    void MeshClusterCuller::cullModels(std::vector<Model>& models, const glm::mat4& leftViewProjection, const glm::mat4& rightViewProjection,
+                                       const glm::vec3& leftEye, const glm::vec3& rightEye, bool backfaceCulling) {
+        // Results of earlier frames go stale with the frame number
+        s_frame++;
+        s_frameBackfaceCulling = backfaceCulling;
+        s_frameCommands.clear();
+        s_stats = Stats();
+        if (!s_enabled) return;
+
+        std::vector<CullTask> tasks;
+        for (auto& model : models) {
+            if (!model.visible || model.placeholder) continue;
+            glm::mat4 modelMatrix = glm::mat4(1.0f);
+            modelMatrix = glm::translate(modelMatrix, model.position);
+            modelMatrix = glm::rotate(modelMatrix, glm::radians(model.rotation.x), glm::vec3(1, 0, 0));
+            modelMatrix = glm::rotate(modelMatrix, glm::radians(model.rotation.y), glm::vec3(0, 1, 0));
+            modelMatrix = glm::rotate(modelMatrix, glm::radians(model.rotation.z), glm::vec3(0, 0, 1));
+            modelMatrix = glm::scale(modelMatrix, model.scale);
+
+            // Normal cones only keep their angles under uniform scale, and a mirroring scale flips
+            // which side is culled; such models are frustum culled only
+            const glm::vec3& scale = model.scale;
+            float largestScale = std::max(std::abs(scale.x), std::max(std::abs(scale.y), std::abs(scale.z)));
+            bool uniformScale = scale.x > 0.0f && scale.y > 0.0f && scale.z > 0.0f &&
+                std::max(scale.x, std::max(scale.y, scale.z)) - std::min(scale.x, std::min(scale.y, scale.z)) <= largestScale * 1e-4f;
+            bool coneCulling = backfaceCulling && uniformScale;
+
+            for (auto& mesh : model.getMeshes()) {
+                // Coarser levels are small enough to draw whole
+                if (!mesh.visible || mesh.meshlets.empty() || mesh.currentLod != 0) continue;
+
+                uint32_t meshletCount = static_cast<uint32_t>(mesh.meshlets.size());
+                s_stats.meshes++;
+                s_stats.clusters += meshletCount;
+                for (uint32_t first = 0; first < meshletCount; first += CLUSTERS_PER_TASK) {
+                    tasks.push_back({ &mesh, modelMatrix, first, std::min(CLUSTERS_PER_TASK, meshletCount - first), coneCulling });
+                }
+            }
+        }
+
+        std::vector<std::vector<DrawElementsIndirectCommand>> taskCommands(tasks.size());
+        std::vector<uint32_t> taskVisible(tasks.size(), 0);
+        JobSystem::parallelFor(tasks.size(), [&](size_t i) {
+            cullRange(tasks[i], leftViewProjection, rightViewProjection, leftEye, rightEye, taskCommands[i], taskVisible[i]);
+        });
+
+        // The tasks of a mesh are consecutive, their commands form the mesh's range
+        Mesh* current = nullptr;
+        for (size_t i = 0; i < tasks.size(); i++) {
+            Mesh& mesh = *tasks[i].mesh;
+            if (&mesh != current) {
+                current = &mesh;
+                mesh.clusterFrame = s_frame;
+                mesh.clusterFirstCommand = static_cast<uint32_t>(s_frameCommands.size());
+                mesh.clusterCommandCount = 0;
+            }
+            s_frameCommands.insert(s_frameCommands.end(), taskCommands[i].begin(), taskCommands[i].end());
+            mesh.clusterCommandCount += static_cast<uint32_t>(taskCommands[i].size());
+            s_stats.visibleClusters += taskVisible[i];
+        }
+        s_stats.commands = static_cast<uint32_t>(s_frameCommands.size());
+    }
+
+    void MeshClusterCuller::cullRange(const CullTask& task, const glm::mat4& leftViewProjection, const glm::mat4& rightViewProjection,
+                                      const glm::vec3& leftEye, const glm::vec3& rightEye,
+                                      std::vector<DrawElementsIndirectCommand>& commands, uint32_t& visibleClusters) {
+        const Mesh& mesh = *task.mesh;
+        const MeshletBounds& bounds = mesh.meshletBounds;
+        const bool backfaceCulling = task.coneCulling;
+
+        // Everything in object space: the planes of both eye frusta and the eye positions. Cones
+        // are only tested under uniform scale, which keeps their angles, so they stay as built.
+        glm::vec4 planes[12];
+        extractFrustumPlanes(leftViewProjection * task.modelMatrix, planes);
+        extractFrustumPlanes(rightViewProjection * task.modelMatrix, planes + 6);
+        glm::mat4 inverseModel = glm::inverse(task.modelMatrix);
+        glm::vec3 eyes[2] = {
+            glm::vec3(inverseModel * glm::vec4(leftEye, 1.0f)),
+            glm::vec3(inverseModel * glm::vec4(rightEye, 1.0f))
+        };
+
+        // Neighbouring visible meshlets are contiguous in the index buffer and share a command
+        auto emit = [&](uint32_t m) {
+            const Meshlet& meshlet = mesh.meshlets[m];
+            visibleClusters++;
+            if (!commands.empty() && commands.back().firstIndex + commands.back().count == meshlet.indexOffset) {
+                commands.back().count += meshlet.indexCount;
+            }
+            else {
+                commands.push_back({ meshlet.indexCount, 1, meshlet.indexOffset, 0, 0 });
+            }
+        };
+
+        const uint32_t end = task.first + task.count;
+        uint32_t m = task.first;
+#ifdef MESH_CULL_SSE
+        // Four meshlets per step; task.first is a multiple of four and the bounds are padded
+        const __m128 allSet = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (; m < end; m += 4) {
+            __m128 cx = _mm_loadu_ps(&bounds.centerX[m]);
+            __m128 cy = _mm_loadu_ps(&bounds.centerY[m]);
+            __m128 cz = _mm_loadu_ps(&bounds.centerZ[m]);
+            __m128 r = _mm_loadu_ps(&bounds.radius[m]);
+            __m128 negR = _mm_sub_ps(_mm_setzero_ps(), r);
+
+            // In the union of the two frusta: inside all six planes of either eye
+            __m128 visible = _mm_setzero_ps();
+            for (int eye = 0; eye < 2; eye++) {
+                __m128 inside = allSet;
+                for (int p = 0; p < 6; p++) {
+                    const glm::vec4& plane = planes[eye * 6 + p];
+                    __m128 d = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_mul_ps(cy, _mm_set1_ps(plane.y))),
+                        _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negR));
+                }
+                visible = _mm_or_ps(visible, inside);
+            }
+
+            // Back-facing for both eyes
+            if (backfaceCulling) {
+                __m128 ax = _mm_loadu_ps(&bounds.axisX[m]);
+                __m128 ay = _mm_loadu_ps(&bounds.axisY[m]);
+                __m128 az = _mm_loadu_ps(&bounds.axisZ[m]);
+                __m128 cutoff = _mm_loadu_ps(&bounds.cutoff[m]);
+                __m128 backFacing = allSet;
+                for (int eye = 0; eye < 2; eye++) {
+                    __m128 dx = _mm_sub_ps(cx, _mm_set1_ps(eyes[eye].x));
+                    __m128 dy = _mm_sub_ps(cy, _mm_set1_ps(eyes[eye].y));
+                    __m128 dz = _mm_sub_ps(cz, _mm_set1_ps(eyes[eye].z));
+                    __m128 along = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, ax), _mm_mul_ps(dy, ay)), _mm_mul_ps(dz, az));
+                    __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+                    backFacing = _mm_and_ps(backFacing, _mm_cmpge_ps(along, _mm_add_ps(_mm_mul_ps(cutoff, distance), r)));
+                }
+                visible = _mm_andnot_ps(backFacing, visible);
+            }
+
+            int mask = _mm_movemask_ps(visible);
+            for (uint32_t lane = 0; lane < 4 && m + lane < end; lane++) {
+                if (mask & (1 << lane)) {
+                    emit(m + lane);
+                }
+            }
+        }
+#endif
+        for (; m < end; m++) {
+            glm::vec3 center(bounds.centerX[m], bounds.centerY[m], bounds.centerZ[m]);
+            float r = bounds.radius[m];
+
+            bool visible = false;
+            for (int eye = 0; eye < 2 && !visible; eye++) {
+                bool inside = true;
+                for (int p = 0; p < 6 && inside; p++) {
+                    const glm::vec4& plane = planes[eye * 6 + p];
+                    inside = glm::dot(glm::vec3(plane), center) + plane.w >= -r;
+                }
+                visible = inside;
+            }
+
+            if (visible && backfaceCulling) {
+                glm::vec3 axis(bounds.axisX[m], bounds.axisY[m], bounds.axisZ[m]);
+                bool backFacing = true;
+                for (int eye = 0; eye < 2 && backFacing; eye++) {
+                    glm::vec3 offset = center - eyes[eye];
+                    backFacing = glm::dot(offset, axis) >= bounds.cutoff[m] * glm::length(offset) + r;
+                }
+                visible = !backFacing;
+            }
+
+            if (visible) {
+                emit(m);
+            }
+        }
+    }
+
+    bool MeshClusterCuller::appendVisible(const Mesh& mesh, uint32_t baseInstance, std::vector<DrawElementsIndirectCommand>& commands) {
+        if (!s_enabled || mesh.clusterFrame != s_frame) {
+            return false;
+        }
+        // Cones were tested for a pass with back faces culled; a pass that shows them needs the rest
+        if (s_frameBackfaceCulling && !glIsEnabled(GL_CULL_FACE)) {
+            return false;
+        }
+
+        uint32_t firstIndex = mesh.getFirstIndex(0);
+        for (uint32_t i = 0; i < mesh.clusterCommandCount; i++) {
+            DrawElementsIndirectCommand command = s_frameCommands[mesh.clusterFirstCommand + i];
+            command.firstIndex += firstIndex;
+            command.baseVertex = static_cast<int32_t>(mesh.gpu->firstVertex);
+            command.baseInstance = baseInstance;
+            commands.push_back(command);
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,96 @@
+#include "Engine/MeshGeometryRegistry.h"
+#include <cstring>
+
+namespace Engine {
+
+    std::unordered_map<MeshGeometryRegistry::Key, MeshGeometryRegistry::Entry, MeshGeometryRegistry::KeyHash> MeshGeometryRegistry::s_entries;
+
+    static uint64_t mixGeometryHash(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // Two independent multiply-rotate lanes; a shared copy is never compared against the data,
+    // so one 64-bit hash alone would be too thin
+    static void hashGeometryWord(uint64_t word, uint64_t hash[2]) {
+        hash[0] ^= word * 0x87c37b91114253d5ULL;
+        hash[0] = ((hash[0] << 27) | (hash[0] >> 37)) * 0x9E3779B97F4A7C15ULL + 0x52dce729ULL;
+        hash[1] ^= word * 0x4cf5ad432745937fULL;
+        hash[1] = ((hash[1] << 31) | (hash[1] >> 33)) * 0xC2B2AE3D27D4EB4FULL + 0x38495ab5ULL;
+    }
+
+    static void hashGeometryBytes(const void* data, uint64_t size, uint64_t hash[2]) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        uint64_t words = size / 8;
+        for (uint64_t i = 0; i < words; i++) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i * 8, 8);
+            hashGeometryWord(word, hash);
+        }
+        if (size % 8 != 0) {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes + words * 8, size % 8);
+            hashGeometryWord(word, hash);
+        }
+    }
+
+    MeshGeometryRegistry::Key MeshGeometryRegistry::computeKey(MeshVertexFormat format, const void* vertices, uint64_t vertexBytes,
+                                                               const void* indices, uint64_t indexBytes) {
+        uint64_t hash[2] = { 0x9E3779B97F4A7C15ULL, 0x2545F4914F6CDD1DULL };
+        hashGeometryBytes(vertices, vertexBytes, hash);
+        // Sizes split the stream: the same bytes cut differently into vertices and indices differ
+        uint64_t sizes = mixGeometryHash(vertexBytes ^ (indexBytes << 24) ^ (static_cast<uint64_t>(format) << 60));
+        hash[0] ^= sizes;
+        hash[1] ^= sizes * 0x9E3779B97F4A7C15ULL;
+        hashGeometryBytes(indices, indexBytes, hash);
+
+        Key key;
+        key.hash[0] = mixGeometryHash(hash[0]);
+        key.hash[1] = mixGeometryHash(hash[1]);
+        return key;
+    }
+
+    std::shared_ptr<const MeshGpuAllocation> MeshGeometryRegistry::acquire(MeshVertexFormat format, const void* vertices, uint32_t vertexCount,
+                                                                           const void* indices, uint64_t indexBytes) {
+        uint64_t vertexBytes = static_cast<uint64_t>(vertexCount) * MeshGpuArena::getVertexSize(format);
+        Key key = computeKey(format, vertices, vertexBytes, indices, indexBytes);
+
+        auto found = s_entries.find(key);
+        if (found != s_entries.end()) {
+            if (std::shared_ptr<const MeshGpuAllocation> resident = found->second.allocation.lock()) {
+                return resident;
+            }
+        }
+
+        MeshGpuAllocation allocation = MeshGpuArena::allocate(format, vertexCount, indexBytes);
+        MeshGpuArena::uploadVertices(allocation, vertices);
+        MeshGpuArena::uploadIndices(allocation, indices);
+
+        // The last mesh to let go gives the range back and removes the entry
+        std::shared_ptr<const MeshGpuAllocation> resident(new MeshGpuAllocation(std::move(allocation)), [key](const MeshGpuAllocation* released) {
+            s_entries.erase(key);
+            delete released;
+        });
+        Entry& entry = s_entries[key];
+        entry.allocation = resident;
+        entry.bytes = vertexBytes + indexBytes;
+        return resident;
+    }
+
+    MeshGeometryRegistry::Stats MeshGeometryRegistry::getStats() {
+        Stats stats;
+        for (const auto& [key, entry] : s_entries) {
+            long users = entry.allocation.use_count();
+            if (users == 0) continue;
+            stats.geometries++;
+            stats.meshes += static_cast<uint32_t>(users);
+            stats.savedBytes += static_cast<size_t>(users - 1) * entry.bytes;
+        }
+        return stats;
+    }
+
+}
@@ -0,0 +1,280 @@
+#include "Engine/MeshGpuArena.h"
+#include "Loaders/ModelLoader.h"
+#include <algorithm>
+#include <iostream>
+
+namespace Engine {
+
+    MeshGpuArena::VertexPool MeshGpuArena::s_vertexPools[MeshGpuArena::FORMAT_COUNT];
+    GLuint MeshGpuArena::s_indexBuffer = 0;
+    MeshGpuArena::RangeList MeshGpuArena::s_indexWords;
+
+    // ---- MeshGpuAllocation ----
+
+    MeshGpuAllocation::~MeshGpuAllocation() {
+        MeshGpuArena::release(*this);
+    }
+
+    MeshGpuAllocation::MeshGpuAllocation(MeshGpuAllocation&& other) noexcept
+        : format(other.format), firstVertex(other.firstVertex), vertexCount(other.vertexCount),
+        indexByteOffset(other.indexByteOffset), indexBytes(other.indexBytes) {
+        other.vertexCount = 0;
+        other.indexBytes = 0;
+    }
+
+    MeshGpuAllocation& MeshGpuAllocation::operator=(MeshGpuAllocation&& other) noexcept {
+        if (this != &other) {
+            MeshGpuArena::release(*this);
+            format = other.format;
+            firstVertex = other.firstVertex;
+            vertexCount = other.vertexCount;
+            indexByteOffset = other.indexByteOffset;
+            indexBytes = other.indexBytes;
+            other.vertexCount = 0;
+            other.indexBytes = 0;
+        }
+        return *this;
+    }
+
+    // ---- Range lists ----
+
+    bool MeshGpuArena::RangeList::allocate(uint64_t count, uint64_t& first) {
+        for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+            if (it->second < count) continue;
+
+            first = it->first;
+            uint64_t remaining = it->second - count;
+            freeRanges.erase(it);
+            if (remaining > 0) {
+                freeRanges[first + count] = remaining;
+            }
+            used += count;
+            return true;
+        }
+        return false;
+    }
+
+    void MeshGpuArena::RangeList::release(uint64_t first, uint64_t count) {
+        used -= count;
+
+        // Merge with the free neighbours on both sides
+        auto next = freeRanges.lower_bound(first);
+        if (next != freeRanges.end() && first + count == next->first) {
+            count += next->second;
+            next = freeRanges.erase(next);
+        }
+        if (next != freeRanges.begin()) {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == first) {
+                first = previous->first;
+                count += previous->second;
+                freeRanges.erase(previous);
+            }
+        }
+        freeRanges[first] = count;
+    }
+
+    void MeshGpuArena::RangeList::grow(uint64_t newCapacity) {
+        uint64_t oldCapacity = capacity;
+        capacity = newCapacity;
+        used += newCapacity - oldCapacity;
+        release(oldCapacity, newCapacity - oldCapacity);
+    }
+
+    // ---- Arena ----
+
+    uint32_t MeshGpuArena::getVertexSize(MeshVertexFormat format) {
+        return format == MeshVertexFormat::Quantized ? sizeof(QuantizedVertex) : sizeof(PackedVertex);
+    }
+
+    MeshGpuAllocation MeshGpuArena::allocate(MeshVertexFormat format, uint32_t vertexCount, uint64_t indexBytes) {
+        MeshGpuAllocation allocation;
+        if (vertexCount == 0) {
+            return allocation;
+        }
+
+        // Indices first: the VAOs set up for new vertex buffers bind the index buffer
+        uint64_t indexWords = (indexBytes + 3) / 4;
+        uint64_t firstWord = 0;
+        if (indexWords > 0 && !s_indexWords.allocate(indexWords, firstWord)) {
+            reserveIndexWords(indexWords);
+            s_indexWords.allocate(indexWords, firstWord);
+        }
+
+        RangeList& vertexRanges = s_vertexPools[static_cast<uint32_t>(format)].ranges;
+        uint64_t firstVertex = 0;
+        if (!vertexRanges.allocate(vertexCount, firstVertex)) {
+            reserveVertices(format, vertexCount);
+            vertexRanges.allocate(vertexCount, firstVertex);
+        }
+
+        allocation.format = format;
+        allocation.firstVertex = static_cast<uint32_t>(firstVertex);
+        allocation.vertexCount = vertexCount;
+        allocation.indexByteOffset = firstWord * 4;
+        allocation.indexBytes = indexBytes;
+        return allocation;
+    }
+
+    void MeshGpuArena::release(MeshGpuAllocation& allocation) {
+        if (!allocation.valid()) {
+            return;
+        }
+        VertexPool& pool = s_vertexPools[static_cast<uint32_t>(allocation.format)];
+        if (pool.buffer != 0) {
+            pool.ranges.release(allocation.firstVertex, allocation.vertexCount);
+            if (allocation.indexBytes > 0) {
+                s_indexWords.release(allocation.indexByteOffset / 4, (allocation.indexBytes + 3) / 4);
+            }
+        }
+        // Otherwise the arena was shut down before the owner released its mesh
+        allocation.vertexCount = 0;
+        allocation.indexBytes = 0;
+    }
+
+    void MeshGpuArena::uploadVertices(const MeshGpuAllocation& allocation, const void* vertices) {
+        if (!allocation.valid()) {
+            return;
+        }
+        uint32_t vertexSize = getVertexSize(allocation.format);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, s_vertexPools[static_cast<uint32_t>(allocation.format)].buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(allocation.firstVertex) * vertexSize,
+                        static_cast<GLsizeiptr>(allocation.vertexCount) * vertexSize, vertices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    void MeshGpuArena::uploadIndices(const MeshGpuAllocation& allocation, const void* indices) {
+        if (!allocation.valid() || allocation.indexBytes == 0) {
+            return;
+        }
+        // Not through GL_ELEMENT_ARRAY_BUFFER, which would change whatever VAO is bound
+        glBindBuffer(GL_COPY_WRITE_BUFFER, s_indexBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(allocation.indexByteOffset),
+                        static_cast<GLsizeiptr>(allocation.indexBytes), indices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    GLuint MeshGpuArena::getVertexArray(MeshVertexFormat format) {
+        return s_vertexPools[static_cast<uint32_t>(format)].vertexArray;
+    }
+
+    GLuint MeshGpuArena::growBuffer(GLuint buffer, uint64_t oldBytes, uint64_t newBytes) {
+        GLuint grown = 0;
+        glGenBuffers(1, &grown);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(newBytes), nullptr, GL_STATIC_DRAW);
+        if (buffer != 0) {
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(oldBytes));
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            glDeleteBuffers(1, &buffer);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return grown;
+    }
+
+    void MeshGpuArena::reserveVertices(MeshVertexFormat format, uint64_t vertexCount) {
+        VertexPool& pool = s_vertexPools[static_cast<uint32_t>(format)];
+        uint64_t capacity = std::max({ pool.ranges.capacity * 2, pool.ranges.capacity + vertexCount, INITIAL_VERTICES });
+        uint32_t vertexSize = getVertexSize(format);
+        pool.buffer = growBuffer(pool.buffer, pool.ranges.capacity * vertexSize, capacity * vertexSize);
+        pool.ranges.grow(capacity);
+        setupVertexArray(format);
+
+        std::cout << "Mesh GPU arena: " << (format == MeshVertexFormat::Quantized ? "quantized" : "packed")
+                  << " vertex buffer grown to " << (capacity * vertexSize / (1024 * 1024)) << " MB" << std::endl;
+    }
+
+    void MeshGpuArena::reserveIndexWords(uint64_t wordCount) {
+        uint64_t capacity = std::max({ s_indexWords.capacity * 2, s_indexWords.capacity + wordCount, INITIAL_INDEX_BYTES / 4 });
+        s_indexBuffer = growBuffer(s_indexBuffer, s_indexWords.capacity * 4, capacity * 4);
+        s_indexWords.grow(capacity);
+
+        // The VAOs still point at the old buffer
+        for (uint32_t f = 0; f < FORMAT_COUNT; f++) {
+            if (s_vertexPools[f].vertexArray != 0) {
+                glBindVertexArray(s_vertexPools[f].vertexArray);
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_indexBuffer);
+            }
+        }
+        glBindVertexArray(0);
+
+        std::cout << "Mesh GPU arena: index buffer grown to " << (capacity * 4 / (1024 * 1024)) << " MB" << std::endl;
+    }
+
+    void MeshGpuArena::setupVertexArray(MeshVertexFormat format) {
+        VertexPool& pool = s_vertexPools[static_cast<uint32_t>(format)];
+        if (pool.vertexArray == 0) {
+            glGenVertexArrays(1, &pool.vertexArray);
+        }
+        glBindVertexArray(pool.vertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, pool.buffer);
+
+        GLsizei stride;
+        size_t attributeOffset;
+        if (format == MeshVertexFormat::Quantized) {
+            // Vertex positions, normalized to [0, 1] and decoded with the mesh's scale and offset
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(QuantizedVertex), (void*)0);
+            stride = sizeof(QuantizedVertex);
+            attributeOffset = offsetof(QuantizedVertex, normal);
+        }
+        else {
+            // Vertex positions
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)0);
+            stride = sizeof(PackedVertex);
+            attributeOffset = offsetof(PackedVertex, normal);
+        }
+
+        // Normal, tangent and texture coordinates follow the position in both layouts
+        static_assert(offsetof(PackedVertex, tangent) - offsetof(PackedVertex, normal) == offsetof(QuantizedVertex, tangent) - offsetof(QuantizedVertex, normal), "packed layouts differ");
+        static_assert(offsetof(PackedVertex, texCoords) - offsetof(PackedVertex, normal) == offsetof(QuantizedVertex, texCoords) - offsetof(QuantizedVertex, normal), "packed layouts differ");
+
+        // Vertex normals
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)attributeOffset);
+
+        // Vertex texture coords
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)(attributeOffset + 8));
+
+        // Vertex tangent, handedness in w
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)(attributeOffset + 4));
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_indexBuffer);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    size_t MeshGpuArena::getReservedBytes() {
+        size_t bytes = s_indexWords.capacity * 4;
+        for (uint32_t f = 0; f < FORMAT_COUNT; f++) {
+            bytes += s_vertexPools[f].ranges.capacity * getVertexSize(static_cast<MeshVertexFormat>(f));
+        }
+        return bytes;
+    }
+
+    size_t MeshGpuArena::getAllocatedBytes() {
+        size_t bytes = s_indexWords.used * 4;
+        for (uint32_t f = 0; f < FORMAT_COUNT; f++) {
+            bytes += s_vertexPools[f].ranges.used * getVertexSize(static_cast<MeshVertexFormat>(f));
+        }
+        return bytes;
+    }
+
+    void MeshGpuArena::shutdown() {
+        for (VertexPool& pool : s_vertexPools) {
+            if (pool.vertexArray != 0) glDeleteVertexArrays(1, &pool.vertexArray);
+            if (pool.buffer != 0) glDeleteBuffers(1, &pool.buffer);
+            pool = VertexPool();
+        }
+        if (s_indexBuffer != 0) {
+            glDeleteBuffers(1, &s_indexBuffer);
+            s_indexBuffer = 0;
+        }
+        s_indexWords = RangeList();
+    }
+
+}
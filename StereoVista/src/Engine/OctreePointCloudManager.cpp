@@ -1,19 +1,50 @@
 #include "../../headers/Engine/OctreePointCloudManager.h"
+#include "../../headers/Engine/PointCloudResidencyManager.h"
+#include "../../headers/Engine/PointCloudCodec.h"
+#include "../../headers/Engine/PointCloudGpuArena.h"
+#include "../../headers/Engine/JobSystem.h"
+#include <json.h>
 #include <iostream>
+#include <iomanip>
+#include <fstream>
 #include <algorithm>
 #include <random>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <functional>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCTREE_QUERY_SSE
+#endif
+
+using json = nlohmann::json;
 
 namespace Engine {
 
+    // The SSE query kernels load position.xyz + intensity of a point as one 16 byte vector
+    static_assert(offsetof(PointCloudPoint, intensity) == 3 * sizeof(float), "PointCloudPoint layout changed");
+
     // Static member definitions for async loading system
     std::vector<std::thread> OctreePointCloudManager::s_workerThreads;
     std::queue<OctreePointCloudManager::LoadingTask> OctreePointCloudManager::s_loadingQueue;
+    std::queue<OctreePointCloudManager::LoadingTask> OctreePointCloudManager::s_prefetchQueue;
     std::mutex OctreePointCloudManager::s_queueMutex;
     std::condition_variable OctreePointCloudManager::s_queueCondition;
     std::atomic<bool> OctreePointCloudManager::s_shutdownRequested{false};
-    std::vector<std::future<bool>> OctreePointCloudManager::s_completedTasks;
-    std::mutex OctreePointCloudManager::s_completedMutex;
     std::mutex OctreePointCloudManager::s_hdf5Mutex;
+    std::list<OctreePointCloudManager::CachedPage> OctreePointCloudManager::s_pageCache;
+    std::map<OctreePointCloudManager::PageKey, std::list<OctreePointCloudManager::CachedPage>::iterator> OctreePointCloudManager::s_pageCacheIndex;
+    std::mutex OctreePointCloudManager::s_pageCacheMutex;
+    size_t OctreePointCloudManager::s_pageCacheBytes = 0;
+    std::vector<OctreePointCloudManager::PendingDraw> OctreePointCloudManager::s_pendingDraws;
+    GLuint OctreePointCloudManager::s_indirectBuffer = 0;
+    GLuint OctreePointCloudManager::s_nodeDrawBuffer = 0;
+    std::vector<OctreePointCloudManager::DrawArraysIndirectCommand> OctreePointCloudManager::s_frameCommands;
+    std::vector<OctreePointCloudManager::NodeDrawParams> OctreePointCloudManager::s_frameNodeDraws;
+    uint32_t OctreePointCloudManager::s_frameDrawsFrame = 0;
+    bool OctreePointCloudManager::s_frameDrawsUploaded = false;
 
     void OctreePointCloudManager::initializeAsyncSystem() {
         s_shutdownRequested = false;
@@ -44,372 +75,1101 @@ namespace Engine {
             
             {
                 std::unique_lock<std::mutex> lock(s_queueMutex);
-                s_queueCondition.wait(lock, [] { return !s_loadingQueue.empty() || s_shutdownRequested; });
+                s_queueCondition.wait(lock, [] { return !s_loadingQueue.empty() || !s_prefetchQueue.empty() || s_shutdownRequested; });
                 
                 if (s_shutdownRequested && s_loadingQueue.empty()) {
                     break;
                 }
                 
+                // Nodes needed for the current frame always go before prefetches
                 if (!s_loadingQueue.empty()) {
                     task = std::move(s_loadingQueue.front());
                     s_loadingQueue.pop();
                     hasTask = true;
+                } else if (!s_prefetchQueue.empty()) {
+                    task = std::move(s_prefetchQueue.front());
+                    s_prefetchQueue.pop();
+                    hasTask = true;
                 }
             }
             
-            if (hasTask && task.node) {
-                try {
-                    // Perform the actual disk loading
-                    loadNodeFromHDF5(task.node, task.node->diskFilePath);
-                    task.node->isLoaded = true;
-                    task.node->memoryUsage = task.node->points.size() * sizeof(PointCloudPoint);
-                    markNodeAccessed(task.node);
-                    
-                    task.promise.set_value(true);
-                } catch (const std::exception& e) {
-                    task.promise.set_value(false);
-                }
+            if (hasTask && task.inbox) {
+                // Load into a task-local buffer; the render thread adopts it in processCompletedLoads
+                std::vector<PointCloudPoint> points;
+                loadNodeFromHDF5(task.filePath, points);
+
+                std::lock_guard<std::mutex> lock(task.inbox->mutex);
+                task.inbox->completed.emplace_back(task.nodeIndex, std::move(points));
             }
         }
     }
 
-    void OctreePointCloudManager::requestAsyncLoad(PointCloudOctreeNode* node, const std::string& cacheDirectory) {
-        if (!node || !node->isOnDisk || node->isLoaded || s_workerThreads.empty()) {
+    void OctreePointCloudManager::requestAsyncLoad(PointCloud& pointCloud, uint32_t nodeIndex, bool prefetch) {
+        PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        if (nodeIndex >= nodes.size() || s_workerThreads.empty()) {
             return;
         }
-        
-        if (node->diskFilePath.empty() || !std::filesystem::exists(node->diskFilePath)) {
+
+        if (!nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_ON_DISK) ||
+            nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_LOADED | PointCloudNodePool::NODE_LOAD_PENDING)) {
+            return;
+        }
+
+        // A recently dropped CPU copy can be adopted right away
+        if (auto cached = findCachedPage(nodes, nodeIndex)) {
+            nodes.setPoints(nodeIndex, std::move(cached));
+            nodes.touch(nodeIndex);
             return;
         }
         
         OctreePointCloudManager::LoadingTask task;
-        task.node = node;
-        task.cacheDirectory = cacheDirectory;
-        
-        auto future = task.promise.get_future();
+        task.inbox = nodes.loadInbox;
+        task.nodeIndex = nodeIndex;
+        task.filePath = getNodeFilePath(pointCloud.chunkCache.cacheDirectory, nodeIndex);
         
         {
             std::lock_guard<std::mutex> lock(s_queueMutex);
-            s_loadingQueue.push(std::move(task));
+            if (prefetch) {
+                // Drop prefetches rather than letting a fast camera build up a backlog
+                if (s_prefetchQueue.size() >= MAX_PREFETCH_QUEUE) {
+                    return;
+                }
+                s_prefetchQueue.push(std::move(task));
+            } else {
+                s_loadingQueue.push(std::move(task));
+            }
         }
         
-        {
-            std::lock_guard<std::mutex> lock(s_completedMutex);
-            s_completedTasks.push_back(std::move(future));
+        nodes.setFlag(nodeIndex, PointCloudNodePool::NODE_LOAD_PENDING);
+        if (prefetch) {
+            nodes.setFlag(nodeIndex, PointCloudNodePool::NODE_PREFETCHED);
+            nodes.prefetchRequests++;
+        } else {
+            nodes.demandLoads++;
         }
-        
         s_queueCondition.notify_one();
     }
 
-    void OctreePointCloudManager::processCompletedLoads() {
-        // Check if async system is initialized
-        if (s_workerThreads.empty()) {
+    void OctreePointCloudManager::prefetchAlongPath(PointCloud& pointCloud, const std::vector<glm::vec3>& predictedCameraPositions) {
+        if (!pointCloud.hasOctree() || !pointCloud.enablePrefetch) {
             return;
         }
-        
-        std::lock_guard<std::mutex> lock(s_completedMutex);
-        
-        auto it = s_completedTasks.begin();
-        while (it != s_completedTasks.end()) {
-            if (it->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-                bool success = it->get();
-                it = s_completedTasks.erase(it);
-            } else {
-                ++it;
+
+        const std::vector<PointCloudClipVolume>* clipVolumes = pointCloud.clipVolumes.empty() ? nullptr : &pointCloud.clipVolumes;
+        for (const auto& position : predictedCameraPositions) {
+            prefetchNodeRecursive(pointCloud, 0, position, pointCloud.lodDistances, pointCloud.lodMultiplier, clipVolumes);
+        }
+    }
+
+    float OctreePointCloudManager::getPrefetchHitRate(const PointCloud& pointCloud) {
+        const PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        uint32_t demanded = nodes.prefetchHits + nodes.prefetchLate + nodes.demandLoads;
+        return demanded > 0 ? static_cast<float>(nodes.prefetchHits) / demanded : 0.0f;
+    }
+
+    void OctreePointCloudManager::prefetchNodeRecursive(
+        PointCloud& pointCloud,
+        uint32_t nodeIndex,
+        const glm::vec3& cameraPosition,
+        const float lodDistances[5],
+        float lodMultiplier,
+        const std::vector<PointCloudClipVolume>* clipVolumes
+    ) {
+        PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        if (nodeIndex >= nodes.size()) return;
+
+        // Same selection as selectRequiredNodes, evaluated at the predicted position
+        if (!narrowClipVolumes(clipVolumes, nodes, nodeIndex)) {
+            return;
+        }
+        float adjustedDistance = calculateNodeDistance(nodes, nodeIndex, cameraPosition) / lodMultiplier;
+        if (adjustedDistance > lodDistances[4] * 2.0f) {
+            return;
+        }
+
+        if (shouldSubdivideNode(nodes, nodeIndex, adjustedDistance, lodDistances)) {
+            uint32_t firstChild = nodes.firstChild[nodeIndex];
+            int childCount = nodes.childCount(nodeIndex);
+            for (int i = 0; i < childCount; i++) {
+                prefetchNodeRecursive(pointCloud, firstChild + i, cameraPosition, lodDistances, lodMultiplier, clipVolumes);
             }
+        } else if (nodes.totalPointCount[nodeIndex] > 0 && !nodes.isResident(nodeIndex)) {
+            requestAsyncLoad(pointCloud, nodeIndex, true);
         }
     }
 
-    void OctreePointCloudManager::buildOctree(PointCloud& pointCloud) {
-        if (pointCloud.points.empty()) {
+    void OctreePointCloudManager::processCompletedLoads(PointCloud& pointCloud) {
+        PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        if (!nodes.loadInbox) {
             return;
         }
 
-        // Check initial memory usage - if raw points exceed 90% of limit, we need to be careful
-        size_t rawPointsMemoryMB = (pointCloud.points.size() * sizeof(PointCloudPoint)) / (1024 * 1024);
-        if (rawPointsMemoryMB > pointCloud.chunkCache.maxMemoryMB * 0.9f) {
-            // For very large point clouds, we need extremely aggressive memory management
-            // Reduce max points per node to create more, smaller chunks
-            pointCloud.maxPointsPerNode = std::min(pointCloud.maxPointsPerNode, size_t(1000));
+        std::vector<std::pair<uint32_t, std::vector<PointCloudPoint>>> completed;
+        {
+            std::lock_guard<std::mutex> lock(nodes.loadInbox->mutex);
+            completed.swap(nodes.loadInbox->completed);
+        }
+
+        for (auto& [nodeIndex, points] : completed) {
+            if (nodeIndex >= nodes.size()) continue;
+
+            nodes.clearFlag(nodeIndex, PointCloudNodePool::NODE_LOAD_PENDING);
+            if (points.empty()) {
+                // Load failed, will be re-requested when needed
+                nodes.clearFlag(nodeIndex, PointCloudNodePool::NODE_PREFETCHED);
+                continue;
+            }
+
+            nodes.setPoints(nodeIndex, std::move(points));
+            nodes.touch(nodeIndex);
+        }
+    }
+
+    void OctreePointCloudManager::buildOctree(PointCloud& pointCloud) {
+        if (pointCloud.points.empty()) {
+            return;
         }
 
-        // Calculate bounds
         OctreeBounds::calculateBounds(pointCloud.points, 
                                     pointCloud.octreeBoundsMin, 
                                     pointCloud.octreeBoundsMax, 
                                     pointCloud.octreeCenter, 
                                     pointCloud.octreeSize);
+        buildOctreeInBounds(pointCloud);
+    }
+
+    void OctreePointCloudManager::buildOctree(PointCloud& pointCloud, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+        if (pointCloud.points.empty()) {
+            return;
+        }
+
+        pointCloud.octreeBoundsMin = boundsMin;
+        pointCloud.octreeBoundsMax = boundsMax;
+        OctreeBounds::calculateCube(boundsMin, boundsMax, pointCloud.octreeCenter, pointCloud.octreeSize);
+        buildOctreeInBounds(pointCloud);
+    }
+
+    void OctreePointCloudManager::buildOctreeInBounds(PointCloud& pointCloud) {
+        auto buildStart = std::chrono::steady_clock::now();
+        pointCloud.buildStats = PointCloudBuildStats();
+        pointCloud.buildStats.inputPoints = pointCloud.points.size();
+
+        if (pointCloud.autoLeafSize) {
+            pointCloud.maxPointsPerNode = chooseLeafSize(pointCloud);
+        }
+        pointCloud.buildStats.maxOctreeDepth = pointCloud.maxOctreeDepth;
+        pointCloud.buildStats.maxPointsPerNode = pointCloud.maxPointsPerNode;
 
         // Create cache directory
         createCacheDirectory(pointCloud.chunkCache.cacheDirectory);
 
         // Initialize build context
         BuildContext context;
-        context.nextNodeId = 1;
         context.cacheDirectory = pointCloud.chunkCache.cacheDirectory;
         context.maxPointsPerNode = pointCloud.maxPointsPerNode;
         context.maxDepth = pointCloud.maxOctreeDepth;
-
-        // Create root node
-        pointCloud.octreeRoot = std::make_unique<PointCloudOctreeNode>();
-        pointCloud.octreeRoot->nodeId = context.nextNodeId++;
-        pointCloud.octreeRoot->depth = 0;
-        pointCloud.octreeRoot->center = pointCloud.octreeCenter;
-        pointCloud.octreeRoot->bounds = glm::vec3(pointCloud.octreeSize * 0.5f);
-
-        // Create point indices vector
+        context.removeDuplicates = pointCloud.removeDuplicates;
+        context.duplicateTolerance = pointCloud.duplicateTolerance;
+        context.removeOutliers = pointCloud.removeOutliers;
+        context.outlierNeighbors = std::max(1, pointCloud.outlierNeighbors);
+        context.outlierStdDevs = pointCloud.outlierStdDevs;
+        context.estimateNormals = pointCloud.estimateNormals;
+        context.normalNeighbors = std::max(3, pointCloud.normalNeighbors);
+
+        // Create root node; roughly two nodes per leaf is a good first guess for the pool size
+        pointCloud.octreeNodes.clear();
+        pointCloud.renderList.invalidate();
+        pointCloud.octreeNodes.reserve(2 * (pointCloud.points.size() / std::max(context.maxPointsPerNode, size_t(1))) + 1);
+        uint32_t root = pointCloud.octreeNodes.allocate(pointCloud.octreeCenter, pointCloud.octreeSize * 0.5f, 0);
+
+        // Point indices, partitioned in place so that every node owns a contiguous range
         std::vector<size_t> allIndices(pointCloud.points.size());
         std::iota(allIndices.begin(), allIndices.end(), 0);
 
-        // Build octree recursively with memory monitoring
+        auto partitionStart = std::chrono::steady_clock::now();
         buildOctreeRecursive(
-            pointCloud.octreeRoot.get(),
+            root,
             pointCloud.points,
             allIndices,
-            pointCloud.octreeCenter,
-            pointCloud.octreeRoot->bounds,
+            0,
+            allIndices.size(),
             0,
             context,
             pointCloud
         );
 
-        // Final memory check and cleanup after build
-        ensureMemoryLimit(pointCloud);
-        
+        // Put the points in leaf order, so that each leaf is a range of pointCloud.points and the
+        // leaves are cleaned where they lie instead of in a second copy of the cloud
+        permutePoints(pointCloud.points, allIndices);
+        std::vector<size_t>().swap(allIndices);
+        pointCloud.buildStats.partitionSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - partitionStart).count();
+
+        // Clean, save and size the leaves in parallel now that the tree structure is known
+        processLeaves(pointCloud, context);
+
+        PointCloudBuildStats& stats = pointCloud.buildStats;
+        collectTreeStats(pointCloud, stats);
+        stats.buildSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - buildStart).count();
+        saveBuildStats(stats, context.cacheDirectory);
+
+        std::cout << "Octree built with " << pointCloud.octreeNodes.size() << " nodes ("
+                  << (pointCloud.octreeNodes.metadataBytes() / 1024) << " KB node metadata) in " << stats.buildSeconds << " s, "
+                  << stats.nodesPerDepth.size() << " levels, " << stats.leavesAtMaxDepth << " leaves at the depth limit" << std::endl;
+        if (stats.duplicatesRemoved > 0 || stats.outliersRemoved > 0) {
+            std::cout << "Removed " << stats.duplicatesRemoved << " duplicate and " << stats.outliersRemoved
+                      << " outlier points, " << stats.storedPoints << " of " << stats.inputPoints << " points stored" << std::endl;
+        }
+        if (stats.normalsEstimated > 0) {
+            std::cout << "Estimated normals for " << stats.normalsEstimated << " points" << std::endl;
+        }
+
         // Clear raw points to save memory (they're now in the octree)
         pointCloud.points.clear();
         pointCloud.points.shrink_to_fit();
     }
 
     void OctreePointCloudManager::buildOctreeRecursive(
-        PointCloudOctreeNode* node,
+        uint32_t nodeIndex,
         const std::vector<PointCloudPoint>& points,
-        const std::vector<size_t>& pointIndices,
-        const glm::vec3& center,
-        const glm::vec3& bounds,
+        std::vector<size_t>& indices,
+        size_t first,
+        size_t count,
         int depth,
         BuildContext& context,
         PointCloud& pointCloud
     ) {
-        node->totalPointCount = pointIndices.size();
-        
-        // Check memory usage before processing this node
-        size_t currentMemoryMB = getMemoryUsage(pointCloud) / (1024 * 1024);
-        if (currentMemoryMB > pointCloud.chunkCache.maxMemoryMB * 0.8f) { // Use 80% threshold
-            // Aggressively unload nodes to free memory
-            unloadOldestNodes(pointCloud, pointCloud.chunkCache.maxMemoryMB * 0.5f); // Target 50% usage
-        }
-        
+        PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        nodes.totalPointCount[nodeIndex] = static_cast<uint32_t>(count);
+
         // Check if we should create a leaf node
-        if (pointIndices.size() <= context.maxPointsPerNode || depth >= context.maxDepth) {
-            // Create leaf node
-            node->isLeaf = true;
-            node->points.reserve(pointIndices.size());
-            
-            for (size_t idx : pointIndices) {
-                node->points.push_back(points[idx]);
-            }
-            
-            // Generate LOD levels for this node
-            generateLODForNode(node);
-            
-            // Calculate memory usage
-            node->memoryUsage = node->points.size() * sizeof(PointCloudPoint);
-            node->isLoaded = true;
-            
-            // Save ALL nodes to disk IMMEDIATELY during build
-            saveToDisk(node, context.cacheDirectory);
-            
-            // ALWAYS unload from memory after saving during build to prevent overflow
-            if (node->isOnDisk) {
-                // Keep the LOD counts but clear the actual point data
-                node->points.clear();
-                node->points.shrink_to_fit();
-                node->isLoaded = false;
-                node->memoryUsage = 0;
-            }
-            
+        if (count <= context.maxPointsPerNode || depth >= context.maxDepth) {
+            // Leaf node - its points are cleaned and saved by processLeaves
+            context.leaves.push_back({ nodeIndex, first, count });
             return;
         }
 
-        // Create internal node - subdivide into 8 children
-        node->isLeaf = false;
-        std::array<std::vector<size_t>, 8> childIndices;
-
-        // Distribute points to children
-        for (size_t idx : pointIndices) {
-            int childIndex = OctreeBounds::getChildIndex(points[idx].position, center);
-            childIndices[childIndex].push_back(idx);
+        // Create internal node - sort the range by child, one binary partition per bit of the
+        // child index, most significant first
+        glm::vec3 center = nodes.center(nodeIndex);
+        auto bitClear = [&](int bit) {
+            return [&points, center, bit](size_t idx) { return (OctreeBounds::getChildIndex(points[idx].position, center) & bit) == 0; };
+        };
+        size_t* childBounds[9];
+        childBounds[0] = indices.data() + first;
+        childBounds[8] = childBounds[0] + count;
+        childBounds[4] = std::partition(childBounds[0], childBounds[8], bitClear(4));
+        for (int half = 0; half < 8; half += 4) {
+            childBounds[half + 2] = std::partition(childBounds[half], childBounds[half + 4], bitClear(2));
+        }
+        for (int quarter = 0; quarter < 8; quarter += 2) {
+            childBounds[quarter + 1] = std::partition(childBounds[quarter], childBounds[quarter + 2], bitClear(1));
         }
 
-        // Create children that have points
+        // Allocate the children that have points as one contiguous block
+        uint8_t mask = 0;
         for (int i = 0; i < 8; i++) {
-            if (!childIndices[i].empty()) {
-                glm::vec3 childCenter, childBounds;
-                OctreeBounds::getChildBounds(center, bounds, i, childCenter, childBounds);
-
-                node->children[i] = std::make_unique<PointCloudOctreeNode>();
-                node->children[i]->nodeId = context.nextNodeId++;
-                node->children[i]->depth = depth + 1;
-                node->children[i]->center = childCenter;
-                node->children[i]->bounds = childBounds;
+            if (childBounds[i + 1] != childBounds[i]) {
+                mask |= static_cast<uint8_t>(1 << i);
+            }
+        }
+        uint32_t childNode = nodes.allocateChildren(nodeIndex, mask);
 
+        for (int i = 0; i < 8; i++) {
+            if (childBounds[i + 1] != childBounds[i]) {
                 buildOctreeRecursive(
-                    node->children[i].get(),
+                    childNode++,
                     points,
-                    childIndices[i],
-                    childCenter,
-                    childBounds,
+                    indices,
+                    static_cast<size_t>(childBounds[i] - indices.data()),
+                    static_cast<size_t>(childBounds[i + 1] - childBounds[i]),
                     depth + 1,
                     context,
                     pointCloud
                 );
-                
-                // Check memory after each child to prevent overflow
-                size_t memoryAfterChild = getMemoryUsage(pointCloud) / (1024 * 1024);
-                if (memoryAfterChild > pointCloud.chunkCache.maxMemoryMB * 0.9f) { // 90% threshold
-                    // Emergency memory cleanup
-                    unloadOldestNodes(pointCloud, pointCloud.chunkCache.maxMemoryMB * 0.3f); // Target 30% usage
+            }
+        }
+    }
+
+    void OctreePointCloudManager::permutePoints(std::vector<PointCloudPoint>& points, std::vector<size_t>& order) {
+        // points[i] becomes the old points[order[i]]; each cycle is walked once and its entries of
+        // order are reset to themselves as they are placed
+        for (size_t start = 0; start < order.size(); start++) {
+            if (order[start] == start) continue;
+            PointCloudPoint first = points[start];
+            size_t position = start;
+            while (true) {
+                size_t source = order[position];
+                order[position] = position;
+                if (source == start) {
+                    points[position] = first;
+                    break;
                 }
+                points[position] = points[source];
+                position = source;
             }
         }
     }
 
-    void OctreePointCloudManager::generateLODForNode(PointCloudOctreeNode* node) {
-        if (node->points.empty()) return;
+    void OctreePointCloudManager::processLeaves(PointCloud& pointCloud, BuildContext& context) {
+        PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        PointCloudPoint* points = pointCloud.points.data();
+        size_t leafCount = context.leaves.size();
+
+        // The pool no longer grows, so workers may write the per-node entries of their own leaves.
+        // Point pages are not published from workers; leaves that could not be saved are collected
+        // and made resident afterwards.
+        std::atomic<size_t> duplicatesRemoved{0};
+        std::atomic<size_t> outliersRemoved{0};
+        std::atomic<size_t> normalsEstimated{0};
+        std::atomic<int64_t> normalMicroseconds{0};
+        std::atomic<int64_t> encodeMicroseconds{0};
+        std::mutex unsavedMutex;
+        std::vector<std::pair<uint32_t, std::vector<PointCloudPoint>>> unsavedLeaves;
+
+        // Pass 1: clean every leaf where it lies, compacting it to the front of its range
+        auto cleanupStart = std::chrono::steady_clock::now();
+        JobSystem::parallelFor(leafCount, [&](size_t leaf) {
+            BuildLeaf& buildLeaf = context.leaves[leaf];
+            PointCloudPoint* leafPoints = points + buildLeaf.first;
+
+            if (context.removeDuplicates) {
+                size_t removed = removeDuplicatePoints(leafPoints, buildLeaf.count, context.duplicateTolerance);
+                buildLeaf.count -= removed;
+                duplicatesRemoved += removed;
+            }
+            if (context.removeOutliers) {
+                size_t removed = removeStatisticalOutliers(leafPoints, buildLeaf.count, context.outlierNeighbors, context.outlierStdDevs);
+                buildLeaf.count -= removed;
+                outliersRemoved += removed;
+            }
+            nodes.totalPointCount[buildLeaf.nodeIndex] = static_cast<uint32_t>(buildLeaf.count);
+        });
+
+        pointCloud.buildStats.cleanupSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - cleanupStart).count();
+
+        std::vector<uint32_t> leafOfNode;
+        if (context.estimateNormals) {
+            leafOfNode.assign(nodes.size(), PointCloudNodePool::INVALID_NODE);
+            for (size_t leaf = 0; leaf < leafCount; leaf++) {
+                leafOfNode[context.leaves[leaf].nodeIndex] = static_cast<uint32_t>(leaf);
+            }
+        }
+
+        // Pass 2: normals, LOD sizes and the node cache. Normal estimation reads the cleaned
+        // positions of neighbouring leaves, which no longer change in this pass, and never their
+        // normals, which the neighbours' workers are writing. Only the page being saved is
+        // copied, so the build holds the cloud once plus a page per worker.
+        auto pageStart = std::chrono::steady_clock::now();
+        JobSystem::parallelFor(leafCount, [&](size_t leaf) {
+            const BuildLeaf& buildLeaf = context.leaves[leaf];
+            uint32_t nodeIndex = buildLeaf.nodeIndex;
+            if (buildLeaf.count == 0) return;
+
+            if (context.estimateNormals) {
+                auto normalStart = std::chrono::steady_clock::now();
+                normalsEstimated += estimateLeafNormals(nodes, leafOfNode, context.leaves, points, leaf,
+                                                        context.normalNeighbors, pointCloud.octreeCenter);
+                normalMicroseconds += std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - normalStart).count();
+            }
+
+            std::vector<PointCloudPoint> page(points + buildLeaf.first, points + buildLeaf.first + buildLeaf.count);
 
-        const int numLODLevels = 5;
-        node->lodPointCounts.resize(numLODLevels);
+            // Generate LOD levels for this node
+            generateLODForNode(nodes, nodeIndex, page);
+
+            // Save every leaf to disk during the build so it never has to stay in memory
+            auto encodeStart = std::chrono::steady_clock::now();
+            try {
+                saveNodeToHDF5(page, getNodeFilePath(context.cacheDirectory, nodeIndex));
+                nodes.setFlag(nodeIndex, PointCloudNodePool::NODE_ON_DISK);
+            } catch (const std::exception& e) {
+                std::cerr << "Failed to save node " << nodeIndex << " to disk: " << e.what() << std::endl;
+                std::lock_guard<std::mutex> lock(unsavedMutex);
+                unsavedLeaves.emplace_back(nodeIndex, std::move(page));
+            }
+            encodeMicroseconds += std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - encodeStart).count();
+        });
+
+        // The pages hold every point now
+        pointCloud.points.clear();
+        pointCloud.points.shrink_to_fit();
+        pointCloud.buildStats.pageSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - pageStart).count();
+        pointCloud.buildStats.normalCpuSeconds = normalMicroseconds * 1e-6f;
+        pointCloud.buildStats.encodeCpuSeconds = encodeMicroseconds * 1e-6f;
+
+        for (auto& [nodeIndex, unsavedPoints] : unsavedLeaves) {
+            nodes.setPoints(nodeIndex, std::move(unsavedPoints));
+        }
+
+        // Children are always allocated after their parent, so one backward pass
+        // brings the internal totals in line with the cleaned leaves
+        for (uint32_t node = nodes.size(); node-- > 0;) {
+            if (nodes.isLeaf(node)) continue;
+            uint32_t total = 0;
+            uint32_t firstChild = nodes.firstChild[node];
+            for (int i = 0; i < nodes.childCount(node); i++) {
+                total += nodes.totalPointCount[firstChild + i];
+            }
+            nodes.totalPointCount[node] = total;
+        }
+
+        pointCloud.buildStats.duplicatesRemoved = duplicatesRemoved;
+        pointCloud.buildStats.outliersRemoved = outliersRemoved;
+        pointCloud.buildStats.normalsEstimated = normalsEstimated;
+        pointCloud.hasNormals = context.estimateNormals;
+    }
+
+    size_t OctreePointCloudManager::removeDuplicatePoints(PointCloudPoint* points, size_t count, float tolerance) {
+        if (count < 2) return 0;
+
+        size_t kept = 0;
+        if (tolerance <= 0.0f) {
+            // Exact copies: hash the position bits
+            struct PositionHash {
+                size_t operator()(const glm::vec3& p) const {
+                    uint32_t bits[3];
+                    std::memcpy(bits, &p, sizeof(bits));
+                    return (size_t(bits[0]) * 73856093u) ^ (size_t(bits[1]) * 19349663u) ^ (size_t(bits[2]) * 83492791u);
+                }
+            };
+            std::unordered_set<glm::vec3, PositionHash> seen;
+            seen.reserve(count);
+            for (size_t i = 0; i < count; i++) {
+                if (seen.insert(points[i].position).second) {
+                    points[kept++] = points[i];
+                }
+            }
+        } else {
+            // Near duplicates: hash cells of the tolerance size and compare against the kept
+            // points of the 27 surrounding cells
+            glm::vec3 origin = points[0].position;
+            float inverseCell = 1.0f / tolerance;
+            float toleranceSquared = tolerance * tolerance;
+            auto cellKey = [](int64_t x, int64_t y, int64_t z) {
+                return (uint64_t(x & 0x1FFFFF) << 42) | (uint64_t(y & 0x1FFFFF) << 21) | uint64_t(z & 0x1FFFFF);
+            };
+
+            std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+            cells.reserve(count);
+            for (size_t i = 0; i < count; i++) {
+                glm::vec3 cell = glm::floor((points[i].position - origin) * inverseCell);
+                int64_t cx = static_cast<int64_t>(cell.x), cy = static_cast<int64_t>(cell.y), cz = static_cast<int64_t>(cell.z);
+
+                bool duplicate = false;
+                for (int64_t dx = -1; dx <= 1 && !duplicate; dx++) {
+                    for (int64_t dy = -1; dy <= 1 && !duplicate; dy++) {
+                        for (int64_t dz = -1; dz <= 1 && !duplicate; dz++) {
+                            auto it = cells.find(cellKey(cx + dx, cy + dy, cz + dz));
+                            if (it == cells.end()) continue;
+                            for (uint32_t keptIndex : it->second) {
+                                glm::vec3 delta = points[keptIndex].position - points[i].position;
+                                if (glm::dot(delta, delta) <= toleranceSquared) {
+                                    duplicate = true;
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+                if (duplicate) continue;
+
+                // Kept points are compacted in place; kept <= i, so earlier entries stay valid
+                points[kept] = points[i];
+                cells[cellKey(cx, cy, cz)].push_back(static_cast<uint32_t>(kept));
+                kept++;
+            }
+        }
+
+        return count - kept;
+    }
+
+    size_t OctreePointCloudManager::removeStatisticalOutliers(PointCloudPoint* points, size_t count, int neighbors, float stdDevs) {
+        if (count <= static_cast<size_t>(neighbors)) return 0;
+
+        std::vector<uint32_t> nearest;
+        findNearestNeighbors(points, count, count, neighbors, nearest);
+
+        // Mean distance to the k nearest neighbours
+        std::vector<float> meanDistances(count);
+        for (size_t i = 0; i < count; i++) {
+            const uint32_t* row = &nearest[i * neighbors];
+            float sum = 0.0f;
+            int found = 0;
+            for (int n = 0; n < neighbors && row[n] != INVALID_NEIGHBOR; n++, found++) {
+                sum += glm::length(points[row[n]].position - points[i].position);
+            }
+            meanDistances[i] = found > 0 ? sum / found : 0.0f;
+        }
+
+        double mean = 0.0, meanSquares = 0.0;
+        for (float d : meanDistances) {
+            mean += d;
+            meanSquares += double(d) * d;
+        }
+        mean /= count;
+        double stdDev = std::sqrt(std::max(0.0, meanSquares / count - mean * mean));
+        float threshold = static_cast<float>(mean + stdDevs * stdDev);
+
+        // Points near the leaf faces see fewer neighbours than they have in the full cloud,
+        // which only makes the filter slightly more conservative there
+        size_t kept = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (meanDistances[i] <= threshold) {
+                points[kept++] = points[i];
+            }
+        }
+        return count - kept;
+    }
+
+    size_t OctreePointCloudManager::chooseLeafSize(const PointCloud& pointCloud) {
+        size_t budget = std::min(PointCloudResidencyManager::getCpuBudget(), PointCloudResidencyManager::getGpuBudget());
+        size_t budgetLeafPoints = budget / (MIN_RESIDENT_LEAVES * sizeof(PointCloudPoint));
+        size_t maxLeafPoints = std::max(MIN_LEAF_POINTS, std::min(budgetLeafPoints, MAX_LEAF_POINTS));
+
+        // Octree level whose cell width is closest to the target on a log scale
+        float targetEdge = std::max(0.5f * pointCloud.lodDistances[0] * pointCloud.lodMultiplier, 1e-6f);
+        int depth = static_cast<int>(std::round(std::log2(std::max(pointCloud.octreeSize / targetEdge, 1.0f))));
+        depth = std::clamp(depth, 0, std::min(pointCloud.maxOctreeDepth, 20));
+        float cellSize = pointCloud.octreeSize / static_cast<float>(1 << depth);
+        glm::vec3 origin = pointCloud.octreeCenter - glm::vec3(pointCloud.octreeSize * 0.5f);
+
+        // Only occupied cells count, so scans of surfaces and solid volumes are treated alike.
+        // Very large clouds are sampled with a stride; sparse cells missed by the sample make
+        // the estimate lean toward larger leaves.
+        const size_t sampleLimit = size_t(1) << 20;
+        size_t count = pointCloud.points.size();
+        size_t stride = std::max<size_t>(1, count / sampleLimit);
+        std::unordered_set<uint64_t> occupied;
+        size_t sampled = 0;
+        for (size_t i = 0; i < count; i += stride, sampled++) {
+            glm::vec3 cell = glm::floor((pointCloud.points[i].position - origin) / cellSize);
+            cell = glm::clamp(cell, glm::vec3(0.0f), glm::vec3(static_cast<float>((1 << depth) - 1)));
+            occupied.insert((static_cast<uint64_t>(cell.x) << 42) | (static_cast<uint64_t>(cell.y) << 21) | static_cast<uint64_t>(cell.z));
+        }
+
+        size_t densityLeafPoints = sampled / std::max<size_t>(occupied.size(), 1) * stride;
+        size_t leafPoints = std::clamp(densityLeafPoints, MIN_LEAF_POINTS, maxLeafPoints);
+
+        std::cout << "Leaf size " << leafPoints << " points: " << densityLeafPoints << " per " << cellSize
+                  << " unit cell, budget allows " << budgetLeafPoints << std::endl;
+        return leafPoints;
+    }
+
+    float OctreePointCloudManager::estimateGridCellSize(const PointCloudPoint* points, size_t count, glm::vec3& minBound, glm::vec3& maxBound) {
+        minBound = glm::vec3(std::numeric_limits<float>::max());
+        maxBound = glm::vec3(std::numeric_limits<float>::lowest());
+        for (size_t i = 0; i < count; i++) {
+            minBound = glm::min(minBound, points[i].position);
+            maxBound = glm::max(maxBound, points[i].position);
+        }
+
+        // A few points per cell. Taking the largest of the volume, area and length based sizes
+        // keeps the cell count proportional to the point count for flat and linear leaves too.
+        glm::vec3 extent = maxBound - minBound;
+        float e[3] = { extent.x, extent.y, extent.z };
+        std::sort(e, e + 3, std::greater<float>());
+        float pointsPerCell = 4.0f;
+        float pointCount = static_cast<float>(std::max<size_t>(count, 1));
+        return std::max({
+            std::cbrt(e[0] * e[1] * e[2] * pointsPerCell / pointCount),
+            std::sqrt(e[0] * e[1] * pointsPerCell / pointCount),
+            e[0] * pointsPerCell / pointCount,
+            1e-6f
+        });
+    }
+
+    void OctreePointCloudManager::findNearestNeighbors(const PointCloudPoint* points, size_t count, size_t queryCount, int neighbors,
+                                                       std::vector<uint32_t>& nearest) {
+        nearest.assign(queryCount * neighbors, INVALID_NEIGHBOR);
+        if (count < 2) return;
+
+        // Uniform grid over the points
+        glm::vec3 minBound, maxBound;
+        float cellSize = estimateGridCellSize(points, count, minBound, maxBound);
+        glm::ivec3 dims = glm::clamp(glm::ivec3((maxBound - minBound) / cellSize) + 1, glm::ivec3(1), glm::ivec3(1024));
+        auto cellOf = [&](const glm::vec3& position) {
+            return glm::clamp(glm::ivec3((position - minBound) / cellSize), glm::ivec3(0), dims - 1);
+        };
+        auto cellIndex = [&](const glm::ivec3& cell) {
+            return (static_cast<size_t>(cell.z) * dims.y + cell.y) * dims.x + cell.x;
+        };
+
+        // Counting sort of the points into cells
+        size_t cellCount = static_cast<size_t>(dims.x) * dims.y * dims.z;
+        std::vector<uint32_t> cellStart(cellCount + 1, 0);
+        std::vector<uint32_t> pointCell(count);
+        for (size_t i = 0; i < count; i++) {
+            pointCell[i] = static_cast<uint32_t>(cellIndex(cellOf(points[i].position)));
+            cellStart[pointCell[i] + 1]++;
+        }
+        for (size_t c = 0; c < cellCount; c++) {
+            cellStart[c + 1] += cellStart[c];
+        }
+        std::vector<uint32_t> cellPoints(count);
+        std::vector<uint32_t> fill(cellStart.begin(), cellStart.end() - 1);
+        for (size_t i = 0; i < count; i++) {
+            cellPoints[fill[pointCell[i]]++] = static_cast<uint32_t>(i);
+        }
+
+        // Search growing shells of cells around each query point with a bounded max-heap
+        std::vector<std::pair<float, uint32_t>> heap;
+        int maxShell = std::max({ dims.x, dims.y, dims.z });
+        for (size_t i = 0; i < queryCount; i++) {
+            const glm::vec3& position = points[i].position;
+            glm::ivec3 home = cellOf(position);
+            heap.clear();
+
+            for (int shell = 0; shell <= maxShell; shell++) {
+                glm::ivec3 lo = glm::max(home - shell, glm::ivec3(0));
+                glm::ivec3 hi = glm::min(home + shell, dims - 1);
+                for (int z = lo.z; z <= hi.z; z++) {
+                    for (int y = lo.y; y <= hi.y; y++) {
+                        for (int x = lo.x; x <= hi.x; x++) {
+                            glm::ivec3 offset = glm::abs(glm::ivec3(x, y, z) - home);
+                            if (std::max({ offset.x, offset.y, offset.z }) != shell) continue;
+
+                            size_t c = cellIndex(glm::ivec3(x, y, z));
+                            for (uint32_t k = cellStart[c]; k < cellStart[c + 1]; k++) {
+                                uint32_t candidate = cellPoints[k];
+                                if (candidate == i) continue;
+                                glm::vec3 delta = points[candidate].position - position;
+                                float distanceSquared = glm::dot(delta, delta);
+                                if (heap.size() < static_cast<size_t>(neighbors)) {
+                                    heap.emplace_back(distanceSquared, candidate);
+                                    std::push_heap(heap.begin(), heap.end());
+                                } else if (distanceSquared < heap.front().first) {
+                                    std::pop_heap(heap.begin(), heap.end());
+                                    heap.back() = { distanceSquared, candidate };
+                                    std::push_heap(heap.begin(), heap.end());
+                                }
+                            }
+                        }
+                    }
+                }
+
+                // Anything beyond this shell is at least shell * cellSize away
+                float reach = shell * cellSize;
+                if (heap.size() == static_cast<size_t>(neighbors) && heap.front().first <= reach * reach) {
+                    break;
+                }
+            }
+
+            for (size_t n = 0; n < heap.size(); n++) {
+                nearest[i * neighbors + n] = heap[n].second;
+            }
+        }
+    }
+
+    size_t OctreePointCloudManager::estimateLeafNormals(const PointCloudNodePool& nodes, const std::vector<uint32_t>& leafOfNode,
+                                                        const std::vector<BuildLeaf>& leaves, PointCloudPoint* points, size_t leaf,
+                                                        int neighbors, const glm::vec3& viewpoint) {
+        uint32_t nodeIndex = leaves[leaf].nodeIndex;
+        PointCloudPoint* own = points + leaves[leaf].first;
+        size_t ownCount = leaves[leaf].count;
+        if (ownCount < 3) return 0;
+
+        // Borrow the points of neighbouring leaves within a few point spacings of this leaf,
+        // so points on the leaf faces get full neighbourhoods
+        glm::vec3 ownMin, ownMax;
+        float margin = 2.0f * estimateGridCellSize(own, ownCount, ownMin, ownMax);
+        glm::vec3 boxMin = ownMin - margin;
+        glm::vec3 boxMax = ownMax + margin;
+
+        std::vector<PointCloudPoint> neighborhood(own, own + ownCount);
+        std::vector<uint32_t> stack = { 0 };
+        while (!stack.empty()) {
+            uint32_t node = stack.back();
+            stack.pop_back();
+
+            glm::vec3 center = nodes.center(node);
+            glm::vec3 halfExtent(nodes.halfSize(node));
+            if (glm::any(glm::lessThan(center + halfExtent, boxMin)) || glm::any(glm::greaterThan(center - halfExtent, boxMax))) {
+                continue;
+            }
+
+            if (nodes.isLeaf(node)) {
+                uint32_t other = leafOfNode[node];
+                if (node == nodeIndex || other == PointCloudNodePool::INVALID_NODE) continue;
+                // Positions only: the other leaf's worker writes its normals concurrently
+                const PointCloudPoint* otherPoints = points + leaves[other].first;
+                for (size_t i = 0; i < leaves[other].count; i++) {
+                    const PointCloudPoint& point = otherPoints[i];
+                    if (glm::all(glm::greaterThanEqual(point.position, boxMin)) && glm::all(glm::lessThanEqual(point.position, boxMax))) {
+                        PointCloudPoint borrowed{};
+                        borrowed.position = point.position;
+                        neighborhood.push_back(borrowed);
+                    }
+                }
+            } else {
+                uint32_t firstChild = nodes.firstChild[node];
+                for (int i = 0; i < nodes.childCount(node); i++) {
+                    stack.push_back(firstChild + i);
+                }
+            }
+        }
+
+        int k = std::max(3, std::min(neighbors, static_cast<int>(neighborhood.size()) - 1));
+        std::vector<uint32_t> nearest;
+        findNearestNeighbors(neighborhood.data(), neighborhood.size(), ownCount, k, nearest);
+
+        for (size_t i = 0; i < ownCount; i++) {
+            glm::vec3 normal = estimateNormal(neighborhood.data(), &nearest[i * k], k, own[i].position);
+
+            // Normals have no inherent sign; face them towards the middle of the cloud, where
+            // the scanner stations usually are
+            if (glm::dot(normal, viewpoint - own[i].position) < 0.0f) {
+                normal = -normal;
+            }
+            own[i].normal = PointCloudPoint::packNormal(normal);
+        }
+        return ownCount;
+    }
+
+    glm::vec3 OctreePointCloudManager::estimateNormal(const PointCloudPoint* points, const uint32_t* neighbors, int count, const glm::vec3& position) {
+        // Sums of the neighbour offsets and their products, relative to the query point for precision
+        float sx = 0, sy = 0, sz = 0, sxx = 0, sxy = 0, sxz = 0, syy = 0, syz = 0, szz = 0;
+        int used = 0;
+        int n = 0;
+#ifdef OCTREE_QUERY_SSE
+        __m128 ax = _mm_setzero_ps(), ay = _mm_setzero_ps(), az = _mm_setzero_ps();
+        __m128 axx = _mm_setzero_ps(), axy = _mm_setzero_ps(), axz = _mm_setzero_ps();
+        __m128 ayy = _mm_setzero_ps(), ayz = _mm_setzero_ps(), azz = _mm_setzero_ps();
+        const __m128 px = _mm_set1_ps(position.x);
+        const __m128 py = _mm_set1_ps(position.y);
+        const __m128 pz = _mm_set1_ps(position.z);
+        for (; n + 4 <= count && neighbors[n + 3] != INVALID_NEIGHBOR; n += 4) {
+            // Gathered loads of position.xyz + intensity, transposed to x/y/z lanes
+            __m128 r0 = _mm_loadu_ps(&points[neighbors[n]].position.x);
+            __m128 r1 = _mm_loadu_ps(&points[neighbors[n + 1]].position.x);
+            __m128 r2 = _mm_loadu_ps(&points[neighbors[n + 2]].position.x);
+            __m128 r3 = _mm_loadu_ps(&points[neighbors[n + 3]].position.x);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+            __m128 dx = _mm_sub_ps(r0, px);
+            __m128 dy = _mm_sub_ps(r1, py);
+            __m128 dz = _mm_sub_ps(r2, pz);
+            ax = _mm_add_ps(ax, dx);
+            ay = _mm_add_ps(ay, dy);
+            az = _mm_add_ps(az, dz);
+            axx = _mm_add_ps(axx, _mm_mul_ps(dx, dx));
+            axy = _mm_add_ps(axy, _mm_mul_ps(dx, dy));
+            axz = _mm_add_ps(axz, _mm_mul_ps(dx, dz));
+            ayy = _mm_add_ps(ayy, _mm_mul_ps(dy, dy));
+            ayz = _mm_add_ps(ayz, _mm_mul_ps(dy, dz));
+            azz = _mm_add_ps(azz, _mm_mul_ps(dz, dz));
+        }
+        used = n;
+
+        auto horizontalSum = [](__m128 v) {
+            float lanes[4];
+            _mm_storeu_ps(lanes, v);
+            return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        };
+        sx = horizontalSum(ax); sy = horizontalSum(ay); sz = horizontalSum(az);
+        sxx = horizontalSum(axx); sxy = horizontalSum(axy); sxz = horizontalSum(axz);
+        syy = horizontalSum(ayy); syz = horizontalSum(ayz); szz = horizontalSum(azz);
+#endif
+        for (; n < count && neighbors[n] != INVALID_NEIGHBOR; n++, used++) {
+            glm::vec3 d = points[neighbors[n]].position - position;
+            sx += d.x; sy += d.y; sz += d.z;
+            sxx += d.x * d.x; sxy += d.x * d.y; sxz += d.x * d.z;
+            syy += d.y * d.y; syz += d.y * d.z; szz += d.z * d.z;
+        }
+        if (used < 3) {
+            return glm::vec3(0.0f, 0.0f, 1.0f);
+        }
+
+        float inv = 1.0f / used;
+        glm::vec3 mean(sx * inv, sy * inv, sz * inv);
+        float cxx = sxx * inv - mean.x * mean.x;
+        float cxy = sxy * inv - mean.x * mean.y;
+        float cxz = sxz * inv - mean.x * mean.z;
+        float cyy = syy * inv - mean.y * mean.y;
+        float cyz = syz * inv - mean.y * mean.z;
+        float czz = szz * inv - mean.z * mean.z;
+
+        // Smallest eigenvalue of the symmetric covariance (trigonometric solution of the cubic)
+        float q = (cxx + cyy + czz) / 3.0f;
+        float p1 = cxy * cxy + cxz * cxz + cyz * cyz;
+        float p2 = (cxx - q) * (cxx - q) + (cyy - q) * (cyy - q) + (czz - q) * (czz - q) + 2.0f * p1;
+        float p = std::sqrt(p2 / 6.0f);
+        if (p < 1e-20f) {
+            return glm::vec3(0.0f, 0.0f, 1.0f); // Isotropic neighbourhood, no preferred direction
+        }
+        float bxx = (cxx - q) / p, byy = (cyy - q) / p, bzz = (czz - q) / p;
+        float bxy = cxy / p, bxz = cxz / p, byz = cyz / p;
+        float r = 0.5f * (bxx * (byy * bzz - byz * byz) - bxy * (bxy * bzz - byz * bxz) + bxz * (bxy * byz - byy * bxz));
+        float phi = std::acos(glm::clamp(r, -1.0f, 1.0f)) / 3.0f;
+        float smallest = q + 2.0f * p * std::cos(phi + 2.0943951f);
+
+        // The eigenvector is orthogonal to the rows of (C - smallest * I); use the most stable cross product
+        glm::vec3 row0(cxx - smallest, cxy, cxz);
+        glm::vec3 row1(cxy, cyy - smallest, cyz);
+        glm::vec3 row2(cxz, cyz, czz - smallest);
+        glm::vec3 c01 = glm::cross(row0, row1);
+        glm::vec3 c02 = glm::cross(row0, row2);
+        glm::vec3 c12 = glm::cross(row1, row2);
+        float d01 = glm::dot(c01, c01), d02 = glm::dot(c02, c02), d12 = glm::dot(c12, c12);
+        glm::vec3 best = c01;
+        float bestLength = d01;
+        if (d02 > bestLength) { best = c02; bestLength = d02; }
+        if (d12 > bestLength) { best = c12; bestLength = d12; }
+        if (bestLength < 1e-30f) {
+            return glm::vec3(0.0f, 0.0f, 1.0f);
+        }
+        return best / std::sqrt(bestLength);
+    }
+
+    void OctreePointCloudManager::generateLODForNode(PointCloudNodePool& nodes, uint32_t nodeIndex, const std::vector<PointCloudPoint>& points) {
+        if (points.empty()) return;
+
+        const int numLODLevels = PointCloudNodePool::NUM_LOD_LEVELS;
+        auto& lodPointCounts = nodes.lodPointCounts[nodeIndex];
         
-        size_t totalPoints = node->points.size();
+        size_t totalPoints = points.size();
         
         // Calculate point density using octree spatial information
-        float nodeVolume = (node->bounds.x * 2.0f) * (node->bounds.y * 2.0f) * (node->bounds.z * 2.0f);
+        float nodeSize = nodes.halfSize(nodeIndex) * 2.0f;
+        float nodeVolume = nodeSize * nodeSize * nodeSize;
         float pointDensity = static_cast<float>(totalPoints) / nodeVolume;
         
         // Use octree depth to understand the spatial resolution
         // Deeper nodes = smaller volumes = potentially higher local density
-        float depthFactor = 1.0f + (node->depth * 0.1f);
+        float depthFactor = 1.0f + (nodes.depth[nodeIndex] * 0.1f);
         float adjustedDensity = pointDensity * depthFactor;
         
         // Density-aware LOD generation
+        const float* reductionFactors;
+        size_t minimumPoints;
         if (adjustedDensity < 10.0f) {
             // Very low density - minimal reduction to maintain visibility
-            const float reductionFactors[] = { 1.0f, 1.0f, 0.9f, 0.8f, 0.7f };
-            for (int lod = 0; lod < numLODLevels; lod++) {
-                node->lodPointCounts[lod] = std::max(static_cast<size_t>(totalPoints * reductionFactors[lod]), size_t(1));
-            }
+            static const float factors[] = { 1.0f, 1.0f, 0.9f, 0.8f, 0.7f };
+            reductionFactors = factors;
+            minimumPoints = 1;
         } else if (adjustedDensity < 50.0f) {
             // Low density - gentle reduction
-            const float reductionFactors[] = { 1.0f, 0.9f, 0.7f, 0.5f, 0.3f };
-            for (int lod = 0; lod < numLODLevels; lod++) {
-                node->lodPointCounts[lod] = std::max(static_cast<size_t>(totalPoints * reductionFactors[lod]), size_t(1));
-            }
+            static const float factors[] = { 1.0f, 0.9f, 0.7f, 0.5f, 0.3f };
+            reductionFactors = factors;
+            minimumPoints = 1;
         } else if (adjustedDensity < 200.0f) {
             // Medium density - moderate reduction
-            const float reductionFactors[] = { 1.0f, 0.7f, 0.4f, 0.2f, 0.08f };
-            for (int lod = 0; lod < numLODLevels; lod++) {
-                node->lodPointCounts[lod] = std::max(static_cast<size_t>(totalPoints * reductionFactors[lod]), size_t(2));
-            }
+            static const float factors[] = { 1.0f, 0.7f, 0.4f, 0.2f, 0.08f };
+            reductionFactors = factors;
+            minimumPoints = 2;
         } else if (adjustedDensity < 1000.0f) {
             // High density - aggressive reduction (points are packed, can afford to lose many)
-            const float reductionFactors[] = { 1.0f, 0.5f, 0.2f, 0.05f, 0.01f };
-            for (int lod = 0; lod < numLODLevels; lod++) {
-                node->lodPointCounts[lod] = std::max(static_cast<size_t>(totalPoints * reductionFactors[lod]), size_t(3));
-            }
+            static const float factors[] = { 1.0f, 0.5f, 0.2f, 0.05f, 0.01f };
+            reductionFactors = factors;
+            minimumPoints = 3;
         } else {
             // Extremely high density - very aggressive reduction (densely packed cloud)
-            const float reductionFactors[] = { 1.0f, 0.3f, 0.08f, 0.015f, 0.003f };
-            for (int lod = 0; lod < numLODLevels; lod++) {
-                node->lodPointCounts[lod] = std::max(static_cast<size_t>(totalPoints * reductionFactors[lod]), size_t(5));
-            }
+            static const float factors[] = { 1.0f, 0.3f, 0.08f, 0.015f, 0.003f };
+            reductionFactors = factors;
+            minimumPoints = 5;
+        }
+
+        for (int lod = 0; lod < numLODLevels; lod++) {
+            lodPointCounts[lod] = static_cast<uint32_t>(std::max(static_cast<size_t>(totalPoints * reductionFactors[lod]), minimumPoints));
         }
         
         // Additional safety: ensure very small chunks always keep some points at all LOD levels
         if (totalPoints <= 20) {
             for (int lod = 0; lod < numLODLevels; lod++) {
-                node->lodPointCounts[lod] = std::max(node->lodPointCounts[lod], static_cast<size_t>(std::max(1, static_cast<int>(totalPoints * 0.3f))));
+                lodPointCounts[lod] = std::max(lodPointCounts[lod], static_cast<uint32_t>(std::max(1, static_cast<int>(totalPoints * 0.3f))));
             }
         }
     }
 
-    void OctreePointCloudManager::createVBOsForNode(PointCloudOctreeNode* node) {
-        if (node->vbosGenerated || node->points.empty()) return;
+    void OctreePointCloudManager::createVBOsForNode(PointCloudNodePool& nodes, uint32_t nodeIndex) {
+        const std::vector<PointCloudPoint>* nodePoints = nodes.points(nodeIndex);
+        if (nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_VBOS_GENERATED) || !nodePoints || nodePoints->empty()) return;
+
+        // Upload the points once in random order, so every LOD level is a random subset
+        // given by a prefix of the same allocation
+        std::vector<PointCloudPoint> shuffledPoints(*nodePoints);
+        std::random_device rd;
+        std::mt19937 g(rd());
+        std::shuffle(shuffledPoints.begin(), shuffledPoints.end(), g);
+
+        PointCloudGpuAllocation allocation = PointCloudGpuArena::allocate(static_cast<uint32_t>(shuffledPoints.size()));
+        if (!allocation.valid()) return;
+        PointCloudGpuArena::upload(allocation, shuffledPoints.data());
+        nodes.gpuAllocations[nodeIndex] = allocation;
+
+        // Small leaves can have a minimum LOD count above their actual size
+        for (uint32_t& lodCount : nodes.lodPointCounts[nodeIndex]) {
+            lodCount = std::min(lodCount, allocation.count);
+        }
+
+        nodes.markVBOsGenerated(nodeIndex);
+    }
 
-        const int numLODLevels = 5;
-        
-        for (int lod = 0; lod < numLODLevels; lod++) {
-            size_t pointCount = node->lodPointCounts[lod];
-            if (pointCount == 0) continue;
-
-            // Create VBO
-            GLuint vbo;
-            glGenBuffers(1, &vbo);
-            glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-            // Subsample points for this LOD level
-            std::vector<PointCloudPoint> lodPoints;
-            if (pointCount >= node->points.size()) {
-                lodPoints = node->points;
-            } else {
-                // Use random sampling for LOD
-                std::vector<size_t> indices(node->points.size());
-                std::iota(indices.begin(), indices.end(), 0);
-                
-                std::random_device rd;
-                std::mt19937 g(rd());
-                std::shuffle(indices.begin(), indices.end(), g);
-                
-                lodPoints.reserve(pointCount);
-                for (size_t i = 0; i < pointCount; i++) {
-                    lodPoints.push_back(node->points[indices[i]]);
+    void OctreePointCloudManager::updateLOD(PointCloud& pointCloud, const glm::vec3& cameraPosition) {
+        if (!pointCloud.hasOctree()) {
+            return;
+        }
+
+        PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        PointCloudRenderList& renderList = pointCloud.renderList;
+
+        // Shared frame counter so nodes of different clouds can be ranked against each other
+        nodes.frameCounter = PointCloudResidencyManager::getFrame();
+
+        // Process any completed async loads first
+        processCompletedLoads(pointCloud);
+
+        // Re-select nodes only when the camera or the LOD settings moved enough to matter
+        if (isSelectionStale(pointCloud, cameraPosition)) {
+            renderList.requiredNodes.clear();
+            renderList.drawNodes.clear();
+
+            // Nodes outside the clip volumes are neither loaded nor drawn
+            const std::vector<PointCloudClipVolume>* clipVolumes = pointCloud.clipVolumes.empty() ? nullptr : &pointCloud.clipVolumes;
+            selectRequiredNodes(renderList, nodes, 0, cameraPosition, pointCloud.lodDistances, pointCloud.lodMultiplier, clipVolumes);
+            selectDrawNodes(renderList, nodes, 0, cameraPosition, pointCloud.lodDistances, pointCloud.basePointSize, clipVolumes);
+
+            renderList.cameraPosition = cameraPosition;
+            std::copy(pointCloud.lodDistances, pointCloud.lodDistances + 5, renderList.lodDistances.begin());
+            renderList.lodMultiplier = pointCloud.lodMultiplier;
+            renderList.basePointSize = pointCloud.basePointSize;
+            renderList.clipVolumes = pointCloud.clipVolumes;
+            renderList.pool = nodes.loadInbox;
+            renderList.selectionsRebuilt++;
+        } else {
+            renderList.selectionsReused++;
+        }
+
+        // Keep the selected nodes loaded and uploaded
+        for (uint32_t nodeIndex : renderList.requiredNodes) {
+            nodes.touch(nodeIndex);
+
+            if (nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_PREFETCHED)) {
+                nodes.clearFlag(nodeIndex, PointCloudNodePool::NODE_PREFETCHED);
+                if (nodes.isResident(nodeIndex)) {
+                    nodes.prefetchHits++;
+                } else {
+                    nodes.prefetchLate++;
                 }
             }
 
-            // Upload to GPU
-            glBufferData(GL_ARRAY_BUFFER, 
-                        lodPoints.size() * sizeof(PointCloudPoint), 
-                        lodPoints.data(), 
-                        GL_STATIC_DRAW);
+            makeNodeDrawable(pointCloud, nodeIndex, false);
+        }
 
-            node->lodVBOs[lod] = vbo;
+        buildFrameDraws(pointCloud);
+    }
+
+    void OctreePointCloudManager::makeNodeDrawable(PointCloud& pointCloud, uint32_t nodeIndex, bool prefetch) {
+        PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        if (!nodes.isResident(nodeIndex) && nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_ON_DISK)) {
+            requestAsyncLoad(pointCloud, nodeIndex, prefetch);
+        } else if (nodes.isLoaded(nodeIndex) && !nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_VBOS_GENERATED)) {
+            createVBOsForNode(nodes, nodeIndex);
+            if (!pointCloud.keepCpuCopy) {
+                releaseNodeCpuCopy(pointCloud, nodeIndex);
+            }
         }
+    }
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        node->vbosGenerated = true;
+    size_t OctreePointCloudManager::prefetchView(PointCloud& pointCloud, const glm::vec3& cameraPosition, bool upload, size_t& requiredCount) {
+        requiredCount = 0;
+        if (!pointCloud.hasOctree()) {
+            return 0;
+        }
+
+        PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        nodes.frameCounter = PointCloudResidencyManager::getFrame();
+        processCompletedLoads(pointCloud);
+
+        // Same selection updateLOD would make, kept aside from the cloud's own render list
+        PointCloudRenderList selection;
+        const std::vector<PointCloudClipVolume>* clipVolumes = pointCloud.clipVolumes.empty() ? nullptr : &pointCloud.clipVolumes;
+        selectRequiredNodes(selection, nodes, 0, cameraPosition, pointCloud.lodDistances, pointCloud.lodMultiplier, clipVolumes);
+
+        size_t residentCount = 0;
+        for (uint32_t nodeIndex : selection.requiredNodes) {
+            // Touched so the residency budget keeps the look-ahead like visible data
+            nodes.touch(nodeIndex);
+            if (nodes.isResident(nodeIndex)) {
+                residentCount++;
+            }
+
+            if (upload) {
+                makeNodeDrawable(pointCloud, nodeIndex, true);
+            } else if (!nodes.isResident(nodeIndex) && nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_ON_DISK)) {
+                requestAsyncLoad(pointCloud, nodeIndex, true);
+            }
+        }
+
+        requiredCount = selection.requiredNodes.size();
+        return residentCount;
     }
 
-    void OctreePointCloudManager::updateLOD(PointCloud& pointCloud, const glm::vec3& cameraPosition) {
-        if (!pointCloud.octreeRoot) {
-            return;
+    bool OctreePointCloudManager::isSelectionStale(const PointCloud& pointCloud, const glm::vec3& cameraPosition) {
+        const PointCloudRenderList& renderList = pointCloud.renderList;
+        if (renderList.pool != pointCloud.octreeNodes.loadInbox ||
+            renderList.lodMultiplier != pointCloud.lodMultiplier ||
+            renderList.basePointSize != pointCloud.basePointSize ||
+            renderList.clipVolumes != pointCloud.clipVolumes ||
+            !std::equal(renderList.lodDistances.begin(), renderList.lodDistances.end(), pointCloud.lodDistances)) {
+            return true;
         }
 
-        // Process any completed async loads first
-        processCompletedLoads();
-        
-        // Update nodes that need to be loaded/unloaded based on camera position
-        updateNodeRecursive(
-            pointCloud.octreeRoot.get(),
-            cameraPosition,
-            pointCloud.lodDistances,
-            pointCloud.lodMultiplier,
-            pointCloud.chunkCache.cacheDirectory
-        );
+        // LOD bands are lodDistances apart, so a small fraction of the nearest band is not noticeable
+        float reuseDistance = pointCloud.lodDistances[0] * pointCloud.lodMultiplier * RENDER_LIST_REUSE_FRACTION;
+        return glm::distance(renderList.cameraPosition, cameraPosition) > reuseDistance;
+    }
 
-        // Manage memory usage
-        ensureMemoryLimit(pointCloud);
+    bool OctreePointCloudManager::shouldSubdivideNode(const PointCloudNodePool& nodes, uint32_t nodeIndex, float distance, const float lodDistances[5]) {
+        if (nodes.isLeaf(nodeIndex)) {
+            return false;
+        }
+
+        // For internal nodes, use density and octree structure to make subdivision decisions
+        float baseThreshold = lodDistances[2]; // Middle LOD distance as base
+        
+        // Calculate estimated density for this internal node based on children
+        float halfSize = nodes.halfSize(nodeIndex);
+        float nodeVolume = (halfSize * 2.0f) * (halfSize * 2.0f) * (halfSize * 2.0f);
+        float estimatedDensity = static_cast<float>(nodes.totalPointCount[nodeIndex]) / nodeVolume;
+        
+        // Size-based factor: larger nodes can be rendered at current level from further away
+        float sizeMultiplier = std::max(0.2f, std::min(3.0f, glm::length(glm::vec3(halfSize)) / 5.0f));
+        
+        // Density-based factor: high-density areas benefit more from subdivision
+        float densityMultiplier = 1.0f;
+        if (estimatedDensity > 500.0f) {
+            densityMultiplier = 1.8f; // Subdivide high-density areas more aggressively
+        } else if (estimatedDensity > 100.0f) {
+            densityMultiplier = 1.4f; // Moderate subdivision for medium density
+        } else if (estimatedDensity < 20.0f) {
+            densityMultiplier = 0.6f; // Less subdivision for sparse areas
+        }
+        
+        // Depth factor: deeper nodes represent higher detail, need closer approach
+        float depthMultiplier = 1.0f + (nodes.depth[nodeIndex] * 0.15f);
+        
+        float subdivisionThreshold = baseThreshold * sizeMultiplier * densityMultiplier * depthMultiplier;
+        return distance < subdivisionThreshold;
     }
 
-    void OctreePointCloudManager::updateNodeRecursive(
-        PointCloudOctreeNode* node,
+    void OctreePointCloudManager::selectRequiredNodes(
+        PointCloudRenderList& renderList,
+        const PointCloudNodePool& nodes,
+        uint32_t nodeIndex,
         const glm::vec3& cameraPosition,
         const float lodDistances[5],
         float lodMultiplier,
-        const std::string& cacheDirectory
+        const std::vector<PointCloudClipVolume>* clipVolumes
     ) {
-        if (!node) return;
+        if (nodeIndex >= nodes.size()) return;
+
+        if (!narrowClipVolumes(clipVolumes, nodes, nodeIndex)) {
+            return;
+        }
 
-        float distance = calculateNodeDistance(node, cameraPosition);
+        float distance = calculateNodeDistance(nodes, nodeIndex, cameraPosition);
         float adjustedDistance = distance / lodMultiplier;
         
         // Distance culling - don't process nodes that are too far away
@@ -418,447 +1178,1242 @@ namespace Engine {
         }
 
         // Use the same hierarchical decision logic as rendering
-        bool shouldSubdivide = false;
+        if (shouldSubdivideNode(nodes, nodeIndex, adjustedDistance, lodDistances)) {
+            // Camera is close - we'll render children, so select them
+            uint32_t firstChild = nodes.firstChild[nodeIndex];
+            int childCount = nodes.childCount(nodeIndex);
+            for (int i = 0; i < childCount; i++) {
+                selectRequiredNodes(renderList, nodes, firstChild + i, cameraPosition, lodDistances, lodMultiplier, clipVolumes);
+            }
+        } else if (nodes.totalPointCount[nodeIndex] > 0) {
+            // We'll render at this level - it needs to be loaded
+            renderList.requiredNodes.push_back(nodeIndex);
+        }
+    }
+
+    float OctreePointCloudManager::calculateNodeDistance(const PointCloudNodePool& nodes, uint32_t nodeIndex, const glm::vec3& cameraPos) {
+        // Calculate distance from camera to closest point on the node's bounding box
+        glm::vec3 center = nodes.center(nodeIndex);
+        glm::vec3 halfExtent(nodes.halfSize(nodeIndex));
         
-        if (!node->isLeaf) {
-            // Use same density-aware logic as rendering for consistency
-            float baseThreshold = lodDistances[2];
-            
-            float nodeVolume = (node->bounds.x * 2.0f) * (node->bounds.y * 2.0f) * (node->bounds.z * 2.0f);
-            float estimatedDensity = static_cast<float>(node->totalPointCount) / nodeVolume;
-            
-            float sizeMultiplier = std::max(0.2f, std::min(3.0f, glm::length(node->bounds) / 5.0f));
+        glm::vec3 closest = glm::clamp(cameraPos, center - halfExtent, center + halfExtent);
+        return glm::length(cameraPos - closest);
+    }
+
+    int OctreePointCloudManager::calculateRequiredLOD(float distance, const float lodDistances[5]) {
+        for (int i = 0; i < 5; i++) {
+            if (distance < lodDistances[i]) {
+                return i;
+            }
+        }
+        return 4; // Lowest quality LOD
+    }
+
+    bool OctreePointCloudManager::narrowClipVolumes(const std::vector<PointCloudClipVolume>*& clipVolumes,
+                                                    const PointCloudNodePool& nodes, uint32_t nodeIndex) {
+        if (!clipVolumes) {
+            return true;
+        }
+
+        switch (PointCloudClipVolume::classifyAll(*clipVolumes, nodes.center(nodeIndex), nodes.halfSize(nodeIndex))) {
+        case PointCloudClipVolume::Coverage::Culled:
+            return false;
+        case PointCloudClipVolume::Coverage::Kept:
+            clipVolumes = nullptr; // Nothing below this node needs testing
+            return true;
+        default:
+            return true;
+        }
+    }
+
+    void OctreePointCloudManager::buildFrameDraws(PointCloud& pointCloud) {
+        const PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        PointCloudRenderList& renderList = pointCloud.renderList;
+        uint32_t frame = PointCloudResidencyManager::getFrame();
+
+        // The first cloud of a frame starts the frame's command buffer
+        if (s_frameDrawsFrame != frame) {
+            s_frameCommands.clear();
+            s_frameNodeDraws.clear();
+            s_frameDrawsFrame = frame;
+        }
+        s_frameDrawsUploaded = false;
+
+        s_pendingDraws.clear();
+        for (const PointCloudRenderList::DrawNode& drawNode : renderList.drawNodes) {
+            if (!nodes.hasFlag(drawNode.node, PointCloudNodePool::NODE_VBOS_GENERATED)) continue;
+
+            const PointCloudGpuAllocation& allocation = nodes.gpuAllocations[drawNode.node];
+            uint32_t pointCount = nodes.lodPointCounts[drawNode.node][drawNode.lodLevel];
+            if (!allocation.valid() || pointCount == 0) continue;
+
+            s_pendingDraws.push_back({ allocation.buffer, allocation.first, pointCount, drawNode.pointSize, drawNode.clipped });
+        }
+
+        // One multi-draw per arena buffer
+        std::stable_sort(s_pendingDraws.begin(), s_pendingDraws.end(),
+            [](const PendingDraw& a, const PendingDraw& b) { return a.buffer < b.buffer; });
+
+        renderList.batches.clear();
+        renderList.frame = frame;
+        for (const PendingDraw& draw : s_pendingDraws) {
+            uint32_t commandIndex = static_cast<uint32_t>(s_frameCommands.size());
+            if (renderList.batches.empty() || renderList.batches.back().buffer != draw.buffer) {
+                renderList.batches.push_back({ draw.buffer, commandIndex, 0 });
+            }
+            renderList.batches.back().commandCount++;
+
+            // baseInstance indexes the node draw buffer, gl_DrawID restarts with every multi-draw
+            s_frameCommands.push_back({ draw.count, 1, draw.first, commandIndex });
+            s_frameNodeDraws.push_back({ draw.pointSize, draw.clipped ? 1u : 0u });
+        }
+    }
+
+    void OctreePointCloudManager::renderVisible(PointCloud& pointCloud) {
+        const PointCloudRenderList& renderList = pointCloud.renderList;
+        if (!pointCloud.hasOctree() || renderList.frame != s_frameDrawsFrame || renderList.batches.empty()) {
+            return;
+        }
+
+        if (s_indirectBuffer == 0) {
+            glGenBuffers(1, &s_indirectBuffer);
+            glGenBuffers(1, &s_nodeDrawBuffer);
+        }
+
+        // The commands of every cloud are uploaded once per frame and replayed for each eye
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, s_indirectBuffer);
+        if (!s_frameDrawsUploaded) {
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, s_frameCommands.size() * sizeof(DrawArraysIndirectCommand),
+                         s_frameCommands.data(), GL_STREAM_DRAW);
+
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, s_nodeDrawBuffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, s_frameNodeDraws.size() * sizeof(NodeDrawParams),
+                         s_frameNodeDraws.data(), GL_STREAM_DRAW);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+            s_frameDrawsUploaded = true;
+        }
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, NODE_DRAW_BUFFER_BINDING, s_nodeDrawBuffer);
+
+        // Attribute layout on the bound VAO (position, color, intensity, normal) - matching main.cpp order.
+        // The vertex buffer itself is switched per arena buffer below.
+        glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, 0);
+        glVertexAttribBinding(0, 0);
+        glEnableVertexAttribArray(0);
+
+        glVertexAttribFormat(1, 3, GL_FLOAT, GL_FALSE, offsetof(PointCloudPoint, color));
+        glVertexAttribBinding(1, 0);
+        glEnableVertexAttribArray(1);
+
+        glVertexAttribFormat(2, 1, GL_FLOAT, GL_FALSE, offsetof(PointCloudPoint, intensity));
+        glVertexAttribBinding(2, 0);
+        glEnableVertexAttribArray(2);
+
+        // Octahedral normal, read by the shader from the tangent slot
+        glVertexAttribFormat(3, 2, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(PointCloudPoint, normal));
+        glVertexAttribBinding(3, 0);
+        glEnableVertexAttribArray(3);
+
+        // Per-node point sizes are written by the vertex shader
+        glEnable(GL_PROGRAM_POINT_SIZE);
+
+        for (const PointCloudRenderList::Batch& batch : renderList.batches) {
+            glBindVertexBuffer(0, PointCloudGpuArena::getBuffer(batch.buffer), 0, sizeof(PointCloudPoint));
+            glMultiDrawArraysIndirect(GL_POINTS,
+                                      reinterpret_cast<const void*>(static_cast<size_t>(batch.firstCommand) * sizeof(DrawArraysIndirectCommand)),
+                                      static_cast<GLsizei>(batch.commandCount), 0);
+        }
+
+        glDisable(GL_PROGRAM_POINT_SIZE);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    void OctreePointCloudManager::releaseGpuResources() {
+        if (s_indirectBuffer != 0) {
+            glDeleteBuffers(1, &s_indirectBuffer);
+            glDeleteBuffers(1, &s_nodeDrawBuffer);
+            s_indirectBuffer = 0;
+            s_nodeDrawBuffer = 0;
+        }
+        PointCloudGpuArena::shutdown();
+    }
+
+    void OctreePointCloudManager::selectDrawNodes(
+        PointCloudRenderList& renderList,
+        const PointCloudNodePool& nodes,
+        uint32_t nodeIndex,
+        const glm::vec3& cameraPosition,
+        const float lodDistances[5],
+        float basePointSize,
+        const std::vector<PointCloudClipVolume>* clipVolumes
+    ) {
+        if (nodeIndex >= nodes.size()) {
+            return;
+        }
+
+        if (!narrowClipVolumes(clipVolumes, nodes, nodeIndex)) {
+            return;
+        }
+
+        float distance = calculateNodeDistance(nodes, nodeIndex, cameraPosition);
+        
+        // Hierarchical LOD decision: decide whether to render at this level or subdivide
+        if (shouldSubdivideNode(nodes, nodeIndex, distance, lodDistances)) {
+            // Camera is close enough - draw children for more detail
+            uint32_t firstChild = nodes.firstChild[nodeIndex];
+            int childCount = nodes.childCount(nodeIndex);
+            for (int i = 0; i < childCount; i++) {
+                selectDrawNodes(renderList, nodes, firstChild + i, cameraPosition, lodDistances, basePointSize, clipVolumes);
+            }
+        } else {
+            // Draw at this level with appropriate LOD
+            if (nodes.isLeaf(nodeIndex)) {
+                addDrawNode(renderList, nodes, nodeIndex, distance, lodDistances, basePointSize, clipVolumes != nullptr);
+            } else {
+                // Internal node - draw all leaf descendants with appropriate LOD
+                selectLeafDescendants(renderList, nodes, nodeIndex, distance, lodDistances, basePointSize, clipVolumes);
+            }
+        }
+    }
+    
+    
+    void OctreePointCloudManager::addDrawNode(
+        PointCloudRenderList& renderList,
+        const PointCloudNodePool& nodes,
+        uint32_t nodeIndex,
+        float distance,
+        const float lodDistances[5],
+        float basePointSize,
+        bool clipped
+    ) {
+        // Determine LOD level based on distance - same logic as legacy system
+        int lodLevel = 4;  // Start with lowest detail
+        for (int i = 0; i < 5; ++i) {
+            if (distance < lodDistances[i] * 1.0f) {
+                lodLevel = i;
+                break;
+            }
+        }
+        
+        if (nodes.totalPointCount[nodeIndex] == 0) {
+            return;
+        }
+        
+        // Density-aware point size scaling
+        float nodeSize = nodes.halfSize(nodeIndex) * 2.0f;
+        float nodeVolume = nodeSize * nodeSize * nodeSize;
+        float pointDensity = static_cast<float>(nodes.totalPointCount[nodeIndex]) / nodeVolume;
+        
+        // Base LOD scaling
+        float lodMultiplier = 1.0f + (lodLevel) * 1.2f;
+        
+        // Density-based scaling: high density = larger points to compensate for aggressive reduction
+        float densityMultiplier = 1.0f;
+        if (pointDensity > 1000.0f) {
+            densityMultiplier = 1.8f; // Much larger points for very dense areas
+        } else if (pointDensity > 200.0f) {
+            densityMultiplier = 1.4f; // Larger points for dense areas
+        } else if (pointDensity < 20.0f) {
+            densityMultiplier = 0.8f; // Smaller points for sparse areas (they're already preserved)
+        }
+        
+        float adjustedPointSize = basePointSize * lodMultiplier * densityMultiplier;
+        
+        // Reasonable limits
+        adjustedPointSize = std::min(adjustedPointSize, 25.0f);
+        adjustedPointSize = std::max(adjustedPointSize, 1.0f);
+        
+        renderList.drawNodes.push_back({ nodeIndex, static_cast<uint8_t>(lodLevel), clipped, adjustedPointSize });
+    }
+    
+    void OctreePointCloudManager::selectLeafDescendants(
+        PointCloudRenderList& renderList,
+        const PointCloudNodePool& nodes,
+        uint32_t nodeIndex,
+        float distance,
+        const float lodDistances[5],
+        float basePointSize,
+        const std::vector<PointCloudClipVolume>* clipVolumes
+    ) {
+        // Children are contiguous, so walk the subtree with an explicit stack of index ranges.
+        // Each entry carries the clip volumes still to be tested below it.
+        std::vector<std::pair<uint32_t, const std::vector<PointCloudClipVolume>*>> stack;
+        stack.emplace_back(nodeIndex, clipVolumes);
+        
+        while (!stack.empty()) {
+            auto [current, currentClip] = stack.back();
+            stack.pop_back();
+
+            if (current != nodeIndex && !narrowClipVolumes(currentClip, nodes, current)) {
+                continue;
+            }
             
-            float densityMultiplier = 1.0f;
-            if (estimatedDensity > 500.0f) {
-                densityMultiplier = 1.8f;
-            } else if (estimatedDensity > 100.0f) {
-                densityMultiplier = 1.4f;
-            } else if (estimatedDensity < 20.0f) {
-                densityMultiplier = 0.6f;
+            if (nodes.isLeaf(current)) {
+                addDrawNode(renderList, nodes, current, distance, lodDistances, basePointSize, currentClip != nullptr);
+            } else {
+                // Internal node - push children in reverse so they are visited in order
+                uint32_t firstChild = nodes.firstChild[current];
+                for (int i = nodes.childCount(current) - 1; i >= 0; i--) {
+                    stack.emplace_back(firstChild + i, currentClip);
+                }
             }
+        }
+    }
+
+    size_t OctreePointCloudManager::getMemoryUsage(const PointCloud& pointCloud) {
+        // Resident point data is tracked incrementally by the node pool
+        return pointCloud.octreeNodes.residentBytes;
+    }
+
+    void OctreePointCloudManager::saveToDisk(PointCloud& pointCloud, uint32_t nodeIndex) {
+        PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        const std::vector<PointCloudPoint>* nodePoints = nodes.points(nodeIndex);
+        if (!nodePoints || nodePoints->empty()) return;
+
+        try {
+            std::string filePath = getNodeFilePath(pointCloud.chunkCache.cacheDirectory, nodeIndex);
+            saveNodeToHDF5(*nodePoints, filePath);
             
-            float depthMultiplier = 1.0f + (node->depth * 0.15f);
+            nodes.setFlag(nodeIndex, PointCloudNodePool::NODE_ON_DISK);
             
-            float subdivisionThreshold = baseThreshold * sizeMultiplier * densityMultiplier * depthMultiplier;
-            shouldSubdivide = (adjustedDistance < subdivisionThreshold);
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to save node " << nodeIndex << " to disk: " << e.what() << std::endl;
         }
-        
-        if (shouldSubdivide) {
-            // Camera is close - we'll render children, so update them
-            for (auto& child : node->children) {
-                if (child) {
-                    updateNodeRecursive(child.get(), cameraPosition, lodDistances, lodMultiplier, cacheDirectory);
+    }
+
+    void OctreePointCloudManager::loadFromDisk(PointCloud& pointCloud, uint32_t nodeIndex) {
+        PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        if (nodeIndex >= nodes.size()) return;
+
+        std::cout << "[DEBUG] loadFromDisk() called for node " << nodeIndex 
+                  << ", isOnDisk: " << (nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_ON_DISK) ? "true" : "false")
+                  << ", isLoaded: " << (nodes.isLoaded(nodeIndex) ? "true" : "false") << std::endl;
+                  
+        if (!nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_ON_DISK) || nodes.isLoaded(nodeIndex)) {
+            std::cout << "[DEBUG] Node " << nodeIndex << " not on disk or already loaded, skipping" << std::endl;
+            return;
+        }
+
+        std::string filePath = getNodeFilePath(pointCloud.chunkCache.cacheDirectory, nodeIndex);
+        std::cout << "[DEBUG] Loading node " << nodeIndex << " from file: " << filePath << std::endl;
+
+        std::vector<PointCloudPoint> points;
+        if (!loadNodeFromHDF5(filePath, points)) {
+            std::cerr << "[ERROR] Failed to load node " << nodeIndex << " from disk" << std::endl;
+            return;
+        }
+
+        nodes.setPoints(nodeIndex, std::move(points));
+        nodes.touch(nodeIndex);
+        std::cout << "[DEBUG] Successfully loaded node " << nodeIndex << " from disk with " << nodes.points(nodeIndex)->size() << " points" << std::endl;
+    }
+
+    void OctreePointCloudManager::createCacheDirectory(const std::string& cacheDir) {
+        try {
+            std::filesystem::create_directories(cacheDir);
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to create cache directory: " << e.what() << std::endl;
+        }
+    }
+
+    std::string OctreePointCloudManager::getNodeFilePath(const std::string& cacheDir, uint32_t nodeIndex) {
+        return cacheDir + "/node_" + std::to_string(nodeIndex) + ".h5";
+    }
+
+    void OctreePointCloudManager::collectTreeStats(const PointCloud& pointCloud, PointCloudBuildStats& stats) {
+        const PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        stats.nodeCount = nodes.size();
+        stats.leafCount = 0;
+        stats.storedPoints = 0;
+        stats.nodesPerDepth.clear();
+        stats.leavesPerDepth.clear();
+        stats.pointsPerDepth.clear();
+        stats.leafFillHistogram.assign(PointCloudBuildStats::FILL_BUCKETS, 0);
+        stats.minLeafPoints = std::numeric_limits<uint32_t>::max();
+        stats.maxLeafPoints = 0;
+        stats.leavesAtMaxDepth = 0;
+        stats.overfullLeaves = 0;
+        stats.cachePages = 0;
+        stats.cacheBytes = 0;
+
+        for (uint32_t i = 0; i < nodes.size(); i++) {
+            size_t depth = nodes.depth[i];
+            if (depth >= stats.nodesPerDepth.size()) {
+                stats.nodesPerDepth.resize(depth + 1, 0);
+                stats.leavesPerDepth.resize(depth + 1, 0);
+                stats.pointsPerDepth.resize(depth + 1, 0);
+            }
+            stats.nodesPerDepth[depth]++;
+            if (!nodes.isLeaf(i)) continue;
+
+            uint32_t count = nodes.totalPointCount[i];
+            stats.leafCount++;
+            stats.storedPoints += count;
+            stats.leavesPerDepth[depth]++;
+            stats.pointsPerDepth[depth] += count;
+            stats.minLeafPoints = std::min(stats.minLeafPoints, count);
+            stats.maxLeafPoints = std::max(stats.maxLeafPoints, count);
+            if (static_cast<int>(depth) >= stats.maxOctreeDepth) {
+                stats.leavesAtMaxDepth++;
+            }
+            if (count > stats.maxPointsPerNode) {
+                stats.overfullLeaves++;
+            }
+            size_t bucket = stats.maxPointsPerNode > 0 ? size_t(count) * PointCloudBuildStats::FILL_BUCKETS / stats.maxPointsPerNode : 0;
+            stats.leafFillHistogram[std::min<size_t>(bucket, PointCloudBuildStats::FILL_BUCKETS - 1)]++;
+
+            if (nodes.hasFlag(i, PointCloudNodePool::NODE_ON_DISK)) {
+                std::error_code error;
+                uintmax_t size = std::filesystem::file_size(getNodeFilePath(pointCloud.chunkCache.cacheDirectory, i), error);
+                if (!error) {
+                    stats.cachePages++;
+                    stats.cacheBytes += size;
                 }
             }
+        }
+        if (stats.leafCount == 0) {
+            stats.minLeafPoints = 0;
+        }
+    }
+
+    bool OctreePointCloudManager::saveBuildStats(const PointCloudBuildStats& stats, const std::string& cacheDir) {
+        json j;
+        j["maxOctreeDepth"] = stats.maxOctreeDepth;
+        j["maxPointsPerNode"] = stats.maxPointsPerNode;
+        j["inputPoints"] = stats.inputPoints;
+        j["storedPoints"] = stats.storedPoints;
+        j["duplicatesRemoved"] = stats.duplicatesRemoved;
+        j["outliersRemoved"] = stats.outliersRemoved;
+        j["normalsEstimated"] = stats.normalsEstimated;
+        j["nodeCount"] = stats.nodeCount;
+        j["leafCount"] = stats.leafCount;
+        j["nodesPerDepth"] = stats.nodesPerDepth;
+        j["leavesPerDepth"] = stats.leavesPerDepth;
+        j["pointsPerDepth"] = stats.pointsPerDepth;
+        j["leafFillHistogram"] = stats.leafFillHistogram;
+        j["minLeafPoints"] = stats.minLeafPoints;
+        j["maxLeafPoints"] = stats.maxLeafPoints;
+        j["leavesAtMaxDepth"] = stats.leavesAtMaxDepth;
+        j["overfullLeaves"] = stats.overfullLeaves;
+        j["cachePages"] = stats.cachePages;
+        j["cacheBytes"] = stats.cacheBytes;
+        j["partitionSeconds"] = stats.partitionSeconds;
+        j["cleanupSeconds"] = stats.cleanupSeconds;
+        j["pageSeconds"] = stats.pageSeconds;
+        j["normalCpuSeconds"] = stats.normalCpuSeconds;
+        j["encodeCpuSeconds"] = stats.encodeCpuSeconds;
+        j["buildSeconds"] = stats.buildSeconds;
+
+        std::ofstream file(cacheDir + "/build_stats.json");
+        if (!file.is_open()) {
+            std::cerr << "Failed to write build statistics to " << cacheDir << std::endl;
+            return false;
+        }
+        file << j.dump(4);
+        return true;
+    }
+
+    bool OctreePointCloudManager::loadBuildStats(const std::string& cacheDir, PointCloudBuildStats& stats) {
+        std::ifstream file(cacheDir + "/build_stats.json");
+        if (!file.is_open()) {
+            return false;
+        }
+
+        try {
+            json j = json::parse(file);
+            stats = PointCloudBuildStats();
+            stats.maxOctreeDepth = j.value("maxOctreeDepth", 0);
+            stats.maxPointsPerNode = j.value("maxPointsPerNode", size_t(0));
+            stats.inputPoints = j.value("inputPoints", size_t(0));
+            stats.storedPoints = j.value("storedPoints", size_t(0));
+            stats.duplicatesRemoved = j.value("duplicatesRemoved", size_t(0));
+            stats.outliersRemoved = j.value("outliersRemoved", size_t(0));
+            stats.normalsEstimated = j.value("normalsEstimated", size_t(0));
+            stats.nodeCount = j.value("nodeCount", 0u);
+            stats.leafCount = j.value("leafCount", 0u);
+            stats.nodesPerDepth = j.value("nodesPerDepth", std::vector<uint32_t>());
+            stats.leavesPerDepth = j.value("leavesPerDepth", std::vector<uint32_t>());
+            stats.pointsPerDepth = j.value("pointsPerDepth", std::vector<uint64_t>());
+            stats.leafFillHistogram = j.value("leafFillHistogram", std::vector<uint32_t>());
+            stats.minLeafPoints = j.value("minLeafPoints", 0u);
+            stats.maxLeafPoints = j.value("maxLeafPoints", 0u);
+            stats.leavesAtMaxDepth = j.value("leavesAtMaxDepth", 0u);
+            stats.overfullLeaves = j.value("overfullLeaves", 0u);
+            stats.cachePages = j.value("cachePages", 0u);
+            stats.cacheBytes = j.value("cacheBytes", uint64_t(0));
+            stats.partitionSeconds = j.value("partitionSeconds", 0.0f);
+            stats.cleanupSeconds = j.value("cleanupSeconds", 0.0f);
+            stats.pageSeconds = j.value("pageSeconds", 0.0f);
+            stats.normalCpuSeconds = j.value("normalCpuSeconds", 0.0f);
+            stats.encodeCpuSeconds = j.value("encodeCpuSeconds", 0.0f);
+            stats.buildSeconds = j.value("buildSeconds", 0.0f);
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to read build statistics from " << cacheDir << ": " << e.what() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void OctreePointCloudManager::printBuildStats(const PointCloudBuildStats& stats, std::ostream& out) {
+        out << "Parameters: max depth " << stats.maxOctreeDepth << ", max points per node " << stats.maxPointsPerNode << "\n";
+        out << "Points: " << stats.inputPoints << " input, " << stats.storedPoints << " stored, "
+            << stats.duplicatesRemoved << " duplicates and " << stats.outliersRemoved << " outliers removed, "
+            << stats.normalsEstimated << " normals estimated\n";
+        out << "Nodes: " << stats.nodeCount << ", leaves " << stats.leafCount << ", " << stats.leavesAtMaxDepth
+            << " at the depth limit, " << stats.overfullLeaves << " over max points per node\n";
+        out << "Leaf points: min " << stats.minLeafPoints << ", mean " << std::fixed << std::setprecision(1)
+            << stats.meanLeafPoints() << ", max " << stats.maxLeafPoints << "\n";
+
+        out << "Depth     Nodes    Leaves        Points\n";
+        for (size_t depth = 0; depth < stats.nodesPerDepth.size(); depth++) {
+            out << std::setw(5) << depth << std::setw(10) << stats.nodesPerDepth[depth]
+                << std::setw(10) << (depth < stats.leavesPerDepth.size() ? stats.leavesPerDepth[depth] : 0)
+                << std::setw(14) << (depth < stats.pointsPerDepth.size() ? stats.pointsPerDepth[depth] : 0) << "\n";
+        }
+
+        out << "Leaf fill:";
+        int buckets = static_cast<int>(stats.leafFillHistogram.size());
+        for (int i = 0; i < buckets; i++) {
+            out << " " << (i * 100 / buckets) << (i + 1 == buckets ? "%+: " : "%: ") << stats.leafFillHistogram[i];
+        }
+        out << "\n";
+
+        out << "Cache: " << stats.cachePages << " pages, " << std::setprecision(1) << (stats.cacheBytes / (1024.0 * 1024.0)) << " MB, "
+            << std::setprecision(2) << (stats.storedPoints > 0 ? static_cast<double>(stats.cacheBytes) / stats.storedPoints : 0.0)
+            << " bytes per point\n";
+        out << "Time: partition " << stats.partitionSeconds << " s, cleanup " << stats.cleanupSeconds << " s, pages "
+            << stats.pageSeconds << " s (normals " << stats.normalCpuSeconds << " CPU s, encode and write "
+            << stats.encodeCpuSeconds << " CPU s), total " << stats.buildSeconds << " s" << std::endl;
+        out << std::defaultfloat << std::setprecision(6);
+    }
+
+    int OctreePointCloudManager::inspectCache(const std::string& cacheDir, bool readPages) {
+        if (!std::filesystem::is_directory(cacheDir)) {
+            std::cerr << "Not a node cache directory: " << cacheDir << std::endl;
+            return 1;
+        }
+
+        std::cout << "Node cache " << cacheDir << std::endl;
+        PointCloudBuildStats stats;
+        bool hasStats = loadBuildStats(cacheDir, stats);
+        if (hasStats) {
+            printBuildStats(stats, std::cout);
         } else {
-            // We'll render at this level - ensure it's loaded
-            if (node->totalPointCount > 0) {
-                markNodeAccessed(node);
+            std::cout << "No build statistics recorded" << std::endl;
+        }
+
+        std::vector<std::filesystem::path> pagePaths;
+        uint64_t pageBytes = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(cacheDir)) {
+            std::string name = entry.path().filename().string();
+            if (entry.is_regular_file() && name.rfind("node_", 0) == 0 && entry.path().extension() == ".h5") {
+                pagePaths.push_back(entry.path());
+                pageBytes += entry.file_size();
+            }
+        }
+        std::cout << "On disk: " << pagePaths.size() << " pages, " << (pageBytes / (1024 * 1024)) << " MB" << std::endl;
+        // All clouds without their own directory share the default cache, so a later build
+        // may have replaced some of the pages
+        if (hasStats && (pagePaths.size() != stats.cachePages || pageBytes != stats.cacheBytes)) {
+            std::cout << "Warning: the pages on disk do not match the recorded build" << std::endl;
+        }
+
+        if (!readPages) {
+            return 0;
+        }
+
+        size_t totalPoints = 0;
+        size_t minPoints = std::numeric_limits<size_t>::max();
+        size_t maxPoints = 0;
+        size_t failed = 0;
+        for (const auto& path : pagePaths) {
+            std::vector<PointCloudPoint> points;
+            if (!loadNodeFromHDF5(path.string(), points)) {
+                std::cerr << "Failed to read page " << path.string() << std::endl;
+                failed++;
+                continue;
+            }
+            totalPoints += points.size();
+            minPoints = std::min(minPoints, points.size());
+            maxPoints = std::max(maxPoints, points.size());
+        }
+
+        size_t readCount = pagePaths.size() - failed;
+        std::cout << "Decoded " << readCount << " pages with " << totalPoints << " points (min "
+                  << (readCount > 0 ? minPoints : 0) << ", mean " << (readCount > 0 ? totalPoints / readCount : 0)
+                  << ", max " << maxPoints << " per page), " << failed << " unreadable" << std::endl;
+        if (hasStats && totalPoints != stats.storedPoints) {
+            std::cout << "Warning: the pages hold " << totalPoints << " points, the build stored " << stats.storedPoints << std::endl;
+        }
+        return failed > 0 ? 1 : 0;
+    }
+
+    void OctreePointCloudManager::saveNodeToHDF5(const std::vector<PointCloudPoint>& points, const std::string& filePath) {
+        // Encode outside the HDF5 lock, the file only stores the compressed page
+        std::vector<uint8_t> encoded;
+        PointCloudCodec::encode(points, encoded);
+
+        std::lock_guard<std::mutex> hdf5Lock(s_hdf5Mutex);
+        H5::H5File file(filePath, H5F_ACC_TRUNC);
+
+        hsize_t dims[1] = { encoded.size() };
+        H5::DataSpace dataspace(1, dims);
+
+        H5::DataSet dataset = file.createDataSet("encoded_points", H5::PredType::NATIVE_UINT8, dataspace);
+        dataset.write(encoded.data(), H5::PredType::NATIVE_UINT8);
+
+        file.close();
+    }
+
+    bool OctreePointCloudManager::loadNodeFromHDF5(const std::string& filePath, std::vector<PointCloudPoint>& points) {
+        if (filePath.empty() || !std::filesystem::exists(filePath)) {
+            return false;
+        }
+        
+        std::vector<uint8_t> encoded;
+        try {
+            std::lock_guard<std::mutex> hdf5Lock(s_hdf5Mutex);
+            H5::H5File file(filePath, H5F_ACC_RDONLY);
+
+            if (file.nameExists("encoded_points")) {
+                H5::DataSet dataset = file.openDataSet("encoded_points");
+                hsize_t dims[1];
+                dataset.getSpace().getSimpleExtentDims(dims, NULL);
+
+                encoded.resize(dims[0]);
+                dataset.read(encoded.data(), H5::PredType::NATIVE_UINT8);
+            } else {
+                // Pages written before the codec store the raw compound points
+                H5::DataSet dataset = file.openDataSet("points");
+                H5::DataSpace dataspace = dataset.getSpace();
                 
-                if (!node->isLoaded && node->isOnDisk) {
-                    requestAsyncLoad(node, cacheDirectory);
-                } else if (node->isLoaded && !node->vbosGenerated) {
-                    createVBOsForNode(node);
-                }
+                // Get dimensions
+                hsize_t dims[1];
+                dataspace.getSimpleExtentDims(dims, NULL);
+                
+                // Resize points vector and read data
+                points.resize(dims[0]);
+                
+                // Create compound datatype
+                H5::CompType pointType(sizeof(PointCloudPoint));
+                pointType.insertMember("position_x", HOFFSET(PointCloudPoint, position.x), H5::PredType::NATIVE_FLOAT);
+                pointType.insertMember("position_y", HOFFSET(PointCloudPoint, position.y), H5::PredType::NATIVE_FLOAT);
+                pointType.insertMember("position_z", HOFFSET(PointCloudPoint, position.z), H5::PredType::NATIVE_FLOAT);
+                pointType.insertMember("intensity", HOFFSET(PointCloudPoint, intensity), H5::PredType::NATIVE_FLOAT);
+                pointType.insertMember("color_r", HOFFSET(PointCloudPoint, color.r), H5::PredType::NATIVE_FLOAT);
+                pointType.insertMember("color_g", HOFFSET(PointCloudPoint, color.g), H5::PredType::NATIVE_FLOAT);
+                pointType.insertMember("color_b", HOFFSET(PointCloudPoint, color.b), H5::PredType::NATIVE_FLOAT);
+                
+                dataset.read(points.data(), pointType);
+                
+                file.close();
+                return true;
             }
+
+            file.close();
+            
+        } catch (const std::exception& e) {
+            // Silent failure - just don't load the node
+            points.clear();
+            return false;
         }
+
+        // Decode after releasing the HDF5 lock so loader workers decode in parallel
+        if (!PointCloudCodec::decode(encoded.data(), encoded.size(), points)) {
+            std::cerr << "Corrupt point cloud page: " << filePath << std::endl;
+            points.clear();
+            return false;
+        }
+        return true;
     }
 
-    float OctreePointCloudManager::calculateNodeDistance(const PointCloudOctreeNode* node, const glm::vec3& cameraPos) {
-        // Calculate distance from camera to closest point on the node's bounding box
-        glm::vec3 nodeMin = node->center - node->bounds;
-        glm::vec3 nodeMax = node->center + node->bounds;
+    void OctreePointCloudManager::unloadNode(PointCloud& pointCloud, uint32_t nodeIndex) {
+        PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        if (!nodes.isResident(nodeIndex)) {
+            return;
+        }
+
+        // Save to disk first if not already saved
+        if (nodes.isLoaded(nodeIndex) && !nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_ON_DISK)) {
+            saveToDisk(pointCloud, nodeIndex);
+        }
         
-        glm::vec3 closest = glm::clamp(cameraPos, nodeMin, nodeMax);
-        return glm::length(cameraPos - closest);
+        // Clean up VBOs and unload from memory
+        nodes.releaseVBOs(nodeIndex);
+        nodes.releasePoints(nodeIndex);
+        nodes.clearFlag(nodeIndex, PointCloudNodePool::NODE_PREFETCHED);
     }
 
-    int OctreePointCloudManager::calculateRequiredLOD(float distance, const float lodDistances[5]) {
-        for (int i = 0; i < 5; i++) {
-            if (distance < lodDistances[i]) {
-                return i;
+    void OctreePointCloudManager::releaseNodeCpuCopy(PointCloud& pointCloud, uint32_t nodeIndex) {
+        PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        auto page = nodes.sharedPoints(nodeIndex);
+        if (!page) {
+            return;
+        }
+
+        // The page cache file is the only way back once the CPU copy is gone
+        if (!nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_ON_DISK)) {
+            saveToDisk(pointCloud, nodeIndex);
+            if (!nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_ON_DISK)) {
+                return;
             }
         }
-        return 4; // Lowest quality LOD
+
+        nodes.releasePoints(nodeIndex);
+        storeCachedPage(nodes, nodeIndex, std::move(page));
+        if (!nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_VBOS_GENERATED)) {
+            nodes.clearFlag(nodeIndex, PointCloudNodePool::NODE_PREFETCHED);
+        }
     }
 
-    void OctreePointCloudManager::renderVisible(PointCloud& pointCloud, const glm::vec3& cameraPosition) {
-        if (!pointCloud.octreeRoot) {
+    void OctreePointCloudManager::releaseNodeGpuCopy(PointCloud& pointCloud, uint32_t nodeIndex) {
+        PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        if (!nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_VBOS_GENERATED)) {
             return;
         }
 
-        renderNodeRecursive(
-            pointCloud.octreeRoot.get(),
-            cameraPosition,
-            pointCloud.lodDistances,
-            pointCloud.basePointSize
-        );
+        nodes.releaseVBOs(nodeIndex);
+        if (!nodes.isLoaded(nodeIndex)) {
+            nodes.clearFlag(nodeIndex, PointCloudNodePool::NODE_PREFETCHED);
+        }
     }
 
-    void OctreePointCloudManager::renderNodeRecursive(
-        PointCloudOctreeNode* node,
-        const glm::vec3& cameraPosition,
-        const float lodDistances[5],
-        float basePointSize
-    ) {
-        if (!node) {
+    std::shared_ptr<const std::vector<PointCloudPoint>> OctreePointCloudManager::findCachedPage(const PointCloudNodePool& nodes, uint32_t nodeIndex) {
+        std::lock_guard<std::mutex> lock(s_pageCacheMutex);
+        auto it = s_pageCacheIndex.find(PageKey(nodes.loadInbox.get(), nodeIndex));
+        if (it == s_pageCacheIndex.end()) {
+            return nullptr;
+        }
+
+        s_pageCache.splice(s_pageCache.begin(), s_pageCache, it->second);
+        return it->second->points;
+    }
+
+    void OctreePointCloudManager::storeCachedPage(const PointCloudNodePool& nodes, uint32_t nodeIndex, std::shared_ptr<const std::vector<PointCloudPoint>> points) {
+        if (!points || !nodes.loadInbox) {
             return;
         }
 
-        float distance = calculateNodeDistance(node, cameraPosition);
-        
-        // Hierarchical LOD decision: decide whether to render at this level or subdivide
-        bool shouldSubdivide = false;
-        
-        if (!node->isLeaf) {
-            // For internal nodes, use density and octree structure to make subdivision decisions
-            float baseThreshold = lodDistances[2]; // Middle LOD distance as base
-            
-            // Calculate estimated density for this internal node based on children
-            float nodeVolume = (node->bounds.x * 2.0f) * (node->bounds.y * 2.0f) * (node->bounds.z * 2.0f);
-            float estimatedDensity = static_cast<float>(node->totalPointCount) / nodeVolume;
-            
-            // Size-based factor: larger nodes can be rendered at current level from further away
-            float sizeMultiplier = std::max(0.2f, std::min(3.0f, glm::length(node->bounds) / 5.0f));
-            
-            // Density-based factor: high-density areas benefit more from subdivision
-            float densityMultiplier = 1.0f;
-            if (estimatedDensity > 500.0f) {
-                densityMultiplier = 1.8f; // Subdivide high-density areas more aggressively
-            } else if (estimatedDensity > 100.0f) {
-                densityMultiplier = 1.4f; // Moderate subdivision for medium density
-            } else if (estimatedDensity < 20.0f) {
-                densityMultiplier = 0.6f; // Less subdivision for sparse areas
-            }
-            
-            // Depth factor: deeper nodes represent higher detail, need closer approach
-            float depthMultiplier = 1.0f + (node->depth * 0.15f);
-            
-            float subdivisionThreshold = baseThreshold * sizeMultiplier * densityMultiplier * depthMultiplier;
-            shouldSubdivide = (distance < subdivisionThreshold);
+        std::lock_guard<std::mutex> lock(s_pageCacheMutex);
+        PageKey key(nodes.loadInbox.get(), nodeIndex);
+        auto existing = s_pageCacheIndex.find(key);
+        if (existing != s_pageCacheIndex.end()) {
+            s_pageCacheBytes -= existing->second->points->size() * sizeof(PointCloudPoint);
+            s_pageCache.erase(existing->second);
+            s_pageCacheIndex.erase(existing);
         }
-        
-        if (shouldSubdivide) {
-            // Camera is close enough - render children for more detail
-            for (auto& child : node->children) {
-                if (child) {
-                    renderNodeRecursive(child.get(), cameraPosition, lodDistances, basePointSize);
-                }
-            }
-        } else {
-            // Render at this level with appropriate LOD
-            if (node->isLeaf) {
-                // Leaf node - render directly if loaded
-                if (node->isLoaded && node->vbosGenerated) {
-                    renderNodeAtLOD(node, distance, lodDistances, basePointSize);
-                }
-            } else {
-                // Internal node - render all leaf descendants with appropriate LOD
-                renderLeafDescendants(node, distance, lodDistances, basePointSize);
-            }
+
+        s_pageCacheBytes += points->size() * sizeof(PointCloudPoint);
+        s_pageCache.push_front({ nodes.loadInbox, nodeIndex, std::move(points) });
+        s_pageCacheIndex[key] = s_pageCache.begin();
+
+        // Drop least recently used pages
+        while (s_pageCacheBytes > PAGE_CACHE_BUDGET && !s_pageCache.empty()) {
+            const CachedPage& oldest = s_pageCache.back();
+            s_pageCacheBytes -= oldest.points->size() * sizeof(PointCloudPoint);
+            s_pageCacheIndex.erase(PageKey(oldest.owner.get(), oldest.nodeIndex));
+            s_pageCache.pop_back();
         }
     }
-    
-    
-    void OctreePointCloudManager::renderNodeAtLOD(
-        PointCloudOctreeNode* node,
-        float distance,
-        const float lodDistances[5],
-        float basePointSize
-    ) {
-        // Determine LOD level based on distance - same logic as legacy system
-        int lodLevel = 4;  // Start with lowest detail
-        for (int i = 0; i < 5; ++i) {
-            if (distance < lodDistances[i] * 1.0f) {
-                lodLevel = i;
-                break;
-            }
-        }
+
+    void OctreePointCloudManager::unloadOldestNodes(PointCloud& pointCloud, size_t targetMemoryMB) {
+        PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        size_t targetMemoryBytes = targetMemoryMB * 1024 * 1024;
+        size_t currentMemory = getMemoryUsage(pointCloud);
         
-        if (node->lodVBOs[lodLevel] == 0 || node->lodPointCounts[lodLevel] == 0) {
+        if (nodes.empty() || currentMemory <= targetMemoryBytes) {
             return;
         }
         
-        // Bind and render this LOD level
-        glBindBuffer(GL_ARRAY_BUFFER, node->lodVBOs[lodLevel]);
-        
-        // Set up vertex attributes (position, color, intensity) - matching main.cpp order
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PointCloudPoint), (void*)0);
-        glEnableVertexAttribArray(0);
-        
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(PointCloudPoint), (void*)offsetof(PointCloudPoint, color));
-        glEnableVertexAttribArray(1);
-        
-        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(PointCloudPoint), (void*)offsetof(PointCloudPoint, intensity));
-        glEnableVertexAttribArray(2);
-        
-        // Density-aware point size scaling
-        float nodeVolume = (node->bounds.x * 2.0f) * (node->bounds.y * 2.0f) * (node->bounds.z * 2.0f);
-        float pointDensity = static_cast<float>(node->points.size()) / nodeVolume;
-        
-        // Base LOD scaling
-        float lodMultiplier = 1.0f + (lodLevel) * 1.2f;
+        std::cout << "Unloading nodes to reduce memory from " << (currentMemory / (1024 * 1024)) 
+                  << "MB to target " << targetMemoryMB << "MB" << std::endl;
         
-        // Density-based scaling: high density = larger points to compensate for aggressive reduction
-        float densityMultiplier = 1.0f;
-        if (pointDensity > 1000.0f) {
-            densityMultiplier = 1.8f; // Much larger points for very dense areas
-        } else if (pointDensity > 200.0f) {
-            densityMultiplier = 1.4f; // Larger points for dense areas
-        } else if (pointDensity < 20.0f) {
-            densityMultiplier = 0.8f; // Smaller points for sparse areas (they're already preserved)
+        // Collect all resident nodes with their last access frame
+        std::vector<std::pair<uint32_t, uint32_t>> nodesByAge;
+        nodesByAge.reserve(nodes.residentPoints.size());
+        for (const auto& entry : nodes.residentPoints) {
+            nodesByAge.emplace_back(nodes.lastAccessedFrame[entry.first], entry.first);
         }
         
-        float adjustedPointSize = basePointSize * lodMultiplier * densityMultiplier;
-        
-        // Reasonable limits
-        adjustedPointSize = std::min(adjustedPointSize, 25.0f);
-        adjustedPointSize = std::max(adjustedPointSize, 1.0f);
+        // Sort by access time (oldest first)
+        std::sort(nodesByAge.begin(), nodesByAge.end());
         
-        glPointSize(adjustedPointSize);
+        // Unload oldest nodes until we reach target memory
+        size_t unloadedCount = 0;
+        for (auto& [accessFrame, nodeIndex] : nodesByAge) {
+            if (getMemoryUsage(pointCloud) <= targetMemoryBytes) {
+                break;
+            }
+            
+            unloadNode(pointCloud, nodeIndex);
+            unloadedCount++;
+        }
         
-        // Render points
-        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(node->lodPointCounts[lodLevel]));
+        std::cout << "Unloaded " << unloadedCount << " nodes, memory after cleanup: " << (getMemoryUsage(pointCloud) / (1024 * 1024)) << "MB" << std::endl;
     }
-    
-    void OctreePointCloudManager::renderLeafDescendants(
-        PointCloudOctreeNode* node,
-        float distance,
-        const float lodDistances[5],
-        float basePointSize
-    ) {
-        if (!node) return;
-        
-        if (node->isLeaf) {
-            // Found a leaf - render it if loaded
-            if (node->isLoaded && node->vbosGenerated) {
-                renderNodeAtLOD(node, distance, lodDistances, basePointSize);
-            }
-        } else {
-            // Internal node - recurse to children
-            for (auto& child : node->children) {
-                if (child) {
-                    renderLeafDescendants(child.get(), distance, lodDistances, basePointSize);
+
+    // Spatial queries
+    std::shared_ptr<const std::vector<PointCloudPoint>> OctreePointCloudManager::acquireNodePoints(const PointCloud& pointCloud, uint32_t nodeIndex) {
+        auto page = pointCloud.octreeNodes.sharedPoints(nodeIndex);
+        if (page) {
+            return page;
+        }
+
+        page = findCachedPage(pointCloud.octreeNodes, nodeIndex);
+        if (page) {
+            return page;
+        }
+
+        // Not resident - re-stream it from the node cache for this query, the render thread owns residency
+        std::vector<PointCloudPoint> points;
+        if (!loadNodeFromHDF5(getNodeFilePath(pointCloud.chunkCache.cacheDirectory, nodeIndex), points)) {
+            return nullptr;
+        }
+        page = std::make_shared<const std::vector<PointCloudPoint>>(std::move(points));
+        storeCachedPage(pointCloud.octreeNodes, nodeIndex, page);
+        return page;
+    }
+
+    float OctreePointCloudManager::nodeDistanceSquared(const PointCloudNodePool& nodes, uint32_t nodeIndex, const glm::vec3& position) {
+        glm::vec3 center = nodes.center(nodeIndex);
+        glm::vec3 halfExtent(nodes.halfSize(nodeIndex));
+        glm::vec3 delta = glm::max(glm::abs(position - center) - halfExtent, glm::vec3(0.0f));
+        return glm::dot(delta, delta);
+    }
+
+    bool OctreePointCloudManager::intersectNodeRay(const PointCloudNodePool& nodes, uint32_t nodeIndex, const glm::vec3& origin,
+                                                   const glm::vec3& inverseDirection, float padding, float& tEnter, float& tExit) {
+        glm::vec3 boxMin = nodes.center(nodeIndex) - glm::vec3(nodes.halfSize(nodeIndex) + padding);
+        glm::vec3 boxMax = nodes.center(nodeIndex) + glm::vec3(nodes.halfSize(nodeIndex) + padding);
+
+        tEnter = 0.0f;
+        tExit = std::numeric_limits<float>::max();
+        for (int axis = 0; axis < 3; axis++) {
+            // A ray parallel to the slab never crosses its planes, and an origin on one of them
+            // would give 0 * inf = NaN below: it is inside the slab for its whole length or never
+            if (std::isinf(inverseDirection[axis])) {
+                if (origin[axis] < boxMin[axis] || origin[axis] > boxMax[axis]) {
+                    return false;
                 }
+                continue;
             }
+            float t0 = (boxMin[axis] - origin[axis]) * inverseDirection[axis];
+            float t1 = (boxMax[axis] - origin[axis]) * inverseDirection[axis];
+            tEnter = std::max(tEnter, std::min(t0, t1));
+            tExit = std::min(tExit, std::max(t0, t1));
         }
+        return tEnter <= tExit;
     }
 
-    void OctreePointCloudManager::ensureMemoryLimit(PointCloud& pointCloud) {
-        size_t currentMemoryMB = getMemoryUsage(pointCloud) / (1024 * 1024);
-        
-        if (currentMemoryMB > pointCloud.chunkCache.maxMemoryMB) {
-            std::cout << "Memory limit exceeded (" << currentMemoryMB << "MB > " << pointCloud.chunkCache.maxMemoryMB << "MB), unloading nodes..." << std::endl;
-            unloadOldestNodes(pointCloud, pointCloud.chunkCache.maxMemoryMB * 0.8f); // Target 80% of limit
+    void OctreePointCloudManager::computeDistancesSquared(const PointCloudPoint* points, size_t count, const glm::vec3& position, float* distancesSquared) {
+        size_t i = 0;
+#ifdef OCTREE_QUERY_SSE
+        const __m128 px = _mm_set1_ps(position.x);
+        const __m128 py = _mm_set1_ps(position.y);
+        const __m128 pz = _mm_set1_ps(position.z);
+        for (; i + 4 <= count; i += 4) {
+            // Each load covers position.xyz + intensity, transpose to x/y/z lanes
+            __m128 r0 = _mm_loadu_ps(&points[i].position.x);
+            __m128 r1 = _mm_loadu_ps(&points[i + 1].position.x);
+            __m128 r2 = _mm_loadu_ps(&points[i + 2].position.x);
+            __m128 r3 = _mm_loadu_ps(&points[i + 3].position.x);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+            __m128 dx = _mm_sub_ps(r0, px);
+            __m128 dy = _mm_sub_ps(r1, py);
+            __m128 dz = _mm_sub_ps(r2, pz);
+            __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            _mm_storeu_ps(distancesSquared + i, d2);
+        }
+#endif
+        for (; i < count; i++) {
+            glm::vec3 delta = points[i].position - position;
+            distancesSquared[i] = glm::dot(delta, delta);
         }
     }
 
-    size_t OctreePointCloudManager::getMemoryUsage(const PointCloud& pointCloud) {
-        size_t totalMemory = 0;
-        if (pointCloud.octreeRoot) {
-            collectMemoryUsage(pointCloud.octreeRoot.get(), totalMemory);
+    void OctreePointCloudManager::computeRayDistances(const PointCloudPoint* points, size_t count, const glm::vec3& origin,
+                                                      const glm::vec3& direction, float* alongRay, float* perpendicularSquared) {
+        size_t i = 0;
+#ifdef OCTREE_QUERY_SSE
+        const __m128 ox = _mm_set1_ps(origin.x);
+        const __m128 oy = _mm_set1_ps(origin.y);
+        const __m128 oz = _mm_set1_ps(origin.z);
+        const __m128 dx = _mm_set1_ps(direction.x);
+        const __m128 dy = _mm_set1_ps(direction.y);
+        const __m128 dz = _mm_set1_ps(direction.z);
+        for (; i + 4 <= count; i += 4) {
+            __m128 r0 = _mm_loadu_ps(&points[i].position.x);
+            __m128 r1 = _mm_loadu_ps(&points[i + 1].position.x);
+            __m128 r2 = _mm_loadu_ps(&points[i + 2].position.x);
+            __m128 r3 = _mm_loadu_ps(&points[i + 3].position.x);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+            __m128 vx = _mm_sub_ps(r0, ox);
+            __m128 vy = _mm_sub_ps(r1, oy);
+            __m128 vz = _mm_sub_ps(r2, oz);
+            __m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, dx), _mm_mul_ps(vy, dy)), _mm_mul_ps(vz, dz));
+            __m128 v2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+            _mm_storeu_ps(alongRay + i, t);
+            _mm_storeu_ps(perpendicularSquared + i, _mm_max_ps(_mm_sub_ps(v2, _mm_mul_ps(t, t)), _mm_setzero_ps()));
+        }
+#endif
+        for (; i < count; i++) {
+            glm::vec3 v = points[i].position - origin;
+            float t = glm::dot(v, direction);
+            alongRay[i] = t;
+            perpendicularSquared[i] = std::max(glm::dot(v, v) - t * t, 0.0f);
         }
-        return totalMemory;
     }
 
-    void OctreePointCloudManager::collectMemoryUsage(PointCloudOctreeNode* node, size_t& totalMemory) {
-        if (!node) return;
-        
-        if (node->isLoaded) {
-            totalMemory += node->memoryUsage;
+    std::vector<PointCloudPoint> OctreePointCloudManager::queryBox(const PointCloud& pointCloud, const glm::vec3& boxMin, const glm::vec3& boxMax) {
+        std::vector<PointCloudPoint> result;
+
+        auto collect = [&](const std::vector<PointCloudPoint>& points) {
+            for (const auto& point : points) {
+                if (glm::all(glm::greaterThanEqual(point.position, boxMin)) && glm::all(glm::lessThanEqual(point.position, boxMax))) {
+                    result.push_back(point);
+                }
+            }
+        };
+
+        if (!pointCloud.hasOctree()) {
+            collect(pointCloud.points);
+            return result;
         }
-        
-        for (auto& child : node->children) {
-            if (child) {
-                collectMemoryUsage(child.get(), totalMemory);
+
+        const PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        std::vector<uint32_t> stack = { 0 };
+        while (!stack.empty()) {
+            uint32_t nodeIndex = stack.back();
+            stack.pop_back();
+
+            if (nodes.totalPointCount[nodeIndex] == 0) continue;
+
+            glm::vec3 nodeMin = nodes.center(nodeIndex) - glm::vec3(nodes.halfSize(nodeIndex));
+            glm::vec3 nodeMax = nodes.center(nodeIndex) + glm::vec3(nodes.halfSize(nodeIndex));
+            if (glm::any(glm::greaterThan(nodeMin, boxMax)) || glm::any(glm::lessThan(nodeMax, boxMin))) {
+                continue;
+            }
+
+            // childMask is fixed after the build, unlike flags which the render thread updates
+            if (nodes.childMask[nodeIndex] != 0) {
+                for (int i = 0; i < nodes.childCount(nodeIndex); i++) {
+                    stack.push_back(nodes.firstChild[nodeIndex] + i);
+                }
+                continue;
+            }
+
+            auto page = acquireNodePoints(pointCloud, nodeIndex);
+            if (!page) continue;
+
+            if (glm::all(glm::greaterThanEqual(nodeMin, boxMin)) && glm::all(glm::lessThanEqual(nodeMax, boxMax))) {
+                // Node is fully inside the box, no per-point test needed
+                result.insert(result.end(), page->begin(), page->end());
+            } else {
+                collect(*page);
             }
         }
+
+        return result;
     }
 
-    void OctreePointCloudManager::collectLoadedNodes(PointCloudOctreeNode* node, 
-                                                   std::vector<std::pair<std::chrono::steady_clock::time_point, PointCloudOctreeNode*>>& nodesByAge) {
-        if (!node) return;
-        
-        if (node->isLoaded) {
-            nodesByAge.emplace_back(node->lastAccessed, node);
+    PointCloudClipSnapshot OctreePointCloudManager::snapshotClippedPages(const PointCloud& pointCloud) {
+        PointCloudClipSnapshot snapshot;
+        snapshot.clipVolumes = pointCloud.clipVolumes;
+
+        if (!pointCloud.hasOctree()) {
+            auto page = std::make_shared<const std::vector<PointCloudPoint>>(pointCloud.points);
+            snapshot.pages.push_back({ page, std::string(), true });
+            return snapshot;
         }
-        
-        for (auto& child : node->children) {
-            if (child) {
-                collectLoadedNodes(child.get(), nodesByAge);
+
+        const PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        const std::vector<PointCloudClipVolume>* rootClip = pointCloud.clipVolumes.empty() ? nullptr : &pointCloud.clipVolumes;
+        std::vector<std::pair<uint32_t, const std::vector<PointCloudClipVolume>*>> stack = { { 0, rootClip } };
+        while (!stack.empty()) {
+            auto [nodeIndex, clipVolumes] = stack.back();
+            stack.pop_back();
+
+            if (nodes.totalPointCount[nodeIndex] == 0 || !narrowClipVolumes(clipVolumes, nodes, nodeIndex)) continue;
+
+            if (nodes.childMask[nodeIndex] != 0) {
+                for (int i = 0; i < nodes.childCount(nodeIndex); i++) {
+                    stack.emplace_back(nodes.firstChild[nodeIndex] + i, clipVolumes);
+                }
+                continue;
+            }
+
+            // Resident pages are shared, the rest is read from the node cache by the reader
+            auto page = nodes.sharedPoints(nodeIndex);
+            if (!page) {
+                page = findCachedPage(nodes, nodeIndex);
             }
+            snapshot.pages.push_back({ page, getNodeFilePath(pointCloud.chunkCache.cacheDirectory, nodeIndex), clipVolumes != nullptr });
         }
+        return snapshot;
     }
 
-    void OctreePointCloudManager::markNodeAccessed(PointCloudOctreeNode* node) {
-        node->lastAccessed = std::chrono::steady_clock::now();
-    }
+    std::vector<PointCloudPoint> OctreePointCloudManager::readClippedPages(const PointCloudClipSnapshot& snapshot) {
+        std::vector<PointCloudPoint> result;
+        std::vector<PointCloudPoint> diskPoints;
 
-    void OctreePointCloudManager::saveToDisk(PointCloudOctreeNode* node, const std::string& cacheDir) {
-        if (node->points.empty()) return;
+        for (const PointCloudClipSnapshot::Page& page : snapshot.pages) {
+            const std::vector<PointCloudPoint>* points = page.points.get();
+            if (!points) {
+                if (!loadNodeFromHDF5(page.filePath, diskPoints)) {
+                    std::cerr << "Failed to read " << page.filePath << " for the clipped export" << std::endl;
+                    continue;
+                }
+                points = &diskPoints;
+            }
 
-        try {
-            std::string filePath = getNodeFilePath(cacheDir, node->nodeId);
-            saveNodeToHDF5(node, filePath);
-            
-            node->isOnDisk = true;
-            node->diskFilePath = filePath;
-            
-            // Can unload from memory after saving to disk
-            // node->points.clear(); // Uncomment to free memory immediately
-            
-        } catch (const std::exception& e) {
-            std::cerr << "Failed to save node " << node->nodeId << " to disk: " << e.what() << std::endl;
+            if (!page.clipped) {
+                result.insert(result.end(), points->begin(), points->end());
+                continue;
+            }
+            for (const PointCloudPoint& point : *points) {
+                if (PointCloudClipVolume::keptByAll(snapshot.clipVolumes, point.position)) {
+                    result.push_back(point);
+                }
+            }
         }
+        return result;
     }
 
-    void OctreePointCloudManager::loadFromDisk(PointCloudOctreeNode* node, const std::string& cacheDir) {
-        std::cout << "[DEBUG] loadFromDisk() called for node " << node->nodeId 
-                  << ", isOnDisk: " << (node->isOnDisk ? "true" : "false")
-                  << ", isLoaded: " << (node->isLoaded ? "true" : "false") << std::endl;
-                  
-        if (!node->isOnDisk || node->isLoaded) {
-            std::cout << "[DEBUG] Node " << node->nodeId << " not on disk or already loaded, skipping" << std::endl;
-            return;
+    std::vector<PointCloudPoint> OctreePointCloudManager::queryRadius(const PointCloud& pointCloud, const glm::vec3& center, float radius) {
+        std::vector<PointCloudPoint> result;
+        std::vector<float> distancesSquared;
+        const float radiusSquared = radius * radius;
+
+        auto collect = [&](const std::vector<PointCloudPoint>& points) {
+            distancesSquared.resize(points.size());
+            computeDistancesSquared(points.data(), points.size(), center, distancesSquared.data());
+            for (size_t i = 0; i < points.size(); i++) {
+                if (distancesSquared[i] <= radiusSquared) {
+                    result.push_back(points[i]);
+                }
+            }
+        };
+
+        if (!pointCloud.hasOctree()) {
+            collect(pointCloud.points);
+            return result;
         }
 
-        try {
-            std::cout << "[DEBUG] Loading node " << node->nodeId << " from file: " << node->diskFilePath << std::endl;
-            loadNodeFromHDF5(node, node->diskFilePath);
-            node->isLoaded = true;
-            markNodeAccessed(node);
-            std::cout << "[DEBUG] Successfully loaded node " << node->nodeId << " from disk with " << node->points.size() << " points" << std::endl;
-            
-        } catch (const std::exception& e) {
-            std::cerr << "[ERROR] Failed to load node " << node->nodeId << " from disk: " << e.what() << std::endl;
+        const PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        std::vector<uint32_t> stack = { 0 };
+        while (!stack.empty()) {
+            uint32_t nodeIndex = stack.back();
+            stack.pop_back();
+
+            if (nodes.totalPointCount[nodeIndex] == 0 || nodeDistanceSquared(nodes, nodeIndex, center) > radiusSquared) {
+                continue;
+            }
+
+            if (nodes.childMask[nodeIndex] != 0) {
+                for (int i = 0; i < nodes.childCount(nodeIndex); i++) {
+                    stack.push_back(nodes.firstChild[nodeIndex] + i);
+                }
+                continue;
+            }
+
+            auto page = acquireNodePoints(pointCloud, nodeIndex);
+            if (page) {
+                collect(*page);
+            }
         }
+
+        return result;
     }
 
-    void OctreePointCloudManager::createCacheDirectory(const std::string& cacheDir) {
-        try {
-            std::filesystem::create_directories(cacheDir);
-        } catch (const std::exception& e) {
-            std::cerr << "Failed to create cache directory: " << e.what() << std::endl;
+    std::vector<PointCloudQueryHit> OctreePointCloudManager::queryNearest(const PointCloud& pointCloud, const glm::vec3& position, size_t count) {
+        std::vector<PointCloudQueryHit> result;
+        if (count == 0) return result;
+
+        // Max-heap on distance holding the best candidates found so far
+        auto fartherFirst = [](const PointCloudQueryHit& a, const PointCloudQueryHit& b) { return a.distance < b.distance; };
+        std::vector<float> distancesSquared;
+
+        auto collect = [&](const std::vector<PointCloudPoint>& points, uint32_t nodeIndex) {
+            distancesSquared.resize(points.size());
+            computeDistancesSquared(points.data(), points.size(), position, distancesSquared.data());
+            for (size_t i = 0; i < points.size(); i++) {
+                if (result.size() == count && distancesSquared[i] >= result.front().distance) continue;
+
+                PointCloudQueryHit hit;
+                hit.point = points[i];
+                hit.nodeIndex = nodeIndex;
+                hit.distance = distancesSquared[i];
+                if (result.size() == count) {
+                    std::pop_heap(result.begin(), result.end(), fartherFirst);
+                    result.back() = hit;
+                } else {
+                    result.push_back(hit);
+                }
+                std::push_heap(result.begin(), result.end(), fartherFirst);
+            }
+        };
+
+        if (!pointCloud.hasOctree()) {
+            collect(pointCloud.points, PointCloudNodePool::INVALID_NODE);
+        } else {
+            // Best-first traversal, nearest node boxes first
+            const PointCloudNodePool& nodes = pointCloud.octreeNodes;
+            using NodeEntry = std::pair<float, uint32_t>;
+            std::priority_queue<NodeEntry, std::vector<NodeEntry>, std::greater<NodeEntry>> queue;
+            queue.emplace(nodeDistanceSquared(nodes, 0, position), 0);
+
+            while (!queue.empty()) {
+                auto [boxDistanceSquared, nodeIndex] = queue.top();
+                queue.pop();
+
+                if (result.size() == count && boxDistanceSquared >= result.front().distance) {
+                    break;
+                }
+
+                if (nodes.childMask[nodeIndex] != 0) {
+                    for (int i = 0; i < nodes.childCount(nodeIndex); i++) {
+                        uint32_t child = nodes.firstChild[nodeIndex] + i;
+                        if (nodes.totalPointCount[child] > 0) {
+                            queue.emplace(nodeDistanceSquared(nodes, child, position), child);
+                        }
+                    }
+                    continue;
+                }
+
+                auto page = acquireNodePoints(pointCloud, nodeIndex);
+                if (page) {
+                    collect(*page, nodeIndex);
+                }
+            }
         }
-    }
 
-    std::string OctreePointCloudManager::getNodeFilePath(const std::string& cacheDir, uint64_t nodeId) {
-        return cacheDir + "/node_" + std::to_string(nodeId) + ".h5";
+        std::sort_heap(result.begin(), result.end(), fartherFirst);
+        for (auto& hit : result) {
+            hit.distance = std::sqrt(hit.distance);
+        }
+        return result;
     }
 
-    void OctreePointCloudManager::saveNodeToHDF5(const PointCloudOctreeNode* node, const std::string& filePath) {
-        std::lock_guard<std::mutex> hdf5Lock(s_hdf5Mutex);
-        H5::H5File file(filePath, H5F_ACC_TRUNC);
-        
-        // Create compound datatype for PointCloudPoint
-        H5::CompType pointType(sizeof(PointCloudPoint));
-        pointType.insertMember("position_x", HOFFSET(PointCloudPoint, position.x), H5::PredType::NATIVE_FLOAT);
-        pointType.insertMember("position_y", HOFFSET(PointCloudPoint, position.y), H5::PredType::NATIVE_FLOAT);
-        pointType.insertMember("position_z", HOFFSET(PointCloudPoint, position.z), H5::PredType::NATIVE_FLOAT);
-        pointType.insertMember("intensity", HOFFSET(PointCloudPoint, intensity), H5::PredType::NATIVE_FLOAT);
-        pointType.insertMember("color_r", HOFFSET(PointCloudPoint, color.r), H5::PredType::NATIVE_FLOAT);
-        pointType.insertMember("color_g", HOFFSET(PointCloudPoint, color.g), H5::PredType::NATIVE_FLOAT);
-        pointType.insertMember("color_b", HOFFSET(PointCloudPoint, color.b), H5::PredType::NATIVE_FLOAT);
-        
-        // Create dataspace
-        hsize_t dims[1] = { node->points.size() };
-        H5::DataSpace dataspace(1, dims);
-        
-        // Create dataset and write points
-        H5::DataSet dataset = file.createDataSet("points", pointType, dataspace);
-        dataset.write(node->points.data(), pointType);
-        
-        file.close();
+    bool OctreePointCloudManager::queryRay(const PointCloud& pointCloud, const glm::vec3& origin, const glm::vec3& direction,
+                                           float radius, float coneSlope, PointCloudQueryHit& hit, float maxDistance) {
+        return traceRay(pointCloud, origin, direction, radius, coneSlope, hit, maxDistance, nullptr);
     }
 
-    void OctreePointCloudManager::loadNodeFromHDF5(PointCloudOctreeNode* node, const std::string& filePath) {
-        if (!node || filePath.empty() || !std::filesystem::exists(filePath)) {
-            return;
-        }
-        
-        try {
-            std::lock_guard<std::mutex> hdf5Lock(s_hdf5Mutex);
-            H5::H5File file(filePath, H5F_ACC_RDONLY);
-            
-            // Open dataset
-            H5::DataSet dataset = file.openDataSet("points");
-            H5::DataSpace dataspace = dataset.getSpace();
-            
-            // Get dimensions
-            hsize_t dims[1];
-            dataspace.getSimpleExtentDims(dims, NULL);
-            
-            // Resize points vector and read data
-            node->points.resize(dims[0]);
-            
-            // Create compound datatype
-            H5::CompType pointType(sizeof(PointCloudPoint));
-            pointType.insertMember("position_x", HOFFSET(PointCloudPoint, position.x), H5::PredType::NATIVE_FLOAT);
-            pointType.insertMember("position_y", HOFFSET(PointCloudPoint, position.y), H5::PredType::NATIVE_FLOAT);
-            pointType.insertMember("position_z", HOFFSET(PointCloudPoint, position.z), H5::PredType::NATIVE_FLOAT);
-            pointType.insertMember("intensity", HOFFSET(PointCloudPoint, intensity), H5::PredType::NATIVE_FLOAT);
-            pointType.insertMember("color_r", HOFFSET(PointCloudPoint, color.r), H5::PredType::NATIVE_FLOAT);
-            pointType.insertMember("color_g", HOFFSET(PointCloudPoint, color.g), H5::PredType::NATIVE_FLOAT);
-            pointType.insertMember("color_b", HOFFSET(PointCloudPoint, color.b), H5::PredType::NATIVE_FLOAT);
-            
-            dataset.read(node->points.data(), pointType);
-            
-            // Update memory usage
-            node->memoryUsage = node->points.size() * sizeof(PointCloudPoint);
-            
-            file.close();
-            
-        } catch (const std::exception& e) {
-            // Silent failure - just don't load the node
+    bool OctreePointCloudManager::pickRay(PointCloud& pointCloud, const glm::vec3& origin, const glm::vec3& direction,
+                                          float coneSlope, PointCloudQueryHit& hit) {
+        std::vector<uint32_t> missedNodes;
+        bool found = traceRay(pointCloud, origin, direction, 0.0f, coneSlope, hit, std::numeric_limits<float>::max(), &missedNodes);
+
+        // Drawn nodes whose CPU copy is gone come back through the loader, later picks see them
+        for (uint32_t nodeIndex : missedNodes) {
+            requestAsyncLoad(pointCloud, nodeIndex);
         }
+        return found;
     }
 
-    void OctreePointCloudManager::unloadOldestNodes(PointCloud& pointCloud, size_t targetMemoryMB) {
-        size_t targetMemoryBytes = targetMemoryMB * 1024 * 1024;
-        size_t currentMemory = getMemoryUsage(pointCloud);
-        
-        if (!pointCloud.octreeRoot || currentMemory <= targetMemoryBytes) {
-            return;
+    bool OctreePointCloudManager::traceRay(const PointCloud& pointCloud, const glm::vec3& origin, const glm::vec3& direction,
+                                           float radius, float coneSlope, PointCloudQueryHit& hit, float maxDistance, std::vector<uint32_t>* missedNodes) {
+        if (glm::length(direction) < 1e-6f) return false;
+
+        const glm::vec3 dir = glm::normalize(direction);
+        float bestT = maxDistance;
+        bool found = false;
+        std::vector<float> alongRay;
+        std::vector<float> perpendicularSquared;
+
+        // Points cropped away by the clip volumes are not drawn and cannot be hit either
+        auto collect = [&](const std::vector<PointCloudPoint>& points, uint32_t nodeIndex, const std::vector<PointCloudClipVolume>* clipVolumes) {
+            alongRay.resize(points.size());
+            perpendicularSquared.resize(points.size());
+            computeRayDistances(points.data(), points.size(), origin, dir, alongRay.data(), perpendicularSquared.data());
+            for (size_t i = 0; i < points.size(); i++) {
+                float coneRadius = radius + coneSlope * alongRay[i];
+                if (alongRay[i] >= 0.0f && alongRay[i] < bestT && perpendicularSquared[i] <= coneRadius * coneRadius &&
+                    (!clipVolumes || PointCloudClipVolume::keptByAll(*clipVolumes, points[i].position))) {
+                    bestT = alongRay[i];
+                    hit.point = points[i];
+                    hit.nodeIndex = nodeIndex;
+                    hit.distance = std::sqrt(perpendicularSquared[i]);
+                    hit.rayDistance = alongRay[i];
+                    found = true;
+                }
+            }
+        };
+
+        const std::vector<PointCloudClipVolume>* rootClip = pointCloud.clipVolumes.empty() ? nullptr : &pointCloud.clipVolumes;
+        if (!pointCloud.hasOctree()) {
+            collect(pointCloud.points, PointCloudNodePool::INVALID_NODE, rootClip);
+            return found;
         }
-        
-        std::cout << "Unloading nodes to reduce memory from " << (currentMemory / (1024 * 1024)) 
-                  << "MB to target " << targetMemoryMB << "MB" << std::endl;
-        
-        // Collect all loaded leaf nodes with their access times
-        std::vector<std::pair<std::chrono::steady_clock::time_point, PointCloudOctreeNode*>> nodesByAge;
-        collectLoadedNodes(pointCloud.octreeRoot.get(), nodesByAge);
-        
-        // Sort by access time (oldest first)
-        std::sort(nodesByAge.begin(), nodesByAge.end());
-        
-        // Unload oldest nodes until we reach target memory
-        for (auto& [accessTime, node] : nodesByAge) {
-            if (getMemoryUsage(pointCloud) <= targetMemoryBytes) {
+
+        // Front-to-back traversal: stop once the next node starts beyond the best hit. Each node
+        // carries the clip volumes still left to test, narrowed as for the render list.
+        const PointCloudNodePool& nodes = pointCloud.octreeNodes;
+        const glm::vec3 inverseDirection = 1.0f / dir;
+        struct NodeEntry {
+            float enter;
+            uint32_t nodeIndex;
+            const std::vector<PointCloudClipVolume>* clipVolumes;
+            bool operator>(const NodeEntry& other) const { return enter > other.enter; }
+        };
+        std::priority_queue<NodeEntry, std::vector<NodeEntry>, std::greater<NodeEntry>> queue;
+
+        // Pad node boxes by the widest the cone can get inside them
+        auto nodePadding = [&](uint32_t nodeIndex) {
+            float farthest = glm::length(nodes.center(nodeIndex) - origin) + nodes.halfSize(nodeIndex) * 1.7320508f;
+            return radius + coneSlope * farthest;
+        };
+
+        float tEnter, tExit;
+        if (intersectNodeRay(nodes, 0, origin, inverseDirection, nodePadding(0), tEnter, tExit)) {
+            queue.push({ tEnter, 0, rootClip });
+        }
+
+        while (!queue.empty()) {
+            NodeEntry entry = queue.top();
+            queue.pop();
+            uint32_t nodeIndex = entry.nodeIndex;
+            const std::vector<PointCloudClipVolume>* clipVolumes = entry.clipVolumes;
+
+            if (entry.enter > bestT) {
                 break;
             }
-            
-            if (node->isLoaded) {
-                // Save to disk first if not already saved
-                if (!node->isOnDisk) {
-                    saveToDisk(node, pointCloud.chunkCache.cacheDirectory);
+            if (!narrowClipVolumes(clipVolumes, nodes, nodeIndex)) {
+                continue;
+            }
+
+            if (nodes.childMask[nodeIndex] != 0) {
+                for (int i = 0; i < nodes.childCount(nodeIndex); i++) {
+                    uint32_t child = nodes.firstChild[nodeIndex] + i;
+                    if (nodes.totalPointCount[child] > 0 &&
+                        intersectNodeRay(nodes, child, origin, inverseDirection, nodePadding(child), tEnter, tExit)) {
+                        queue.push({ tEnter, child, clipVolumes });
+                    }
+                }
+                continue;
+            }
+
+            // Interactive picks never wait on the disk: they use pages already in memory and report
+            // drawn nodes whose CPU copy went with keepCpuCopy off and fell out of the page cache
+            auto page = nodes.sharedPoints(nodeIndex);
+            if (!page) {
+                if (!missedNodes) {
+                    page = acquireNodePoints(pointCloud, nodeIndex);
+                } else {
+                    page = findCachedPage(nodes, nodeIndex);
+                    if (!page && nodes.hasFlag(nodeIndex, PointCloudNodePool::NODE_VBOS_GENERATED)) {
+                        missedNodes->push_back(nodeIndex);
+                    }
                 }
-                
-                // Clean up VBOs
-                node->cleanup();
-                
-                // Unload from memory
-                node->points.clear();
-                node->points.shrink_to_fit();
-                node->isLoaded = false;
-                node->vbosGenerated = false;
-                node->memoryUsage = 0;
-                
-                std::cout << "Unloaded node " << node->nodeId << " from memory" << std::endl;
+            }
+            if (page) {
+                collect(*page, nodeIndex, clipVolumes);
             }
         }
-        
-        std::cout << "Memory after cleanup: " << (getMemoryUsage(pointCloud) / (1024 * 1024)) << "MB" << std::endl;
+
+        return found;
     }
 
     // OctreeBounds utility functions
@@ -877,6 +2432,10 @@ namespace Engine {
             max = glm::max(max, point.position);
         }
 
+        calculateCube(min, max, center, size);
+    }
+
+    void OctreeBounds::calculateCube(const glm::vec3& min, const glm::vec3& max, glm::vec3& center, float& size) {
         center = (min + max) * 0.5f;
         glm::vec3 extent = max - min;
         size = std::max({extent.x, extent.y, extent.z});
@@ -909,10 +2468,10 @@ namespace Engine {
     }
 
     void OctreePointCloudManager::generateOctreeVisualization(PointCloud& pointCloud, int depth) {
-        if (!pointCloud.octreeRoot) return;
+        if (!pointCloud.hasOctree()) return;
 
         pointCloud.chunkOutlineVertices.clear();
-        generateOctreeVisualizationRecursive(pointCloud.octreeRoot.get(), depth, 0, pointCloud.chunkOutlineVertices);
+        generateOctreeVisualizationRecursive(pointCloud.octreeNodes, 0, depth, 0, pointCloud.chunkOutlineVertices);
 
         // Create and bind VAO and VBO for octree visualization
         if (pointCloud.chunkOutlineVAO == 0) {
@@ -935,15 +2494,15 @@ namespace Engine {
     }
 
     void OctreePointCloudManager::generateOctreeVisualizationRecursive(
-        PointCloudOctreeNode* node, int targetDepth, int currentDepth, 
+        const PointCloudNodePool& nodes, uint32_t nodeIndex, int targetDepth, int currentDepth, 
         std::vector<glm::vec3>& vertices) {
         
-        if (!node || currentDepth > targetDepth) return;
+        if (nodeIndex >= nodes.size() || currentDepth > targetDepth) return;
 
-        if (currentDepth == targetDepth || node->isLeaf) {
+        if (currentDepth == targetDepth || nodes.isLeaf(nodeIndex)) {
             // Generate bounding box lines for this node
-            glm::vec3 minBound = node->center - node->bounds;
-            glm::vec3 maxBound = node->center + node->bounds;
+            glm::vec3 minBound = nodes.center(nodeIndex) - glm::vec3(nodes.halfSize(nodeIndex));
+            glm::vec3 maxBound = nodes.center(nodeIndex) + glm::vec3(nodes.halfSize(nodeIndex));
 
             // Front face
             vertices.push_back(minBound);
@@ -985,10 +2544,9 @@ namespace Engine {
             vertices.push_back(glm::vec3(minBound.x, maxBound.y, maxBound.z));
         } else {
             // Recurse to children
-            for (auto& child : node->children) {
-                if (child) {
-                    generateOctreeVisualizationRecursive(child.get(), targetDepth, currentDepth + 1, vertices);
-                }
+            uint32_t firstChild = nodes.firstChild[nodeIndex];
+            for (int i = 0; i < nodes.childCount(nodeIndex); i++) {
+                generateOctreeVisualizationRecursive(nodes, firstChild + i, targetDepth, currentDepth + 1, vertices);
             }
         }
     }
@@ -0,0 +1,392 @@
+#include "../../headers/Engine/PointCloudCodec.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+namespace Engine {
+    namespace PointCloudCodec {
+
+        static const uint32_t CODEC_MAGIC = 0x32434350;    // "PCC2", adds normals
+        static const uint32_t CODEC_MAGIC_V1 = 0x31434350; // "PCC1"
+        static const size_t BLOCK_SIZE = 128;
+
+        enum ChannelMode : uint8_t {
+            CHANNEL_FLOAT = 0,      // Delta + bit-packed float bits
+            CHANNEL_BYTES = 1,      // Exact 8-bit values, one byte each
+            CHANNEL_BYTES_RLE = 2   // Exact 8-bit values, (value, run length) pairs
+        };
+
+        // ---- Bit helpers ----
+
+        // Maps float bits to an unsigned integer with the same ordering as the floats
+        static inline uint32_t floatToOrdered(float value) {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+        }
+
+        static inline float orderedToFloat(uint32_t ordered) {
+            uint32_t bits = (ordered & 0x80000000u) ? (ordered & 0x7FFFFFFFu) : ~ordered;
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        static inline uint32_t zigzag(uint32_t delta) {
+            int32_t signedDelta = static_cast<int32_t>(delta);
+            return (static_cast<uint32_t>(signedDelta) << 1) ^ static_cast<uint32_t>(signedDelta >> 31);
+        }
+
+        static inline uint32_t unzigzag(uint32_t value) {
+            return (value >> 1) ^ (0u - (value & 1u));
+        }
+
+        static inline int bitWidth(uint32_t value) {
+            int width = 0;
+            while (value) { width++; value >>= 1; }
+            return width;
+        }
+
+        static void writeU32(std::vector<uint8_t>& out, uint32_t value) {
+            for (int i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+
+        static void writeVarint(std::vector<uint8_t>& out, uint32_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        struct Reader {
+            const uint8_t* data;
+            size_t size;
+            size_t offset = 0;
+
+            bool readU8(uint8_t& value) {
+                if (offset + 1 > size) return false;
+                value = data[offset++];
+                return true;
+            }
+
+            bool readU32(uint32_t& value) {
+                if (offset + 4 > size) return false;
+                value = uint32_t(data[offset]) | (uint32_t(data[offset + 1]) << 8) |
+                        (uint32_t(data[offset + 2]) << 16) | (uint32_t(data[offset + 3]) << 24);
+                offset += 4;
+                return true;
+            }
+
+            bool readVarint(uint32_t& value) {
+                value = 0;
+                for (int shift = 0; shift < 35; shift += 7) {
+                    uint8_t byte;
+                    if (!readU8(byte)) return false;
+                    value |= uint32_t(byte & 0x7F) << shift;
+                    if (!(byte & 0x80)) return true;
+                }
+                return false;
+            }
+        };
+
+        // ---- Integer streams ----
+
+        // Delta + zigzag + per-block bit packing
+        static void encodeOrderedStream(const std::vector<uint32_t>& values, std::vector<uint8_t>& out) {
+            uint32_t previous = 0;
+            uint32_t residuals[BLOCK_SIZE];
+
+            for (size_t blockStart = 0; blockStart < values.size(); blockStart += BLOCK_SIZE) {
+                size_t count = std::min(BLOCK_SIZE, values.size() - blockStart);
+
+                uint32_t combined = 0;
+                for (size_t i = 0; i < count; i++) {
+                    residuals[i] = zigzag(values[blockStart + i] - previous);
+                    previous = values[blockStart + i];
+                    combined |= residuals[i];
+                }
+
+                int width = bitWidth(combined);
+                out.push_back(static_cast<uint8_t>(width));
+                if (width == 0) continue;
+
+                uint64_t accumulator = 0;
+                int bits = 0;
+                for (size_t i = 0; i < count; i++) {
+                    accumulator |= uint64_t(residuals[i]) << bits;
+                    bits += width;
+                    while (bits >= 8) {
+                        out.push_back(static_cast<uint8_t>(accumulator));
+                        accumulator >>= 8;
+                        bits -= 8;
+                    }
+                }
+                if (bits > 0) {
+                    out.push_back(static_cast<uint8_t>(accumulator));
+                }
+            }
+        }
+
+        // Block layout keeps the inner loops branch-free so they vectorize well
+        static bool decodeOrderedStream(Reader& reader, size_t valueCount, uint32_t* values) {
+            uint32_t previous = 0;
+
+            for (size_t blockStart = 0; blockStart < valueCount; blockStart += BLOCK_SIZE) {
+                size_t count = std::min(BLOCK_SIZE, valueCount - blockStart);
+                uint32_t* block = values + blockStart;
+
+                uint8_t width;
+                if (!reader.readU8(width) || width > 32) return false;
+
+                if (width == 0) {
+                    std::fill(block, block + count, 0u);
+                } else {
+                    size_t byteCount = (count * width + 7) / 8;
+                    if (reader.offset + byteCount > reader.size) return false;
+                    const uint8_t* packed = reader.data + reader.offset;
+                    reader.offset += byteCount;
+
+                    const uint64_t mask = (width == 32) ? 0xFFFFFFFFull : ((1ull << width) - 1);
+                    for (size_t i = 0; i < count; i++) {
+                        size_t bitOffset = i * width;
+                        size_t byteOffset = bitOffset >> 3;
+                        // Gather up to 5 bytes covering this value without reading past the block
+                        uint64_t word = 0;
+                        size_t available = std::min<size_t>(8, byteCount - byteOffset);
+                        std::memcpy(&word, packed + byteOffset, available);
+                        block[i] = static_cast<uint32_t>((word >> (bitOffset & 7)) & mask);
+                    }
+                }
+
+                // Undo zigzag, then prefix-sum the deltas
+                for (size_t i = 0; i < count; i++) {
+                    previous += unzigzag(block[i]);
+                    block[i] = previous;
+                }
+            }
+            return true;
+        }
+
+        // ---- Attribute channels ----
+
+        static bool isExactByte(float value, uint8_t& byte) {
+            long k = std::lround(value * 255.0f);
+            if (k < 0 || k > 255) return false;
+            float decoded = static_cast<float>(k) / 255.0f;
+            if (std::memcmp(&decoded, &value, sizeof(float)) != 0) return false;
+            byte = static_cast<uint8_t>(k);
+            return true;
+        }
+
+        static void encodeChannel(const std::vector<float>& values, std::vector<uint8_t>& out) {
+            std::vector<uint8_t> bytes(values.size());
+            bool allBytes = true;
+            for (size_t i = 0; i < values.size() && allBytes; i++) {
+                allBytes = isExactByte(values[i], bytes[i]);
+            }
+
+            if (!allBytes) {
+                out.push_back(CHANNEL_FLOAT);
+                std::vector<uint32_t> ordered(values.size());
+                for (size_t i = 0; i < values.size(); i++) {
+                    ordered[i] = floatToOrdered(values[i]);
+                }
+                encodeOrderedStream(ordered, out);
+                return;
+            }
+
+            std::vector<uint8_t> runs;
+            for (size_t i = 0; i < bytes.size();) {
+                size_t run = 1;
+                while (i + run < bytes.size() && bytes[i + run] == bytes[i]) run++;
+                runs.push_back(bytes[i]);
+                writeVarint(runs, static_cast<uint32_t>(run));
+                i += run;
+            }
+
+            if (runs.size() < bytes.size()) {
+                out.push_back(CHANNEL_BYTES_RLE);
+                writeU32(out, static_cast<uint32_t>(runs.size()));
+                out.insert(out.end(), runs.begin(), runs.end());
+            } else {
+                out.push_back(CHANNEL_BYTES);
+                out.insert(out.end(), bytes.begin(), bytes.end());
+            }
+        }
+
+        // Writes channel values to a strided float field (e.g. &points[0].color.g)
+        static bool decodeChannel(Reader& reader, size_t count, float* field, size_t stride, std::vector<uint32_t>& scratch) {
+            uint8_t mode;
+            if (!reader.readU8(mode)) return false;
+
+            // Exact byte values, shared with the encoder's isExactByte
+            float byteTable[256];
+            if (mode != CHANNEL_FLOAT) {
+                for (int k = 0; k < 256; k++) byteTable[k] = static_cast<float>(k) / 255.0f;
+            }
+
+            auto at = [&](size_t i) -> float& {
+                return *reinterpret_cast<float*>(reinterpret_cast<uint8_t*>(field) + i * stride);
+            };
+
+            switch (mode) {
+            case CHANNEL_FLOAT:
+                scratch.resize(count);
+                if (!decodeOrderedStream(reader, count, scratch.data())) return false;
+                for (size_t i = 0; i < count; i++) at(i) = orderedToFloat(scratch[i]);
+                return true;
+
+            case CHANNEL_BYTES:
+                if (reader.offset + count > reader.size) return false;
+                for (size_t i = 0; i < count; i++) at(i) = byteTable[reader.data[reader.offset + i]];
+                reader.offset += count;
+                return true;
+
+            case CHANNEL_BYTES_RLE: {
+                uint32_t runBytes;
+                if (!reader.readU32(runBytes) || reader.offset + runBytes > reader.size) return false;
+                size_t end = reader.offset + runBytes;
+                size_t i = 0;
+                while (reader.offset < end) {
+                    uint8_t value;
+                    uint32_t run;
+                    if (!reader.readU8(value) || !reader.readVarint(run) || i + run > count) return false;
+                    float decoded = byteTable[value];
+                    for (uint32_t r = 0; r < run; r++) at(i++) = decoded;
+                }
+                return i == count;
+            }
+
+            default:
+                return false;
+            }
+        }
+
+        // ---- Morton ordering ----
+
+        static inline uint32_t spreadBits10(uint32_t v) {
+            v &= 0x3FF;
+            v = (v | (v << 16)) & 0x030000FF;
+            v = (v | (v << 8)) & 0x0300F00F;
+            v = (v | (v << 4)) & 0x030C30C3;
+            v = (v | (v << 2)) & 0x09249249;
+            return v;
+        }
+
+        static std::vector<uint32_t> mortonOrder(const std::vector<PointCloudPoint>& points) {
+            glm::vec3 minBound(std::numeric_limits<float>::max());
+            glm::vec3 maxBound(std::numeric_limits<float>::lowest());
+            for (const auto& point : points) {
+                minBound = glm::min(minBound, point.position);
+                maxBound = glm::max(maxBound, point.position);
+            }
+            glm::vec3 extent = glm::max(maxBound - minBound, glm::vec3(1e-20f));
+            glm::vec3 scale = glm::vec3(1023.0f) / extent;
+
+            std::vector<std::pair<uint32_t, uint32_t>> keyed(points.size());
+            for (size_t i = 0; i < points.size(); i++) {
+                glm::vec3 q = glm::clamp((points[i].position - minBound) * scale, glm::vec3(0.0f), glm::vec3(1023.0f));
+                uint32_t code = spreadBits10(static_cast<uint32_t>(q.x)) |
+                                (spreadBits10(static_cast<uint32_t>(q.y)) << 1) |
+                                (spreadBits10(static_cast<uint32_t>(q.z)) << 2);
+                keyed[i] = { code, static_cast<uint32_t>(i) };
+            }
+            std::sort(keyed.begin(), keyed.end());
+
+            std::vector<uint32_t> order(points.size());
+            for (size_t i = 0; i < keyed.size(); i++) {
+                order[i] = keyed[i].second;
+            }
+            return order;
+        }
+
+        // ---- Public API ----
+
+        void encode(const std::vector<PointCloudPoint>& points, std::vector<uint8_t>& encoded) {
+            encoded.clear();
+            encoded.reserve(points.size() * 10 + 64);
+            writeU32(encoded, CODEC_MAGIC);
+            writeU32(encoded, static_cast<uint32_t>(points.size()));
+            if (points.empty()) return;
+
+            std::vector<uint32_t> order = mortonOrder(points);
+
+            // Positions, one stream per axis
+            std::vector<uint32_t> ordered(points.size());
+            for (int axis = 0; axis < 3; axis++) {
+                for (size_t i = 0; i < order.size(); i++) {
+                    ordered[i] = floatToOrdered(points[order[i]].position[axis]);
+                }
+                encodeOrderedStream(ordered, encoded);
+            }
+
+            // Intensity and colors
+            std::vector<float> channel(points.size());
+            for (size_t i = 0; i < order.size(); i++) channel[i] = points[order[i]].intensity;
+            encodeChannel(channel, encoded);
+
+            for (int c = 0; c < 3; c++) {
+                for (size_t i = 0; i < order.size(); i++) channel[i] = points[order[i]].color[c];
+                encodeChannel(channel, encoded);
+            }
+
+            // Normals, skipped for pages without them. Neighbouring points on a surface share
+            // similar octahedral codes, so the delta stream packs well.
+            bool hasNormals = false;
+            for (size_t i = 0; i < order.size(); i++) {
+                ordered[i] = points[order[i]].normal;
+                hasNormals |= ordered[i] != 0;
+            }
+            encoded.push_back(hasNormals ? 1 : 0);
+            if (hasNormals) {
+                encodeOrderedStream(ordered, encoded);
+            }
+        }
+
+        bool decode(const uint8_t* data, size_t size, std::vector<PointCloudPoint>& points) {
+            Reader reader{ data, size };
+            uint32_t magic, count;
+            if (!reader.readU32(magic) || (magic != CODEC_MAGIC && magic != CODEC_MAGIC_V1) || !reader.readU32(count)) {
+                return false;
+            }
+
+            // Each block of the three position streams holds at least its width byte, a count the
+            // remaining bytes cannot cover is corrupt and must not size the allocation
+            size_t blocks = (static_cast<size_t>(count) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            if (blocks * 3 > reader.size - reader.offset) return false;
+
+            points.resize(count);
+            if (count == 0) return true;
+
+            std::vector<uint32_t> scratch(count);
+            for (int axis = 0; axis < 3; axis++) {
+                if (!decodeOrderedStream(reader, count, scratch.data())) return false;
+                for (size_t i = 0; i < count; i++) {
+                    points[i].position[axis] = orderedToFloat(scratch[i]);
+                }
+            }
+
+            if (!decodeChannel(reader, count, &points[0].intensity, sizeof(PointCloudPoint), scratch)) return false;
+            for (int c = 0; c < 3; c++) {
+                if (!decodeChannel(reader, count, &points[0].color[c], sizeof(PointCloudPoint), scratch)) return false;
+            }
+
+            uint8_t hasNormals = 0;
+            if (magic != CODEC_MAGIC_V1 && !reader.readU8(hasNormals)) return false;
+            if (hasNormals) {
+                scratch.resize(count);
+                if (!decodeOrderedStream(reader, count, scratch.data())) return false;
+                for (size_t i = 0; i < count; i++) {
+                    points[i].normal = static_cast<uint16_t>(scratch[i]);
+                }
+            } else {
+                for (size_t i = 0; i < count; i++) {
+                    points[i].normal = 0;
+                }
+            }
+            return true;
+        }
+    }
+}
@@ -0,0 +1,159 @@
+#include "../../headers/Engine/PointCloudGpuArena.h"
+#include <iostream>
+#include <algorithm>
+
+namespace Engine {
+
+    std::vector<PointCloudGpuArena::ArenaBuffer> PointCloudGpuArena::s_buffers;
+    size_t PointCloudGpuArena::s_allocatedPoints = 0;
+
+    PointCloudGpuAllocation PointCloudGpuArena::allocate(uint32_t pointCount) {
+        PointCloudGpuAllocation allocation;
+        if (pointCount == 0) {
+            return allocation;
+        }
+
+        for (uint32_t slot = 0; slot < s_buffers.size(); slot++) {
+            if (allocateFrom(slot, pointCount, allocation)) {
+                return allocation;
+            }
+        }
+
+        // Nodes larger than a regular buffer get a buffer of their own
+        uint32_t slot = createBuffer(std::max(pointCount, BUFFER_POINTS));
+        allocateFrom(slot, pointCount, allocation);
+        return allocation;
+    }
+
+    bool PointCloudGpuArena::allocateFrom(uint32_t slot, uint32_t pointCount, PointCloudGpuAllocation& allocation) {
+        ArenaBuffer& arenaBuffer = s_buffers[slot];
+        if (arenaBuffer.buffer == 0 || arenaBuffer.capacity - arenaBuffer.usedPoints < pointCount) {
+            return false;
+        }
+
+        // First fit keeps allocations packed towards the start of the buffer
+        for (auto it = arenaBuffer.freeRanges.begin(); it != arenaBuffer.freeRanges.end(); ++it) {
+            if (it->second < pointCount) continue;
+
+            uint32_t first = it->first;
+            uint32_t remaining = it->second - pointCount;
+            arenaBuffer.freeRanges.erase(it);
+            if (remaining > 0) {
+                arenaBuffer.freeRanges[first + pointCount] = remaining;
+            }
+
+            arenaBuffer.usedPoints += pointCount;
+            s_allocatedPoints += pointCount;
+
+            allocation.buffer = slot;
+            allocation.first = first;
+            allocation.count = pointCount;
+            return true;
+        }
+        return false;
+    }
+
+    uint32_t PointCloudGpuArena::createBuffer(uint32_t capacity) {
+        uint32_t slot = 0;
+        while (slot < s_buffers.size() && s_buffers[slot].buffer != 0) slot++;
+        if (slot == s_buffers.size()) {
+            s_buffers.emplace_back();
+        }
+
+        ArenaBuffer& arenaBuffer = s_buffers[slot];
+        arenaBuffer.capacity = capacity;
+        arenaBuffer.usedPoints = 0;
+        arenaBuffer.freeRanges.clear();
+        arenaBuffer.freeRanges[0] = capacity;
+
+        glGenBuffers(1, &arenaBuffer.buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, arenaBuffer.buffer);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity) * POINT_STRIDE, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        std::cout << "Point cloud GPU arena: allocated buffer " << slot << " ("
+                  << (static_cast<size_t>(capacity) * POINT_STRIDE / (1024 * 1024)) << " MB)" << std::endl;
+        return slot;
+    }
+
+    void PointCloudGpuArena::release(PointCloudGpuAllocation& allocation) {
+        if (!allocation.valid()) {
+            return;
+        }
+        if (allocation.buffer >= s_buffers.size() || s_buffers[allocation.buffer].buffer == 0) {
+            // The arena was shut down before the owner released its nodes
+            allocation = PointCloudGpuAllocation();
+            return;
+        }
+
+        ArenaBuffer& arenaBuffer = s_buffers[allocation.buffer];
+        uint32_t first = allocation.first;
+        uint32_t count = allocation.count;
+
+        // Merge with the free neighbours on both sides
+        auto next = arenaBuffer.freeRanges.lower_bound(first);
+        if (next != arenaBuffer.freeRanges.end() && first + count == next->first) {
+            count += next->second;
+            next = arenaBuffer.freeRanges.erase(next);
+        }
+        if (next != arenaBuffer.freeRanges.begin()) {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == first) {
+                first = previous->first;
+                count += previous->second;
+                arenaBuffer.freeRanges.erase(previous);
+            }
+        }
+        arenaBuffer.freeRanges[first] = count;
+
+        arenaBuffer.usedPoints -= allocation.count;
+        s_allocatedPoints -= allocation.count;
+
+        // Give empty buffers back to the driver, but keep one around for the next upload
+        if (arenaBuffer.usedPoints == 0 && getBufferCount() > 1) {
+            glDeleteBuffers(1, &arenaBuffer.buffer);
+            arenaBuffer = ArenaBuffer();
+        }
+
+        allocation = PointCloudGpuAllocation();
+    }
+
+    void PointCloudGpuArena::upload(const PointCloudGpuAllocation& allocation, const void* points) {
+        if (!allocation.valid()) {
+            return;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, s_buffers[allocation.buffer].buffer);
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        static_cast<GLintptr>(allocation.first) * POINT_STRIDE,
+                        static_cast<GLsizeiptr>(allocation.count) * POINT_STRIDE,
+                        points);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    size_t PointCloudGpuArena::getBufferCount() {
+        size_t count = 0;
+        for (const ArenaBuffer& arenaBuffer : s_buffers) {
+            if (arenaBuffer.buffer != 0) count++;
+        }
+        return count;
+    }
+
+    size_t PointCloudGpuArena::getReservedBytes() {
+        size_t points = 0;
+        for (const ArenaBuffer& arenaBuffer : s_buffers) {
+            if (arenaBuffer.buffer != 0) points += arenaBuffer.capacity;
+        }
+        return points * POINT_STRIDE;
+    }
+
+    void PointCloudGpuArena::shutdown() {
+        for (ArenaBuffer& arenaBuffer : s_buffers) {
+            if (arenaBuffer.buffer != 0) {
+                glDeleteBuffers(1, &arenaBuffer.buffer);
+            }
+        }
+        s_buffers.clear();
+        s_allocatedPoints = 0;
+    }
+
+}
@@ -0,0 +1,297 @@
+#include "../../headers/Engine/PointCloudResidencyManager.h"
+#include "../../headers/Engine/OctreePointCloudManager.h"
+#include <glad/glad.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// Memory info extensions, not part of the generated loader
+#ifndef GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX
+#define GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX 0x9047
+#endif
+#ifndef GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#endif
+#ifndef GL_VBO_FREE_MEMORY_ATI
+#define GL_VBO_FREE_MEMORY_ATI 0x87FB
+#endif
+
+namespace Engine {
+
+    size_t PointCloudResidencyManager::s_cpuBudgetBytes = size_t(8192) * 1024 * 1024;
+    size_t PointCloudResidencyManager::s_gpuBudgetBytes = size_t(2048) * 1024 * 1024;
+    size_t PointCloudResidencyManager::s_cpuBudgetLimit = size_t(8192) * 1024 * 1024;
+    size_t PointCloudResidencyManager::s_gpuBudgetLimit = size_t(2048) * 1024 * 1024;
+    size_t PointCloudResidencyManager::s_cpuReserveBytes = size_t(1024) * 1024 * 1024;
+    size_t PointCloudResidencyManager::s_gpuReserveBytes = size_t(256) * 1024 * 1024;
+    PointCloudResidencyManager::GpuMemoryQuery PointCloudResidencyManager::s_gpuMemoryQuery = GpuMemoryQuery::None;
+    uint32_t PointCloudResidencyManager::s_frame = 0;
+    size_t PointCloudResidencyManager::s_cpuEvictions = 0;
+    size_t PointCloudResidencyManager::s_gpuEvictions = 0;
+    bool PointCloudResidencyManager::s_cpuOverBudget = false;
+    bool PointCloudResidencyManager::s_gpuOverBudget = false;
+
+    void PointCloudResidencyManager::initialize() {
+        size_t physicalMemory = detectPhysicalMemory();
+
+        // Leave room for the OS, meshes, textures and the raw points of a cloud being built,
+        // and keep a tenth of the machine free for everything else that runs alongside
+        s_cpuBudgetLimit = physicalMemory * 2 / 5;
+        s_cpuReserveBytes = physicalMemory / 10;
+        s_cpuBudgetBytes = adjustBudget(s_cpuBudgetLimit, s_cpuBudgetLimit, 0, detectAvailableMemory(), s_cpuReserveBytes);
+
+        std::cout << "Point cloud residency: " << (physicalMemory / (1024 * 1024)) << " MB physical memory, CPU budget "
+                  << (s_cpuBudgetBytes / (1024 * 1024)) << " MB" << std::endl;
+    }
+
+    void PointCloudResidencyManager::initializeGpu() {
+        size_t totalMemory = 0;
+        if (hasGlExtension("GL_NVX_gpu_memory_info")) {
+            GLint dedicatedKB = 0;
+            glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &dedicatedKB);
+            totalMemory = static_cast<size_t>(dedicatedKB) * 1024;
+            s_gpuMemoryQuery = GpuMemoryQuery::Nvx;
+        } else if (hasGlExtension("GL_ATI_meminfo")) {
+            // Only the free memory is reported; at startup that is close enough to the total
+            GLint freeKB[4] = { 0, 0, 0, 0 };
+            glGetIntegerv(GL_VBO_FREE_MEMORY_ATI, freeKB);
+            totalMemory = static_cast<size_t>(freeKB[0]) * 1024;
+            s_gpuMemoryQuery = GpuMemoryQuery::Ati;
+        }
+
+        if (totalMemory == 0) {
+            s_gpuMemoryQuery = GpuMemoryQuery::None;
+            std::cout << "Point cloud residency: GPU memory unknown, GPU budget " << (s_gpuBudgetBytes / (1024 * 1024)) << " MB" << std::endl;
+            return;
+        }
+
+        // The rest goes to meshes, textures and the stereo framebuffers
+        s_gpuBudgetLimit = totalMemory / 2;
+        s_gpuReserveBytes = totalMemory / 10;
+        s_gpuBudgetBytes = adjustBudget(s_gpuBudgetLimit, s_gpuBudgetLimit, 0, detectAvailableGpuMemory(), s_gpuReserveBytes);
+
+        std::cout << "Point cloud residency: " << (totalMemory / (1024 * 1024)) << " MB video memory, GPU budget "
+                  << (s_gpuBudgetBytes / (1024 * 1024)) << " MB" << std::endl;
+    }
+
+    void PointCloudResidencyManager::beginFrame() {
+        s_frame++;
+    }
+
+    size_t PointCloudResidencyManager::detectPhysicalMemory() {
+#ifdef _WIN32
+        MEMORYSTATUSEX status;
+        status.dwLength = sizeof(status);
+        if (GlobalMemoryStatusEx(&status)) {
+            return static_cast<size_t>(status.ullTotalPhys);
+        }
+#else
+        long pages = sysconf(_SC_PHYS_PAGES);
+        long pageSize = sysconf(_SC_PAGE_SIZE);
+        if (pages > 0 && pageSize > 0) {
+            return static_cast<size_t>(pages) * static_cast<size_t>(pageSize);
+        }
+#endif
+        std::cerr << "Could not detect physical memory, assuming 16 GB" << std::endl;
+        return size_t(16384) * 1024 * 1024;
+    }
+
+    size_t PointCloudResidencyManager::detectAvailableMemory() {
+#ifdef _WIN32
+        MEMORYSTATUSEX status;
+        status.dwLength = sizeof(status);
+        if (GlobalMemoryStatusEx(&status)) {
+            return static_cast<size_t>(status.ullAvailPhys);
+        }
+#else
+        // MemAvailable counts the page cache the kernel would drop for us; the free page
+        // count does not and would read as constant pressure
+        std::ifstream meminfo("/proc/meminfo");
+        std::string key;
+        size_t valueKB = 0;
+        std::string unit;
+        while (meminfo >> key >> valueKB >> unit) {
+            if (key == "MemAvailable:") {
+                return valueKB * 1024;
+            }
+        }
+#ifdef _SC_AVPHYS_PAGES
+        long pages = sysconf(_SC_AVPHYS_PAGES);
+        long pageSize = sysconf(_SC_PAGE_SIZE);
+        if (pages > 0 && pageSize > 0) {
+            return static_cast<size_t>(pages) * static_cast<size_t>(pageSize);
+        }
+#endif
+#endif
+        return 0;
+    }
+
+    size_t PointCloudResidencyManager::detectAvailableGpuMemory() {
+        GLint freeKB[4] = { 0, 0, 0, 0 };
+        switch (s_gpuMemoryQuery) {
+            case GpuMemoryQuery::Nvx:
+                glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, freeKB);
+                break;
+            case GpuMemoryQuery::Ati:
+                glGetIntegerv(GL_VBO_FREE_MEMORY_ATI, freeKB);
+                break;
+            default:
+                return 0;
+        }
+        return static_cast<size_t>(std::max(freeKB[0], 0)) * 1024;
+    }
+
+    bool PointCloudResidencyManager::hasGlExtension(const char* name) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (extension && std::strcmp(extension, name) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t PointCloudResidencyManager::adjustBudget(size_t budget, size_t limit, size_t usage, size_t available, size_t reserve) {
+        if (available == 0) {
+            return budget;
+        }
+
+        // Our own nodes count as reachable: evicting them is how the budget gets met
+        size_t reachable = usage + (available > reserve ? available - reserve : 0);
+        size_t target = std::clamp(reachable, std::min(MIN_BUDGET_BYTES, limit), limit);
+
+        // Shrink at once so the eviction that follows frees the memory, but ignore small dips.
+        // Grow back in steps so a short spike elsewhere does not empty and refill the cache.
+        if (target < budget - budget / 20) {
+            return target;
+        }
+        if (target > budget) {
+            return std::min(target, budget + limit / 8);
+        }
+        return budget;
+    }
+
+    void PointCloudResidencyManager::updateBudgets(const std::vector<PointCloud>& pointClouds) {
+        size_t cpuBudget = adjustBudget(s_cpuBudgetBytes, s_cpuBudgetLimit, getCpuUsage(pointClouds),
+                                        detectAvailableMemory(), s_cpuReserveBytes);
+        size_t gpuBudget = adjustBudget(s_gpuBudgetBytes, s_gpuBudgetLimit, getGpuUsage(pointClouds),
+                                        detectAvailableGpuMemory(), s_gpuReserveBytes);
+
+        if (cpuBudget != s_cpuBudgetBytes || gpuBudget != s_gpuBudgetBytes) {
+            std::cout << "Residency: budgets adjusted to CPU " << (cpuBudget / (1024 * 1024)) << "/" << (s_cpuBudgetLimit / (1024 * 1024))
+                      << " MB, GPU " << (gpuBudget / (1024 * 1024)) << "/" << (s_gpuBudgetLimit / (1024 * 1024)) << " MB" << std::endl;
+        }
+        s_cpuBudgetBytes = cpuBudget;
+        s_gpuBudgetBytes = gpuBudget;
+    }
+
+    size_t PointCloudResidencyManager::getCpuUsage(const std::vector<PointCloud>& pointClouds) {
+        size_t usage = 0;
+        for (const auto& pointCloud : pointClouds) {
+            usage += pointCloud.octreeNodes.residentBytes;
+        }
+        return usage;
+    }
+
+    size_t PointCloudResidencyManager::getGpuUsage(const std::vector<PointCloud>& pointClouds) {
+        size_t usage = 0;
+        for (const auto& pointCloud : pointClouds) {
+            usage += pointCloud.octreeNodes.gpuBytes;
+        }
+        return usage;
+    }
+
+    void PointCloudResidencyManager::enforceBudgets(std::vector<PointCloud>& pointClouds) {
+        if (s_frame % BUDGET_UPDATE_INTERVAL == 0) {
+            updateBudgets(pointClouds);
+        }
+
+        // The tiers are evicted independently: dropping VBOs keeps the RAM copy for a cheap
+        // re-upload, dropping the RAM copy keeps the node drawable from its VBOs
+        size_t cpuUsage = getCpuUsage(pointClouds);
+        bool cpuOverBudget = cpuUsage > s_cpuBudgetBytes;
+        if (cpuOverBudget) {
+            // Streaming through a large cloud overruns every frame, only the first one is logged
+            if (!s_cpuOverBudget) {
+                std::cout << "Residency: CPU over budget at " << (cpuUsage / (1024 * 1024)) << "/"
+                          << (s_cpuBudgetBytes / (1024 * 1024)) << " MB, evicting" << std::endl;
+            }
+            s_cpuEvictions += evictTier(pointClouds, false, cpuUsage, s_cpuBudgetBytes / 10 * 9);
+        }
+        s_cpuOverBudget = cpuOverBudget;
+
+        size_t gpuUsage = getGpuUsage(pointClouds);
+        bool gpuOverBudget = gpuUsage > s_gpuBudgetBytes;
+        if (gpuOverBudget) {
+            if (!s_gpuOverBudget) {
+                std::cout << "Residency: GPU over budget at " << (gpuUsage / (1024 * 1024)) << "/"
+                          << (s_gpuBudgetBytes / (1024 * 1024)) << " MB, evicting" << std::endl;
+            }
+            s_gpuEvictions += evictTier(pointClouds, true, gpuUsage, s_gpuBudgetBytes / 10 * 9);
+        }
+        s_gpuOverBudget = gpuOverBudget;
+    }
+
+    size_t PointCloudResidencyManager::evictTier(std::vector<PointCloud>& pointClouds, bool gpuTier, size_t& usage, size_t target) {
+        // Rank nodes holding this tier from every cloud together: least recently used first,
+        // finer (deeper) nodes before coarse ones on ties
+        std::vector<EvictionCandidate> candidates;
+        for (auto& pointCloud : pointClouds) {
+            const PointCloudNodePool& nodes = pointCloud.octreeNodes;
+            if (gpuTier) {
+                for (uint32_t i = 0; i < nodes.size(); i++) {
+                    if (nodes.hasFlag(i, PointCloudNodePool::NODE_VBOS_GENERATED)) {
+                        candidates.push_back({ &pointCloud, i, nodes.lastAccessedFrame[i], nodes.depth[i] });
+                    }
+                }
+            } else {
+                for (const auto& entry : nodes.residentPoints) {
+                    candidates.push_back({ &pointCloud, entry.first, nodes.lastAccessedFrame[entry.first], nodes.depth[entry.first] });
+                }
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const EvictionCandidate& a, const EvictionCandidate& b) {
+            if (a.lastAccessedFrame != b.lastAccessedFrame) return a.lastAccessedFrame < b.lastAccessedFrame;
+            return a.depth > b.depth;
+        });
+
+        size_t evictedCount = 0;
+        for (const auto& candidate : candidates) {
+            if (usage <= target) {
+                break;
+            }
+
+            PointCloudNodePool& nodes = candidate.pointCloud->octreeNodes;
+            if (gpuTier) {
+                // Nodes drawn this frame would only be uploaded again next frame
+                if (candidate.lastAccessedFrame == s_frame) {
+                    break;
+                }
+                size_t before = nodes.gpuBytes;
+                OctreePointCloudManager::releaseNodeGpuCopy(*candidate.pointCloud, candidate.nodeIndex);
+                usage -= before - nodes.gpuBytes;
+            } else {
+                // The CPU copy of a drawn node can go as long as its VBOs are there
+                if (candidate.lastAccessedFrame == s_frame && !nodes.hasFlag(candidate.nodeIndex, PointCloudNodePool::NODE_VBOS_GENERATED)) {
+                    continue;
+                }
+                size_t before = nodes.residentBytes;
+                OctreePointCloudManager::releaseNodeCpuCopy(*candidate.pointCloud, candidate.nodeIndex);
+                usage -= before - nodes.residentBytes;
+            }
+            evictedCount++;
+        }
+
+        return evictedCount;
+    }
+
+}
@@ -0,0 +1,152 @@
+#include "../../headers/Engine/PointCloudSequenceManager.h"
+#include "../../headers/Engine/OctreePointCloudManager.h"
+#include "../../headers/Loaders/PointCloudLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace Engine {
+
+    uint32_t PointCloudSequenceManager::s_nextSequenceId = 1;
+    std::vector<PointCloudSequenceManager::PendingImport> PointCloudSequenceManager::s_imports;
+
+    void PointCloudSequenceManager::beginImport(const std::vector<std::string>& framePaths, const std::string& name) {
+        PendingImport import;
+        import.sequence.id = allocateSequenceId();
+        import.sequence.name = name.empty() ? "Sequence " + std::to_string(import.sequence.id) : name;
+        import.frames = std::async(std::launch::async, [framePaths, id = import.sequence.id, sequenceName = import.sequence.name]() {
+            return PointCloudLoader::loadSequence(framePaths, id, sequenceName);
+        });
+        std::cout << "Importing point cloud sequence in the background: " << import.sequence.name
+                  << " (" << framePaths.size() << " frames)" << std::endl;
+        s_imports.push_back(std::move(import));
+    }
+
+    bool PointCloudSequenceManager::updateImports(std::vector<PointCloudSequence>& sequences, std::vector<PointCloud>& pointClouds) {
+        bool added = false;
+        for (size_t i = 0; i < s_imports.size();) {
+            PendingImport& import = s_imports[i];
+            if (import.frames.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                i++;
+                continue;
+            }
+
+            std::vector<PointCloud> frames = import.frames.get();
+            if (frames.empty()) {
+                std::cerr << "Failed to load point cloud sequence " << import.sequence.name << std::endl;
+            } else {
+                // Octree frames draw from the GPU arena, the vertex array only holds the attribute layout
+                for (PointCloud& frame : frames) {
+                    PointCloudLoader::setupPointCloudGLBuffers(frame);
+                    pointClouds.push_back(std::move(frame));
+                }
+                sequences.push_back(import.sequence);
+                added = true;
+            }
+            s_imports.erase(s_imports.begin() + i);
+        }
+        return added;
+    }
+
+    void PointCloudSequenceManager::shutdown() {
+        for (PendingImport& import : s_imports) {
+            import.frames.wait();
+        }
+        s_imports.clear();
+    }
+
+    std::vector<PointCloud*> PointCloudSequenceManager::getFrames(const PointCloudSequence& sequence, std::vector<PointCloud>& pointClouds) {
+        std::vector<PointCloud*> frames;
+        for (auto& pointCloud : pointClouds) {
+            if (pointCloud.sequenceId == sequence.id) {
+                frames.push_back(&pointCloud);
+            }
+        }
+        std::sort(frames.begin(), frames.end(),
+            [](const PointCloud* a, const PointCloud* b) { return a->sequenceFrame < b->sequenceFrame; });
+        return frames;
+    }
+
+    void PointCloudSequenceManager::seek(PointCloudSequence& sequence, std::vector<PointCloud>& pointClouds, int frame) {
+        std::vector<PointCloud*> frames = getFrames(sequence, pointClouds);
+        if (frames.empty()) return;
+
+        showFrame(sequence, frames, std::clamp(frame, 0, static_cast<int>(frames.size()) - 1));
+        sequence.frameTimer = 0.0f;
+    }
+
+    void PointCloudSequenceManager::showFrame(PointCloudSequence& sequence, const std::vector<PointCloud*>& frames, int frame) {
+        sequence.currentFrame = frame;
+        for (size_t i = 0; i < frames.size(); i++) {
+            frames[i]->visible = sequence.visible && static_cast<int>(i) == frame;
+        }
+    }
+
+    void PointCloudSequenceManager::update(std::vector<PointCloudSequence>& sequences, std::vector<PointCloud>& pointClouds,
+                                           float deltaTime, const glm::vec3& cameraPosition) {
+        // Sequences whose frames were all deleted
+        sequences.erase(std::remove_if(sequences.begin(), sequences.end(),
+            [&](const PointCloudSequence& sequence) { return getFrames(sequence, pointClouds).empty(); }),
+            sequences.end());
+
+        for (PointCloudSequence& sequence : sequences) {
+            std::vector<PointCloud*> frames = getFrames(sequence, pointClouds);
+
+            int frameCount = static_cast<int>(frames.size());
+            int current = std::clamp(sequence.currentFrame, 0, frameCount - 1);
+
+            if (sequence.visible && sequence.playing && sequence.framesPerSecond > 0.0f) {
+                sequence.frameTimer += deltaTime;
+                float frameDuration = 1.0f / sequence.framesPerSecond;
+
+                if (sequence.frameTimer >= frameDuration) {
+                    // Drop frames rather than fall behind when rendering is slower than playback
+                    int steps = static_cast<int>(sequence.frameTimer / frameDuration);
+                    int next = current + steps;
+                    if (next >= frameCount) {
+                        if (sequence.loop) {
+                            next %= frameCount;
+                        } else {
+                            next = frameCount - 1;
+                            sequence.playing = false;
+                        }
+                    }
+
+                    if (next != current) {
+                        // How much of the new frame the look-ahead already brought in
+                        size_t required = 0;
+                        size_t ready = OctreePointCloudManager::prefetchView(*frames[next], cameraPosition, false, required);
+                        sequence.nodesRequiredOnAdvance += required;
+                        sequence.nodesReadyOnAdvance += ready;
+                        sequence.framesAdvanced++;
+
+                        float rate = steps / sequence.frameTimer;
+                        sequence.measuredFramesPerSecond = sequence.measuredFramesPerSecond > 0.0f
+                            ? sequence.measuredFramesPerSecond * 0.8f + rate * 0.2f
+                            : rate;
+                        current = next;
+                    }
+                    sequence.frameTimer = 0.0f;
+                }
+            }
+
+            // Also re-applies visibility after the sequence was hidden or a frame was removed
+            showFrame(sequence, frames, current);
+            if (!sequence.visible) continue;
+
+            // Look-ahead: the next frame is uploaded so it can be drawn the moment it is shown,
+            // the ones after it only have to be in memory
+            for (int ahead = 1; ahead <= sequence.prefetchFrames && ahead < frameCount; ahead++) {
+                int frame = current + ahead;
+                if (frame >= frameCount) {
+                    if (!sequence.loop) break;
+                    frame %= frameCount;
+                }
+
+                size_t required = 0;
+                OctreePointCloudManager::prefetchView(*frames[frame], cameraPosition, ahead == 1, required);
+            }
+        }
+    }
+
+}
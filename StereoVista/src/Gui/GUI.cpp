@@ -10,6 +10,14 @@
 #include "Core/Voxalizer.h"
 #include "Cursors/Base/CursorManager.h"
 #include "Engine/SpaceMouseInput.h"
+#include "Engine/OctreePointCloudManager.h"
+#include "Engine/MeshBatchRenderer.h"
+#include "Engine/MeshClusterCuller.h"
+#include "Engine/MeshGeometryRegistry.h"
+#include "Engine/PointCloudResidencyManager.h"
+#include "Engine/PointCloudSequenceManager.h"
+#include "Loaders/ModelImportManager.h"
+#include "Loaders/MeshOptimizer.h"
 #include "imgui/imgui_sytle.h"
 #include <utility>
 
@@ -126,8 +134,8 @@ void renderGUI(bool isLeftEye, ImGuiViewportP* viewport, ImGuiWindowFlags window
                     if (!selection.empty()) {
                         std::string filePath = selection[0];
                         try {
-                            Engine::Model newModel = *Engine::loadModel(filePath);
-                            currentScene.models.push_back(newModel);
+                            // Shows up as a box right away, the meshes follow as they are imported
+                            currentScene.models.push_back(Engine::ModelImportManager::beginImport(filePath));
                             currentSelectedIndex = currentScene.models.size() - 1;
                             currentSelectedType = SelectedType::Model;
                             updateSpaceMouseBounds();
@@ -154,7 +162,7 @@ void renderGUI(bool isLeftEye, ImGuiViewportP* viewport, ImGuiWindowFlags window
                         }
                         else if (extension == ".pcb") {
                             Engine::PointCloud newPointCloud = std::move(Engine::PointCloudLoader::loadFromBinary(filePath));
-                            if (newPointCloud.octreeRoot || !newPointCloud.points.empty()) {
+                            if (newPointCloud.hasOctree() || !newPointCloud.points.empty()) {
                                 newPointCloud.filePath = filePath;
                                 newPointCloud.name = std::filesystem::path(filePath).stem().string();
                                 currentScene.pointClouds.emplace_back(std::move(newPointCloud));
@@ -167,7 +175,7 @@ void renderGUI(bool isLeftEye, ImGuiViewportP* viewport, ImGuiWindowFlags window
                         }
                         else if (extension == ".h5" || extension == ".hdf5" || extension == ".f5") {
                             Engine::PointCloud newPointCloud = std::move(Engine::PointCloudLoader::loadPointCloudFile(filePath));
-                            if (newPointCloud.octreeRoot || !newPointCloud.points.empty()) {
+                            if (newPointCloud.hasOctree() || !newPointCloud.points.empty()) {
                                 newPointCloud.filePath = filePath;
                                 newPointCloud.name = std::filesystem::path(filePath).stem().string();
                                 currentScene.pointClouds.emplace_back(std::move(newPointCloud));
@@ -180,6 +188,18 @@ void renderGUI(bool isLeftEye, ImGuiViewportP* viewport, ImGuiWindowFlags window
                         }
                     }
                 }
+                if (ImGui::MenuItem("Point Cloud Sequence...")) {
+                    auto selection = pfd::open_file("Select the frames of a point cloud sequence", ".",
+                        { "Point Cloud Files", "*.txt *.xyz *.ply *.pcb *.h5 *.hdf5 *.f5",
+                          "All Files", "*" }, pfd::opt::multiselect).result();
+
+                    if (!selection.empty()) {
+                        // Frames play in file name order
+                        std::sort(selection.begin(), selection.end());
+                        Engine::PointCloudSequenceManager::beginImport(selection,
+                            std::filesystem::path(selection[0]).parent_path().filename().string());
+                    }
+                }
                 ImGui::EndMenu();
             }
             ImGui::Separator();
@@ -217,7 +237,7 @@ void renderGUI(bool isLeftEye, ImGuiViewportP* viewport, ImGuiWindowFlags window
                 Engine::Model newCube = Engine::createCube(glm::vec3(0.8f, 0.8f, 0.8f), 1.0f, 0.0f);
                 newCube.scale = glm::vec3(0.5f);
                 newCube.position = glm::vec3(0.0f, 0.0f, 0.0f);
-                currentScene.models.push_back(newCube);
+                currentScene.models.push_back(std::move(newCube));
                 currentSelectedIndex = currentScene.models.size() - 1;
                 currentSelectedType = SelectedType::Model;
                 updateSpaceMouseBounds();
@@ -226,7 +246,7 @@ void renderGUI(bool isLeftEye, ImGuiViewportP* viewport, ImGuiWindowFlags window
                 Engine::Model newSphere = Engine::createSphere(glm::vec3(0.8f, 0.4f, 0.4f), 1.0f, 0.0f);
                 newSphere.scale = glm::vec3(0.5f);
                 newSphere.position = glm::vec3(0.0f, 0.0f, 0.0f);
-                currentScene.models.push_back(newSphere);
+                currentScene.models.push_back(std::move(newSphere));
                 currentSelectedIndex = currentScene.models.size() - 1;
                 currentSelectedType = SelectedType::Model;
                 updateSpaceMouseBounds();
@@ -235,7 +255,7 @@ void renderGUI(bool isLeftEye, ImGuiViewportP* viewport, ImGuiWindowFlags window
                 Engine::Model newCylinder = Engine::createCylinder(glm::vec3(0.4f, 0.8f, 0.4f), 1.0f, 0.0f);
                 newCylinder.scale = glm::vec3(0.5f);
                 newCylinder.position = glm::vec3(0.0f, 0.0f, 0.0f);
-                currentScene.models.push_back(newCylinder);
+                currentScene.models.push_back(std::move(newCylinder));
                 currentSelectedIndex = currentScene.models.size() - 1;
                 currentSelectedType = SelectedType::Model;
                 updateSpaceMouseBounds();
@@ -244,7 +264,7 @@ void renderGUI(bool isLeftEye, ImGuiViewportP* viewport, ImGuiWindowFlags window
                 Engine::Model newPlane = Engine::createPlane(glm::vec3(0.6f, 0.6f, 0.8f), 1.0f, 0.0f);
                 newPlane.scale = glm::vec3(1.0f);
                 newPlane.position = glm::vec3(0.0f, 0.0f, 0.0f);
-                currentScene.models.push_back(newPlane);
+                currentScene.models.push_back(std::move(newPlane));
                 currentSelectedIndex = currentScene.models.size() - 1;
                 currentSelectedType = SelectedType::Model;
                 updateSpaceMouseBounds();
@@ -253,7 +273,7 @@ void renderGUI(bool isLeftEye, ImGuiViewportP* viewport, ImGuiWindowFlags window
                 Engine::Model newTorus = Engine::createTorus(glm::vec3(0.8f, 0.6f, 0.2f), 1.0f, 0.0f);
                 newTorus.scale = glm::vec3(0.8f);
                 newTorus.position = glm::vec3(0.0f, 0.0f, 0.0f);
-                currentScene.models.push_back(newTorus);
+                currentScene.models.push_back(std::move(newTorus));
                 currentSelectedIndex = currentScene.models.size() - 1;
                 currentSelectedType = SelectedType::Model;
                 updateSpaceMouseBounds();
@@ -517,6 +537,22 @@ void renderGUI(bool isLeftEye, ImGuiViewportP* viewport, ImGuiWindowFlags window
         ImGui::EndChild();
     }
 
+    // Background model imports
+    for (const auto& import : Engine::ModelImportManager::getImports()) {
+        ImGui::PushID(static_cast<int>(import.id));
+        ImGui::TextUnformatted(std::filesystem::path(import.path).filename().string().c_str());
+        std::string overlay = Engine::ModelImportManager::stageName(import.stage);
+        if (import.totalMeshes > 0) {
+            overlay += " " + std::to_string(import.meshesLoaded) + "/" + std::to_string(import.totalMeshes);
+        }
+        ImGui::ProgressBar(import.progress, ImVec2(-70, 0), overlay.c_str());
+        ImGui::SameLine();
+        if (ImGui::Button("Cancel", ImVec2(-1, 0))) {
+            Engine::ModelImportManager::cancel(import.id);
+        }
+        ImGui::PopID();
+    }
+
     ImGui::Separator();
 
     // Object Manipulation Panels
@@ -769,6 +805,39 @@ void renderSettingsWindow() {
                 settingsChanged = true;
             }
             ImGui::SetItemTooltip("Renders objects as wireframes instead of solid surfaces");
+
+            ImGui::Checkbox("Quantize Mesh Positions", &Engine::Mesh::quantizePositions);
+            ImGui::SetItemTooltip("Stores positions of models loaded from now on as 16-bit values, saving GPU memory at the cost of precision");
+
+            bool optimizeMeshes = Engine::MeshOptimizer::isEnabled();
+            if (ImGui::Checkbox("Optimize Mesh Order", &optimizeMeshes)) {
+                Engine::MeshOptimizer::setEnabled(optimizeMeshes);
+            }
+            ImGui::SetItemTooltip("Reorders triangles and vertices of models loaded from now on for the vertex cache and less overdraw");
+
+            ImGui::Checkbox("Mesh LOD", &Engine::Mesh::lodEnabled);
+            ImGui::SetItemTooltip("Draws simplified versions of large meshes when they are small on screen");
+            if (Engine::Mesh::lodEnabled) {
+                ImGui::SliderFloat("LOD Error (px)", &Engine::Mesh::lodPixelError, 0.25f, 8.0f, "%.2f");
+                ImGui::SetItemTooltip("Largest on-screen deviation from the full mesh that a simplified level may have");
+            }
+
+            bool clusterCulling = Engine::MeshClusterCuller::isEnabled();
+            if (ImGui::Checkbox("Cluster Culling", &clusterCulling)) {
+                Engine::MeshClusterCuller::setEnabled(clusterCulling);
+            }
+            ImGui::SetItemTooltip("Skips the parts of large meshes that are outside both eye frusta or facing away from both eyes");
+            if (clusterCulling) {
+                const Engine::MeshClusterCuller::Stats& clusterStats = Engine::MeshClusterCuller::getStats();
+                ImGui::Text("Clusters: %u of %u visible, %u ranges", clusterStats.visibleClusters, clusterStats.clusters, clusterStats.commands);
+            }
+            const Engine::MeshBatchRenderer::Stats& batchStats = Engine::MeshBatchRenderer::getStats(Engine::MeshBatchRenderer::PASS_SCENE);
+            ImGui::Text("Meshes: %u in %u multi-draws, %u draws", batchStats.meshes, batchStats.batches, batchStats.commands);
+            const Engine::MeshGeometryRegistry::Stats geometryStats = Engine::MeshGeometryRegistry::getStats();
+            ImGui::Text("Shared geometry: %u copies for %u meshes, %.1f MB saved", geometryStats.geometries, geometryStats.meshes,
+                geometryStats.savedBytes / (1024.0 * 1024.0));
+            ImGui::Text("Geometry: %.1f of %.1f MB used",
+                Engine::MeshGpuArena::getAllocatedBytes() / (1024.0 * 1024.0), Engine::MeshGpuArena::getReservedBytes() / (1024.0 * 1024.0));
             ImGui::EndGroup();
             
             ImGui::Spacing();
@@ -2031,7 +2100,7 @@ void renderModelManipulationPanel(Engine::Model& model, Engine::Shader* shader)
                 if (!selection.empty()) {
                     // Create and load new texture
                     Texture texture;
-                    texture.id = model.TextureFromFile(selection[0].c_str(), selection[0], selection[0]);
+                    texture.adopt(model.TextureFromFile(selection[0].c_str(), selection[0], selection[0]));
                     texture.type = type;
                     texture.path = selection[0];
 
@@ -2108,7 +2177,7 @@ void renderMeshManipulationPanel(Engine::Model& model, int meshIndex, Engine::Sh
                 if (!selection.empty()) {
                     // Create and load new texture
                     Texture texture;
-                    texture.id = model.TextureFromFile(selection[0].c_str(), selection[0], selection[0]);
+                    texture.adopt(model.TextureFromFile(selection[0].c_str(), selection[0], selection[0]));
                     texture.type = type;
                     texture.path = selection[0];
 
@@ -2166,7 +2235,7 @@ void renderMeshManipulationPanel(Engine::Model& model, int meshIndex, Engine::Sh
 void renderPointCloudManipulationPanel(Engine::PointCloud& pointCloud) {
     ImGui::Text("Point Cloud Manipulation: %s", pointCloud.name.c_str());
     // Check if point cloud has data (either in points vector or octree)
-    bool hasData = !pointCloud.points.empty() || pointCloud.octreeRoot;
+    bool hasData = !pointCloud.points.empty() || pointCloud.hasOctree();
     if (!hasData) {
         ImGui::Text("Point cloud is empty");
         return;
@@ -2217,6 +2286,178 @@ void renderPointCloudManipulationPanel(Engine::PointCloud& pointCloud) {
         ImGui::Checkbox("Visualize Chunks", &pointCloud.visualizeChunks);
     }
 
+    if (pointCloud.sequenceId != 0) {
+        auto sequence = std::find_if(currentScene.pointCloudSequences.begin(), currentScene.pointCloudSequences.end(),
+            [&](const Engine::PointCloudSequence& s) { return s.id == pointCloud.sequenceId; });
+
+        if (sequence != currentScene.pointCloudSequences.end() && ImGui::CollapsingHeader("Sequence Playback", ImGuiTreeNodeFlags_DefaultOpen)) {
+            int frameCount = static_cast<int>(Engine::PointCloudSequenceManager::getFrames(*sequence, currentScene.pointClouds).size());
+            ImGui::Text("%s: frame %d of %d", sequence->name.c_str(), sequence->currentFrame + 1, frameCount);
+
+            if (ImGui::Button(sequence->playing ? "Pause" : "Play")) {
+                sequence->playing = !sequence->playing;
+                sequence->frameTimer = 0.0f;
+            }
+            ImGui::SameLine();
+            ImGui::Checkbox("Loop", &sequence->loop);
+            ImGui::SameLine();
+            ImGui::Checkbox("Visible", &sequence->visible);
+
+            int frame = sequence->currentFrame;
+            if (ImGui::SliderInt("Frame", &frame, 0, std::max(0, frameCount - 1))) {
+                Engine::PointCloudSequenceManager::seek(*sequence, currentScene.pointClouds, frame);
+            }
+            ImGui::SliderFloat("Frames Per Second", &sequence->framesPerSecond, 0.5f, 60.0f, "%.1f");
+            ImGui::SliderInt("Prefetch Frames", &sequence->prefetchFrames, 0, 10);
+            ImGui::SetItemTooltip("Frames ahead of the current one whose visible nodes are streamed in");
+
+            ImGui::Text("Playback: %.1f fps, prefetch hit rate %.1f%% over %u frames",
+                sequence->measuredFramesPerSecond, 100.0f * sequence->getPrefetchHitRate(), sequence->framesAdvanced);
+        }
+    }
+
+    if (pointCloud.hasOctree() && ImGui::CollapsingHeader("Clip Volumes")) {
+        using Engine::PointCloudClipVolume;
+        auto& volumes = pointCloud.clipVolumes;
+
+        bool canAdd = volumes.size() < static_cast<size_t>(Engine::PointCloud::MAX_CLIP_VOLUMES);
+        ImGui::BeginDisabled(!canAdd);
+        if (ImGui::Button("Add Box")) {
+            // Start with the middle half of the cloud
+            PointCloudClipVolume volume;
+            glm::vec3 quarter = (pointCloud.octreeBoundsMax - pointCloud.octreeBoundsMin) * 0.25f;
+            volume.boxMin = pointCloud.octreeBoundsMin + quarter;
+            volume.boxMax = pointCloud.octreeBoundsMax - quarter;
+            volumes.push_back(volume);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Add Plane")) {
+            PointCloudClipVolume volume;
+            volume.shape = PointCloudClipVolume::Shape::Plane;
+            volume.planeOffset = -pointCloud.octreeCenter.z;
+            volumes.push_back(volume);
+        }
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        if (ImGui::Button("Clear")) {
+            volumes.clear();
+        }
+
+        float dragSpeed = std::max(0.01f, pointCloud.octreeSize * 0.002f);
+        for (size_t i = 0; i < volumes.size(); i++) {
+            PointCloudClipVolume& volume = volumes[i];
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::Separator();
+
+            ImGui::Checkbox(volume.shape == PointCloudClipVolume::Shape::Box ? "Box" : "Plane", &volume.enabled);
+            ImGui::SameLine();
+            int mode = static_cast<int>(volume.mode);
+            ImGui::SetNextItemWidth(120.0f);
+            if (ImGui::Combo("##Mode", &mode, "Keep Inside\0Keep Outside\0")) {
+                volume.mode = static_cast<PointCloudClipVolume::Mode>(mode);
+            }
+            ImGui::SameLine();
+            bool remove = ImGui::Button("Remove");
+
+            if (volume.shape == PointCloudClipVolume::Shape::Box) {
+                ImGui::DragFloat3("Min", glm::value_ptr(volume.boxMin), dragSpeed);
+                ImGui::DragFloat3("Max", glm::value_ptr(volume.boxMax), dragSpeed);
+                volume.boxMax = glm::max(volume.boxMax, volume.boxMin);
+            } else {
+                if (ImGui::DragFloat3("Normal", glm::value_ptr(volume.planeNormal), 0.01f, -1.0f, 1.0f) &&
+                    glm::length(volume.planeNormal) > 1e-4f) {
+                    volume.planeNormal = glm::normalize(volume.planeNormal);
+                }
+                ImGui::DragFloat("Offset", &volume.planeOffset, dragSpeed);
+            }
+
+            ImGui::PopID();
+            if (remove) {
+                volumes.erase(volumes.begin() + i);
+                break;
+            }
+        }
+    }
+
+    if (pointCloud.hasOctree() && ImGui::CollapsingHeader("Streaming")) {
+        ImGui::Checkbox("Predictive Prefetch", &pointCloud.enablePrefetch);
+        ImGui::SetItemTooltip("Loads nodes ahead of the camera based on its current motion");
+        ImGui::SliderFloat("Prefetch Horizon (s)", &pointCloud.prefetchHorizon, 0.1f, 2.0f);
+        ImGui::SetItemTooltip("How far ahead along the camera path nodes are requested");
+
+        const auto& nodes = pointCloud.octreeNodes;
+        ImGui::Text("Prefetch Hit Rate: %.1f%%", Engine::OctreePointCloudManager::getPrefetchHitRate(pointCloud) * 100.0f);
+        ImGui::Text("Prefetched: %u  Hits: %u  Late: %u  On Demand: %u",
+            nodes.prefetchRequests, nodes.prefetchHits, nodes.prefetchLate, nodes.demandLoads);
+
+        const auto& renderList = pointCloud.renderList;
+        uint32_t selections = renderList.selectionsRebuilt + renderList.selectionsReused;
+        ImGui::Text("Render List: %zu nodes, reused %.1f%% of frames", renderList.drawNodes.size(),
+            selections > 0 ? 100.0f * renderList.selectionsReused / selections : 0.0f);
+
+        ImGui::Separator();
+        ImGui::Checkbox("Keep CPU Copy After Upload", &pointCloud.keepCpuCopy);
+        ImGui::SetItemTooltip("Keeps node points in RAM next to their GPU copy. Faster queries and picking, but twice the memory");
+        ImGui::Text("This Cloud: CPU %zu MB, GPU %zu MB", nodes.residentBytes / (1024 * 1024), nodes.gpuBytes / (1024 * 1024));
+        ImGui::Text("Scene: CPU %zu / %zu MB, GPU %zu / %zu MB",
+            Engine::PointCloudResidencyManager::getCpuUsage(currentScene.pointClouds) / (1024 * 1024),
+            Engine::PointCloudResidencyManager::getCpuBudget() / (1024 * 1024),
+            Engine::PointCloudResidencyManager::getGpuUsage(currentScene.pointClouds) / (1024 * 1024),
+            Engine::PointCloudResidencyManager::getGpuBudget() / (1024 * 1024));
+        ImGui::Text("Evicted: CPU %zu, GPU %zu copies",
+            Engine::PointCloudResidencyManager::getCpuEvictions(),
+            Engine::PointCloudResidencyManager::getGpuEvictions());
+        if (Engine::PointCloudResidencyManager::getCpuBudget() < Engine::PointCloudResidencyManager::getCpuBudgetLimit() ||
+            Engine::PointCloudResidencyManager::getGpuBudget() < Engine::PointCloudResidencyManager::getGpuBudgetLimit()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.7f, 0.2f, 1.0f), "Budgets lowered by memory pressure (limits CPU %zu MB, GPU %zu MB)",
+                Engine::PointCloudResidencyManager::getCpuBudgetLimit() / (1024 * 1024),
+                Engine::PointCloudResidencyManager::getGpuBudgetLimit() / (1024 * 1024));
+        }
+        ImGui::Text("Leaf Size: %zu points%s", pointCloud.maxPointsPerNode, pointCloud.autoLeafSize ? " (auto)" : "");
+        ImGui::Text("GPU Arena: %zu / %zu MB in %zu buffers",
+            Engine::PointCloudGpuArena::getAllocatedBytes() / (1024 * 1024),
+            Engine::PointCloudGpuArena::getReservedBytes() / (1024 * 1024),
+            Engine::PointCloudGpuArena::getBufferCount());
+    }
+
+    if (pointCloud.hasOctree() && ImGui::CollapsingHeader("Build Statistics")) {
+        const auto& stats = pointCloud.buildStats;
+        ImGui::Text("Built with max depth %d, %zu points per node", stats.maxOctreeDepth, stats.maxPointsPerNode);
+        ImGui::Text("Points: %zu input, %zu stored", stats.inputPoints, stats.storedPoints);
+        ImGui::Text("Removed: %zu duplicates, %zu outliers", stats.duplicatesRemoved, stats.outliersRemoved);
+        ImGui::Text("Nodes: %u, leaves: %u (%u at depth limit, %u overfull)",
+            stats.nodeCount, stats.leafCount, stats.leavesAtMaxDepth, stats.overfullLeaves);
+        ImGui::Text("Leaf points: min %u, mean %.0f, max %u", stats.minLeafPoints, stats.meanLeafPoints(), stats.maxLeafPoints);
+        ImGui::Text("Cache: %u pages, %.1f MB", stats.cachePages, stats.cacheBytes / (1024.0 * 1024.0));
+
+        if (ImGui::BeginTable("OctreeDepths", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchSame)) {
+            ImGui::TableSetupColumn("Depth");
+            ImGui::TableSetupColumn("Nodes");
+            ImGui::TableSetupColumn("Leaves");
+            ImGui::TableSetupColumn("Points");
+            ImGui::TableHeadersRow();
+            for (size_t depth = 0; depth < stats.nodesPerDepth.size(); depth++) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::Text("%zu", depth);
+                ImGui::TableNextColumn(); ImGui::Text("%u", stats.nodesPerDepth[depth]);
+                ImGui::TableNextColumn(); ImGui::Text("%u", stats.leavesPerDepth[depth]);
+                ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(stats.pointsPerDepth[depth]));
+            }
+            ImGui::EndTable();
+        }
+
+        if (!stats.leafFillHistogram.empty()) {
+            std::vector<float> fill(stats.leafFillHistogram.begin(), stats.leafFillHistogram.end());
+            ImGui::PlotHistogram("Leaf Fill", fill.data(), static_cast<int>(fill.size()), 0, "0% to 100% of max points per node",
+                0.0f, FLT_MAX, ImVec2(0, 60));
+        }
+
+        ImGui::Text("Partition %.2f s, cleanup %.2f s, pages %.2f s, total %.2f s",
+            stats.partitionSeconds, stats.cleanupSeconds, stats.pageSeconds, stats.buildSeconds);
+        ImGui::Text("Normals %.2f CPU s, encode and write %.2f CPU s", stats.normalCpuSeconds, stats.encodeCpuSeconds);
+        ImGui::SetItemTooltip("Summed over the build threads");
+    }
+
     ImGui::Separator();
 
     if (ImGui::CollapsingHeader("Export", ImGuiTreeNodeFlags_DefaultOpen)) {
@@ -2224,17 +2465,44 @@ void renderPointCloudManipulationPanel(Engine::PointCloud& pointCloud) {
             ImGui::OpenPopup("Export Point Cloud");
         }
 
+        // Octree clouds are exported in the background from their node pages, cropped to the
+        // clip volumes. Only one such export runs at a time.
+        static std::future<bool> backgroundExport;
+        static std::string backgroundExportPath;
+        bool exportRunning = backgroundExport.valid() &&
+            backgroundExport.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+        if (backgroundExport.valid() && !exportRunning) {
+            if (backgroundExport.get()) {
+                std::cout << "Point cloud exported successfully to " << backgroundExportPath << std::endl;
+            }
+            else {
+                std::cerr << "Failed to export point cloud to " << backgroundExportPath << std::endl;
+            }
+        }
+        if (exportRunning) {
+            ImGui::SameLine();
+            ImGui::Text("Exporting to %s...", std::filesystem::path(backgroundExportPath).filename().string().c_str());
+        }
+
         if (ImGui::BeginPopupModal("Export Point Cloud", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
             static int exportFormat = 0;
             ImGui::RadioButton("XYZ", &exportFormat, 0);
             ImGui::RadioButton("Optimized Binary", &exportFormat, 1);
+            if (pointCloud.hasOctree() && !pointCloud.clipVolumes.empty()) {
+                ImGui::Text("Only points kept by the clip volumes are exported");
+            }
 
+            ImGui::BeginDisabled(exportRunning);
             if (ImGui::Button("Export")) {
                 std::string defaultExt = (exportFormat == 0) ? ".xyz" : ".pcb";
                 auto destination = pfd::save_file("Select a file to export point cloud", ".",
                     { "Point Cloud Files", "*" + defaultExt, "All Files", "*" }).result();
 
-                if (!destination.empty()) {
+                if (!destination.empty() && pointCloud.hasOctree()) {
+                    backgroundExportPath = destination;
+                    backgroundExport = Engine::PointCloudLoader::exportClippedAsync(pointCloud, destination, exportFormat == 1);
+                }
+                else if (!destination.empty()) {
                     bool success = false;
                     if (exportFormat == 0) {
                         success = Engine::PointCloudLoader::exportToXYZ(pointCloud, destination);
@@ -2252,6 +2520,7 @@ void renderPointCloudManipulationPanel(Engine::PointCloud& pointCloud) {
                 }
                 ImGui::CloseCurrentPopup();
             }
+            ImGui::EndDisabled();
 
             ImGui::SameLine();
             if (ImGui::Button("Cancel")) {
@@ -0,0 +1,621 @@
+#include "Loaders/MeshCache.h"
+#include "Loaders/MeshOptimizer.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Engine {
+
+    bool MeshCache::s_enabled = true;
+    std::string MeshCache::s_cacheDirectory = "mesh_cache";
+
+    // File layout: header, then per mesh its vertices (16-byte aligned) followed by its indices
+    // and LOD indices, then the mesh, LOD, meshlet, material and texture records and the string
+    // blob they point into
+    struct MeshCacheHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint32_t vertexSize;
+        uint32_t meshCount;
+        uint32_t materialCount;
+        uint32_t textureCount;
+        uint32_t lodCount;
+        uint32_t meshletCount;
+        uint64_t tableOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+
+    struct MeshCacheMeshRecord {
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        uint64_t lodIndexOffset;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t lodIndexCount;
+        uint32_t firstLod;
+        uint32_t lodCount;
+        uint32_t firstMeshlet;
+        uint32_t meshletCount;
+        uint32_t materialIndex;
+        float color[3];
+        float shininess;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+    };
+
+    struct MeshCacheLodRecord {
+        uint32_t indexOffset;
+        uint32_t indexCount;
+        float error;
+    };
+
+    struct MeshCacheMeshletRecord {
+        uint32_t indexOffset;
+        uint32_t indexCount;
+        float center[3];
+        float radius;
+        float coneAxis[3];
+        float coneCutoff;
+    };
+
+    struct MeshCacheMaterialRecord {
+        uint32_t firstTexture;
+        uint32_t textureCount;
+    };
+
+    struct MeshCacheTextureRecord {
+        uint32_t typeOffset, typeLength;
+        uint32_t pathOffset, pathLength;
+        uint32_t fullPathOffset, fullPathLength;
+    };
+
+    static_assert(sizeof(MeshCacheHeader) == 88, "Mesh cache header layout changed");
+    static_assert(sizeof(MeshCacheMeshRecord) == 80, "Mesh cache record layout changed");
+
+    static const char MESH_CACHE_MAGIC[4] = { 'S', 'V', 'M', 'C' };
+
+    // ---- MappedFile ----
+
+    MappedFile::~MappedFile() {
+        close();
+    }
+
+    bool MappedFile::open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            CloseHandle(file);
+            return false;
+        }
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        m_file = file;
+        m_mapping = mapping;
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+
+        void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        madvise(view, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+        m_fd = fd;
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<size_t>(fileStat.st_size);
+#endif
+        return true;
+    }
+
+    void MappedFile::close() {
+        if (!m_data) return;
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+        ::close(m_fd);
+        m_fd = -1;
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    // ---- Cache keys ----
+
+    static uint64_t mixHash(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    uint64_t MeshCache::computeKey(const std::string& sourcePath, unsigned int importFlags) {
+        std::ifstream file(sourcePath, std::ios::binary);
+        if (!file) {
+            return 0;
+        }
+
+        // One multiply-rotate per 8 bytes; reading the file is the limit, not the hash
+        const size_t BLOCK_SIZE = 1 << 20;
+        std::vector<char> block(BLOCK_SIZE);
+        uint64_t h = 0x9E3779B97F4A7C15ULL;
+        uint64_t totalBytes = 0;
+        while (file) {
+            file.read(block.data(), BLOCK_SIZE);
+            size_t bytesRead = static_cast<size_t>(file.gcount());
+            if (bytesRead == 0) break;
+
+            size_t words = bytesRead / 8;
+            for (size_t i = 0; i < words; i++) {
+                uint64_t word;
+                std::memcpy(&word, block.data() + i * 8, 8);
+                h ^= word * 0x87c37b91114253d5ULL;
+                h = ((h << 27) | (h >> 37)) * 0x9E3779B97F4A7C15ULL + 0x52dce729ULL;
+            }
+            // Only the last block can end in a partial word
+            if (bytesRead % 8 != 0) {
+                uint64_t word = 0;
+                std::memcpy(&word, block.data() + words * 8, bytesRead % 8);
+                h ^= word * 0x87c37b91114253d5ULL;
+                h = ((h << 27) | (h >> 37)) * 0x9E3779B97F4A7C15ULL + 0x52dce729ULL;
+            }
+            totalBytes += bytesRead;
+        }
+
+        // Cook options that change the output are part of the key, toggling them misses the cache
+        uint64_t cookOptions = MeshOptimizer::isEnabled() ? 1 : 0;
+        uint64_t key = mixHash(h ^ totalBytes) ^
+            mixHash(importFlags ^ (static_cast<uint64_t>(FORMAT_VERSION) << 32) ^ (cookOptions << 44) ^ (static_cast<uint64_t>(sizeof(Vertex)) << 48));
+        return key != 0 ? key : 1;
+    }
+
+    std::string MeshCache::getCachePath(uint64_t key) {
+        std::ostringstream name;
+        name << std::hex << std::setw(16) << std::setfill('0') << key << ".svmesh";
+        return (std::filesystem::path(s_cacheDirectory) / name.str()).string();
+    }
+
+    // ---- Reading ----
+
+    std::unique_ptr<MeshCache::CachedModel> MeshCache::open(uint64_t key) {
+        std::string path = getCachePath(key);
+        std::error_code ec;
+        if (!std::filesystem::exists(path, ec)) {
+            return nullptr;
+        }
+
+        auto model = std::make_unique<CachedModel>();
+        if (!model->file.open(path)) {
+            std::cerr << "Failed to map mesh cache file: " << path << std::endl;
+            return nullptr;
+        }
+
+        const uint8_t* data = model->file.data();
+        const size_t size = model->file.size();
+        auto invalid = [&path](const char* reason) -> std::unique_ptr<CachedModel> {
+            std::cerr << "Ignoring mesh cache file " << path << ": " << reason << std::endl;
+            return nullptr;
+        };
+
+        if (size < sizeof(MeshCacheHeader)) {
+            return invalid("truncated header");
+        }
+        MeshCacheHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, MESH_CACHE_MAGIC, 4) != 0 || header.version != FORMAT_VERSION) {
+            return invalid("unknown format");
+        }
+        if (header.key != key || header.vertexSize != sizeof(Vertex)) {
+            return invalid("key or vertex layout mismatch");
+        }
+
+        uint64_t tableSize = static_cast<uint64_t>(header.meshCount) * sizeof(MeshCacheMeshRecord) +
+            static_cast<uint64_t>(header.lodCount) * sizeof(MeshCacheLodRecord) +
+            static_cast<uint64_t>(header.meshletCount) * sizeof(MeshCacheMeshletRecord) +
+            static_cast<uint64_t>(header.materialCount) * sizeof(MeshCacheMaterialRecord) +
+            static_cast<uint64_t>(header.textureCount) * sizeof(MeshCacheTextureRecord);
+        if (header.tableOffset > size || tableSize > size - header.tableOffset ||
+            header.stringsOffset > size || header.stringsSize > size - header.stringsOffset) {
+            return invalid("table out of range");
+        }
+
+        const char* strings = reinterpret_cast<const char*>(data + header.stringsOffset);
+        auto readString = [&](uint32_t offset, uint32_t length, std::string& out) {
+            if (static_cast<uint64_t>(offset) + length > header.stringsSize) return false;
+            out.assign(strings + offset, length);
+            return true;
+        };
+
+        const uint8_t* cursor = data + header.tableOffset;
+
+        std::vector<MeshCacheMeshRecord> meshRecords(header.meshCount);
+        if (header.meshCount > 0) {
+            std::memcpy(meshRecords.data(), cursor, header.meshCount * sizeof(MeshCacheMeshRecord));
+            cursor += header.meshCount * sizeof(MeshCacheMeshRecord);
+        }
+
+        std::vector<MeshCacheLodRecord> lodRecords(header.lodCount);
+        if (header.lodCount > 0) {
+            std::memcpy(lodRecords.data(), cursor, header.lodCount * sizeof(MeshCacheLodRecord));
+            cursor += header.lodCount * sizeof(MeshCacheLodRecord);
+        }
+
+        std::vector<MeshCacheMeshletRecord> meshletRecords(header.meshletCount);
+        if (header.meshletCount > 0) {
+            std::memcpy(meshletRecords.data(), cursor, header.meshletCount * sizeof(MeshCacheMeshletRecord));
+            cursor += header.meshletCount * sizeof(MeshCacheMeshletRecord);
+        }
+
+        model->meshes.resize(header.meshCount);
+        for (uint32_t i = 0; i < header.meshCount; i++) {
+            const MeshCacheMeshRecord& record = meshRecords[i];
+
+            uint64_t vertexBytes = static_cast<uint64_t>(record.vertexCount) * sizeof(Vertex);
+            uint64_t indexBytes = static_cast<uint64_t>(record.indexCount) * sizeof(GLuint);
+            uint64_t lodIndexBytes = static_cast<uint64_t>(record.lodIndexCount) * sizeof(GLuint);
+            if (record.vertexOffset > size || vertexBytes > size - record.vertexOffset ||
+                record.indexOffset > size || indexBytes > size - record.indexOffset ||
+                record.lodIndexOffset > size || lodIndexBytes > size - record.lodIndexOffset ||
+                record.vertexOffset % alignof(Vertex) != 0 || record.indexOffset % alignof(GLuint) != 0 ||
+                record.lodIndexOffset % alignof(GLuint) != 0 ||
+                static_cast<uint64_t>(record.firstLod) + record.lodCount > header.lodCount ||
+                static_cast<uint64_t>(record.firstMeshlet) + record.meshletCount > header.meshletCount ||
+                (header.materialCount > 0 && record.materialIndex >= header.materialCount)) {
+                return invalid("mesh out of range");
+            }
+
+            CachedMesh& mesh = model->meshes[i];
+            mesh.vertices = reinterpret_cast<const Vertex*>(data + record.vertexOffset);
+            mesh.vertexCount = record.vertexCount;
+            mesh.indices = reinterpret_cast<const GLuint*>(data + record.indexOffset);
+            mesh.indexCount = record.indexCount;
+            mesh.lodIndices = reinterpret_cast<const GLuint*>(data + record.lodIndexOffset);
+            mesh.lodIndexCount = record.lodIndexCount;
+            // An index past the vertices would read outside the mesh's arena range when drawn
+            auto indicesInRange = [&mesh](const GLuint* indices, uint32_t count) {
+                for (uint32_t k = 0; k < count; k++) {
+                    if (indices[k] >= mesh.vertexCount) return false;
+                }
+                return true;
+            };
+            if (!indicesInRange(mesh.indices, mesh.indexCount) || !indicesInRange(mesh.lodIndices, mesh.lodIndexCount)) {
+                return invalid("index out of range");
+            }
+            for (uint32_t l = record.firstLod; l < record.firstLod + record.lodCount; l++) {
+                const MeshCacheLodRecord& lodRecord = lodRecords[l];
+                if (static_cast<uint64_t>(lodRecord.indexOffset) + lodRecord.indexCount > record.lodIndexCount) {
+                    return invalid("LOD out of range");
+                }
+                MeshLod lod;
+                lod.indexOffset = lodRecord.indexOffset;
+                lod.indexCount = lodRecord.indexCount;
+                lod.error = lodRecord.error;
+                mesh.lods.push_back(lod);
+            }
+            for (uint32_t m = record.firstMeshlet; m < record.firstMeshlet + record.meshletCount; m++) {
+                const MeshCacheMeshletRecord& meshletRecord = meshletRecords[m];
+                if (static_cast<uint64_t>(meshletRecord.indexOffset) + meshletRecord.indexCount > record.indexCount) {
+                    return invalid("meshlet out of range");
+                }
+                Meshlet meshlet;
+                meshlet.indexOffset = meshletRecord.indexOffset;
+                meshlet.indexCount = meshletRecord.indexCount;
+                meshlet.center = glm::vec3(meshletRecord.center[0], meshletRecord.center[1], meshletRecord.center[2]);
+                meshlet.radius = meshletRecord.radius;
+                meshlet.coneAxis = glm::vec3(meshletRecord.coneAxis[0], meshletRecord.coneAxis[1], meshletRecord.coneAxis[2]);
+                meshlet.coneCutoff = meshletRecord.coneCutoff;
+                mesh.meshlets.push_back(meshlet);
+            }
+            mesh.materialIndex = record.materialIndex;
+            mesh.color = glm::vec3(record.color[0], record.color[1], record.color[2]);
+            mesh.shininess = record.shininess;
+            if (!readString(record.nameOffset, record.nameLength, mesh.name)) {
+                return invalid("mesh name out of range");
+            }
+        }
+
+        std::vector<MeshCacheMaterialRecord> materialRecords(header.materialCount);
+        if (header.materialCount > 0) {
+            std::memcpy(materialRecords.data(), cursor, header.materialCount * sizeof(MeshCacheMaterialRecord));
+            cursor += header.materialCount * sizeof(MeshCacheMaterialRecord);
+        }
+
+        std::vector<CachedTexture> textures(header.textureCount);
+        for (uint32_t i = 0; i < header.textureCount; i++) {
+            MeshCacheTextureRecord record;
+            std::memcpy(&record, cursor, sizeof(record));
+            cursor += sizeof(record);
+            if (!readString(record.typeOffset, record.typeLength, textures[i].type) ||
+                !readString(record.pathOffset, record.pathLength, textures[i].path) ||
+                !readString(record.fullPathOffset, record.fullPathLength, textures[i].fullPath)) {
+                return invalid("texture path out of range");
+            }
+        }
+
+        model->materials.resize(header.materialCount);
+        for (uint32_t i = 0; i < header.materialCount; i++) {
+            const MeshCacheMaterialRecord& record = materialRecords[i];
+            if (static_cast<uint64_t>(record.firstTexture) + record.textureCount > header.textureCount) {
+                return invalid("material out of range");
+            }
+            model->materials[i].assign(textures.begin() + record.firstTexture,
+                textures.begin() + record.firstTexture + record.textureCount);
+        }
+
+        model->boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+        model->boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+        return model;
+    }
+
+    MeshData MeshCache::toMeshData(const CachedMesh& mesh) {
+        MeshData data;
+        data.vertices.assign(mesh.vertices, mesh.vertices + mesh.vertexCount);
+        data.indices.assign(mesh.indices, mesh.indices + mesh.indexCount);
+        data.lodIndices.assign(mesh.lodIndices, mesh.lodIndices + mesh.lodIndexCount);
+        data.lods = mesh.lods;
+        data.meshlets = mesh.meshlets;
+        data.materialIndex = mesh.materialIndex;
+        data.color = mesh.color;
+        data.shininess = mesh.shininess;
+        data.name = mesh.name;
+        return data;
+    }
+
+    // ---- Writing ----
+
+    MeshCache::Writer::Writer(uint64_t key)
+        : m_key(key),
+        m_boundsMin(std::numeric_limits<float>::max()),
+        m_boundsMax(std::numeric_limits<float>::lowest()) {
+        static std::atomic<uint32_t> tempCounter{ 0 };
+
+        std::error_code ec;
+        std::filesystem::create_directories(s_cacheDirectory, ec);
+
+        // Concurrent imports of the same file each write their own temporary file
+        m_path = getCachePath(key);
+        m_tempPath = m_path + "." + std::to_string(tempCounter++) + ".tmp";
+        m_stream.open(m_tempPath, std::ios::binary | std::ios::trunc);
+        if (!m_stream) {
+            std::cerr << "Failed to create mesh cache file: " << m_tempPath << std::endl;
+            return;
+        }
+
+        // Written for real in finish()
+        MeshCacheHeader header = {};
+        m_stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        m_offset = sizeof(header);
+    }
+
+    MeshCache::Writer::~Writer() {
+        if (m_stream.is_open()) {
+            m_stream.close();
+            std::error_code ec;
+            std::filesystem::remove(m_tempPath, ec);
+        }
+    }
+
+    void MeshCache::Writer::align(size_t alignment) {
+        static const char zeros[16] = {};
+        size_t padding = (alignment - m_offset % alignment) % alignment;
+        m_stream.write(zeros, padding);
+        m_offset += padding;
+    }
+
+    void MeshCache::Writer::addMesh(const MeshData& data) {
+        if (!m_stream.is_open() || m_failed) return;
+
+        const std::vector<Vertex>& vertices = data.vertices;
+        PendingMesh mesh;
+        align(16);
+        mesh.vertexOffset = m_offset;
+        m_stream.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(Vertex));
+        m_offset += vertices.size() * sizeof(Vertex);
+        mesh.indexOffset = m_offset;
+        m_stream.write(reinterpret_cast<const char*>(data.indices.data()), data.indices.size() * sizeof(GLuint));
+        m_offset += data.indices.size() * sizeof(GLuint);
+        mesh.lodIndexOffset = m_offset;
+        m_stream.write(reinterpret_cast<const char*>(data.lodIndices.data()), data.lodIndices.size() * sizeof(GLuint));
+        m_offset += data.lodIndices.size() * sizeof(GLuint);
+
+        mesh.vertexCount = static_cast<uint32_t>(vertices.size());
+        mesh.indexCount = static_cast<uint32_t>(data.indices.size());
+        mesh.lodIndexCount = static_cast<uint32_t>(data.lodIndices.size());
+        mesh.lods = data.lods;
+        mesh.meshlets = data.meshlets;
+        mesh.materialIndex = data.materialIndex;
+        mesh.color = data.color;
+        mesh.shininess = data.shininess;
+        mesh.name = data.name;
+        m_meshes.push_back(std::move(mesh));
+
+        for (const Vertex& vertex : vertices) {
+            m_boundsMin = glm::min(m_boundsMin, vertex.position);
+            m_boundsMax = glm::max(m_boundsMax, vertex.position);
+        }
+
+        if (!m_stream) {
+            m_failed = true;
+        }
+    }
+
+    void MeshCache::Writer::setMaterialTextures(unsigned int materialIndex, const std::vector<CachedTexture>& textures) {
+        if (materialIndex >= m_materials.size()) {
+            m_materials.resize(materialIndex + 1);
+        }
+        m_materials[materialIndex] = textures;
+    }
+
+    bool MeshCache::Writer::finish() {
+        if (!m_stream.is_open() || m_failed) return false;
+
+        std::string strings;
+        auto addString = [&strings](const std::string& value, uint32_t& offset, uint32_t& length) {
+            offset = static_cast<uint32_t>(strings.size());
+            length = static_cast<uint32_t>(value.size());
+            strings += value;
+        };
+
+        size_t materialCount = m_materials.size();
+        for (const PendingMesh& mesh : m_meshes) {
+            materialCount = std::max<size_t>(materialCount, mesh.materialIndex + 1);
+        }
+        m_materials.resize(materialCount);
+
+        std::vector<MeshCacheMeshRecord> meshRecords(m_meshes.size());
+        std::vector<MeshCacheLodRecord> lodRecords;
+        std::vector<MeshCacheMeshletRecord> meshletRecords;
+        for (size_t i = 0; i < m_meshes.size(); i++) {
+            const PendingMesh& mesh = m_meshes[i];
+            MeshCacheMeshRecord& record = meshRecords[i];
+            record = {};
+            record.vertexOffset = mesh.vertexOffset;
+            record.indexOffset = mesh.indexOffset;
+            record.lodIndexOffset = mesh.lodIndexOffset;
+            record.vertexCount = mesh.vertexCount;
+            record.indexCount = mesh.indexCount;
+            record.lodIndexCount = mesh.lodIndexCount;
+            record.firstLod = static_cast<uint32_t>(lodRecords.size());
+            record.lodCount = static_cast<uint32_t>(mesh.lods.size());
+            for (const MeshLod& lod : mesh.lods) {
+                lodRecords.push_back({ lod.indexOffset, lod.indexCount, lod.error });
+            }
+            record.firstMeshlet = static_cast<uint32_t>(meshletRecords.size());
+            record.meshletCount = static_cast<uint32_t>(mesh.meshlets.size());
+            for (const Meshlet& meshlet : mesh.meshlets) {
+                meshletRecords.push_back({ meshlet.indexOffset, meshlet.indexCount,
+                    { meshlet.center.x, meshlet.center.y, meshlet.center.z }, meshlet.radius,
+                    { meshlet.coneAxis.x, meshlet.coneAxis.y, meshlet.coneAxis.z }, meshlet.coneCutoff });
+            }
+            record.materialIndex = mesh.materialIndex;
+            record.color[0] = mesh.color.r;
+            record.color[1] = mesh.color.g;
+            record.color[2] = mesh.color.b;
+            record.shininess = mesh.shininess;
+            addString(mesh.name, record.nameOffset, record.nameLength);
+        }
+
+        std::vector<MeshCacheMaterialRecord> materialRecords(materialCount);
+        std::vector<MeshCacheTextureRecord> textureRecords;
+        for (size_t i = 0; i < materialCount; i++) {
+            materialRecords[i].firstTexture = static_cast<uint32_t>(textureRecords.size());
+            materialRecords[i].textureCount = static_cast<uint32_t>(m_materials[i].size());
+            for (const CachedTexture& texture : m_materials[i]) {
+                MeshCacheTextureRecord record;
+                addString(texture.type, record.typeOffset, record.typeLength);
+                addString(texture.path, record.pathOffset, record.pathLength);
+                addString(texture.fullPath, record.fullPathOffset, record.fullPathLength);
+                textureRecords.push_back(record);
+            }
+        }
+
+        align(8);
+        MeshCacheHeader header = {};
+        std::memcpy(header.magic, MESH_CACHE_MAGIC, 4);
+        header.version = FORMAT_VERSION;
+        header.key = m_key;
+        header.vertexSize = sizeof(Vertex);
+        header.meshCount = static_cast<uint32_t>(meshRecords.size());
+        header.materialCount = static_cast<uint32_t>(materialRecords.size());
+        header.textureCount = static_cast<uint32_t>(textureRecords.size());
+        header.lodCount = static_cast<uint32_t>(lodRecords.size());
+        header.meshletCount = static_cast<uint32_t>(meshletRecords.size());
+        header.tableOffset = m_offset;
+        header.stringsOffset = m_offset + meshRecords.size() * sizeof(MeshCacheMeshRecord) +
+            lodRecords.size() * sizeof(MeshCacheLodRecord) +
+            meshletRecords.size() * sizeof(MeshCacheMeshletRecord) +
+            materialRecords.size() * sizeof(MeshCacheMaterialRecord) +
+            textureRecords.size() * sizeof(MeshCacheTextureRecord);
+        header.stringsSize = strings.size();
+        if (m_meshes.empty()) {
+            m_boundsMin = m_boundsMax = glm::vec3(0.0f);
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            header.boundsMin[axis] = m_boundsMin[axis];
+            header.boundsMax[axis] = m_boundsMax[axis];
+        }
+
+        m_stream.write(reinterpret_cast<const char*>(meshRecords.data()), meshRecords.size() * sizeof(MeshCacheMeshRecord));
+        m_stream.write(reinterpret_cast<const char*>(lodRecords.data()), lodRecords.size() * sizeof(MeshCacheLodRecord));
+        m_stream.write(reinterpret_cast<const char*>(meshletRecords.data()), meshletRecords.size() * sizeof(MeshCacheMeshletRecord));
+        m_stream.write(reinterpret_cast<const char*>(materialRecords.data()), materialRecords.size() * sizeof(MeshCacheMaterialRecord));
+        m_stream.write(reinterpret_cast<const char*>(textureRecords.data()), textureRecords.size() * sizeof(MeshCacheTextureRecord));
+        m_stream.write(strings.data(), strings.size());
+        uint64_t fileSize = header.stringsOffset + strings.size();
+
+        m_stream.seekp(0);
+        m_stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        m_stream.close();
+        if (!m_stream) {
+            std::cerr << "Failed to write mesh cache file: " << m_tempPath << std::endl;
+            std::error_code ec;
+            std::filesystem::remove(m_tempPath, ec);
+            return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(m_tempPath, m_path, ec);
+        if (ec) {
+            std::cerr << "Failed to store mesh cache file " << m_path << ": " << ec.message() << std::endl;
+            std::filesystem::remove(m_tempPath, ec);
+            return false;
+        }
+
+        std::cout << "Wrote mesh cache " << m_path << " (" << m_meshes.size() << " meshes, "
+                  << (fileSize / (1024.0 * 1024.0)) << " MB)" << std::endl;
+        return true;
+    }
+
+}
@@ -0,0 +1,361 @@
+#include "Loaders/MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace Engine {
+
+    bool MeshOptimizer::s_enabled = true;
+
+    static const uint32_t NO_VERTEX = std::numeric_limits<uint32_t>::max();
+
+    void MeshOptimizer::optimize(MeshData& data) {
+        std::vector<GLuint>& indices = data.indices;
+        const size_t triangleCount = indices.size() / 3;
+        const size_t vertexCount = data.vertices.size();
+        MeshOrderStats& stats = data.orderStats;
+        stats = MeshOrderStats();
+        if (triangleCount == 0) {
+            return;
+        }
+
+        stats.triangles = triangleCount;
+        stats.cacheMissesBefore = countCacheMisses(indices.data(), triangleCount * 3, vertexCount);
+        measureOverdraw(data.vertices, indices.data(), triangleCount * 3, stats.pixelsCovered, stats.pixelsShadedBefore);
+
+        std::vector<uint32_t> localOf(vertexCount, NO_VERTEX);
+
+        // Clusters are triangle ranges: the meshlets where there are some, which only get their
+        // insides ordered, otherwise runs of the cache order
+        std::vector<uint32_t> clusterStarts;
+        if (!data.meshlets.empty()) {
+            for (const Meshlet& meshlet : data.meshlets) {
+                orderForVertexCache(indices.data() + meshlet.indexOffset, meshlet.indexCount, localOf, nullptr);
+                clusterStarts.push_back(meshlet.indexOffset / 3);
+            }
+        }
+        else {
+            std::vector<uint32_t> runStarts;
+            orderForVertexCache(indices.data(), triangleCount * 3, localOf, &runStarts);
+            runStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+            // A run that starts from a cold cache can be moved freely. Runs are cut further where
+            // a cluster's own miss rate has come down close to the mesh's, so that reordering the
+            // clusters costs little cache efficiency (Sander et al., "Fast Triangle Reordering").
+            float threshold = CLUSTER_ACMR_THRESHOLD *
+                static_cast<float>(countCacheMisses(indices.data(), triangleCount * 3, vertexCount)) / static_cast<float>(triangleCount);
+            std::vector<uint32_t> timestamps(vertexCount, 0);
+            uint32_t time = CACHE_SIZE + 1;
+            for (size_t r = 0; r + 1 < runStarts.size(); r++) {
+                uint32_t clusterStart = runStarts[r];
+                uint32_t misses = 0;
+                time += CACHE_SIZE + 1;
+                clusterStarts.push_back(clusterStart);
+                for (uint32_t t = runStarts[r]; t < runStarts[r + 1]; t++) {
+                    for (int corner = 0; corner < 3; corner++) {
+                        GLuint v = indices[t * 3 + corner];
+                        if (time - timestamps[v] > CACHE_SIZE) {
+                            timestamps[v] = time++;
+                            misses++;
+                        }
+                    }
+                    uint32_t clusterTriangles = t + 1 - clusterStart;
+                    if (t + 1 < runStarts[r + 1] && clusterTriangles >= MIN_CLUSTER_TRIANGLES &&
+                        static_cast<float>(misses) <= threshold * static_cast<float>(clusterTriangles)) {
+                        clusterStart = t + 1;
+                        misses = 0;
+                        time += CACHE_SIZE + 1;
+                        clusterStarts.push_back(clusterStart);
+                    }
+                }
+            }
+        }
+        const size_t clusterCount = clusterStarts.size();
+        clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+        // Clusters far out along their own average normal are on the outside of the mesh and
+        // likely to hide the rest from most directions, so they are drawn first
+        std::vector<glm::vec3> clusterCentroid(clusterCount, glm::vec3(0.0f));
+        std::vector<glm::vec3> clusterNormal(clusterCount, glm::vec3(0.0f));
+        std::vector<float> clusterArea(clusterCount, 0.0f);
+        glm::vec3 meshCentroidSum(0.0f);
+        float meshArea = 0.0f;
+        for (size_t c = 0; c < clusterCount; c++) {
+            glm::vec3 unweighted(0.0f);
+            for (uint32_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+                const glm::vec3& p0 = data.vertices[indices[t * 3]].position;
+                const glm::vec3& p1 = data.vertices[indices[t * 3 + 1]].position;
+                const glm::vec3& p2 = data.vertices[indices[t * 3 + 2]].position;
+                glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                float area = glm::length(normal) * 0.5f;
+                glm::vec3 centroid = (p0 + p1 + p2) / 3.0f;
+                clusterCentroid[c] += centroid * area;
+                clusterNormal[c] += normal;
+                clusterArea[c] += area;
+                unweighted += centroid;
+            }
+            meshCentroidSum += clusterCentroid[c];
+            meshArea += clusterArea[c];
+            clusterCentroid[c] = clusterArea[c] > 0.0f ? clusterCentroid[c] / clusterArea[c] :
+                unweighted / static_cast<float>(clusterStarts[c + 1] - clusterStarts[c]);
+        }
+        glm::vec3 meshCentroid = meshArea > 0.0f ? meshCentroidSum / meshArea : glm::vec3(0.0f);
+
+        std::vector<float> occlusion(clusterCount, 0.0f);
+        for (size_t c = 0; c < clusterCount; c++) {
+            float normalLength = glm::length(clusterNormal[c]);
+            if (normalLength > 0.0f) {
+                occlusion[c] = glm::dot(clusterCentroid[c] - meshCentroid, clusterNormal[c] / normalLength);
+            }
+        }
+        std::vector<uint32_t> order(clusterCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return occlusion[a] > occlusion[b]; });
+
+        std::vector<GLuint> sorted;
+        sorted.reserve(triangleCount * 3);
+        std::vector<Meshlet> sortedMeshlets;
+        sortedMeshlets.reserve(data.meshlets.size());
+        for (uint32_t c : order) {
+            if (!data.meshlets.empty()) {
+                Meshlet meshlet = data.meshlets[c];
+                meshlet.indexOffset = static_cast<uint32_t>(sorted.size());
+                sortedMeshlets.push_back(meshlet);
+            }
+            sorted.insert(sorted.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+        }
+        indices = std::move(sorted);
+        data.meshlets = std::move(sortedMeshlets);
+
+        // Simplified levels are small enough on screen that their overdraw does not matter
+        for (const MeshLod& lod : data.lods) {
+            orderForVertexCache(data.lodIndices.data() + lod.indexOffset, lod.indexCount, localOf, nullptr);
+        }
+
+        // Vertices in order of first use, the full level first; unused ones go to the end
+        std::vector<uint32_t> remap(vertexCount, NO_VERTEX);
+        uint32_t nextVertex = 0;
+        for (const std::vector<GLuint>* list : { &data.indices, &data.lodIndices }) {
+            for (GLuint v : *list) {
+                if (remap[v] == NO_VERTEX) remap[v] = nextVertex++;
+            }
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            if (remap[v] == NO_VERTEX) remap[v] = nextVertex++;
+        }
+        std::vector<Vertex> vertices(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++) {
+            vertices[remap[v]] = data.vertices[v];
+        }
+        data.vertices = std::move(vertices);
+        for (GLuint& index : data.indices) index = remap[index];
+        for (GLuint& index : data.lodIndices) index = remap[index];
+
+        uint64_t coveredAfter = 0;
+        stats.cacheMissesAfter = countCacheMisses(data.indices.data(), triangleCount * 3, vertexCount);
+        measureOverdraw(data.vertices, data.indices.data(), triangleCount * 3, coveredAfter, stats.pixelsShadedAfter);
+    }
+
+    void MeshOptimizer::orderForVertexCache(GLuint* indices, size_t indexCount, std::vector<uint32_t>& localOf,
+                                            std::vector<uint32_t>* clusterStarts) {
+        const size_t triangleCount = indexCount / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+
+        // Range-local vertex ids keep the working set small for meshlet sized ranges
+        std::vector<GLuint> globalOf;
+        std::vector<uint32_t> local(triangleCount * 3);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            GLuint v = indices[i];
+            if (localOf[v] == NO_VERTEX) {
+                localOf[v] = static_cast<uint32_t>(globalOf.size());
+                globalOf.push_back(v);
+            }
+            local[i] = localOf[v];
+        }
+        for (GLuint v : globalOf) {
+            localOf[v] = NO_VERTEX;
+        }
+        const uint32_t vertexCount = static_cast<uint32_t>(globalOf.size());
+
+        // Triangles around each vertex; live counts the ones not emitted yet
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (uint32_t v : local) {
+            adjacencyOffsets[v + 1]++;
+        }
+        std::vector<uint32_t> live(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++) {
+            live[v] = adjacencyOffsets[v + 1];
+        }
+        std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        {
+            std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < triangleCount * 3; i++) {
+                adjacency[cursor[local[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        std::vector<uint32_t> timestamps(vertexCount, 0);
+        uint32_t time = CACHE_SIZE + 1;
+        std::vector<uint8_t> emitted(triangleCount, 0);
+        std::vector<uint32_t> deadEnd;
+        std::vector<uint32_t> candidates;
+        std::vector<GLuint> output;
+        output.reserve(triangleCount * 3);
+
+        uint32_t inputCursor = 0;
+        uint32_t fanning = local[0];
+        bool coldStart = true;
+        while (fanning != NO_VERTEX) {
+            if (clusterStarts && coldStart) {
+                clusterStarts->push_back(static_cast<uint32_t>(output.size() / 3));
+            }
+
+            // Emit every remaining triangle around the fanning vertex
+            candidates.clear();
+            for (uint32_t a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++) {
+                uint32_t t = adjacency[a];
+                if (emitted[t]) continue;
+                emitted[t] = 1;
+                for (int corner = 0; corner < 3; corner++) {
+                    uint32_t v = local[t * 3 + corner];
+                    deadEnd.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+                    if (time - timestamps[v] > CACHE_SIZE) {
+                        timestamps[v] = time++;
+                    }
+                    output.push_back(globalOf[v]);
+                }
+            }
+
+            // Next fan around the candidate that will still be cached once its remaining
+            // triangles are emitted, preferring the one that entered the cache first
+            uint32_t next = NO_VERTEX;
+            int bestPriority = -1;
+            for (uint32_t v : candidates) {
+                if (live[v] == 0) continue;
+                int priority = 0;
+                if (time - timestamps[v] + 2 * live[v] <= CACHE_SIZE) {
+                    priority = static_cast<int>(time - timestamps[v]);
+                }
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    next = v;
+                }
+            }
+
+            // Dead end: the most recently used vertex with triangles left, otherwise the next one
+            // in input order, which starts over with a cold cache
+            coldStart = false;
+            while (next == NO_VERTEX && !deadEnd.empty()) {
+                uint32_t v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v] > 0) next = v;
+            }
+            if (next == NO_VERTEX) {
+                while (inputCursor < vertexCount && live[inputCursor] == 0) inputCursor++;
+                if (inputCursor < vertexCount) {
+                    next = inputCursor;
+                    coldStart = true;
+                }
+            }
+            fanning = next;
+        }
+
+        std::copy(output.begin(), output.end(), indices);
+    }
+
+    uint64_t MeshOptimizer::countCacheMisses(const GLuint* indices, size_t indexCount, size_t vertexCount) {
+        std::vector<uint32_t> timestamps(vertexCount, 0);
+        uint32_t time = CACHE_SIZE + 1;
+        uint64_t misses = 0;
+        for (size_t i = 0; i < indexCount; i++) {
+            GLuint v = indices[i];
+            if (time - timestamps[v] > CACHE_SIZE) {
+                timestamps[v] = time++;
+                misses++;
+            }
+        }
+        return misses;
+    }
+
+    void MeshOptimizer::measureOverdraw(const std::vector<Vertex>& vertices, const GLuint* indices, size_t indexCount,
+                                        uint64_t& covered, uint64_t& shaded) {
+        covered = 0;
+        shaded = 0;
+        const size_t triangleCount = indexCount / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+
+        glm::vec3 boundsMin(std::numeric_limits<float>::max());
+        glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            boundsMin = glm::min(boundsMin, vertices[indices[i]].position);
+            boundsMax = glm::max(boundsMax, vertices[indices[i]].position);
+        }
+        glm::vec3 size = boundsMax - boundsMin;
+        float extent = std::max(size.x, std::max(size.y, size.z));
+        if (extent <= 0.0f) {
+            return;
+        }
+        // Uniform scale so the mesh keeps its proportions, fits the grid in every direction
+        const float scale = static_cast<float>(OVERDRAW_GRID) * 0.999f / extent;
+
+        auto edge = [](float ax, float ay, float bx, float by, float px, float py) {
+            return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+        };
+
+        std::vector<float> depth(OVERDRAW_GRID * OVERDRAW_GRID);
+        for (int axis = 0; axis < 3; axis++) {
+            const int u = (axis + 1) % 3;
+            const int v = (axis + 2) % 3;
+            for (float direction : { 1.0f, -1.0f }) {
+                std::fill(depth.begin(), depth.end(), std::numeric_limits<float>::max());
+
+                for (size_t t = 0; t < triangleCount; t++) {
+                    glm::vec3 p[3];
+                    for (int corner = 0; corner < 3; corner++) {
+                        p[corner] = (vertices[indices[t * 3 + corner]].position - boundsMin) * scale;
+                    }
+                    // Looking along direction on the axis, counter-clockwise faces point back at the viewer
+                    glm::vec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    if (normal[axis] * direction >= 0.0f) continue;
+
+                    float area = edge(p[0][u], p[0][v], p[1][u], p[1][v], p[2][u], p[2][v]);
+                    if (area == 0.0f) continue;
+                    float sign = area > 0.0f ? 1.0f : -1.0f;
+                    float z[3] = { p[0][axis] * direction, p[1][axis] * direction, p[2][axis] * direction };
+
+                    int xMin = std::max(0, static_cast<int>(std::floor(std::min({ p[0][u], p[1][u], p[2][u] }))));
+                    int xMax = std::min(OVERDRAW_GRID - 1, static_cast<int>(std::ceil(std::max({ p[0][u], p[1][u], p[2][u] }))));
+                    int yMin = std::max(0, static_cast<int>(std::floor(std::min({ p[0][v], p[1][v], p[2][v] }))));
+                    int yMax = std::min(OVERDRAW_GRID - 1, static_cast<int>(std::ceil(std::max({ p[0][v], p[1][v], p[2][v] }))));
+                    for (int y = yMin; y <= yMax; y++) {
+                        float py = static_cast<float>(y) + 0.5f;
+                        for (int x = xMin; x <= xMax; x++) {
+                            float px = static_cast<float>(x) + 0.5f;
+                            float w0 = edge(p[1][u], p[1][v], p[2][u], p[2][v], px, py) * sign;
+                            float w1 = edge(p[2][u], p[2][v], p[0][u], p[0][v], px, py) * sign;
+                            float w2 = edge(p[0][u], p[0][v], p[1][u], p[1][v], px, py) * sign;
+                            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+
+                            float fragmentDepth = (w0 * z[0] + w1 * z[1] + w2 * z[2]) / (area * sign);
+                            float& stored = depth[y * OVERDRAW_GRID + x];
+                            if (stored == std::numeric_limits<float>::max()) covered++;
+                            if (fragmentDepth < stored) {
+                                stored = fragmentDepth;
+                                shaded++;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+}
@@ -0,0 +1,359 @@
+#include "Loaders/MeshSimplifier.h"
+#include "Engine/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace Engine {
+
+    static const GLuint NO_VERTEX = std::numeric_limits<GLuint>::max();
+    static const size_t SIMPLIFY_CHUNK_SIZE = 4096;
+    static const int MAX_SIMPLIFY_PASSES = 64;
+
+    // Sum of area weighted plane quadrics. Evaluated at p it gives the weighted sum of squared
+    // distances to the planes; divided by the weight, the mean squared distance.
+    struct SimplifierQuadric {
+        float a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+        float b0 = 0, b1 = 0, b2 = 0, c = 0;
+        float weight = 0;
+
+        void addPlane(const glm::vec3& n, float d, float w) {
+            a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z;
+            a11 += w * n.y * n.y; a12 += w * n.y * n.z; a22 += w * n.z * n.z;
+            b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+            c += w * d * d;
+            weight += w;
+        }
+
+        void add(const SimplifierQuadric& q) {
+            a00 += q.a00; a01 += q.a01; a02 += q.a02;
+            a11 += q.a11; a12 += q.a12; a22 += q.a22;
+            b0 += q.b0; b1 += q.b1; b2 += q.b2;
+            c += q.c;
+            weight += q.weight;
+        }
+
+        float meanSquaredDistance(const glm::vec3& p) const {
+            if (weight <= 0.0f) return 0.0f;
+            float e = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z +
+                2.0f * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z) +
+                2.0f * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+            return std::max(e / weight, 0.0f);
+        }
+    };
+
+    struct SimplifierCollapse {
+        GLuint from;
+        GLuint to;
+        float cost;
+    };
+
+    // Runs task(begin, end) over [0, count) in chunks on the job system
+    static void parallelForRange(size_t count, const std::function<void(size_t, size_t)>& task) {
+        size_t chunks = (count + SIMPLIFY_CHUNK_SIZE - 1) / SIMPLIFY_CHUNK_SIZE;
+        JobSystem::parallelFor(chunks, [&](size_t chunk) {
+            size_t begin = chunk * SIMPLIFY_CHUNK_SIZE;
+            task(begin, std::min(count, begin + SIMPLIFY_CHUNK_SIZE));
+        });
+    }
+
+    std::vector<GLuint> MeshSimplifier::simplify(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+                                                 size_t targetIndexCount, float maxError, float& outError) {
+        outError = 0.0f;
+        const size_t vertexCount = vertices.size();
+        if (indices.size() <= targetIndexCount || vertexCount == 0) {
+            return indices;
+        }
+
+        // Vertices at the same position collapse as one; canonical is the lowest index among them.
+        // Positions are taken relative to the bounds centre to keep the float quadrics precise.
+        std::vector<GLuint> canonical(vertexCount);
+        std::vector<glm::vec3> positions(vertexCount);
+        std::vector<uint8_t> locked(vertexCount, 0);
+        {
+            glm::vec3 boundsMin(std::numeric_limits<float>::max());
+            glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+            for (const Vertex& vertex : vertices) {
+                boundsMin = glm::min(boundsMin, vertex.position);
+                boundsMax = glm::max(boundsMax, vertex.position);
+            }
+            glm::vec3 origin = (boundsMin + boundsMax) * 0.5f;
+            for (size_t v = 0; v < vertexCount; v++) {
+                positions[v] = vertices[v].position - origin;
+            }
+
+            std::vector<GLuint> order(vertexCount);
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&vertices](GLuint a, GLuint b) {
+                const glm::vec3& pa = vertices[a].position;
+                const glm::vec3& pb = vertices[b].position;
+                if (pa.x != pb.x) return pa.x < pb.x;
+                if (pa.y != pb.y) return pa.y < pb.y;
+                if (pa.z != pb.z) return pa.z < pb.z;
+                return a < b;
+            });
+            for (size_t i = 0; i < vertexCount;) {
+                size_t j = i + 1;
+                while (j < vertexCount && vertices[order[j]].position == vertices[order[i]].position) j++;
+                for (size_t k = i; k < j; k++) {
+                    canonical[order[k]] = order[i];
+                }
+                // Attribute seam: the position has to keep all of its vertices
+                if (j - i > 1) {
+                    locked[order[i]] = 1;
+                }
+                i = j;
+            }
+        }
+
+        // Working triangles with their original vertex indices, degenerate ones dropped
+        std::vector<GLuint> triangles;
+        triangles.reserve(indices.size());
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            GLuint a = canonical[indices[i]], b = canonical[indices[i + 1]], c = canonical[indices[i + 2]];
+            if (a == b || b == c || a == c) continue;
+            triangles.insert(triangles.end(), { indices[i], indices[i + 1], indices[i + 2] });
+        }
+
+        // Triangles around each canonical vertex, rebuilt after every pass
+        std::vector<GLuint> adjacencyOffsets(vertexCount + 1);
+        std::vector<GLuint> adjacency;
+        std::vector<GLuint> cursor(vertexCount);
+        auto buildAdjacency = [&]() {
+            std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+            for (GLuint index : triangles) {
+                adjacencyOffsets[canonical[index] + 1]++;
+            }
+            std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+            std::copy(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1, cursor.begin());
+            adjacency.resize(triangles.size());
+            for (size_t i = 0; i < triangles.size(); i++) {
+                adjacency[cursor[canonical[triangles[i]]]++] = static_cast<GLuint>(i / 3);
+            }
+        };
+        buildAdjacency();
+
+        // Quadrics of the input surface and the border test, gathered per vertex in parallel
+        std::vector<SimplifierQuadric> quadrics(vertexCount);
+        parallelForRange(vertexCount, [&](size_t begin, size_t end) {
+            std::vector<GLuint> neighbours;
+            for (size_t v = begin; v < end; v++) {
+                if (canonical[v] != v) continue;
+
+                neighbours.clear();
+                for (GLuint a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; a++) {
+                    const GLuint* triangle = &triangles[adjacency[a] * 3];
+                    const glm::vec3& p0 = positions[triangle[0]];
+                    glm::vec3 normal = glm::cross(positions[triangle[1]] - p0, positions[triangle[2]] - p0);
+                    float length = glm::length(normal);
+                    if (length > 0.0f) {
+                        normal /= length;
+                        quadrics[v].addPlane(normal, -glm::dot(normal, p0), length * 0.5f);
+                    }
+                    for (int corner = 0; corner < 3; corner++) {
+                        GLuint other = canonical[triangle[corner]];
+                        if (other != v) neighbours.push_back(other);
+                    }
+                }
+
+                // Every edge of a closed manifold surface is shared by exactly two triangles
+                std::sort(neighbours.begin(), neighbours.end());
+                for (size_t i = 0; i < neighbours.size();) {
+                    size_t j = i + 1;
+                    while (j < neighbours.size() && neighbours[j] == neighbours[i]) j++;
+                    if (j - i != 2) {
+                        locked[v] = 1;
+                        break;
+                    }
+                    i = j;
+                }
+            }
+        });
+
+        // The quadric cost is a mean over the merged planes and ranks collapses. What is reported
+        // is a bound on the largest deviation: per vertex, how far the surface around it may have
+        // moved, grown by each collapse's distance between the old and the new triangle planes.
+        const float maxErrorSq = maxError * maxError;  // Infinite for an unbounded error
+        std::vector<float> deviation(vertexCount, 0.0f);
+        float worstError = 0.0f;
+        size_t indexCount = triangles.size();
+
+        std::vector<GLuint> bestTarget(vertexCount);
+        std::vector<float> bestCost(vertexCount);
+        std::vector<uint8_t> passLocked(vertexCount);
+        std::vector<GLuint> redirect(vertexCount, NO_VERTEX);
+        std::vector<SimplifierCollapse> candidates;
+
+        for (int pass = 0; pass < MAX_SIMPLIFY_PASSES && indexCount > targetIndexCount; pass++) {
+            if (pass > 0) {
+                buildAdjacency();
+            }
+
+            // Cheapest collapse of each free vertex onto one of its neighbours
+            parallelForRange(vertexCount, [&](size_t begin, size_t end) {
+                for (size_t v = begin; v < end; v++) {
+                    bestTarget[v] = NO_VERTEX;
+                    if (canonical[v] != v || locked[v] || adjacencyOffsets[v] == adjacencyOffsets[v + 1]) continue;
+
+                    float cost = std::numeric_limits<float>::max();
+                    for (GLuint a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; a++) {
+                        const GLuint* triangle = &triangles[adjacency[a] * 3];
+                        for (int corner = 0; corner < 3; corner++) {
+                            GLuint u = canonical[triangle[corner]];
+                            if (u == v) continue;
+                            SimplifierQuadric merged = quadrics[v];
+                            merged.add(quadrics[u]);
+                            float error = merged.meanSquaredDistance(positions[u]);
+                            if (error < cost) {
+                                cost = error;
+                                bestTarget[v] = u;
+                            }
+                        }
+                    }
+                    bestCost[v] = cost;
+                }
+            });
+
+            candidates.clear();
+            for (size_t v = 0; v < vertexCount; v++) {
+                if (bestTarget[v] != NO_VERTEX && bestCost[v] <= maxErrorSq) {
+                    candidates.push_back({ static_cast<GLuint>(v), bestTarget[v], bestCost[v] });
+                }
+            }
+            if (candidates.empty()) break;
+            std::sort(candidates.begin(), candidates.end(), [](const SimplifierCollapse& a, const SimplifierCollapse& b) {
+                return a.cost < b.cost;
+            });
+
+            // Cheapest first. A collapse locks the one-ring of its vertex for the rest of the pass,
+            // so the adjacency and the flip test stay valid without updating them.
+            std::fill(passLocked.begin(), passLocked.end(), 0);
+            size_t trianglesToRemove = (indexCount - targetIndexCount + 2) / 3;
+            size_t trianglesRemoved = 0;
+            for (const SimplifierCollapse& collapse : candidates) {
+                if (trianglesRemoved >= trianglesToRemove) break;
+                GLuint v = collapse.from;
+                GLuint u = collapse.to;
+                if (passLocked[v] || passLocked[u]) continue;
+
+                // The vertex of u that v's triangles continue with, and no triangle may flip
+                GLuint target = NO_VERTEX;
+                size_t collapsedTriangles = 0;
+                bool flips = false;
+                float collapseDeviation = deviation[v];
+                float ringDeviation = 0.0f;
+                for (GLuint a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1] && !flips; a++) {
+                    const GLuint* triangle = &triangles[adjacency[a] * 3];
+                    glm::vec3 p[3];
+                    glm::vec3 moved[3];
+                    bool containsU = false;
+                    for (int corner = 0; corner < 3; corner++) {
+                        GLuint c = canonical[triangle[corner]];
+                        if (c == u) {
+                            containsU = true;
+                            target = triangle[corner];
+                        }
+                        p[corner] = positions[c];
+                        moved[corner] = c == v ? positions[u] : p[corner];
+                        collapseDeviation = std::max(collapseDeviation, deviation[c]);
+                    }
+                    if (containsU) {
+                        collapsedTriangles++;
+                        continue;
+                    }
+                    glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                    float beforeLength = glm::length(before);
+                    float afterLength = glm::length(after);
+                    flips = glm::dot(before, after) <= 0.2f * beforeLength * afterLength;
+                    if (!flips) {
+                        // u against the plane v's triangle had, v against the plane it has now
+                        ringDeviation = std::max(ringDeviation, std::abs(glm::dot(before, positions[u] - p[0])) / beforeLength);
+                        ringDeviation = std::max(ringDeviation, std::abs(glm::dot(after, positions[v] - moved[0])) / afterLength);
+                    }
+                }
+                if (flips || target == NO_VERTEX) continue;
+                collapseDeviation += ringDeviation;
+                if (collapseDeviation > maxError) continue;
+
+                for (GLuint a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; a++) {
+                    const GLuint* triangle = &triangles[adjacency[a] * 3];
+                    for (int corner = 0; corner < 3; corner++) {
+                        passLocked[canonical[triangle[corner]]] = 1;
+                    }
+                }
+
+                // v is not a seam, so it is its only vertex at that position
+                redirect[v] = target;
+                quadrics[u].add(quadrics[v]);
+                deviation[u] = std::max(deviation[u], collapseDeviation);
+                worstError = std::max(worstError, collapseDeviation);
+                trianglesRemoved += collapsedTriangles;
+            }
+            if (trianglesRemoved == 0) break;
+
+            // Apply the pass and drop the triangles that lost an edge
+            size_t write = 0;
+            for (size_t i = 0; i < triangles.size(); i += 3) {
+                GLuint t[3];
+                for (int corner = 0; corner < 3; corner++) {
+                    GLuint index = triangles[i + corner];
+                    t[corner] = redirect[index] != NO_VERTEX ? redirect[index] : index;
+                }
+                GLuint a = canonical[t[0]], b = canonical[t[1]], c = canonical[t[2]];
+                if (a == b || b == c || a == c) continue;
+                triangles[write++] = t[0];
+                triangles[write++] = t[1];
+                triangles[write++] = t[2];
+            }
+            triangles.resize(write);
+            indexCount = write;
+
+            // Collapsed vertices are no longer referenced; keep them out of later passes
+            for (size_t v = 0; v < vertexCount; v++) {
+                if (redirect[v] != NO_VERTEX) {
+                    locked[v] = 1;
+                    redirect[v] = NO_VERTEX;
+                }
+            }
+        }
+
+        outError = worstError;
+        return triangles;
+    }
+
+    void MeshSimplifier::buildLodChain(MeshData& data) {
+        data.lodIndices.clear();
+        data.lods.clear();
+        if (data.indices.size() / 3 < MIN_LOD_TRIANGLES * 2) {
+            return;
+        }
+
+        // Each level starts from the previous one; its bound adds to theirs
+        std::vector<GLuint> previous;
+        const std::vector<GLuint>* source = &data.indices;
+        float error = 0.0f;
+        for (size_t level = 0; level < MAX_LOD_LEVELS; level++) {
+            size_t targetIndexCount = source->size() / 6 * 3;
+            if (targetIndexCount / 3 < MIN_LOD_TRIANGLES) break;
+
+            float levelError = 0.0f;
+            std::vector<GLuint> simplified = simplify(data.vertices, *source, targetIndexCount,
+                std::numeric_limits<float>::max(), levelError);
+            if (simplified.size() > source->size() * (1.0f - MIN_LOD_REDUCTION)) break;
+
+            error += levelError;
+            MeshLod lod;
+            lod.indexOffset = static_cast<uint32_t>(data.lodIndices.size());
+            lod.indexCount = static_cast<uint32_t>(simplified.size());
+            lod.error = error;
+            data.lodIndices.insert(data.lodIndices.end(), simplified.begin(), simplified.end());
+            data.lods.push_back(lod);
+
+            previous = std::move(simplified);
+            source = &previous;
+        }
+    }
+
+}
@@ -0,0 +1,185 @@
+#include "Loaders/MeshletBuilder.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Engine {
+
+    static const uint32_t NO_TRIANGLE = std::numeric_limits<uint32_t>::max();
+
+    void MeshletBuilder::build(MeshData& data) {
+        data.meshlets.clear();
+        const std::vector<Vertex>& vertices = data.vertices;
+        const std::vector<GLuint>& indices = data.indices;
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount < MIN_SOURCE_TRIANGLES) {
+            return;
+        }
+
+        // Triangles around each vertex
+        std::vector<uint32_t> adjacencyOffsets(vertices.size() + 1, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            adjacencyOffsets[indices[i] + 1]++;
+        }
+        std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        {
+            std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < triangleCount * 3; i++) {
+                adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        std::vector<glm::vec3> centroids(triangleCount);
+        std::vector<glm::vec3> normals(triangleCount);
+        for (size_t t = 0; t < triangleCount; t++) {
+            const glm::vec3& p0 = vertices[indices[t * 3]].position;
+            const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+            centroids[t] = (p0 + p1 + p2) / 3.0f;
+            glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            float length = glm::length(normal);
+            normals[t] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+        }
+
+        std::vector<uint8_t> used(triangleCount, 0);
+        std::vector<uint32_t> candidateOf(triangleCount, NO_TRIANGLE);
+        std::vector<uint32_t> candidates;
+        std::vector<GLuint> reordered;
+        reordered.reserve(triangleCount * 3);
+
+        size_t seedCursor = 0;
+        uint32_t nextSeed = NO_TRIANGLE;
+        while (true) {
+            // Continue next to the previous meshlet while it left unused neighbours, so
+            // consecutive meshlets stay close together
+            uint32_t seed = nextSeed;
+            if (seed == NO_TRIANGLE) {
+                while (seedCursor < triangleCount && used[seedCursor]) seedCursor++;
+                if (seedCursor == triangleCount) break;
+                seed = static_cast<uint32_t>(seedCursor);
+            }
+
+            const uint32_t meshletIndex = static_cast<uint32_t>(data.meshlets.size());
+            const uint32_t indexOffset = static_cast<uint32_t>(reordered.size());
+            glm::vec3 centroidSum(0.0f);
+            glm::vec3 normalSum(0.0f);
+            uint32_t count = 0;
+            candidates.clear();
+
+            auto addTriangle = [&](uint32_t t) {
+                used[t] = 1;
+                reordered.insert(reordered.end(), { indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2] });
+                centroidSum += centroids[t];
+                normalSum += normals[t];
+                count++;
+                for (int corner = 0; corner < 3; corner++) {
+                    GLuint v = indices[t * 3 + corner];
+                    for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; a++) {
+                        uint32_t neighbour = adjacency[a];
+                        if (!used[neighbour] && candidateOf[neighbour] != meshletIndex) {
+                            candidateOf[neighbour] = meshletIndex;
+                            candidates.push_back(neighbour);
+                        }
+                    }
+                }
+            };
+
+            addTriangle(seed);
+            while (count < MAX_TRIANGLES) {
+                // Closest to the meshlet's centre, with distance stretched for triangles that
+                // face away from its average normal; keeps meshlets round and their cones narrow
+                glm::vec3 center = centroidSum / static_cast<float>(count);
+                float normalLength = glm::length(normalSum);
+                glm::vec3 axis = normalLength > 0.0f ? normalSum / normalLength : glm::vec3(0.0f);
+
+                uint32_t best = NO_TRIANGLE;
+                float bestScore = std::numeric_limits<float>::max();
+                for (size_t c = 0; c < candidates.size();) {
+                    uint32_t t = candidates[c];
+                    if (used[t]) {
+                        candidates[c] = candidates.back();
+                        candidates.pop_back();
+                        continue;
+                    }
+                    float score = glm::distance(centroids[t], center) * (2.0f - glm::dot(normals[t], axis));
+                    if (score < bestScore) {
+                        bestScore = score;
+                        best = t;
+                    }
+                    c++;
+                }
+                if (best == NO_TRIANGLE) break;
+                addTriangle(best);
+            }
+
+            nextSeed = NO_TRIANGLE;
+            for (uint32_t t : candidates) {
+                if (!used[t]) {
+                    nextSeed = t;
+                    break;
+                }
+            }
+
+            data.meshlets.push_back(computeBounds(vertices, reordered, indexOffset, count * 3));
+        }
+
+        data.indices = std::move(reordered);
+    }
+
+    Meshlet MeshletBuilder::computeBounds(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+                                          uint32_t indexOffset, uint32_t indexCount) {
+        Meshlet meshlet;
+        meshlet.indexOffset = indexOffset;
+        meshlet.indexCount = indexCount;
+        if (indexCount == 0) {
+            return meshlet;
+        }
+
+        glm::vec3 boundsMin(std::numeric_limits<float>::max());
+        glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+        for (uint32_t i = indexOffset; i < indexOffset + indexCount; i++) {
+            boundsMin = glm::min(boundsMin, vertices[indices[i]].position);
+            boundsMax = glm::max(boundsMax, vertices[indices[i]].position);
+        }
+        meshlet.center = (boundsMin + boundsMax) * 0.5f;
+        float radiusSq = 0.0f;
+        for (uint32_t i = indexOffset; i < indexOffset + indexCount; i++) {
+            glm::vec3 offset = vertices[indices[i]].position - meshlet.center;
+            radiusSq = std::max(radiusSq, glm::dot(offset, offset));
+        }
+        meshlet.radius = std::sqrt(radiusSq);
+
+        // Cone around the average face normal, wide enough for the normal furthest from it
+        glm::vec3 normalSum(0.0f);
+        std::vector<glm::vec3> normals;
+        normals.reserve(indexCount / 3);
+        for (uint32_t i = indexOffset; i + 2 < indexOffset + indexCount; i += 3) {
+            const glm::vec3& p0 = vertices[indices[i]].position;
+            glm::vec3 normal = glm::cross(vertices[indices[i + 1]].position - p0, vertices[indices[i + 2]].position - p0);
+            float length = glm::length(normal);
+            if (length > 0.0f) {
+                normals.push_back(normal / length);
+                normalSum += normal / length;
+            }
+        }
+        float axisLength = glm::length(normalSum);
+        if (normals.empty() || axisLength <= 0.0f) {
+            return meshlet;
+        }
+        glm::vec3 axis = normalSum / axisLength;
+        float minDot = 1.0f;
+        for (const glm::vec3& normal : normals) {
+            minDot = std::min(minDot, glm::dot(normal, axis));
+        }
+
+        // Nearly a half sphere of directions or more: some triangle faces every viewer
+        if (minDot <= 0.1f) {
+            return meshlet;
+        }
+        meshlet.coneAxis = axis;
+        meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+        return meshlet;
+    }
+
+}
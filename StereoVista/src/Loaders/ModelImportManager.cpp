@@ -0,0 +1,544 @@
+#include "Loaders/ModelImportManager.h"
+#include "Loaders/MeshCache.h"
+#include "Engine/JobSystem.h"
+#include <assimp/ProgressHandler.hpp>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <limits>
+#include <unordered_map>
+
+namespace Engine {
+
+    std::vector<std::unique_ptr<ModelImportManager::ImportJob>> ModelImportManager::s_jobs;
+    uint32_t ModelImportManager::s_nextImportId = 1;
+    float ModelImportManager::s_uploadBudgetMs = 4.0f;
+
+    // Reports Assimp's parse progress and aborts the parse once the import is cancelled
+    class ImportProgressHandler : public Assimp::ProgressHandler {
+    public:
+        ImportProgressHandler(std::atomic<float>& progress, const std::atomic<bool>& cancelled)
+            : progress(progress), cancelled(cancelled) {}
+
+        bool Update(float percentage) override {
+            if (percentage >= 0.0f) {
+                progress = std::min(percentage, 1.0f);
+            }
+            return !cancelled;
+        }
+
+    private:
+        std::atomic<float>& progress;
+        const std::atomic<bool>& cancelled;
+    };
+
+    Model ModelImportManager::beginImport(const std::string& path, std::function<void(Model&)> onComplete) {
+        auto job = std::make_unique<ImportJob>();
+        job->id = s_nextImportId++;
+        job->path = path;
+        job->directory = path.substr(0, path.find_last_of("/\\"));
+        job->onComplete = std::move(onComplete);
+
+        // Same naming as Model(path); the unit box marks the spot until the bounds are known
+        Model model;
+        model.path = path;
+        model.directory = job->directory;
+        std::string filename = path.substr(path.find_last_of("/\\") + 1);
+        model.name = filename.substr(0, filename.find_last_of('.'));
+        model.importId = job->id;
+        model.placeholder = true;
+        model.meshes.push_back(createBoxMesh(glm::vec3(-0.5f), glm::vec3(0.5f)));
+        model.meshes.back().name = "Loading";
+        model.updateBoundingSphere();
+        model.initializeMeshSelection();
+
+        std::cout << "Importing model in the background: " << path << std::endl;
+
+        ImportJob& jobRef = *job;
+        job->worker = std::thread([&jobRef]() { runImport(jobRef); });
+        s_jobs.push_back(std::move(job));
+        return model;
+    }
+
+    void ModelImportManager::runImport(ImportJob& job) {
+        auto startTime = std::chrono::steady_clock::now();
+
+        // A cooked copy of the same file contents skips Assimp entirely
+        uint64_t cacheKey = MeshCache::isEnabled() ? MeshCache::computeKey(job.path, Model::IMPORT_FLAGS) : 0;
+        std::unique_ptr<MeshCache::CachedModel> cached = cacheKey ? MeshCache::open(cacheKey) : nullptr;
+
+        Assimp::Importer importer;
+        const aiScene* scene = nullptr;
+        std::vector<const aiMesh*> meshList;
+
+        size_t meshCount = 0;
+        glm::vec3 boundsMin(std::numeric_limits<float>::max());
+        glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+        // Texture references per material; fullPath is only known for cached models
+        std::vector<std::vector<MeshCache::CachedTexture>> sourceTextures;
+
+        if (cached) {
+            std::cout << "Loading model from mesh cache: " << job.path << std::endl;
+            meshCount = cached->meshes.size();
+            boundsMin = cached->boundsMin;
+            boundsMax = cached->boundsMax;
+            sourceTextures = cached->materials;
+        }
+        else {
+            // The importer owns its progress handler and deletes it with itself
+            importer.SetProgressHandler(new ImportProgressHandler(job.readProgress, job.cancelled));
+            scene = importer.ReadFile(job.path, Model::IMPORT_FLAGS);
+            if (job.cancelled) {
+                job.workerDone = true;
+                return;
+            }
+            if (!scene || !scene->mRootNode) {
+                std::lock_guard<std::mutex> lock(job.mutex);
+                job.error = scene ? "No root node found" : importer.GetErrorString();
+                job.stage = Stage::Failed;
+                job.workerDone = true;
+                return;
+            }
+            if (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) {
+                std::cerr << "WARNING: Model '" << job.path << "' loaded with incomplete data" << std::endl;
+            }
+
+            Model::collectMeshes(scene->mRootNode, scene, meshList);
+            meshCount = meshList.size();
+
+            // Bounds of the referenced meshes, for the placeholder box
+            std::vector<glm::vec3> meshMin(meshList.size(), glm::vec3(std::numeric_limits<float>::max()));
+            std::vector<glm::vec3> meshMax(meshList.size(), glm::vec3(std::numeric_limits<float>::lowest()));
+            JobSystem::parallelFor(meshList.size(), [&](size_t i) {
+                const aiMesh* mesh = meshList[i];
+                for (unsigned int v = 0; v < mesh->mNumVertices; v++) {
+                    glm::vec3 position(mesh->mVertices[v].x, mesh->mVertices[v].y, mesh->mVertices[v].z);
+                    meshMin[i] = glm::min(meshMin[i], position);
+                    meshMax[i] = glm::max(meshMax[i], position);
+                }
+            });
+            for (size_t i = 0; i < meshList.size(); i++) {
+                boundsMin = glm::min(boundsMin, meshMin[i]);
+                boundsMax = glm::max(boundsMax, meshMax[i]);
+            }
+
+            std::vector<bool> materialUsed(scene->mNumMaterials, false);
+            for (const aiMesh* mesh : meshList) {
+                materialUsed[mesh->mMaterialIndex] = true;
+            }
+
+            const std::pair<aiTextureType, const char*> textureTypes[] = {
+                { aiTextureType_DIFFUSE, "texture_diffuse" },
+                { aiTextureType_SPECULAR, "texture_specular" },
+                { aiTextureType_HEIGHT, "texture_normal" },
+                { aiTextureType_AMBIENT_OCCLUSION, "texture_ao" }
+            };
+
+            sourceTextures.resize(scene->mNumMaterials);
+            for (unsigned int m = 0; m < scene->mNumMaterials; m++) {
+                if (!materialUsed[m]) continue;
+                const aiMaterial* material = scene->mMaterials[m];
+                for (const auto& [type, typeName] : textureTypes) {
+                    for (unsigned int t = 0; t < material->GetTextureCount(type); t++) {
+                        aiString texturePath;
+                        if (material->GetTexture(type, t, &texturePath) != AI_SUCCESS) continue;
+                        sourceTextures[m].push_back({ typeName, texturePath.C_Str(), "" });
+                    }
+                }
+            }
+        }
+        job.readProgress = 1.0f;
+
+        // One image per distinct type and path
+        std::vector<std::vector<TextureRef>> materialTextures(sourceTextures.size());
+        std::vector<const MeshCache::CachedTexture*> imageSources;
+        std::unordered_map<std::string, size_t> imageIndices;
+        for (size_t m = 0; m < sourceTextures.size(); m++) {
+            for (const MeshCache::CachedTexture& texture : sourceTextures[m]) {
+                std::string key = texture.type + "|" + texture.path;
+                auto it = imageIndices.find(key);
+                if (it == imageIndices.end()) {
+                    it = imageIndices.emplace(key, imageSources.size()).first;
+                    imageSources.push_back(&texture);
+                }
+                materialTextures[m].push_back({ texture.type, texture.path, it->second });
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            job.boundsMin = boundsMin;
+            job.boundsMax = boundsMax;
+            job.boundsReady = meshCount > 0;
+            job.totalMeshes = static_cast<uint32_t>(meshCount);
+            job.totalTextures = static_cast<uint32_t>(imageSources.size());
+        }
+        job.stage = Stage::Textures;
+
+        // Decode the texture files here; the render thread only uploads the pixels
+        std::vector<TextureImage> images(imageSources.size());
+        JobSystem::parallelFor(imageSources.size(), [&](size_t i) {
+            if (job.cancelled) return;
+            const MeshCache::CachedTexture& source = *imageSources[i];
+            if (!source.path.empty() && source.path[0] == '*') {
+                // Embedded textures are not supported yet, same yellow marker as Model::loadEmbeddedTexture
+                images[i].fullPath = "embedded_texture_" + source.path.substr(1);
+                images[i].width = images[i].height = 1;
+                images[i].components = 4;
+                images[i].pixels = { 255, 255, 0, 255 };
+            }
+            else {
+                // The file the texture resolved to last time, then the usual search next to the model
+                std::filesystem::path resolved(source.fullPath);
+                bool decoded = !source.fullPath.empty() && Model::decodeTextureFile(
+                    resolved.filename().string().c_str(), resolved.parent_path().string(), images[i]);
+                if (!decoded) {
+                    Model::decodeTextureFile(source.path.c_str(), job.directory, images[i]);
+                }
+            }
+            job.texturesDecoded++;
+        });
+        if (job.cancelled) {
+            job.workerDone = true;
+            return;
+        }
+
+        // Converted meshes are written to the cache as they go past
+        std::unique_ptr<MeshCache::Writer> cacheWriter;
+        if (!cached && cacheKey) {
+            cacheWriter = std::make_unique<MeshCache::Writer>(cacheKey);
+            for (size_t m = 0; m < materialTextures.size(); m++) {
+                std::vector<MeshCache::CachedTexture> resolved;
+                for (const TextureRef& ref : materialTextures[m]) {
+                    resolved.push_back({ ref.type, ref.path, images[ref.imageIndex].fullPath });
+                }
+                cacheWriter->setMaterialTextures(static_cast<unsigned int>(m), resolved);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            job.images = std::move(images);
+            job.materialTextures = std::move(materialTextures);
+            job.texturesReady = true;
+        }
+        job.stage = Stage::Converting;
+
+        // Convert a batch at a time so the first meshes show up while the rest are still converting
+        MeshOrderStats orderStats;
+        const size_t batchSize = std::max<size_t>(4, (JobSystem::getWorkerCount() + 1) * 2);
+        for (size_t start = 0; start < meshCount && !job.cancelled; start += batchSize) {
+            size_t count = std::min(batchSize, meshCount - start);
+            std::vector<MeshData> converted(count);
+            JobSystem::parallelFor(count, [&](size_t i) {
+                if (cached) {
+                    converted[i] = MeshCache::toMeshData(cached->meshes[start + i]);
+                }
+                else {
+                    converted[i] = Model::convertMesh(meshList[start + i], scene, start + i);
+                }
+            });
+
+            for (const MeshData& data : converted) {
+                if (cacheWriter) {
+                    cacheWriter->addMesh(data);
+                }
+                orderStats += data.orderStats;
+            }
+
+            std::unique_lock<std::mutex> lock(job.mutex);
+            job.queueSpace.wait(lock, [&job]() { return job.cancelled || job.queuedBytes < MAX_QUEUED_BYTES; });
+            for (MeshData& data : converted) {
+                job.queuedBytes += data.vertices.size() * sizeof(Vertex) + (data.indices.size() + data.lodIndices.size()) * sizeof(GLuint);
+                job.readyMeshes.push_back(std::move(data));
+            }
+            job.meshesConverted += static_cast<uint32_t>(count);
+        }
+
+        if (!job.cancelled) {
+            if (cacheWriter) {
+                cacheWriter->finish();
+            }
+            job.stage = Stage::Uploading;
+            std::cout << "Model '" << job.path << "' " << (cached ? "read from the mesh cache" : "parsed and converted") << " in "
+                      << std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count()
+                      << " s (" << meshCount << " meshes, " << imageSources.size() << " textures)" << std::endl;
+            if (orderStats.triangles > 0) {
+                std::cout << "Mesh order: ACMR " << orderStats.acmrBefore() << " -> " << orderStats.acmrAfter()
+                          << ", overdraw " << orderStats.overdrawBefore() << " -> " << orderStats.overdrawAfter() << std::endl;
+            }
+        }
+        job.workerDone = true;
+    }
+
+    bool ModelImportManager::update(std::vector<Model>& models) {
+        bool changed = false;
+        auto deadline = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float, std::milli>(s_uploadBudgetMs));
+        // At least one upload per frame, however small the budget
+        bool uploaded = false;
+        auto withinBudget = [&]() { return !uploaded || std::chrono::steady_clock::now() < deadline; };
+
+        for (size_t j = 0; j < s_jobs.size();) {
+            ImportJob& job = *s_jobs[j];
+
+            auto modelIt = std::find_if(models.begin(), models.end(),
+                [&job](const Model& m) { return m.importId == job.id; });
+
+            // Deleting the placeholder from the scene cancels the import
+            if (modelIt == models.end() && !job.cancelled) {
+                std::cout << "Model import cancelled, placeholder removed: " << job.path << std::endl;
+                cancel(job.id);
+            }
+
+            if (job.cancelled || job.stage == Stage::Failed) {
+                if (job.stage == Stage::Failed) {
+                    std::lock_guard<std::mutex> lock(job.mutex);
+                    std::cerr << "ERROR: Assimp failed to load model '" << job.path << "'" << std::endl;
+                    std::cerr << "Reason: " << job.error << std::endl;
+                }
+                if (modelIt != models.end()) {
+                    models.erase(std::remove_if(models.begin(), models.end(),
+                        [&job](const Model& m) { return m.importId == job.id; }), models.end());
+                    changed = true;
+                }
+                // Keep the job until the worker has left; ReadFile stops at its next progress report
+                if (job.workerDone) {
+                    finishJob(j);
+                    continue;
+                }
+                j++;
+                continue;
+            }
+
+            Model& model = *modelIt;
+
+            std::unique_lock<std::mutex> lock(job.mutex);
+            if (job.boundsReady && !job.boundsApplied) {
+                job.boundsApplied = true;
+                if (model.placeholder) {
+                    model.meshes[0] = createBoxMesh(job.boundsMin, job.boundsMax);
+                    model.meshes[0].name = "Loading";
+                    model.updateBoundingSphere();
+                }
+            }
+
+            if (job.texturesReady) {
+                if (job.meshTextures.empty()) {
+                    job.uploadedImages.resize(job.images.size());
+                    job.meshTextures.resize(job.materialTextures.size());
+                }
+
+                // Textures first, so every mesh gets its complete set when it is inserted
+                while (job.imagesUploaded < job.images.size() && withinBudget()) {
+                    TextureImage& image = job.images[job.imagesUploaded];
+                    Texture& texture = job.uploadedImages[job.imagesUploaded];
+                    texture.adopt(Model::uploadTexture(image));
+                    texture.fullPath = image.fullPath;
+                    image.pixels = std::vector<unsigned char>();
+                    job.imagesUploaded++;
+                    uploaded = true;
+                }
+
+                while (job.imagesUploaded == job.images.size() && !job.readyMeshes.empty() && withinBudget()) {
+                    MeshData data = std::move(job.readyMeshes.front());
+                    job.readyMeshes.pop_front();
+                    job.queuedBytes -= data.vertices.size() * sizeof(Vertex) + (data.indices.size() + data.lodIndices.size()) * sizeof(GLuint);
+                    job.queueSpace.notify_one();
+                    lock.unlock();
+
+                    std::vector<Texture> textures = resolveTextures(job, data.materialIndex);
+                    Mesh mesh(std::move(data), std::move(textures));
+
+                    // The first real mesh replaces the box
+                    if (model.placeholder) {
+                        model.meshes.clear();
+                        model.placeholder = false;
+                    }
+                    model.meshes.push_back(std::move(mesh));
+                    job.meshesUploaded++;
+                    uploaded = true;
+
+                    lock.lock();
+                }
+            }
+
+            bool complete = job.workerDone && job.texturesReady &&
+                job.imagesUploaded == job.images.size() && job.readyMeshes.empty();
+            lock.unlock();
+
+            if (complete) {
+                if (model.placeholder) {
+                    model.meshes.clear();
+                    model.placeholder = false;
+                }
+                model.updateBoundingSphere();
+                model.initializeMeshSelection();
+                model.importId = 0;
+                job.stage = Stage::Done;
+                size_t gpuBytes = 0;
+                for (const auto& mesh : model.meshes) {
+                    gpuBytes += mesh.getGpuBytes();
+                }
+                std::cout << "Model import complete: " << job.path << " (" << model.meshes.size() << " meshes, "
+                    << gpuBytes / (1024.0 * 1024.0) << " MB of geometry on the GPU)" << std::endl;
+                if (job.onComplete) {
+                    job.onComplete(model);
+                }
+                // Copies made while the import ran still show the placeholder. They are refreshed
+                // last so they also get what onComplete changed, such as a scene's saved textures.
+                for (Model& copy : models) {
+                    if (copy.importId != job.id) continue;
+                    copy.meshes.clear();
+                    for (const Mesh& mesh : model.meshes) {
+                        copy.meshes.push_back(mesh.clone());
+                    }
+                    copy.placeholder = false;
+                    copy.importId = 0;
+                    copy.updateBoundingSphere();
+                    copy.initializeMeshSelection();
+                }
+                finishJob(j);
+                changed = true;
+                continue;
+            }
+            j++;
+        }
+        return changed;
+    }
+
+    std::vector<Texture> ModelImportManager::resolveTextures(ImportJob& job, unsigned int materialIndex) {
+        if (materialIndex >= job.materialTextures.size()) {
+            return {};
+        }
+
+        std::vector<Texture>& textures = job.meshTextures[materialIndex];
+        if (textures.empty()) {
+            for (const TextureRef& ref : job.materialTextures[materialIndex]) {
+                Texture texture = job.uploadedImages[ref.imageIndex];
+                texture.type = ref.type;
+                texture.path = ref.path;
+                textures.push_back(texture);
+            }
+        }
+        return textures;
+    }
+
+    void ModelImportManager::finishJob(size_t jobIndex) {
+        ImportJob& job = *s_jobs[jobIndex];
+        if (job.worker.joinable()) {
+            job.worker.join();
+        }
+        s_jobs.erase(s_jobs.begin() + jobIndex);
+    }
+
+    void ModelImportManager::cancel(uint32_t importId) {
+        for (auto& job : s_jobs) {
+            if (job->id != importId) continue;
+            {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->cancelled = true;
+            }
+            job->queueSpace.notify_all();
+        }
+    }
+
+    void ModelImportManager::shutdown() {
+        for (auto& job : s_jobs) {
+            cancel(job->id);
+        }
+        while (!s_jobs.empty()) {
+            finishJob(s_jobs.size() - 1);
+        }
+    }
+
+    std::vector<ModelImportManager::ImportStatus> ModelImportManager::getImports() {
+        std::vector<ImportStatus> imports;
+        for (const auto& job : s_jobs) {
+            if (job->cancelled) continue;
+            ImportStatus status;
+            status.id = job->id;
+            status.path = job->path;
+            status.stage = job->stage;
+            status.progress = computeProgress(*job);
+            status.meshesLoaded = job->meshesUploaded;
+            {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                status.totalMeshes = job->totalMeshes;
+            }
+            imports.push_back(status);
+        }
+        return imports;
+    }
+
+    bool ModelImportManager::hasActiveImports() {
+        return !s_jobs.empty();
+    }
+
+    float ModelImportManager::computeProgress(const ImportJob& job) {
+        // Rough weights: parsing dominates, texture decode and conversion come next, uploads are quick
+        uint32_t totalMeshes;
+        uint32_t totalTextures;
+        {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            totalMeshes = job.totalMeshes;
+            totalTextures = job.totalTextures;
+        }
+        float progress = 0.5f * job.readProgress;
+        if (job.stage != Stage::Reading) {
+            progress += 0.1f * (totalTextures > 0 ? float(job.texturesDecoded) / totalTextures : 1.0f);
+            progress += 0.2f * (totalMeshes > 0 ? float(job.meshesConverted) / totalMeshes : 1.0f);
+            progress += 0.2f * (totalMeshes > 0 ? float(job.meshesUploaded) / totalMeshes : 1.0f);
+        }
+        return std::min(progress, 1.0f);
+    }
+
+    const char* ModelImportManager::stageName(Stage stage) {
+        switch (stage) {
+        case Stage::Reading: return "Reading file";
+        case Stage::Textures: return "Decoding textures";
+        case Stage::Converting: return "Converting meshes";
+        case Stage::Uploading: return "Uploading";
+        case Stage::Done: return "Done";
+        case Stage::Failed: return "Failed";
+        }
+        return "";
+    }
+
+    Mesh ModelImportManager::createBoxMesh(const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+        // Four vertices per face so every face has a flat normal
+        const glm::vec3 normals[6] = {
+            { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+        };
+
+        std::vector<Vertex> vertices;
+        std::vector<GLuint> indices;
+        vertices.reserve(24);
+        indices.reserve(36);
+        glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+        glm::vec3 halfSize = (boundsMax - boundsMin) * 0.5f;
+
+        for (const glm::vec3& normal : normals) {
+            // Two axes spanning the face, ordered so that the winding is counter-clockwise from outside
+            glm::vec3 u = normal.x != 0.0f ? glm::vec3(0, 1, 0) : glm::vec3(1, 0, 0);
+            glm::vec3 v = glm::cross(normal, u);
+
+            GLuint base = static_cast<GLuint>(vertices.size());
+            const glm::vec2 corners[4] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+            for (const glm::vec2& corner : corners) {
+                Vertex vertex;
+                vertex.position = center + halfSize * (normal + u * corner.x + v * corner.y);
+                vertex.normal = normal;
+                vertex.texCoords = corner * 0.5f + 0.5f;
+                vertex.tangent = u;
+                vertex.bitangent = v;
+                vertex.materialID = 0;
+                vertices.push_back(vertex);
+            }
+            indices.insert(indices.end(), { base, base + 1, base + 2, base + 2, base + 3, base });
+        }
+
+        return Mesh(std::move(vertices), std::move(indices), std::vector<Texture>());
+    }
+
+}
@@ -1,49 +1,179 @@
 // model_loader.cpp
 #include "Loaders/ModelLoader.h"
+#include "Loaders/MeshCache.h"
+#include "Loaders/MeshSimplifier.h"
+#include "Loaders/MeshletBuilder.h"
+#include "Loaders/MeshOptimizer.h"
+#include "Engine/MeshGeometryRegistry.h"
+#include "Engine/JobSystem.h"
 #include <stb_image.h>
+#include <glm/gtc/packing.hpp>
+#include <limits>
+#include <algorithm>
 #include <map>
 #include <filesystem>
+#include <chrono>
 
 namespace Engine {
 
+    bool Mesh::quantizePositions = false;
+    bool Mesh::lodEnabled = true;
+    float Mesh::lodPixelError = 1.0f;
+
+    // Fraction of lodPixelError a coarser level has to stay under before it replaces the current one
+    static const float MESH_LOD_HYSTERESIS = 0.25f;
+
+    Mesh::Mesh(MeshData&& data, std::vector<Texture> textures)
+        : vertices(std::move(data.vertices)), indices(std::move(data.indices)), textures(std::move(textures)),
+        lodIndices(std::move(data.lodIndices)), lods(std::move(data.lods)), meshlets(std::move(data.meshlets)),
+        visible(true), color(data.color), shininess(data.shininess), emissive(0.0f), name(std::move(data.name)) {
+        setupMesh();
+    }
+
+    void Mesh::packAttributes(const Vertex& vertex, uint32_t& normal, uint32_t& tangent, uint32_t& texCoords) {
+        // The shader rebuilds the bitangent as cross(N, T); w records whether it has to be flipped
+        // for mirrored UVs. Meshes without tangents keep the default +1.
+        float handedness = glm::dot(glm::cross(vertex.normal, vertex.tangent), vertex.bitangent) < 0.0f ? -1.0f : 1.0f;
+        normal = glm::packSnorm3x10_1x2(glm::vec4(vertex.normal, 0.0f));
+        tangent = glm::packSnorm3x10_1x2(glm::vec4(vertex.tangent, handedness));
+        texCoords = glm::packHalf2x16(vertex.texCoords);
+    }
+
     void Mesh::setupMesh() {
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
+        glm::vec3 boundsMin(std::numeric_limits<float>::max());
+        glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+        for (const auto& vertex : vertices) {
+            boundsMin = glm::min(boundsMin, vertex.position);
+            boundsMax = glm::max(boundsMax, vertex.position);
+        }
+        if (!vertices.empty()) {
+            boundsCenter = (boundsMin + boundsMax) * 0.5f;
+            boundsRadius = glm::length(boundsMax - boundsMin) * 0.5f;
+        }
 
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+        // Indices are 16-bit whenever the mesh has few enough vertices. The LOD levels follow the
+        // full index list in the same range.
+        indexType = vertices.size() <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(GLuint);
+
+        // The GPU copy is packed; vertices keeps full precision for picking, bounds and voxelization
+        quantized = quantizePositions && !vertices.empty();
+        MeshVertexFormat format = quantized ? MeshVertexFormat::Quantized : MeshVertexFormat::Packed;
+        std::vector<QuantizedVertex> quantizedVertices;
+        std::vector<PackedVertex> packedVertices;
+        const void* vertexData;
+        if (quantized) {
+            positionOffset = boundsMin;
+            positionScale = glm::max(boundsMax - boundsMin, glm::vec3(1e-6f));
+
+            quantizedVertices.resize(vertices.size());
+            for (size_t i = 0; i < vertices.size(); ++i) {
+                QuantizedVertex& packed = quantizedVertices[i];
+                glm::vec3 t = glm::clamp((vertices[i].position - positionOffset) / positionScale, 0.0f, 1.0f);
+                packed.position[0] = static_cast<uint16_t>(t.x * 65535.0f + 0.5f);
+                packed.position[1] = static_cast<uint16_t>(t.y * 65535.0f + 0.5f);
+                packed.position[2] = static_cast<uint16_t>(t.z * 65535.0f + 0.5f);
+                packed.position[3] = 0;
+                packAttributes(vertices[i], packed.normal, packed.tangent, packed.texCoords);
+            }
+            vertexData = quantizedVertices.data();
+        }
+        else {
+            positionOffset = glm::vec3(0.0f);
+            positionScale = glm::vec3(1.0f);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
+            packedVertices.resize(vertices.size());
+            for (size_t i = 0; i < vertices.size(); ++i) {
+                packedVertices[i].position = vertices[i].position;
+                packAttributes(vertices[i], packedVertices[i].normal, packedVertices[i].tangent, packedVertices[i].texCoords);
+            }
+            vertexData = packedVertices.data();
+        }
 
-        // Vertex positions
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        std::vector<uint16_t> shortIndices;
+        std::vector<GLuint> allIndices;
+        const void* indexData;
+        if (indexType == GL_UNSIGNED_SHORT) {
+            shortIndices.reserve(indices.size() + lodIndices.size());
+            shortIndices.insert(shortIndices.end(), indices.begin(), indices.end());
+            shortIndices.insert(shortIndices.end(), lodIndices.begin(), lodIndices.end());
+            indexData = shortIndices.data();
+        }
+        else if (lodIndices.empty()) {
+            indexData = indices.data();
+        }
+        else {
+            allIndices.reserve(indices.size() + lodIndices.size());
+            allIndices.insert(allIndices.end(), indices.begin(), indices.end());
+            allIndices.insert(allIndices.end(), lodIndices.begin(), lodIndices.end());
+            indexData = allIndices.data();
+        }
 
-        // Vertex normals
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+        // Uploaded only if no other mesh has the same geometry resident
+        gpu = MeshGeometryRegistry::acquire(format, vertexData, static_cast<uint32_t>(vertices.size()),
+                                            indexData, (indices.size() + lodIndices.size()) * indexSize);
+        currentLod = 0;
+        meshletBounds.build(meshlets);
+    }
 
-        // Vertex texture coords
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+    size_t Mesh::getGpuBytes() const {
+        size_t vertexSize = quantized ? sizeof(QuantizedVertex) : sizeof(PackedVertex);
+        size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(GLuint);
+        return vertices.size() * vertexSize + (indices.size() + lodIndices.size()) * indexSize;
+    }
 
-        // Vertex tangent
-        glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
+    void Mesh::selectLod(float pixelsPerUnit) {
+        if (!lodEnabled || lods.empty()) {
+            currentLod = 0;
+            return;
+        }
 
-        // Vertex bitangent
-        glEnableVertexAttribArray(4);
-        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, bitangent));
+        // Errors grow with the level. A level coarser than the current one has to be well within
+        // the budget, so a mesh near a switching distance does not flicker between two levels.
+        int level = 0;
+        for (size_t i = 0; i < lods.size(); i++) {
+            int candidate = static_cast<int>(i) + 1;
+            float budget = candidate > currentLod ? lodPixelError * (1.0f - MESH_LOD_HYSTERESIS) : lodPixelError;
+            if (lods[i].error * pixelsPerUnit > budget) break;
+            level = candidate;
+        }
+        currentLod = level;
+    }
 
-        glBindVertexArray(0);
+    void Mesh::applyPositionDecode(Shader& shader) const {
+        if (!quantized) return;
+        shader.setVec3("meshPositionScale", positionScale);
+        shader.setVec3("meshPositionOffset", positionOffset);
     }
 
-    void Mesh::Draw(Shader& shader) {
-        if (!visible) return;
+    void Mesh::resetPositionDecode(Shader& shader) {
+        shader.setVec3("meshPositionScale", glm::vec3(1.0f));
+        shader.setVec3("meshPositionOffset", glm::vec3(0.0f));
+    }
 
+    Mesh Mesh::clone() const {
+        MeshData data;
+        data.vertices = vertices;
+        data.indices = indices;
+        data.lodIndices = lodIndices;
+        data.lods = lods;
+        data.meshlets = meshlets;
+        data.color = color;
+        data.shininess = shininess;
+        data.name = name;
+        Mesh copy(std::move(data), textures);
+        copy.visible = visible;
+        copy.emissive = emissive;
+        return copy;
+    }
+
+    uint32_t Mesh::getFirstIndex(int level) const {
+        size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(GLuint);
+        size_t first = level == 0 ? 0 : indices.size() + lods[level - 1].indexOffset;
+        return static_cast<uint32_t>(gpu->indexByteOffset / indexSize + first);
+    }
+
+    void Mesh::bindTextures(Shader& shader, const std::vector<Texture>& textures) {
         unsigned int diffuseNr = 0;
         unsigned int specularNr = 0;
         unsigned int normalNr = 0;
@@ -53,7 +183,7 @@ namespace Engine {
         for (unsigned int i = 0; i < textures.size(); i++) {
             glActiveTexture(GL_TEXTURE0 + i);
 
-            std::string name = textures[i].type;
+            const std::string& name = textures[i].type;
 
             if (name == "texture_diffuse") {
                 diffuseNr++;
@@ -79,13 +209,28 @@ namespace Engine {
         shader.setInt("material.numDiffuseTextures", diffuseNr);
         shader.setInt("material.numSpecularTextures", specularNr);
         shader.setInt("material.numNormalTextures", normalNr);
+    }
 
-        // Draw mesh
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+    void Mesh::drawLevel(int level) const {
+        if (!gpu || !gpu->valid()) return;
+        size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(GLuint);
+        glBindVertexArray(MeshGpuArena::getVertexArray(gpu->format));
+        glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(getLodIndexCount(level)), indexType,
+                                 (void*)(static_cast<size_t>(getFirstIndex(level)) * indexSize), static_cast<GLint>(gpu->firstVertex));
         glBindVertexArray(0);
     }
 
+    void Mesh::Draw(Shader& shader) {
+        if (!visible) return;
+
+        bindTextures(shader, textures);
+
+        // Draw mesh
+        applyPositionDecode(shader);
+        drawLevel(currentLod);
+        if (quantized) resetPositionDecode(shader);
+    }
+
     Model::Model(const std::string& path) {
         // Save the original path
         this->path = path;
@@ -97,8 +242,10 @@ namespace Engine {
         name = filename.substr(0, filename.find_last_of('.'));
 
         loadModel(path);
+        updateBoundingSphere();
+    }
 
-        // Calculate bounding sphere radius
+    void Model::updateBoundingSphere() {
         float maxDistSq = 0.0f;
         for (const auto& mesh : meshes) {
             for (const auto& vertex : mesh.vertices) {
@@ -109,16 +256,96 @@ namespace Engine {
         boundingSphereRadius = std::sqrt(maxDistSq);
     }
 
+    Model Model::clone() const {
+        Model copy;
+        copy.name = name;
+        copy.path = path;
+        copy.position = position;
+        copy.scale = scale;
+        copy.rotation = rotation;
+        copy.selected = selected;
+        copy.color = color;
+        copy.shininess = shininess;
+        copy.emissive = emissive;
+        copy.diffuseReflectivity = diffuseReflectivity;
+        copy.specularColor = specularColor;
+        copy.specularDiffusion = specularDiffusion;
+        copy.specularReflectivity = specularReflectivity;
+        copy.refractiveIndex = refractiveIndex;
+        copy.transparency = transparency;
+        copy.materialType = materialType;
+        copy.visible = visible;
+        copy.boundingSphereRadius = boundingSphereRadius;
+        copy.directory = directory;
+        copy.selectedMeshes = selectedMeshes;
+        // A copy of a model still importing follows it and gets the meshes when the import completes
+        copy.importId = importId;
+        copy.placeholder = placeholder;
+
+        copy.meshes.reserve(meshes.size());
+        for (const auto& mesh : meshes) {
+            copy.meshes.push_back(mesh.clone());
+        }
+        return copy;
+    }
+
     void Model::loadModel(const std::string& path) {
+        uint64_t cacheKey = MeshCache::isEnabled() ? MeshCache::computeKey(path, IMPORT_FLAGS) : 0;
+        if (std::unique_ptr<MeshCache::CachedModel> cached = cacheKey ? MeshCache::open(cacheKey) : nullptr) {
+            std::cout << "Loading model from mesh cache: " << path << std::endl;
+
+            std::vector<std::vector<Texture>> materialTextures(cached->materials.size());
+            for (size_t m = 0; m < cached->materials.size(); m++) {
+                for (const MeshCache::CachedTexture& cachedTexture : cached->materials[m]) {
+                    auto loaded = std::find_if(loadedTextures.begin(), loadedTextures.end(), [&](const Texture& t) {
+                        return t.path == cachedTexture.path && t.type == cachedTexture.type;
+                    });
+                    if (loaded != loadedTextures.end()) {
+                        materialTextures[m].push_back(*loaded);
+                        continue;
+                    }
+
+                    Texture texture;
+                    texture.type = cachedTexture.type;
+                    texture.path = cachedTexture.path;
+                    // Embedded textures ("*N") have no file, they get the same fallback as an import
+                    if (!cachedTexture.path.empty() && cachedTexture.path[0] == '*') {
+                        texture.adopt(loadEmbeddedTexture(cachedTexture.path, texture.fullPath));
+                        loadedTextures.push_back(texture);
+                        materialTextures[m].push_back(texture);
+                        continue;
+                    }
+
+                    // Decode from where the texture resolved last time, search next to the model otherwise
+                    TextureImage image;
+                    std::filesystem::path resolved(cachedTexture.fullPath);
+                    bool decoded = !cachedTexture.fullPath.empty() &&
+                        decodeTextureFile(resolved.filename().string().c_str(), resolved.parent_path().string(), image);
+                    if (!decoded) {
+                        decodeTextureFile(cachedTexture.path.c_str(), directory, image);
+                    }
+                    texture.fullPath = image.fullPath;
+                    texture.adopt(uploadTexture(image));
+                    loadedTextures.push_back(texture);
+                    materialTextures[m].push_back(texture);
+                }
+            }
+
+            meshes.reserve(cached->meshes.size());
+            for (const MeshCache::CachedMesh& cachedMesh : cached->meshes) {
+                MeshData data = MeshCache::toMeshData(cachedMesh);
+                std::vector<Texture> textures = data.materialIndex < materialTextures.size() ?
+                    materialTextures[data.materialIndex] : std::vector<Texture>();
+                meshes.emplace_back(std::move(data), std::move(textures));
+            }
+            loadedTextures.clear();
+            return;
+        }
+
         Assimp::Importer importer;
         
         // Original working flags to preserve normals and textures
-        const aiScene* scene = importer.ReadFile(path,
-            aiProcess_Triangulate |
-            aiProcess_GenNormals |
-            aiProcess_CalcTangentSpace |
-            aiProcess_JoinIdenticalVertices |
-            aiProcess_SortByPType);
+        const aiScene* scene = importer.ReadFile(path, IMPORT_FLAGS);
 
         if (!scene) {
             std::cerr << "ERROR: Assimp failed to load model '" << path << "'" << std::endl;
@@ -139,133 +366,179 @@ namespace Engine {
         std::cout << "Meshes: " << scene->mNumMeshes << ", Materials: " << scene->mNumMaterials << std::endl;
 
         directory = path.substr(0, path.find_last_of('/'));
-        processNode(scene->mRootNode, scene);
+
+        std::vector<const aiMesh*> meshList;
+        collectMeshes(scene->mRootNode, scene, meshList);
+
+        // Convert every mesh on the worker threads, then create the GL objects here in one pass
+        auto convertStart = std::chrono::steady_clock::now();
+        std::vector<MeshData> converted(meshList.size());
+        JobSystem::parallelFor(meshList.size(), [&](size_t i) {
+            converted[i] = convertMesh(meshList[i], scene, i);
+        });
+        auto uploadStart = std::chrono::steady_clock::now();
+
+        // Cook the converted meshes before they are handed to the GL buffers
+        std::unique_ptr<MeshCache::Writer> cacheWriter;
+        if (cacheKey) {
+            cacheWriter = std::make_unique<MeshCache::Writer>(cacheKey);
+            for (const MeshData& data : converted) {
+                cacheWriter->addMesh(data);
+            }
+        }
+
+        std::vector<std::vector<Texture>> materialTextures;
+        uploadMeshes(converted, scene, materialTextures);
+        auto uploadEnd = std::chrono::steady_clock::now();
+
+        if (cacheWriter) {
+            for (size_t m = 0; m < materialTextures.size(); m++) {
+                std::vector<MeshCache::CachedTexture> resolved;
+                for (const Texture& texture : materialTextures[m]) {
+                    resolved.push_back({ texture.type, texture.path, texture.fullPath });
+                }
+                cacheWriter->setMaterialTextures(static_cast<unsigned int>(m), resolved);
+            }
+            cacheWriter->finish();
+        }
+
+        // The import cache would otherwise keep textures alive after every mesh dropped them
+        loadedTextures.clear();
         
-        std::cout << "Model processing complete. Total meshes processed: " << meshes.size() << std::endl;
+        std::cout << "Model processing complete. Total meshes processed: " << meshes.size() << " (converted in "
+                  << std::chrono::duration<float, std::milli>(uploadStart - convertStart).count() << " ms on "
+                  << (JobSystem::getWorkerCount() + 1) << " threads, uploaded in "
+                  << std::chrono::duration<float, std::milli>(uploadEnd - uploadStart).count() << " ms)" << std::endl;
+        MeshOrderStats orderStats;
+        for (const MeshData& data : converted) {
+            orderStats += data.orderStats;
+        }
+        if (orderStats.triangles > 0) {
+            std::cout << "Mesh order: ACMR " << orderStats.acmrBefore() << " -> " << orderStats.acmrAfter()
+                      << ", overdraw " << orderStats.overdrawBefore() << " -> " << orderStats.overdrawAfter() << std::endl;
+        }
     }
 
-    void Model::processNode(aiNode* node, const aiScene* scene) {
-        // Process all meshes in current node
+    void Model::collectMeshes(const aiNode* node, const aiScene* scene, std::vector<const aiMesh*>& meshList) {
         for (unsigned int i = 0; i < node->mNumMeshes; i++) {
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.push_back(processMesh(mesh, scene, meshes.size())); // Pass current mesh count as index
+            meshList.push_back(scene->mMeshes[node->mMeshes[i]]);
         }
 
-        // Process children nodes
         for (unsigned int i = 0; i < node->mNumChildren; i++) {
-            processNode(node->mChildren[i], scene);
+            collectMeshes(node->mChildren[i], scene, meshList);
         }
     }
 
-    Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene, size_t meshIndex) {
-        std::vector<Vertex> vertices;
-        std::vector<GLuint> indices;
-        std::vector<Texture> textures;
+    MeshData Model::convertMesh(const aiMesh* mesh, const aiScene* scene, size_t meshIndex) {
+        MeshData data;
+        std::vector<Vertex>& vertices = data.vertices;
+        std::vector<GLuint>& indices = data.indices;
+        vertices.resize(mesh->mNumVertices);
+        indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
 
         // Process vertices
+        bool hasNormals = mesh->HasNormals();
+        bool hasTexCoords = mesh->mTextureCoords[0] != nullptr;
+        bool hasTangents = mesh->mTangents && mesh->mBitangents;
         for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
-            Vertex vertex;
-
-            // Position (always present)
-            vertex.position.x = mesh->mVertices[i].x;
-            vertex.position.y = mesh->mVertices[i].y;
-            vertex.position.z = mesh->mVertices[i].z;
-
-            // Normals (check if available)
-            if (mesh->HasNormals()) {
-                vertex.normal.x = mesh->mNormals[i].x;
-                vertex.normal.y = mesh->mNormals[i].y;
-                vertex.normal.z = mesh->mNormals[i].z;
+            Vertex& vertex = vertices[i];
+            vertex.position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+
+            if (hasNormals) {
+                vertex.normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
             } else {
                 vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f); // Default up vector
             }
 
-            // Texture coordinates (check if available)
-            if (mesh->mTextureCoords[0]) {
-                vertex.texCoords.x = mesh->mTextureCoords[0][i].x;
-                vertex.texCoords.y = mesh->mTextureCoords[0][i].y;
+            if (hasTexCoords) {
+                vertex.texCoords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
             } else {
                 vertex.texCoords = glm::vec2(0.0f, 0.0f);
             }
 
-            // Tangents and bitangents (check if available)
-            if (mesh->mTangents && mesh->mBitangents) {
-                vertex.tangent.x = mesh->mTangents[i].x;
-                vertex.tangent.y = mesh->mTangents[i].y;
-                vertex.tangent.z = mesh->mTangents[i].z;
-
-                vertex.bitangent.x = mesh->mBitangents[i].x;
-                vertex.bitangent.y = mesh->mBitangents[i].y;
-                vertex.bitangent.z = mesh->mBitangents[i].z;
+            if (hasTangents) {
+                vertex.tangent = glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
+                vertex.bitangent = glm::vec3(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z);
             } else {
-                // Calculate default tangent and bitangent
                 vertex.tangent = glm::vec3(1.0f, 0.0f, 0.0f);
                 vertex.bitangent = glm::vec3(0.0f, 0.0f, 1.0f);
             }
-
-            vertices.push_back(vertex);
+            vertex.materialID = 0;
         }
 
         // Process indices
         for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
-            aiFace face = mesh->mFaces[i];
-            for (unsigned int j = 0; j < face.mNumIndices; j++) {
-                indices.push_back(face.mIndices[j]);
-            }
+            const aiFace& face = mesh->mFaces[i];
+            indices.insert(indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
         }
 
-        // Process material
-        if (mesh->mMaterialIndex >= 0) {
-            aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-
-            // Load textures for this specific mesh
-            std::vector<Texture> diffuseMaps = loadMaterialTextures(material,
-                aiTextureType_DIFFUSE, "texture_diffuse");
-            textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+        // Material parameters; reading an aiMaterial is safe from several threads
+        data.materialIndex = mesh->mMaterialIndex;
+        const aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
 
-            std::vector<Texture> specularMaps = loadMaterialTextures(material,
-                aiTextureType_SPECULAR, "texture_specular");
-            textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-
-            std::vector<Texture> normalMaps = loadMaterialTextures(material,
-                aiTextureType_HEIGHT, "texture_normal");
-            textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+        aiColor3D color(0.f, 0.f, 0.f);
+        if (AI_SUCCESS == material->Get(AI_MATKEY_COLOR_DIFFUSE, color)) {
+            data.color = glm::vec3(color.r, color.g, color.b);
+        }
 
-            std::vector<Texture> aoMaps = loadMaterialTextures(material,
-                aiTextureType_AMBIENT_OCCLUSION, "texture_ao");
-            textures.insert(textures.end(), aoMaps.begin(), aoMaps.end());
+        float shininess = 32.0f;
+        if (AI_SUCCESS == material->Get(AI_MATKEY_SHININESS, shininess)) {
+            data.shininess = shininess;
+        }
 
-            // Store material properties
-            aiColor3D color(0.f, 0.f, 0.f);
-            material->Get(AI_MATKEY_COLOR_DIFFUSE, color);
+        if (mesh->mName.length > 0) {
+            data.name = mesh->mName.C_Str();
+        }
+        else {
+            data.name = "Mesh_" + std::to_string(meshIndex);
         }
 
-        Mesh result(vertices, indices, textures);
+        MeshSimplifier::buildLodChain(data);
+        MeshletBuilder::build(data);
+        if (MeshOptimizer::isEnabled()) {
+            MeshOptimizer::optimize(data);
+        }
 
-        // Initialize mesh-specific properties from material if available
-        if (mesh->mMaterialIndex >= 0) {
-            aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+        return data;
+    }
 
-            aiColor3D color(0.f, 0.f, 0.f);
-            if (AI_SUCCESS == material->Get(AI_MATKEY_COLOR_DIFFUSE, color)) {
-                result.color = glm::vec3(color.r, color.g, color.b);
-            }
+    void Model::uploadMeshes(std::vector<MeshData>& converted, const aiScene* scene, std::vector<std::vector<Texture>>& materialTextures) {
+        // Textures are loaded once per material that a mesh uses
+        materialTextures.assign(scene->mNumMaterials, std::vector<Texture>());
+        std::vector<bool> materialLoaded(scene->mNumMaterials, false);
 
-            float shininess = 32.0f;
-            if (AI_SUCCESS == material->Get(AI_MATKEY_SHININESS, shininess)) {
-                result.shininess = shininess;
+        meshes.reserve(meshes.size() + converted.size());
+        for (MeshData& data : converted) {
+            if (!materialLoaded[data.materialIndex]) {
+                materialTextures[data.materialIndex] = loadMeshTextures(scene->mMaterials[data.materialIndex]);
+                materialLoaded[data.materialIndex] = true;
             }
 
-            // Set name if available
-            if (mesh->mName.length > 0) {
-                result.name = mesh->mName.C_Str();
-            }
-            else {
-                result.name = "Mesh_" + std::to_string(meshIndex);
-            }
+            meshes.emplace_back(std::move(data), materialTextures[data.materialIndex]);
         }
+        converted.clear();
+    }
 
-        return result;
+    std::vector<Texture> Model::loadMeshTextures(aiMaterial* material) {
+        std::vector<Texture> textures;
+
+        std::vector<Texture> diffuseMaps = loadMaterialTextures(material,
+            aiTextureType_DIFFUSE, "texture_diffuse");
+        textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+
+        std::vector<Texture> specularMaps = loadMaterialTextures(material,
+            aiTextureType_SPECULAR, "texture_specular");
+        textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+
+        std::vector<Texture> normalMaps = loadMaterialTextures(material,
+            aiTextureType_HEIGHT, "texture_normal");
+        textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+
+        std::vector<Texture> aoMaps = loadMaterialTextures(material,
+            aiTextureType_AMBIENT_OCCLUSION, "texture_ao");
+        textures.insert(textures.end(), aoMaps.begin(), aoMaps.end());
+
+        return textures;
     }
 
     std::vector<Texture> Model::loadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName) {
@@ -310,10 +583,10 @@ namespace Engine {
                 std::string pathStr = texturePath.C_Str();
                 if (pathStr[0] == '*') {
                     // Handle embedded texture
-                    texture.id = loadEmbeddedTexture(pathStr, texture.fullPath);
+                    texture.adopt(loadEmbeddedTexture(pathStr, texture.fullPath));
                 } else {
                     // Handle file texture
-                    texture.id = TextureFromFile(texturePath.C_Str(), directory, texture.fullPath);
+                    texture.adopt(TextureFromFile(texturePath.C_Str(), directory, texture.fullPath));
                 }
                 
                 if (texture.id != 0) {
@@ -329,6 +602,14 @@ namespace Engine {
     }
 
     GLuint Model::TextureFromFile(const char* path, const std::string& directory, std::string& outFullPath) {
+        TextureImage image;
+        if (decodeTextureFile(path, directory, image)) {
+            outFullPath = image.fullPath;
+        }
+        return uploadTexture(image);
+    }
+
+    bool Model::decodeTextureFile(const char* path, const std::string& directory, TextureImage& image) {
         // Get the base directory without the model file name
         std::string baseDir = directory;
         size_t lastSlash = baseDir.find_last_of("/\\");
@@ -413,7 +694,6 @@ namespace Engine {
 
                     if (data) {
                         successPath = canonicalPath.string();
-                        outFullPath = successPath;
                         break;
                     }
                     else {
@@ -429,52 +709,63 @@ namespace Engine {
             }
         }
 
+        if (!data) {
+            std::cout << "Failed to load texture from all attempted paths for: " << textureName << std::endl;
+            std::cout << "Last STB Image error: " << stbi_failure_reason() << std::endl;
+            return false;
+        }
+
+        image.fullPath = successPath;
+        image.width = width;
+        image.height = height;
+        image.components = nrComponents;
+        image.pixels.assign(data, data + static_cast<size_t>(width) * height * nrComponents);
+        stbi_image_free(data);
+        std::cout << "Successfully loaded texture: " << successPath
+            << " (" << width << "x" << height << ", " << nrComponents << " components)" << std::endl;
+        return true;
+    }
+
+    GLuint Model::uploadTexture(const TextureImage& image) {
         GLuint textureID;
         glGenTextures(1, &textureID);
 
-        if (data) {
+        if (!image.pixels.empty()) {
             GLenum format;
             GLenum internalFormat;
-            if (nrComponents == 1) {
+            if (image.components == 1) {
                 format = GL_RED;
                 internalFormat = GL_R8;
             }
-            else if (nrComponents == 2) {
+            else if (image.components == 2) {
                 format = GL_RG;
                 internalFormat = GL_RG8;
             }
-            else if (nrComponents == 3) {
+            else if (image.components == 3) {
                 format = GL_RGB;
                 internalFormat = GL_RGB8;
             }
-            else if (nrComponents == 4) {
+            else if (image.components == 4) {
                 format = GL_RGBA;
                 internalFormat = GL_RGBA8;
             }
             else {
-                std::cout << "Unexpected number of components: " << nrComponents << std::endl;
+                std::cout << "Unexpected number of components: " << image.components << std::endl;
                 format = GL_RGB;
                 internalFormat = GL_RGB8;
             }
 
             glBindTexture(GL_TEXTURE_2D, textureID);
             // Use internalFormat instead of format for the internal format parameter
-            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+            glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.data());
             glGenerateMipmap(GL_TEXTURE_2D);
 
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-            stbi_image_free(data);
-            std::cout << "Successfully loaded texture: " << successPath
-                << " (" << width << "x" << height << ", " << nrComponents << " components)" << std::endl;
         }
         else {
-            std::cout << "Failed to load texture from all attempted paths for: " << textureName << std::endl;
-            std::cout << "Last STB Image error: " << stbi_failure_reason() << std::endl;
-
             // Create a default colored texture
             unsigned char defaultColor[] = { 255, 0, 255, 255 };  // Magenta
             glBindTexture(GL_TEXTURE_2D, textureID);
@@ -539,8 +830,8 @@ namespace Engine {
         glBindTexture(GL_TEXTURE_2D, 0);
     }
 
-    Model* loadModel(const std::string& filePath) {
-        return new Model(filePath);
+    Model loadModel(const std::string& filePath) {
+        return Model(filePath);
     }
 
 
@@ -608,11 +899,13 @@ namespace Engine {
         };
 
         // Create a single mesh for the cube
-        Mesh cubeMesh(vertices, indices, std::vector<Texture>());
+        Mesh cubeMesh(std::move(vertices), std::move(indices), std::vector<Texture>());
 
         // Create a Model and add the mesh
-        Model cubeModel("cube");
-        cubeModel.meshes.push_back(cubeMesh);
+        Model cubeModel;
+        cubeModel.path = "cube";
+        cubeModel.meshes.push_back(std::move(cubeMesh));
+        cubeModel.updateBoundingSphere();
 
         // Set model properties
         static int cubeCounter = 0;
@@ -704,9 +997,11 @@ namespace Engine {
             }
         }
 
-        Mesh sphereMesh(vertices, indices, std::vector<Texture>());
-        Model sphereModel("sphere");
-        sphereModel.meshes.push_back(sphereMesh);
+        Mesh sphereMesh(std::move(vertices), std::move(indices), std::vector<Texture>());
+        Model sphereModel;
+        sphereModel.path = "sphere";
+        sphereModel.meshes.push_back(std::move(sphereMesh));
+        sphereModel.updateBoundingSphere();
 
         static int sphereCounter = 0;
         sphereModel.name = "Sphere_" + std::to_string(sphereCounter++);
@@ -855,9 +1150,11 @@ namespace Engine {
             indices.push_back(currentTopCap);
         }
 
-        Mesh cylinderMesh(vertices, indices, std::vector<Texture>());
-        Model cylinderModel("cylinder");
-        cylinderModel.meshes.push_back(cylinderMesh);
+        Mesh cylinderMesh(std::move(vertices), std::move(indices), std::vector<Texture>());
+        Model cylinderModel;
+        cylinderModel.path = "cylinder";
+        cylinderModel.meshes.push_back(std::move(cylinderMesh));
+        cylinderModel.updateBoundingSphere();
 
         static int cylinderCounter = 0;
         cylinderModel.name = "Cylinder_" + std::to_string(cylinderCounter++);
@@ -892,9 +1189,11 @@ namespace Engine {
             0, 3, 1, 1, 3, 2
         };
 
-        Mesh planeMesh(vertices, indices, std::vector<Texture>());
-        Model planeModel("plane");
-        planeModel.meshes.push_back(planeMesh);
+        Mesh planeMesh(std::move(vertices), std::move(indices), std::vector<Texture>());
+        Model planeModel;
+        planeModel.path = "plane";
+        planeModel.meshes.push_back(std::move(planeMesh));
+        planeModel.updateBoundingSphere();
 
         static int planeCounter = 0;
         planeModel.name = "Plane_" + std::to_string(planeCounter++);
@@ -972,9 +1271,11 @@ namespace Engine {
             }
         }
 
-        Mesh torusMesh(vertices, indices, std::vector<Texture>());
-        Model torusModel("torus");
-        torusModel.meshes.push_back(torusMesh);
+        Mesh torusMesh(std::move(vertices), std::move(indices), std::vector<Texture>());
+        Model torusModel;
+        torusModel.path = "torus";
+        torusModel.meshes.push_back(std::move(torusMesh));
+        torusModel.updateBoundingSphere();
 
         static int torusCounter = 0;
         torusModel.name = "Torus_" + std::to_string(torusCounter++);
@@ -1,6 +1,7 @@
 // point_cloud_loader.cpp
 #include "Loaders/PointCloudLoader.h"
 #include "Engine/OctreePointCloudManager.h"
+#include "Engine/PointCloudResidencyManager.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -30,7 +31,7 @@ using namespace H5;
 
 namespace Engine {
 
-    PointCloud PointCloudLoader::loadPointCloudFile(const std::string& filePath, size_t downsampleFactor) {
+    PointCloud PointCloudLoader::loadPointCloudFile(const std::string& filePath, size_t downsampleFactor, bool buildIndex) {
         std::cout << "[DEBUG] PointCloudLoader::loadPointCloudFile() called with file: " << filePath << std::endl;
         std::cout << "[DEBUG] Downsample factor: " << downsampleFactor << std::endl;
         
@@ -43,11 +44,11 @@ namespace Engine {
         // Check file extension and delegate to appropriate loader
         if (extension == ".h5" || extension == ".hdf5" || extension == ".f5") {
             std::cout << "[DEBUG] Loading as HDF5 file" << std::endl;
-            return loadFromHDF5(filePath, downsampleFactor);
+            return loadFromHDF5(filePath, downsampleFactor, buildIndex);
         }
         else if (extension == ".pcb") {
             std::cout << "[DEBUG] Loading as binary file" << std::endl;
-            return loadFromBinary(filePath);
+            return loadFromBinary(filePath, buildIndex);
         }
 
         // Default handling for XYZ, PLY, and other text formats
@@ -128,8 +129,11 @@ namespace Engine {
         std::cout << "Total points in file: " << totalPointsProcessed << std::endl;
         std::cout << "Points loaded after downsampling: " << pointCloud.points.size() << std::endl;
 
-        setupPointCloudGLBuffers(pointCloud);
+        if (!buildIndex) {
+            return std::move(pointCloud);
+        }
 
+        setupPointCloudGLBuffers(pointCloud);
 
         if (pointCloud.useOctree) {
             OctreePointCloudManager::buildOctree(pointCloud);
@@ -141,22 +145,32 @@ namespace Engine {
         return std::move(pointCloud);
     }
 
-    bool PointCloudLoader::exportToXYZ(const PointCloud& pointCloud, const std::string& filePath) {
-        std::ofstream file(filePath);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file for writing: " << filePath << std::endl;
-            return false;
-        }
-
-        // Create transformation matrix
+    glm::mat4 PointCloudLoader::getModelMatrix(const PointCloud& pointCloud) {
         glm::mat4 transform = glm::mat4(1.0f);
         transform = glm::translate(transform, pointCloud.position);
         transform = glm::rotate(transform, glm::radians(pointCloud.rotation.x), glm::vec3(1, 0, 0));
         transform = glm::rotate(transform, glm::radians(pointCloud.rotation.y), glm::vec3(0, 1, 0));
         transform = glm::rotate(transform, glm::radians(pointCloud.rotation.z), glm::vec3(0, 0, 1));
         transform = glm::scale(transform, pointCloud.scale);
+        return transform;
+    }
 
-        for (const auto& point : pointCloud.points) {
+    bool PointCloudLoader::exportToXYZ(const PointCloud& pointCloud, const std::string& filePath) {
+        return exportPointsToXYZ(pointCloud.points, getModelMatrix(pointCloud), filePath);
+    }
+
+    bool PointCloudLoader::exportToBinary(const PointCloud& pointCloud, const std::string& filePath) {
+        return exportPointsToBinary(pointCloud.points, getModelMatrix(pointCloud), filePath);
+    }
+
+    bool PointCloudLoader::exportPointsToXYZ(const std::vector<PointCloudPoint>& points, const glm::mat4& transform, const std::string& filePath) {
+        std::ofstream file(filePath);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open file for writing: " << filePath << std::endl;
+            return false;
+        }
+
+        for (const auto& point : points) {
             // Apply transformation
             glm::vec4 transformedPos = transform * glm::vec4(point.position, 1.0f);
 
@@ -174,28 +188,20 @@ namespace Engine {
         return true;
     }
 
-    bool PointCloudLoader::exportToBinary(const PointCloud& pointCloud, const std::string& filePath) {
+    bool PointCloudLoader::exportPointsToBinary(const std::vector<PointCloudPoint>& points, const glm::mat4& transform, const std::string& filePath) {
         std::ofstream file(filePath, std::ios::binary);
         if (!file.is_open()) {
             std::cerr << "Failed to open file for writing: " << filePath << std::endl;
             return false;
         }
 
-        // Create transformation matrix
-        glm::mat4 transform = glm::mat4(1.0f);
-        transform = glm::translate(transform, pointCloud.position);
-        transform = glm::rotate(transform, glm::radians(pointCloud.rotation.x), glm::vec3(1, 0, 0));
-        transform = glm::rotate(transform, glm::radians(pointCloud.rotation.y), glm::vec3(0, 1, 0));
-        transform = glm::rotate(transform, glm::radians(pointCloud.rotation.z), glm::vec3(0, 0, 1));
-        transform = glm::scale(transform, pointCloud.scale);
-
         // Write header
         file.write(BINARY_MAGIC_NUMBER, 4);
-        uint32_t numPoints = pointCloud.points.size();
+        uint32_t numPoints = points.size();
         file.write(reinterpret_cast<const char*>(&numPoints), sizeof(numPoints));
 
         // Write point data
-        for (const auto& point : pointCloud.points) {
+        for (const auto& point : points) {
             // Apply transformation
             glm::vec4 transformedPos = transform * glm::vec4(point.position, 1.0f);
             glm::vec3 finalPos(transformedPos);
@@ -213,6 +219,78 @@ namespace Engine {
         return true;
     }
 
+    std::future<bool> PointCloudLoader::exportClippedAsync(const PointCloud& pointCloud, const std::string& filePath, bool binary) {
+        // Everything the worker needs is captured here, the cloud itself is not touched again
+        PointCloudClipSnapshot snapshot = OctreePointCloudManager::snapshotClippedPages(pointCloud);
+        glm::mat4 transform = getModelMatrix(pointCloud);
+
+        return std::async(std::launch::async, [snapshot = std::move(snapshot), transform, filePath, binary]() {
+            std::vector<PointCloudPoint> points = OctreePointCloudManager::readClippedPages(snapshot);
+            std::cout << "Exporting " << points.size() << " clipped points to " << filePath << std::endl;
+            return binary ? exportPointsToBinary(points, transform, filePath)
+                          : exportPointsToXYZ(points, transform, filePath);
+        });
+    }
+
+    std::vector<PointCloud> PointCloudLoader::loadSequence(const std::vector<std::string>& framePaths, uint32_t sequenceId,
+                                                          const std::string& sequenceName) {
+        std::vector<PointCloud> frames;
+        frames.reserve(framePaths.size());
+
+        // The frames get one root cube, so the union of their bounds is needed before any is built.
+        // Raw frames are held until then as long as they fit in half the CPU budget, the rest is
+        // read a second time.
+        glm::vec3 boundsMin(std::numeric_limits<float>::max());
+        glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+        size_t heldBytes = 0;
+        size_t holdBudget = PointCloudResidencyManager::getCpuBudget() / 2;
+
+        for (const std::string& framePath : framePaths) {
+            PointCloud frame = loadPointCloudFile(framePath, 1, false);
+            if (frame.points.empty()) {
+                std::cerr << "Skipping empty sequence frame: " << framePath << std::endl;
+                continue;
+            }
+
+            for (const auto& point : frame.points) {
+                boundsMin = glm::min(boundsMin, point.position);
+                boundsMax = glm::max(boundsMax, point.position);
+            }
+
+            size_t frameBytes = frame.points.size() * sizeof(PointCloudPoint);
+            if (heldBytes + frameBytes > holdBudget) {
+                frame.points.clear();
+                frame.points.shrink_to_fit();
+            } else {
+                heldBytes += frameBytes;
+            }
+
+            frame.filePath = framePath;
+            frames.push_back(std::move(frame));
+        }
+
+        for (size_t i = 0; i < frames.size(); i++) {
+            PointCloud& frame = frames[i];
+            if (frame.points.empty()) {
+                PointCloud reread = loadPointCloudFile(frame.filePath, 1, false);
+                frame.points = std::move(reread.points);
+            }
+
+            char frameLabel[16];
+            snprintf(frameLabel, sizeof(frameLabel), "%04zu", i);
+            frame.name = sequenceName + " [" + frameLabel + "]";
+            frame.sequenceId = sequenceId;
+            frame.sequenceFrame = static_cast<int>(i);
+            frame.visible = (i == 0);
+            frame.chunkCache.cacheDirectory = "pointcloud_cache/sequence_" + std::to_string(sequenceId) + "/frame_" + frameLabel;
+
+            OctreePointCloudManager::buildOctree(frame, boundsMin, boundsMax);
+        }
+
+        std::cout << "Loaded sequence " << sequenceName << " with " << frames.size() << " frames" << std::endl;
+        return frames;
+    }
+
     struct IVec3Comparator{
     bool operator()(const glm::ivec3 & lhs, const glm::ivec3 & rhs) const {
         if (lhs.x != rhs.x) return lhs.x < rhs.x;
@@ -221,7 +299,7 @@ namespace Engine {
     }
     };
 
-    PointCloud PointCloudLoader::loadFromBinary(const std::string& filePath) {
+    PointCloud PointCloudLoader::loadFromBinary(const std::string& filePath, bool buildIndex) {
         std::cout << "[DEBUG] loadFromBinary() called with file: " << filePath << std::endl;
         
         PointCloud pointCloud;
@@ -341,9 +419,11 @@ namespace Engine {
             
             std::cout << "[DEBUG] Transformation values initialized" << std::endl;
 
-            std::cout << "[DEBUG] Setting up GL buffers..." << std::endl;
-            setupPointCloudGLBuffers(pointCloud);
-            std::cout << "[DEBUG] GL buffers setup complete" << std::endl;
+            if (buildIndex) {
+                std::cout << "[DEBUG] Setting up GL buffers..." << std::endl;
+                setupPointCloudGLBuffers(pointCloud);
+                std::cout << "[DEBUG] GL buffers setup complete" << std::endl;
+            }
 
             std::cout << "Successfully loaded point cloud from: " << filePath << std::endl;
             std::cout << "Loaded " << pointCloud.points.size() << " points" << std::endl;
@@ -355,6 +435,10 @@ namespace Engine {
         }
 
 
+        if (!buildIndex) {
+            return std::move(pointCloud);
+        }
+
         std::cout << "[DEBUG] useOctree flag: " << (pointCloud.useOctree ? "true" : "false") << std::endl;
         if (pointCloud.useOctree) {
             std::cout << "[DEBUG] Starting octree build..." << std::endl;
@@ -638,7 +722,7 @@ namespace Engine {
         glBindVertexArray(0);
     }
 
-    PointCloud PointCloudLoader::loadFromHDF5(const std::string& filePath, size_t downsampleFactor) {
+    PointCloud PointCloudLoader::loadFromHDF5(const std::string& filePath, size_t downsampleFactor, bool buildIndex) {
         PointCloud pointCloud;
         pointCloud.name = "PointCloud_" + std::filesystem::path(filePath).filename().string();
         pointCloud.position = glm::vec3(0.0f);
@@ -1312,10 +1396,13 @@ namespace Engine {
                             // Skip the regular dataset processing since we already have our data
                             file.close();
                             
+                            if (!buildIndex) {
+                                return std::move(pointCloud);
+                            }
+
                             // Set up OpenGL buffers and build octree
                             setupPointCloudGLBuffers(pointCloud);
                             
-                            
                             if (pointCloud.useOctree) {
                                 OctreePointCloudManager::buildOctree(pointCloud);
                             } else {
@@ -1350,10 +1437,13 @@ namespace Engine {
             return std::move(pointCloud);
         }
 
+        if (!buildIndex) {
+            return std::move(pointCloud);
+        }
+
         // Set up OpenGL buffers and build octree
         setupPointCloudGLBuffers(pointCloud);
         
-        
         if (pointCloud.useOctree) {
             OctreePointCloudManager::buildOctree(pointCloud);
         } else {
@@ -7,6 +7,7 @@
 
 // ---- Project-Specific Includes ----
 #include "Loaders/ModelLoader.h"
+#include "Loaders/ModelImportManager.h"
 #include "Core/Camera.h"
 #include "Core/SceneManager.h"
 #include "Cursors/CursorPresets.h"
@@ -14,6 +15,11 @@
 #include "Cursors/Base/CursorManager.h"
 #include "Core/Voxalizer.h"
 #include "Engine/OctreePointCloudManager.h"
+#include "Engine/MeshBatchRenderer.h"
+#include "Engine/MeshClusterCuller.h"
+#include "Engine/PointCloudResidencyManager.h"
+#include "Engine/PointCloudSequenceManager.h"
+#include "Engine/JobSystem.h"
 #include "Engine/SpaceMouseInput.h"
 #include "Gui/Gui.h"
 #include "Gui/GuiTypes.h"
@@ -59,7 +65,7 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 
 // ---- Rendering Functions ----
 void renderEye(GLenum drawBuffer, const glm::mat4& projection, const glm::mat4& view, Engine::Shader* shader, ImGuiViewportP* viewport, ImGuiWindowFlags windowFlags, GLFWwindow* window);
-void renderModels(Engine::Shader* shader);
+void renderModels(Engine::Shader* shader, bool cullClusters = false);
 void renderPointClouds(Engine::Shader* shader);
 void renderZeroPlane(Engine::Shader* shader, const glm::mat4& projection, const glm::mat4& view, float convergence);
 void DrawRadar(bool isStereoWindow, Camera camera, GLfloat focaldist, 
@@ -74,6 +80,10 @@ glm::vec4 divw(glm::vec4 vec);
 void updatePointLights();
 void updateSpaceMouseBounds();
 void updateSpaceMouseCursorAnchor();
+void updatePointClouds();
+void prefetchPointClouds();
+void updateModelLODs();
+void setPointCloudClipUniforms(Engine::Shader* shader, const PointCloud& pointCloud);
 
 PointCloud loadPointCloudFile(const std::string& filePath, size_t downsampleFactor = 1);
 
@@ -86,6 +96,8 @@ void cleanup(Engine::Shader* shader);
 float calculateLargestModelDimension();
 void calculateMouseRay(float mouseX, float mouseY, glm::vec3& rayOrigin, glm::vec3& rayDirection, glm::vec3& rayNear, glm::vec3& rayFar, float aspect);
 bool rayIntersectsModel(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const Engine::Model& model, float& distance);
+bool rayIntersectsPointCloud(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, float coneSlope, PointCloud& pointCloud, float& distance, glm::vec3& hitPosition);
+bool pickPointClouds(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, float coneSlope, float& distance, glm::vec3& hitPosition, int& pointCloudIndex);
 #pragma endregion
 
 
@@ -178,6 +190,7 @@ bool middleMousePressed = false; // Middle mouse button state
 bool ctrlPressed = false;
 double lastClickTime = 0.0;
 const double doubleClickTime = 0.3; // 300 ms double-click threshold
+const float pointCloudPickRadiusPixels = 3.0f; // Screen-space radius for point cloud picking
 
 // ---- Timing ----
 float deltaTime = 0.0f;
@@ -1337,14 +1350,28 @@ void PerspectiveProjection(GLfloat* frustum, GLfloat dir,
     frustum[5] = zfar;
 }
 
-int main() {
-    // ---- Initialize Async Loading System ----
+int main(int argc, char** argv) {
+    // ---- Headless Cache Inspection ----
+    // StereoVista --inspect-cache <cache directory> [--pages]
+    if (argc >= 2 && std::string(argv[1]) == "--inspect-cache") {
+        if (argc < 3) {
+            std::cerr << "Usage: " << argv[0] << " --inspect-cache <cache directory> [--pages]" << std::endl;
+            return 1;
+        }
+        bool readPages = argc >= 4 && std::string(argv[3]) == "--pages";
+        return OctreePointCloudManager::inspectCache(argv[2], readPages);
+    }
+
+    // ---- Initialize Worker Threads and Async Loading System ----
+    Engine::JobSystem::initialize();
     OctreePointCloudManager::initializeAsyncSystem();
+    Engine::PointCloudResidencyManager::initialize();
     
     // ---- Initialize GLFW ----
     if (!glfwInit()) {
         std::cout << "Failed to initialize GLFW" << std::endl;
         OctreePointCloudManager::shutdownAsyncSystem();
+        Engine::JobSystem::shutdown();
         return -1;
     }
 
@@ -1388,6 +1415,7 @@ int main() {
         glfwTerminate();
         return -1;
     }
+    Engine::PointCloudResidencyManager::initializeGpu();
 
     glEnable(GL_MULTISAMPLE);
 
@@ -1438,70 +1466,70 @@ int main() {
     basePlatform.scale = glm::vec3(4.0f, 0.2f, 4.0f);
     basePlatform.name = "Base_Platform";
     basePlatform.position = glm::vec3(0.0f, -1.0f, 0.0f);
-    currentScene.models.push_back(basePlatform);
+    currentScene.models.push_back(std::move(basePlatform));
 
 
     Engine::Model centralCube = Engine::createCube(glm::vec3(1.0f, 0.2f, 0.2f), 1.0f, 0.8f);
     centralCube.scale = glm::vec3(0.8f, 0.8f, 0.8f);
     centralCube.name = "Central_Light_Cube";
     centralCube.position = glm::vec3(0.0f, 0.0f, 0.0f);
-    currentScene.models.push_back(centralCube);
+    currentScene.models.push_back(std::move(centralCube));
 
 
     Engine::Model blueCube = Engine::createCube(glm::vec3(0.2f, 0.4f, 1.0f), 1.0f, 0.0f);
     blueCube.scale = glm::vec3(0.6f, 0.6f, 0.6f);
     blueCube.name = "Blue_Cube";
     blueCube.position = glm::vec3(-1.5f, 0.2f, 1.5f);
-    currentScene.models.push_back(blueCube);
+    currentScene.models.push_back(std::move(blueCube));
 
 
     Engine::Model greenCube = Engine::createCube(glm::vec3(0.2f, 1.0f, 0.3f), 1.0f, 0.0f);
     greenCube.scale = glm::vec3(0.5f, 1.2f, 0.5f);
     greenCube.name = "Green_Tower";
     greenCube.position = glm::vec3(1.2f, 0.6f, 1.0f);
-    currentScene.models.push_back(greenCube);
+    currentScene.models.push_back(std::move(greenCube));
 
 
     Engine::Model yellowCube = Engine::createCube(glm::vec3(1.0f, 1.0f, 0.3f), 1.0f, 0.4f);
     yellowCube.scale = glm::vec3(0.4f, 0.4f, 0.4f);
     yellowCube.name = "Yellow_Light";
     yellowCube.position = glm::vec3(-1.8f, 0.5f, -1.8f);
-    currentScene.models.push_back(yellowCube);
+    currentScene.models.push_back(std::move(yellowCube));
 
 
     Engine::Model purpleCube = Engine::createCube(glm::vec3(0.8f, 0.2f, 0.9f), 1.0f, 0.0f);
     purpleCube.scale = glm::vec3(0.7f, 0.7f, 0.7f);
     purpleCube.name = "Purple_Cube";
     purpleCube.position = glm::vec3(1.5f, 0.35f, -1.5f);
-    currentScene.models.push_back(purpleCube);
+    currentScene.models.push_back(std::move(purpleCube));
 
 
     Engine::Model orangeCube = Engine::createCube(glm::vec3(1.0f, 0.6f, 0.1f), 1.0f, 0.0f);
     orangeCube.scale = glm::vec3(0.3f, 0.3f, 0.3f);
     orangeCube.name = "Orange_Small";
     orangeCube.position = glm::vec3(0.5f, 1.5f, 0.5f);
-    currentScene.models.push_back(orangeCube);
+    currentScene.models.push_back(std::move(orangeCube));
 
 
     Engine::Model cyanCube = Engine::createCube(glm::vec3(0.2f, 0.9f, 0.9f), 1.0f, 0.1f);
     cyanCube.scale = glm::vec3(0.4f, 0.8f, 0.4f);
     cyanCube.name = "Cyan_Pillar";
     cyanCube.position = glm::vec3(-2.5f, 0.4f, 0.0f);
-    currentScene.models.push_back(cyanCube);
+    currentScene.models.push_back(std::move(cyanCube));
 
 
     Engine::Model whiteCube = Engine::createCube(glm::vec3(0.9f, 0.9f, 0.9f), 1.0f, 0.0f);
     whiteCube.scale = glm::vec3(0.5f, 0.5f, 0.5f);
     whiteCube.name = "White_Reflective";
     whiteCube.position = glm::vec3(2.5f, 0.25f, 0.5f);
-    currentScene.models.push_back(whiteCube);
+    currentScene.models.push_back(std::move(whiteCube));
 
     for (int i = 0; i < 3; i++) {
         Engine::Model smallCube = Engine::createCube(glm::vec3(0.6f + i * 0.3f, 0.4f, 0.7f - i * 0.3f), 1.0f, 0.0f);
         smallCube.scale = glm::vec3(0.2f, 0.2f, 0.2f);
         smallCube.name = "Small_Detail_" + std::to_string(i);
         smallCube.position = glm::vec3(-0.5f + i * 0.3f, -0.7f, -0.8f + i * 0.6f);
-        currentScene.models.push_back(smallCube);
+        currentScene.models.push_back(std::move(smallCube));
     }
     
     currentModelIndex = 0;
@@ -1525,6 +1553,12 @@ int main() {
 
     // Initialize cursor manager
     cursorManager.initialize();
+    cursorManager.setPickRadiusPixels(pointCloudPickRadiusPixels);
+    cursorManager.setRayPicker([](const glm::vec3& origin, const glm::vec3& direction, float coneSlope, glm::vec3& hitPosition) {
+        float distance;
+        int pointCloudIndex;
+        return pickPointClouds(origin, direction, coneSlope, distance, hitPosition, pointCloudIndex);
+    });
 
     setupShadowMapping();
     setupSkyboxVAO(skyboxVAO, skyboxVBO);
@@ -1710,6 +1744,26 @@ int main() {
         // Update smooth scrolling deceleration, centering animation etc.
         camera.UpdateScrolling(deltaTime);
         camera.UpdateAnimation(deltaTime);
+        camera.TrackMotion(deltaTime);
+
+        // Select the visible point cloud nodes once for both eyes, then queue loads
+        // for the nodes along the predicted camera path
+        Engine::PointCloudResidencyManager::beginFrame();
+        updatePointClouds();
+        prefetchPointClouds();
+
+        // Move meshes of background model imports into the scene, within the per-frame upload budget
+        if (Engine::ModelImportManager::update(currentScene.models)) {
+            if (currentSelectedType == SelectedType::Model && currentSelectedIndex >= static_cast<int>(currentScene.models.size())) {
+                currentSelectedIndex = -1;
+                currentSelectedMeshIndex = -1;
+                currentSelectedType = SelectedType::None;
+            }
+            updateSpaceMouseBounds();
+        }
+
+        // Mesh LODs are chosen from the centre camera, so both eyes and the shadow pass draw the same level
+        updateModelLODs();
 
         // ---- Calculate View and Projection ----
         glm::mat4 view = camera.GetViewMatrix();
@@ -1761,6 +1815,18 @@ int main() {
         glm::vec3 rightEyePos = pos + (rightVec * effectiveSeparation / 2.0f);
         rightView = glm::lookAt(rightEyePos, rightEyePos + frontVec, upVec);
         }
+
+        // Clusters are culled once against both eyes; each eye replays the same draw commands
+        if (isStereoWindow) {
+            Engine::MeshClusterCuller::cullModels(currentScene.models, leftProjection * leftView, rightProjection * rightView,
+                glm::vec3(glm::inverse(leftView)[3]), glm::vec3(glm::inverse(rightView)[3]), glIsEnabled(GL_CULL_FACE));
+        }
+        else {
+            Engine::MeshClusterCuller::cullModels(currentScene.models, projection * view, projection * view,
+                camera.Position, camera.Position, glIsEnabled(GL_CULL_FACE));
+        }
+        Engine::MeshBatchRenderer::beginFrame();
+
         // ---- Update Scene State ----
         // Set wireframe mode before rendering
         glPolygonMode(GL_FRONT_AND_BACK, camera.wireframe ? GL_LINE : GL_FILL);
@@ -1790,6 +1856,9 @@ int main() {
             // Render mono view to default buffer (cursor position will be calculated here)
             renderEye(GL_BACK_LEFT, projection, view, activeShader, viewport, windowFlags, window);
         }
+
+        // Keep streamed point cloud nodes of all clouds within the shared memory budgets
+        Engine::PointCloudResidencyManager::enforceBudgets(currentScene.pointClouds);
         
         // Update the cursor's captured position if available (after rendering)
         if (cursorManager.isCursorPositionValid()) {
@@ -1812,8 +1881,9 @@ int main() {
     // ---- Cleanup ----
     cleanup(shader);
     
-    // ---- Shutdown Async Loading System ----
+    // ---- Shutdown Async Loading System and Worker Threads ----
     OctreePointCloudManager::shutdownAsyncSystem();
+    Engine::JobSystem::shutdown();
 
     return 0;
 }
@@ -1825,11 +1895,19 @@ void cleanup(Engine::Shader* shader) {
     // Delete cursor manager resources
     cursorManager.cleanup();
 
+    // Meshes and textures delete their GL objects with the models, while the context is alive
+    Engine::ModelImportManager::shutdown();
+    Engine::PointCloudSequenceManager::shutdown();
+    currentScene.models.clear();
+
     // Delete point cloud resources
     for (auto& pointCloud : currentScene.pointClouds) {
         glDeleteVertexArrays(1, &pointCloud.vao);
         glDeleteBuffers(1, &pointCloud.vbo);
     }
+    OctreePointCloudManager::releaseGpuResources();
+    Engine::MeshBatchRenderer::releaseGpuResources();
+    Engine::MeshGpuArena::shutdown();
 
     // Delete skybox resources
     glDeleteVertexArrays(1, &skyboxVAO);
@@ -2132,7 +2210,7 @@ void renderEye(GLenum drawBuffer, const glm::mat4& projection, const glm::mat4&
     }
 
     // Render scene
-    renderModels(shader);
+    renderModels(shader, true);
     renderPointClouds(shader);
     
     // Calculate distance to nearest object AFTER scene rendering but BEFORE zero plane
@@ -2176,6 +2254,8 @@ void renderEye(GLenum drawBuffer, const glm::mat4& projection, const glm::mat4&
 
     // Calculate cursor position (only once per frame for stereo consistency)
     // For stereo: first call (left eye) calculates, second call (right eye) uses cached value
+    // Point clouds are picked on the CPU, the depth readback is only needed for meshes and the zero plane
+    cursorManager.setDepthPickingEnabled(!currentScene.models.empty() || currentScene.settings.showZeroPlane);
     cursorManager.updateCursorPosition(window, projection, view, shader, false);
     
     // Update SpaceMouse cursor anchor when cursor position changes
@@ -2213,7 +2293,7 @@ void renderEye(GLenum drawBuffer, const glm::mat4& projection, const glm::mat4&
     glBindTexture(GL_TEXTURE_3D, 0);
 }
 
-void renderModels(Engine::Shader* shader) {
+void renderModels(Engine::Shader* shader, bool cullClusters) {
     // Don't do lighting setup for the depth shader
     if (shader != simpleDepthShader) {
         // Bind skybox for reflections
@@ -2286,10 +2366,27 @@ void renderModels(Engine::Shader* shader) {
             * camera.GetViewMatrix();
     }
 
+    // Meshes go out batched from the shared geometry buffers. The pass is built by the first
+    // eye that draws it this frame; the second eye only replays it.
+    Engine::MeshBatchRenderer::Pass pass = shader == simpleDepthShader ? Engine::MeshBatchRenderer::PASS_DEPTH
+        : cullClusters ? Engine::MeshBatchRenderer::PASS_SCENE : Engine::MeshBatchRenderer::PASS_RADAR;
+    bool buildPass = !Engine::MeshBatchRenderer::isBuilt(pass);
+    if (buildPass) {
+        Engine::MeshBatchRenderer::beginPass(pass);
+    }
+
+    // Set selection state
+    shader->setBool("selectionMode", selectionMode);
+    shader->setInt("selectedMeshIndex", currentSelectedMeshIndex);
+    shader->setBool("isMeshSelected", currentSelectedMeshIndex >= 0);
+
     // Render each model
     for (int i = 0; i < currentScene.models.size(); i++) {
         auto& model = currentScene.models[i];
         if (!model.visible) continue;
+        // The box of a model that is still importing is drawn as an outline and casts no shadow
+        if (model.placeholder && shader == simpleDepthShader) continue;
+        if (!model.placeholder && !buildPass) continue;
 
         // Calculate model matrix
         glm::mat4 modelMatrix = glm::mat4(1.0f);
@@ -2299,41 +2396,51 @@ void renderModels(Engine::Shader* shader) {
         modelMatrix = glm::rotate(modelMatrix, glm::radians(model.rotation.z), glm::vec3(0, 0, 1));
         modelMatrix = glm::scale(modelMatrix, model.scale);
 
-        // Set model matrix in shader
-        shader->setMat4("model", modelMatrix);
+        bool isSelected = selectionMode && (i == currentSelectedIndex) && (currentSelectedType == SelectedType::Model);
+
+        if (!model.placeholder) {
+            Engine::MeshBatchRenderer::DrawParams params{};
+            params.model = modelMatrix;
+            params.colorShininess = glm::vec4(model.color, model.shininess);
+            params.specularColorDiffusion = glm::vec4(model.specularColor, model.specularDiffusion);
+            params.emissive = model.emissive;
+            params.hasTexture = !model.getMeshes().empty() && !model.getMeshes()[0].textures.empty() ? 1.0f : 0.0f;
+            params.diffuseReflectivity = model.diffuseReflectivity;
+            params.specularReflectivity = model.specularReflectivity;
+            params.refractiveIndex = model.refractiveIndex;
+            params.transparency = model.transparency;
+            params.flags = (isSelected ? Engine::MeshBatchRenderer::DRAW_SELECTED : 0u)
+                | (model.hasNormalMap() ? Engine::MeshBatchRenderer::DRAW_NORMAL_MAP : 0u)
+                | (model.hasSpecularMap() ? Engine::MeshBatchRenderer::DRAW_SPECULAR_MAP : 0u)
+                | (model.hasAOMap() ? Engine::MeshBatchRenderer::DRAW_AO_MAP : 0u);
+
+            for (int j = 0; j < model.getMeshes().size(); j++) {
+                params.meshIndex = j;
+                Engine::MeshBatchRenderer::addMesh(pass, model.getMeshes()[j], params, cullClusters);
+            }
+            continue;
+        }
 
-        // Set standard material properties
-        shader->setBool("material.hasNormalMap", model.hasNormalMap());
-        shader->setBool("material.hasSpecularMap", model.hasSpecularMap());
-        shader->setBool("material.hasAOMap", model.hasAOMap());
-        shader->setFloat("material.hasTexture", !model.getMeshes().empty() && !model.getMeshes()[0].textures.empty() ? 1.0f : 0.0f);
+        // Placeholders are few and drawn on their own with plain uniforms
+        shader->setMat4("model", modelMatrix);
+        shader->setBool("material.hasNormalMap", false);
+        shader->setBool("material.hasSpecularMap", false);
+        shader->setBool("material.hasAOMap", false);
+        shader->setFloat("material.hasTexture", 0.0f);
         shader->setVec3("material.objectColor", model.color);
         shader->setFloat("material.shininess", model.shininess);
         shader->setFloat("material.emissive", model.emissive);
+        shader->setBool("isSelected", isSelected);
 
-        // For VCT, set additional material properties
-        if (currentLightingMode == GUI::LIGHTING_VOXEL_CONE_TRACING) {
-            // Set VCT specific material properties
-            shader->setFloat("material.diffuseReflectivity", model.diffuseReflectivity);
-            shader->setVec3("material.specularColor", model.specularColor);
-            shader->setFloat("material.specularReflectivity", model.specularReflectivity);
-            shader->setFloat("material.specularDiffusion", model.specularDiffusion);
-            shader->setFloat("material.refractiveIndex", model.refractiveIndex);
-            shader->setFloat("material.transparency", model.transparency);
-        }
-
-        // Set selection state
-        shader->setBool("selectionMode", selectionMode);
-        shader->setBool("isSelected", selectionMode && (i == currentSelectedIndex) && (currentSelectedType == SelectedType::Model));
-        shader->setInt("selectedMeshIndex", currentSelectedMeshIndex);
-        shader->setBool("isMeshSelected", currentSelectedMeshIndex >= 0);
-
-        // Set current mesh index for all meshes
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
         for (int j = 0; j < model.getMeshes().size(); j++) {
             shader->setInt("currentMeshIndex", j);
             model.getMeshes()[j].Draw(*shader);
         }
+        glPolygonMode(GL_FRONT_AND_BACK, camera.wireframe ? GL_LINE : GL_FILL);
     }
+
+    Engine::MeshBatchRenderer::draw(pass, *shader);
 }
 
 void renderPointClouds(Engine::Shader* shader) {
@@ -2354,22 +2461,22 @@ void renderPointClouds(Engine::Shader* shader) {
         shader->setBool("isPointCloud", true);
 
         // Always use octree-based rendering (legacy system removed)
-        if (pointCloud.octreeRoot) {
-            // Update LOD system for current camera position
-            glm::vec3 cameraPosition = camera.Position;
-            OctreePointCloudManager::updateLOD(pointCloud, cameraPosition);
-            
-            // Bind VAO for octree rendering (octree nodes use their own VBOs but need the VAO for attributes)
+        if (pointCloud.hasOctree()) {
+            // Bind VAO for octree rendering (node data lives in the shared GPU arena, the VAO holds the attribute layout)
             glBindVertexArray(pointCloud.vao);
             
-            // Render visible octree nodes
-            OctreePointCloudManager::renderVisible(pointCloud, cameraPosition);
+            // Replay the render list selected for this frame in updatePointClouds
+            shader->setBool("useNodeDrawBuffer", true);
+            shader->setBool("pointCloudHasNormals", pointCloud.hasNormals);
+            setPointCloudClipUniforms(shader, pointCloud);
+            OctreePointCloudManager::renderVisible(pointCloud);
+            shader->setBool("useNodeDrawBuffer", false);
             
             glBindVertexArray(0);
         }
 
         // Visualize octree structure if enabled
-        if (pointCloud.visualizeOctree && pointCloud.octreeRoot) {
+        if (pointCloud.visualizeOctree && pointCloud.hasOctree()) {
             // Generate octree visualization if not already done
             if (pointCloud.chunkOutlineVertices.empty()) {
                 OctreePointCloudManager::generateOctreeVisualization(pointCloud, pointCloud.visualizeDepth);
@@ -2748,7 +2855,7 @@ void updateSpaceMouseBounds() {
     
     // Include point clouds in bounding box calculation
     for (const auto& pointCloud : currentScene.pointClouds) {
-        if (pointCloud.octreeRoot) {
+        if (pointCloud.hasOctree()) {
             // Use octree bounds if available
             glm::vec3 pcMin = pointCloud.position + (pointCloud.octreeBoundsMin * pointCloud.scale);
             glm::vec3 pcMax = pointCloud.position + (pointCloud.octreeBoundsMax * pointCloud.scale);
@@ -2774,6 +2881,86 @@ void updateSpaceMouseBounds() {
     spaceMouseInput.SetModelExtents(modelMin, modelMax);
 }
 
+void updatePointClouds() {
+    // Sequences whose background import finished join the scene
+    if (Engine::PointCloudSequenceManager::updateImports(currentScene.pointCloudSequences, currentScene.pointClouds)) {
+        updateSpaceMouseBounds();
+    }
+
+    // Sequence playback first, so a newly shown frame gets its render list this frame
+    Engine::PointCloudSequenceManager::update(currentScene.pointCloudSequences, currentScene.pointClouds, deltaTime, camera.Position);
+
+    for (auto& pointCloud : currentScene.pointClouds) {
+        if (!pointCloud.visible || !pointCloud.hasOctree()) continue;
+        OctreePointCloudManager::updateLOD(pointCloud, camera.Position);
+    }
+}
+
+void updateModelLODs() {
+    if (windowHeight <= 0) return;
+
+    // Pixels covered by one unit at distance 1 along the view direction
+    float pixelsPerUnitAtUnitDistance = windowHeight / (2.0f * tan(glm::radians(camera.Zoom) * 0.5f));
+
+    for (auto& model : currentScene.models) {
+        if (!model.visible) continue;
+
+        glm::mat4 modelMatrix = glm::mat4(1.0f);
+        modelMatrix = glm::translate(modelMatrix, model.position);
+        modelMatrix = glm::rotate(modelMatrix, glm::radians(model.rotation.x), glm::vec3(1, 0, 0));
+        modelMatrix = glm::rotate(modelMatrix, glm::radians(model.rotation.y), glm::vec3(0, 1, 0));
+        modelMatrix = glm::rotate(modelMatrix, glm::radians(model.rotation.z), glm::vec3(0, 0, 1));
+        modelMatrix = glm::scale(modelMatrix, model.scale);
+        float maxScale = glm::max(glm::abs(model.scale.x), glm::max(glm::abs(model.scale.y), glm::abs(model.scale.z)));
+
+        for (auto& mesh : model.getMeshes()) {
+            // Distance to the nearest point of the bounding sphere, so large meshes refine early
+            glm::vec3 center = glm::vec3(modelMatrix * glm::vec4(mesh.boundsCenter, 1.0f));
+            float distance = glm::distance(camera.Position, center) - mesh.boundsRadius * maxScale;
+            distance = glm::max(distance, currentScene.settings.nearPlane);
+            mesh.selectLod(pixelsPerUnitAtUnitDistance * maxScale / distance);
+        }
+    }
+}
+
+void setPointCloudClipUniforms(Engine::Shader* shader, const PointCloud& pointCloud) {
+    // Only read for nodes that straddle a volume, fully clipped nodes are never drawn
+    int count = 0;
+    for (const auto& volume : pointCloud.clipVolumes) {
+        if (!volume.enabled || count == PointCloud::MAX_CLIP_VOLUMES) continue;
+
+        std::string index = "[" + std::to_string(count) + "]";
+        shader->setInt("clipVolumeShapes" + index, static_cast<int>(volume.shape));
+        shader->setInt("clipVolumeModes" + index, static_cast<int>(volume.mode));
+        if (volume.shape == Engine::PointCloudClipVolume::Shape::Box) {
+            shader->setVec4("clipVolumeA" + index, glm::vec4(volume.boxMin, 0.0f));
+            shader->setVec4("clipVolumeB" + index, glm::vec4(volume.boxMax, 0.0f));
+        } else {
+            shader->setVec4("clipVolumeA" + index, glm::vec4(volume.planeNormal, volume.planeOffset));
+        }
+        count++;
+    }
+    shader->setInt("clipVolumeCount", count);
+}
+
+void prefetchPointClouds() {
+    for (auto& pointCloud : currentScene.pointClouds) {
+        if (!pointCloud.visible || !pointCloud.enablePrefetch || !pointCloud.hasOctree()) continue;
+
+        // Nothing to predict for a camera at rest, the regular LOD update covers it
+        glm::vec3 horizonPosition = camera.PredictPosition(pointCloud.prefetchHorizon);
+        if (glm::distance(horizonPosition, camera.Position) < 0.01f) continue;
+
+        // Sample the path so nodes passed on the way are fetched, not just the end point
+        std::vector<glm::vec3> predictedPositions = {
+            camera.PredictPosition(pointCloud.prefetchHorizon / 3.0f),
+            camera.PredictPosition(pointCloud.prefetchHorizon * 2.0f / 3.0f),
+            horizonPosition
+        };
+        OctreePointCloudManager::prefetchAlongPath(pointCloud, predictedPositions);
+    }
+}
+
 void updateSpaceMouseCursorAnchor() {
     // Update SpaceMouse cursor anchor based on mode
     static glm::vec3 lastCursorPosition = glm::vec3(FLT_MAX);
@@ -2924,6 +3111,51 @@ bool rayIntersectsModel(const glm::vec3& rayOrigin, const glm::vec3& rayDirectio
 
     return false;
 }
+
+bool rayIntersectsPointCloud(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, float coneSlope, PointCloud& pointCloud, float& distance, glm::vec3& hitPosition) {
+    // Calculate model matrix
+    glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), pointCloud.position);
+    modelMatrix = glm::rotate(modelMatrix, glm::radians(pointCloud.rotation.x), glm::vec3(1, 0, 0));
+    modelMatrix = glm::rotate(modelMatrix, glm::radians(pointCloud.rotation.y), glm::vec3(0, 1, 0));
+    modelMatrix = glm::rotate(modelMatrix, glm::radians(pointCloud.rotation.z), glm::vec3(0, 0, 1));
+    modelMatrix = glm::scale(modelMatrix, pointCloud.scale);
+
+    // Transform ray to point cloud space
+    glm::mat4 invModelMatrix = glm::inverse(modelMatrix);
+    glm::vec3 rayOriginModel = glm::vec3(invModelMatrix * glm::vec4(rayOrigin, 1.0f));
+    glm::vec3 rayDirectionModel = glm::normalize(glm::vec3(invModelMatrix * glm::vec4(rayDirection, 0.0f)));
+
+    // Walks resident octree nodes front to back, testing points inside the pick cone; points
+    // cropped by the cloud's clip volumes are skipped like in rendering
+    Engine::PointCloudQueryHit hit;
+    if (!OctreePointCloudManager::pickRay(pointCloud, rayOriginModel, rayDirectionModel, coneSlope, hit)) {
+        return false;
+    }
+
+    hitPosition = glm::vec3(modelMatrix * glm::vec4(hit.point.position, 1.0f));
+    distance = glm::distance(rayOrigin, hitPosition);
+    return true;
+}
+
+bool pickPointClouds(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, float coneSlope, float& distance, glm::vec3& hitPosition, int& pointCloudIndex) {
+    distance = std::numeric_limits<float>::max();
+    pointCloudIndex = -1;
+
+    for (int i = 0; i < currentScene.pointClouds.size(); i++) {
+        auto& pointCloud = currentScene.pointClouds[i];
+        if (!pointCloud.visible) continue;
+
+        float hitDistance;
+        glm::vec3 hit;
+        if (rayIntersectsPointCloud(rayOrigin, rayDirection, coneSlope, pointCloud, hitDistance, hit) && hitDistance < distance) {
+            distance = hitDistance;
+            hitPosition = hit;
+            pointCloudIndex = i;
+        }
+    }
+
+    return pointCloudIndex != -1;
+}
 #pragma endregion
 
 
@@ -2988,13 +3220,15 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
                     }
                 }
 
-                // Check intersection with point clouds (simplified)
-                for (int i = 0; i < currentScene.pointClouds.size(); i++) {
-                    const auto& pointCloud = currentScene.pointClouds[i];
-                    float distance = glm::length(pointCloud.position - rayOrigin);
-                    if (distance < closestDistance) {
-                        closestDistance = distance;
-                        closestPointCloudIndex = i;
+                // Check intersection with point clouds
+                float coneSlope = pointCloudPickRadiusPixels * 2.0f * tan(glm::radians(camera.Zoom) * 0.5f) / (float)windowHeight;
+                float pointCloudDistance;
+                glm::vec3 pointCloudHit;
+                int pointCloudIndex;
+                if (pickPointClouds(rayOrigin, rayDirection, coneSlope, pointCloudDistance, pointCloudHit, pointCloudIndex)) {
+                    if (pointCloudDistance < closestDistance) {
+                        closestDistance = pointCloudDistance;
+                        closestPointCloudIndex = pointCloudIndex;
                         closestModelIndex = -1;
                     }
                 }
@@ -3003,13 +3237,13 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
                     // Handle Alt+drag duplication
                     if (altPressed) {
                         // Duplicate the model at the same position
-                        Engine::Model duplicatedModel = currentScene.models[closestModelIndex];
+                        Engine::Model duplicatedModel = currentScene.models[closestModelIndex].clone();
                         duplicatedModel.name += "_Copy";
-                        currentScene.models.push_back(duplicatedModel);
+                        currentScene.models.push_back(std::move(duplicatedModel));
                         
                         // Select the new duplicated model for moving
                         currentSelectedIndex = currentScene.models.size() - 1;
-                        std::cout << "Model duplicated: " << duplicatedModel.name << std::endl;
+                        std::cout << "Model duplicated: " << currentScene.models.back().name << std::endl;
                     } else {
                         // Normal Ctrl+drag - select existing model
                         currentSelectedIndex = closestModelIndex;